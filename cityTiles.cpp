@@ -0,0 +1,500 @@
+#include "cityTiles.h"
+#include "stadium.h"
+#include "glExtensions.h"
+#include "frameArena.h"
+#include "renderStats.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "glTrace.h"
+
+// --- Streaming limits ---
+const float CITY_LOAD_RADIUS = VIEW_FAR_DISTANCE;     // tiles closer than this to the eye are wanted
+const size_t CITY_UPLOAD_BYTES_PER_FRAME = 256 * 1024; // spread GPU uploads over frames
+const int CITY_JOBS_PER_WORKER = 2;                    // keep the queue short so priorities stay fresh
+const int MAX_CITY_WORKERS = 3;
+
+// --- Street layout inside one tile ---
+const float ROAD_WIDTH = 10.0f;  // along the tile's west and south edges
+const float KERB_HEIGHT = 0.15f;
+const float LOT_MARGIN = 3.0f;
+
+struct CityVertex {
+    float pos[3];
+    float normal[3];
+    unsigned char color[4];
+};
+
+enum TileState {
+    TILE_QUEUED,   // waiting for or being generated by a worker
+    TILE_READY,    // vertices generated, waiting for upload
+    TILE_RESIDENT  // drawable
+};
+
+struct CityTile {
+    int tx, tz;
+    TileState state;
+    std::vector<CityVertex> vertices; // kept only until upload when buffers are available
+    GLuint buffer;
+    int vertexCount;
+    size_t bytes;   // what this tile counts against the budget
+    long lastUsed;  // frame the tile was last within the load radius
+    Bounds bounds;
+};
+
+struct TileResult {
+    long long key;
+    std::vector<CityVertex> vertices;
+    float maxHeight;
+};
+
+// Main-thread state
+static std::unordered_map<long long, CityTile> tiles;
+static std::deque<long long> uploadQueue;
+static size_t budgetBytes = 0;
+static size_t memoryUsed = 0;
+static size_t averageTileBytes = 8 * 1024; // estimate for tiles still in flight
+static int inFlight = 0;
+static long frame = 0;
+static bool cityReady = false;
+
+// Shared with the workers
+static std::mutex queueMutex;
+static std::condition_variable queueSignal;
+static std::deque<long long> jobs;
+static std::vector<TileResult> results;
+static bool stopping = false;
+static std::vector<std::thread> workers;
+
+static long long tileKey(int tx, int tz) {
+    return ((long long)tx << 32) | (unsigned int)tz;
+}
+
+static void keyToTile(long long key, int& tx, int& tz) {
+    tx = (int)(key >> 32);
+    tz = (int)(key & 0xFFFFFFFF);
+}
+
+// **********************************************
+// ************ TILE GENERATION (WORKERS) *******
+// **********************************************
+
+static unsigned int hashTile(int tx, int tz) {
+    unsigned int h = (unsigned int)tx * 73856093u ^ (unsigned int)tz * 19349663u;
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h ? h : 1u;
+}
+
+struct TileRandom {
+    unsigned int state;
+    unsigned int next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    float unit() { return (next() & 0xFFFFFF) / (float)0x1000000; }
+};
+
+static void addQuad(std::vector<CityVertex>& out, const float p[4][3], float nx, float ny, float nz,
+                    const float color[3]) {
+    static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+    for (int i = 0; i < 6; ++i) {
+        CityVertex v;
+        for (int k = 0; k < 3; ++k) v.pos[k] = p[order[i]][k];
+        v.normal[0] = nx; v.normal[1] = ny; v.normal[2] = nz;
+        for (int k = 0; k < 3; ++k) v.color[k] = (unsigned char)(color[k] * 255.0f);
+        v.color[3] = 255;
+        out.push_back(v);
+    }
+}
+
+static void addGroundQuad(std::vector<CityVertex>& out, float x0, float z0, float x1, float z1, float y,
+                          const float color[3]) {
+    float p[4][3] = { {x0, y, z0}, {x0, y, z1}, {x1, y, z1}, {x1, y, z0} };
+    addQuad(out, p, 0.0f, 1.0f, 0.0f, color);
+}
+
+// Axis-aligned box without a bottom face
+static void addBox(std::vector<CityVertex>& out, float x0, float y0, float z0, float x1, float y1, float z1,
+                   const float sideColor[3], const float topColor[3]) {
+    addGroundQuad(out, x0, z0, x1, z1, y1, topColor);
+    float east[4][3]  = { {x1, y0, z1}, {x1, y0, z0}, {x1, y1, z0}, {x1, y1, z1} };
+    float west[4][3]  = { {x0, y0, z0}, {x0, y0, z1}, {x0, y1, z1}, {x0, y1, z0} };
+    float south[4][3] = { {x0, y0, z1}, {x1, y0, z1}, {x1, y1, z1}, {x0, y1, z1} };
+    float north[4][3] = { {x1, y0, z0}, {x0, y0, z0}, {x0, y1, z0}, {x1, y1, z0} };
+    addQuad(out, east, 1.0f, 0.0f, 0.0f, sideColor);
+    addQuad(out, west, -1.0f, 0.0f, 0.0f, sideColor);
+    addQuad(out, south, 0.0f, 0.0f, 1.0f, sideColor);
+    addQuad(out, north, 0.0f, 0.0f, -1.0f, sideColor);
+}
+
+static void addRoadMarkings(std::vector<CityVertex>& out, float x0, float z0) {
+    static const float paint[3] = { 0.9f, 0.9f, 0.8f };
+    float centre = ROAD_WIDTH / 2.0f;
+    for (float d = 1.0f; d < CITY_TILE_SIZE; d += 8.0f) {
+        addGroundQuad(out, x0 + centre - 0.2f, z0 + d, x0 + centre + 0.2f, z0 + d + 3.0f, 0.02f, paint);
+        addGroundQuad(out, x0 + d, z0 + centre - 0.2f, x0 + d + 3.0f, z0 + centre + 0.2f, 0.02f, paint);
+    }
+}
+
+// Two rows of bays facing a centre aisle, most of them taken on match day
+static void addCarPark(std::vector<CityVertex>& out, TileRandom& rng, float bx0, float bz0, float bx1, float bz1) {
+    static const float tarmac[3] = { 0.28f, 0.28f, 0.3f };
+    static const float paint[3] = { 0.95f, 0.95f, 0.95f };
+    static const float carColors[6][3] = {
+        {0.7f, 0.1f, 0.1f}, {0.1f, 0.2f, 0.6f}, {0.85f, 0.85f, 0.85f},
+        {0.1f, 0.1f, 0.1f}, {0.5f, 0.5f, 0.55f}, {0.8f, 0.7f, 0.2f}
+    };
+    static const float glass[3] = { 0.15f, 0.2f, 0.25f };
+    float y = KERB_HEIGHT + 0.01f;
+    addGroundQuad(out, bx0, bz0, bx1, bz1, y, tarmac);
+
+    const float bayWidth = 3.0f, bayDepth = 6.0f;
+    float rows[2] = { bz0 + 2.0f, bz1 - 2.0f - bayDepth };
+    for (int r = 0; r < 2; ++r) {
+        for (float x = bx0 + 2.0f; x + bayWidth <= bx1 - 2.0f; x += bayWidth) {
+            addGroundQuad(out, x - 0.1f, rows[r], x + 0.1f, rows[r] + bayDepth, y + 0.01f, paint);
+            if (rng.unit() > 0.75f) continue;
+            const float* body = carColors[rng.next() % 6];
+            float cx = x + bayWidth / 2.0f, cz = rows[r] + bayDepth / 2.0f;
+            addBox(out, cx - 0.9f, y, cz - 2.1f, cx + 0.9f, y + 0.9f, cz + 2.1f, body, body);
+            addBox(out, cx - 0.8f, y + 0.9f, cz - 1.1f, cx + 0.8f, y + 1.5f, cz + 1.0f, glass, body);
+        }
+    }
+}
+
+// Up to four buildings on a 2x2 grid of lots; the skyline rises away from the stadium
+static void addBuildings(std::vector<CityVertex>& out, TileRandom& rng, float bx0, float bz0, float bx1, float bz1,
+                         float distance, float& maxHeight) {
+    static const float facades[5][3] = {
+        {0.75f, 0.72f, 0.65f}, {0.6f, 0.55f, 0.5f}, {0.55f, 0.6f, 0.68f},
+        {0.8f, 0.78f, 0.75f}, {0.65f, 0.45f, 0.35f}
+    };
+    float lotW = (bx1 - bx0) / 2.0f, lotD = (bz1 - bz0) / 2.0f;
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            if (rng.unit() < 0.15f) continue; // empty lot
+            float lx0 = bx0 + i * lotW + LOT_MARGIN, lz0 = bz0 + j * lotD + LOT_MARGIN;
+            float w = (lotW - 2.0f * LOT_MARGIN) * (0.6f + 0.4f * rng.unit());
+            float d = (lotD - 2.0f * LOT_MARGIN) * (0.6f + 0.4f * rng.unit());
+            float h = 6.0f + rng.unit() * (10.0f + distance * 0.04f);
+            if (rng.unit() < 0.1f) h *= 2.5f; // the odd tower
+            const float* facade = facades[rng.next() % 5];
+            float roof[3] = { facade[0] * 0.6f, facade[1] * 0.6f, facade[2] * 0.6f };
+            addBox(out, lx0, KERB_HEIGHT, lz0, lx0 + w, KERB_HEIGHT + h, lz0 + d, facade, roof);
+            maxHeight = std::max(maxHeight, KERB_HEIGHT + h);
+        }
+    }
+}
+
+// Everything in a tile is derived from its coordinates, so a tile that is
+// evicted and loaded again looks the same.
+static void generateTile(int tx, int tz, std::vector<CityVertex>& out, float& maxHeight) {
+    float x0 = tx * CITY_TILE_SIZE, z0 = tz * CITY_TILE_SIZE;
+    float x1 = x0 + CITY_TILE_SIZE, z1 = z0 + CITY_TILE_SIZE;
+    maxHeight = 0.0f;
+
+    // The park: just lawn under the stadium and the trees
+    bool park = x0 >= -PARK_HALF_EXTENT && x1 <= PARK_HALF_EXTENT &&
+                z0 >= -PARK_HALF_EXTENT && z1 <= PARK_HALF_EXTENT;
+    if (park) {
+        static const float lawn[3] = { 0.18f, 0.45f, 0.15f };
+        addGroundQuad(out, x0, z0, x1, z1, -0.05f, lawn);
+        return;
+    }
+
+    TileRandom rng = { hashTile(tx, tz) };
+    static const float asphalt[3] = { 0.22f, 0.22f, 0.24f };
+    static const float pavement[3] = { 0.62f, 0.61f, 0.58f };
+    static const float grass[3] = { 0.2f, 0.5f, 0.18f };
+    addGroundQuad(out, x0, z0, x1, z1, 0.0f, asphalt);
+    addRoadMarkings(out, x0, z0);
+    addBox(out, x0 + ROAD_WIDTH, 0.0f, z0 + ROAD_WIDTH, x1, KERB_HEIGHT, z1, pavement, pavement);
+    maxHeight = KERB_HEIGHT;
+
+    float bx0 = x0 + ROAD_WIDTH + LOT_MARGIN, bz0 = z0 + ROAD_WIDTH + LOT_MARGIN;
+    float bx1 = x1 - LOT_MARGIN, bz1 = z1 - LOT_MARGIN;
+    float cx = 0.5f * (x0 + x1), cz = 0.5f * (z0 + z1);
+    float distance = std::sqrt(cx * cx + cz * cz);
+
+    // Fans park close to the ground; further out it is mostly buildings
+    float carParkChance = distance < 450.0f ? 0.5f : 0.1f;
+    float pick = rng.unit();
+    if (pick < carParkChance) {
+        addCarPark(out, rng, bx0, bz0, bx1, bz1);
+        maxHeight = KERB_HEIGHT + 1.6f;
+    } else if (pick < carParkChance + 0.1f) {
+        addGroundQuad(out, bx0, bz0, bx1, bz1, KERB_HEIGHT + 0.01f, grass);
+    } else {
+        addBuildings(out, rng, bx0, bz0, bx1, bz1, distance, maxHeight);
+    }
+}
+
+static void workerLoop() {
+    for (;;) {
+        long long key;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueSignal.wait(lock, [] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            key = jobs.front();
+            jobs.pop_front();
+        }
+
+        int tx, tz;
+        keyToTile(key, tx, tz);
+        TileResult result;
+        result.key = key;
+        generateTile(tx, tz, result.vertices, result.maxHeight);
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        results.push_back(TileResult());
+        results.back().key = key;
+        results.back().maxHeight = result.maxHeight;
+        results.back().vertices.swap(result.vertices);
+    }
+}
+
+// **********************************************
+// ************ CACHE (MAIN THREAD) *************
+// **********************************************
+
+void initCity(int budgetMB) {
+    budgetBytes = (size_t)budgetMB * 1024 * 1024;
+    int workerCount = (int)std::thread::hardware_concurrency() - 1;
+    workerCount = std::max(1, std::min(workerCount, MAX_CITY_WORKERS));
+    stopping = false;
+    for (int i = 0; i < workerCount; ++i) workers.push_back(std::thread(workerLoop));
+    cityReady = true;
+    std::cout << "City: " << workerCount << " tile workers, " << budgetMB << " MB budget" << std::endl;
+}
+
+static float tileDistance(int tx, int tz, const float eye[3]) {
+    float x0 = tx * CITY_TILE_SIZE, z0 = tz * CITY_TILE_SIZE;
+    float dx = std::max(std::max(x0 - eye[0], eye[0] - (x0 + CITY_TILE_SIZE)), 0.0f);
+    float dz = std::max(std::max(z0 - eye[2], eye[2] - (z0 + CITY_TILE_SIZE)), 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+static void releaseTile(CityTile& tile) {
+    if (tile.buffer) glExt.DeleteBuffers(1, &tile.buffer);
+    tile.buffer = 0;
+    std::vector<CityVertex>().swap(tile.vertices);
+    memoryUsed -= tile.bytes;
+    tile.bytes = 0;
+}
+
+// Evicts the least recently used tile, or failing that one further away
+// than maxDistance. Tiles still with a worker hold no memory and are skipped.
+static bool evictOne(const float eye[3], float maxDistance) {
+    std::unordered_map<long long, CityTile>::iterator victim = tiles.end();
+    float victimDistance = 0.0f;
+    for (std::unordered_map<long long, CityTile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        CityTile& t = it->second;
+        if (t.state == TILE_QUEUED) continue;
+        float d = tileDistance(t.tx, t.tz, eye);
+        if (victim == tiles.end() || t.lastUsed < victim->second.lastUsed ||
+            (t.lastUsed == victim->second.lastUsed && d > victimDistance)) {
+            victim = it;
+            victimDistance = d;
+        }
+    }
+    if (victim == tiles.end()) return false;
+    if (victim->second.lastUsed == frame && victimDistance <= maxDistance) return false;
+
+    releaseTile(victim->second);
+    if (victim->second.state == TILE_READY)
+        uploadQueue.erase(std::find(uploadQueue.begin(), uploadQueue.end(), victim->first));
+    tiles.erase(victim);
+    return true;
+}
+
+static void collectResults(std::vector<TileResult>& finished) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        finished.swap(results);
+    }
+    for (size_t i = 0; i < finished.size(); ++i) {
+        --inFlight;
+        std::unordered_map<long long, CityTile>::iterator it = tiles.find(finished[i].key);
+        if (it == tiles.end()) continue;
+        CityTile& tile = it->second;
+        tile.vertices.swap(finished[i].vertices);
+        tile.vertexCount = (int)tile.vertices.size();
+        tile.bytes = tile.vertices.size() * sizeof(CityVertex);
+        memoryUsed += tile.bytes;
+        averageTileBytes = (averageTileBytes * 7 + tile.bytes) / 8;
+
+        float x0 = tile.tx * CITY_TILE_SIZE, z0 = tile.tz * CITY_TILE_SIZE;
+        makeBounds(tile.bounds, x0, -0.1f, z0, x0 + CITY_TILE_SIZE, finished[i].maxHeight, z0 + CITY_TILE_SIZE);
+
+        tile.state = TILE_READY;
+        uploadQueue.push_back(finished[i].key);
+    }
+    finished.clear();
+}
+
+// A bounded number of bytes per frame, so a burst of arrivals is spread out
+static int uploadTiles() {
+    size_t uploaded = 0;
+    int count = 0;
+    while (!uploadQueue.empty() && uploaded < CITY_UPLOAD_BYTES_PER_FRAME) {
+        CityTile& tile = tiles[uploadQueue.front()];
+        uploadQueue.pop_front();
+        if (glExt.hasVertexBuffers && tile.vertexCount > 0) {
+            glExt.GenBuffers(1, &tile.buffer);
+            glExt.BindBuffer(GL_ARRAY_BUFFER, tile.buffer);
+            glExt.BufferData(GL_ARRAY_BUFFER, tile.bytes, &tile.vertices[0], GL_STATIC_DRAW);
+            std::vector<CityVertex>().swap(tile.vertices); // the buffer's copy is what counts now
+        }
+        tile.state = TILE_RESIDENT;
+        uploaded += tile.bytes;
+        ++count;
+    }
+    if (count && glExt.hasVertexBuffers) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    return count;
+}
+
+struct MissingTile {
+    int tx, tz;
+    float distance;
+    bool operator<(const MissingTile& o) const { return distance < o.distance; }
+};
+
+void updateCity(const float eye[3]) {
+    if (!cityReady) return;
+    ++frame;
+
+    static std::vector<TileResult> finished;
+    collectResults(finished);
+    int uploads = uploadTiles();
+
+    // --- Mark wanted tiles, list the ones not loaded yet ---
+    int span = (int)std::ceil(CITY_LOAD_RADIUS / CITY_TILE_SIZE);
+    MissingTile* missing = frameAllocArray<MissingTile>((size_t)(2 * span + 1) * (2 * span + 1));
+    size_t missingCount = 0;
+    int ex = (int)std::floor(eye[0] / CITY_TILE_SIZE), ez = (int)std::floor(eye[2] / CITY_TILE_SIZE);
+    for (int tz = ez - span; tz <= ez + span; ++tz) {
+        for (int tx = ex - span; tx <= ex + span; ++tx) {
+            float d = tileDistance(tx, tz, eye);
+            if (d > CITY_LOAD_RADIUS) continue;
+            std::unordered_map<long long, CityTile>::iterator it = tiles.find(tileKey(tx, tz));
+            if (it != tiles.end()) it->second.lastUsed = frame;
+            else {
+                MissingTile m = { tx, tz, d };
+                missing[missingCount++] = m;
+            }
+        }
+    }
+    std::sort(missing, missing + missingCount);
+
+    // --- Queue the nearest missing tiles, making room if needed ---
+    int maxInFlight = (int)workers.size() * CITY_JOBS_PER_WORKER;
+    size_t queued = 0;
+    for (size_t i = 0; i < missingCount && inFlight < maxInFlight; ++i) {
+        size_t projected = memoryUsed + (size_t)(inFlight + 1) * averageTileBytes;
+        bool room = true;
+        while (projected > budgetBytes && room) {
+            room = evictOne(eye, missing[i].distance);
+            projected = memoryUsed + (size_t)(inFlight + 1) * averageTileBytes;
+        }
+        if (!room) break; // everything resident is nearer than what is left to load
+
+        CityTile tile = CityTile();
+        tile.tx = missing[i].tx;
+        tile.tz = missing[i].tz;
+        tile.state = TILE_QUEUED;
+        tile.buffer = 0;
+        tile.vertexCount = 0;
+        tile.bytes = 0;
+        tile.lastUsed = frame;
+        tiles[tileKey(tile.tx, tile.tz)] = tile;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            jobs.push_back(tileKey(tile.tx, tile.tz));
+        }
+        ++inFlight;
+        ++queued;
+    }
+    if (queued) queueSignal.notify_all();
+
+    // Arrivals can overshoot the estimate; trim tiles nobody wants any more
+    while (memoryUsed > budgetBytes && evictOne(eye, CITY_LOAD_RADIUS * 2.0f)) {}
+
+    statsAdd(STAT_CITY_UPLOADS, uploads);
+    statsAdd(STAT_CITY_KB, (long)(memoryUsed / 1024));
+}
+
+// **********************************************
+// ************ DRAWING *************************
+// **********************************************
+
+void drawCity(const Frustum& frustum) {
+    if (!cityReady) return;
+
+    // Fade the far edge into the sky so tiles never pop in at the horizon
+    GLfloat sky[4];
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, sky);
+    glFogi(GL_FOG_MODE, GL_LINEAR);
+    glFogfv(GL_FOG_COLOR, sky);
+    glFogf(GL_FOG_START, VIEW_FAR_DISTANCE * 0.45f);
+    glFogf(GL_FOG_END, VIEW_FAR_DISTANCE * 0.95f);
+    glEnable(GL_FOG);
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    int drawn = 0;
+    for (std::unordered_map<long long, CityTile>::iterator it = tiles.begin(); it != tiles.end(); ++it) {
+        const CityTile& tile = it->second;
+        if (tile.state != TILE_RESIDENT || !tile.vertexCount) continue;
+        if (!boundsInFrustum(tile.bounds, frustum)) continue;
+
+        const char* base = 0;
+        if (tile.buffer) glExt.BindBuffer(GL_ARRAY_BUFFER, tile.buffer);
+        else base = (const char*)&tile.vertices[0];
+        glVertexPointer(3, GL_FLOAT, sizeof(CityVertex), base + offsetof(CityVertex, pos));
+        glNormalPointer(GL_FLOAT, sizeof(CityVertex), base + offsetof(CityVertex, normal));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(CityVertex), base + offsetof(CityVertex, color));
+        glDrawArrays(GL_TRIANGLES, 0, tile.vertexCount);
+        ++drawn;
+    }
+    if (glExt.hasVertexBuffers) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisable(GL_FOG);
+
+    statsAdd(STAT_CITY_TILES, drawn);
+}
+
+void shutdownCity() {
+    if (!cityReady) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    queueSignal.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+    workers.clear();
+    results.clear();
+
+    for (std::unordered_map<long long, CityTile>::iterator it = tiles.begin(); it != tiles.end(); ++it)
+        releaseTile(it->second);
+    tiles.clear();
+    uploadQueue.clear();
+    inFlight = 0;
+    cityReady = false;
+}
@@ -0,0 +1,32 @@
+#ifndef CITY_TILES_H
+#define CITY_TILES_H
+
+#include "viewMath.h"
+
+// **********************************************
+// ************ STREAMED CITY TILES *************
+// **********************************************
+
+// The district around the stadium - roads, car parks and buildings - split
+// into square tiles that are generated on worker threads and paged in and out
+// around the director camera. Finished tiles are uploaded a few per frame so
+// arrivals never stall a frame, and the least recently used tiles are evicted
+// to stay under the memory budget.
+
+const float CITY_TILE_SIZE = 80.0f;
+
+// Starts the worker threads. budgetMB bounds the memory held by tiles
+// (generated vertices waiting for upload plus uploaded buffers).
+void initCity(int budgetMB);
+
+// Once per frame, before drawing: collects finished tiles, uploads some,
+// queues missing ones nearest to eye first and evicts if over budget.
+void updateCity(const float eye[3]);
+
+// Draws the resident tiles inside the frustum.
+void drawCity(const Frustum& frustum);
+
+// Stops the workers and frees every tile. Needs the GL context.
+void shutdownCity();
+
+#endif
@@ -0,0 +1,314 @@
+#include "crowd.h"
+#include "jobSystem.h"
+#include "stadium.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Most fans per job; jobs never cross a sector
+const int CROWD_JOB_FANS = 4096;
+
+// --- Mexican wave: a bump of raised fans travelling round the bowl ---
+const float WAVE_DEGREES_PER_SECOND = 30.0f; // a lap in twelve seconds
+const float WAVE_HALF_WIDTH = 16.0f;         // degrees either side of the front
+const float WAVE_START_DEG = 250.0f;
+const float WAVE_REACTION_DEG = 3.0f;        // fans rise up to this far early or late
+const float WAVE_TIER_LAG_DEG = 1.0f;        // and the back rows a little after the front
+const float WAVE_FADE_SECONDS = 2.0f;        // to start or stop once toggled
+
+// --- Goal cheer ---
+const float CHEER_SECONDS = 8.0f;
+const float CHEER_FADE_SECONDS = 3.0f;       // the last part of it
+const float CHEER_BOUNCE_HZ = 1.6f;
+
+// How fast a fan gets up or sits down, per second
+const float LIFT_RATE = 8.0f;
+
+// Every figure faces the pitch centre. Seat tops are SEAT_HEIGHT / 2 above
+// the seat centre; standing raises the body 0.45 and lifts the arms.
+const float CROWD_FIGURE[CROWD_FAN_VERTICES][4] = {
+    // Shirt
+    { -0.25f, 0.2f, 0.45f, 0 }, { 0.25f, 0.2f, 0.45f, 0 }, { 0.25f, 0.9f, 0.45f, 0 },
+    { -0.25f, 0.2f, 0.45f, 0 }, { 0.25f, 0.9f, 0.45f, 0 }, { -0.25f, 0.9f, 0.45f, 0 },
+    // Head
+    { -0.13f, 0.9f, 0.45f, 1 }, { 0.13f, 0.9f, 0.45f, 1 }, { 0.13f, 1.18f, 0.45f, 1 },
+    { -0.13f, 0.9f, 0.45f, 1 }, { 0.13f, 1.18f, 0.45f, 1 }, { -0.13f, 1.18f, 0.45f, 1 },
+    // Arms in a V, no height at all while seated
+    { -0.12f, 1.18f, 0.45f, 1 }, { 0.12f, 1.18f, 0.45f, 1 }, { 0.32f, 1.18f, 0.95f, 1 },
+    { -0.12f, 1.18f, 0.45f, 1 }, { 0.32f, 1.18f, 0.95f, 1 }, { -0.32f, 1.18f, 0.95f, 1 }
+};
+const unsigned char CROWD_SKIN[3] = { 222, 184, 135 };
+
+// Team shirts (the players' colours), then the odd white shirt and dark jacket
+static const unsigned char SHIRT_RED[3] = { 230, 26, 26 };
+static const unsigned char SHIRT_BLUE[3] = { 26, 26, 230 };
+static const unsigned char SHIRT_WHITE[3] = { 245, 245, 245 };
+static const unsigned char SHIRT_DARK[3] = { 60, 60, 70 };
+
+// SoA, one entry per seat in layout order
+static std::vector<CrowdFan> fans;
+static std::vector<float> waveAngle;   // seat angle with the fan's reaction folded in
+static std::vector<float> rhythm;      // 0-1 offset into the cheer bounce
+static std::vector<float> enthusiasm;  // 0.6-1 of a full cheer
+static std::vector<float> side;        // 0 red supporters, 1 blue
+static std::vector<float> lift;        // 0 seated .. 1 standing, arms up
+static std::vector<unsigned char> liftBytes;
+
+static unsigned int sectorFirst[NUM_SEAT_SECTORS + 1];
+static Bounds sectorBounds[NUM_SEAT_SECTORS];
+static std::vector<int> jobFirst; // job j is fans [jobFirst[j], jobFirst[j + 1])
+static bool ready = false;
+
+static float waveFront = WAVE_START_DEG;
+static float waveStrength = 1.0f;
+static bool waveOn = true;
+static float cheerLeft[2] = { 0.0f, 0.0f }; // red, blue
+static float bouncePhase = 0.0f;
+
+// Per-step job context
+struct CrowdStep {
+    float front, strength, cheerRed, cheerBlue, bounce, ease;
+};
+static CrowdStep step;
+
+// xorshift32 seeded by seat, so the crowd is the same every run
+static unsigned int nextRandom(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+static float randomRange(unsigned int& state, float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+// **********************************************
+// ************ SEATING THE CROWD ***************
+// **********************************************
+
+// Sections behind the +X goal (Gate A side) support blue, the -X half red
+static bool sectorSupportsBlue(int sector) {
+    float centreDeg = (sector + 0.5f) * 360.0f / NUM_SEAT_SECTORS;
+    return std::cos(centreDeg * (float)M_PI / 180.0f) > 0.0f;
+}
+
+static void seatFan(int i, const SeatPlacement& seat, bool blue) {
+    unsigned int seed = 0x9E3779B9u ^ (unsigned int)(i * 2654435761u);
+    nextRandom(seed);
+
+    CrowdFan& f = fans[i];
+    f.pos[0] = seat.x; f.pos[1] = seat.y; f.pos[2] = seat.z;
+    int pick = nextRandom(seed) % 20;
+    const unsigned char* shirt = pick < 2 ? SHIRT_WHITE : pick < 3 ? SHIRT_DARK : blue ? SHIRT_BLUE : SHIRT_RED;
+    float shade = randomRange(seed, 0.85f, 1.0f);
+    for (int k = 0; k < 3; ++k) f.color[k] = (unsigned char)(shirt[k] * shade);
+    f.color[3] = 255;
+
+    waveAngle[i] = seat.angleDeg + seat.tier * WAVE_TIER_LAG_DEG + randomRange(seed, -WAVE_REACTION_DEG, WAVE_REACTION_DEG);
+    rhythm[i] = randomRange(seed, 0.0f, 1.0f);
+    enthusiasm[i] = randomRange(seed, 0.6f, 1.0f);
+    side[i] = blue ? 1.0f : 0.0f;
+    lift[i] = 0.0f;
+}
+
+static void settleCrowd();
+
+void initCrowd(const std::vector<SeatPlacement>& seats, const unsigned int* sectorFirstSeat) {
+    int count = (int)seats.size();
+    fans.assign(count, CrowdFan());
+    std::vector<float>* arrays[] = { &waveAngle, &rhythm, &enthusiasm, &side, &lift };
+    for (int a = 0; a < 5; ++a) arrays[a]->assign(count, 0.0f);
+    liftBytes.assign(count, 0);
+
+    jobFirst.clear();
+    for (int s = 0; s < NUM_SEAT_SECTORS; ++s) {
+        int first = sectorFirstSeat[s], end = sectorFirstSeat[s + 1];
+        sectorFirst[s] = first;
+        Bounds& b = sectorBounds[s];
+        for (int k = 0; k < 3; ++k) { b.min[k] = 1e30f; b.max[k] = -1e30f; }
+        for (int i = first; i < end; ++i) {
+            seatFan(i, seats[i], sectorSupportsBlue(s));
+            // A standing fan with arms up, however it is turned
+            const float* p = fans[i].pos;
+            b.min[0] = std::min(b.min[0], p[0] - 0.35f); b.max[0] = std::max(b.max[0], p[0] + 0.35f);
+            b.min[1] = std::min(b.min[1], p[1]);         b.max[1] = std::max(b.max[1], p[1] + 2.2f);
+            b.min[2] = std::min(b.min[2], p[2] - 0.35f); b.max[2] = std::max(b.max[2], p[2] + 0.35f);
+        }
+        for (int j = first; j < end; j += CROWD_JOB_FANS) jobFirst.push_back(j);
+    }
+    sectorFirst[NUM_SEAT_SECTORS] = count;
+    jobFirst.push_back(count);
+
+    ready = true;
+    settleCrowd();
+    std::cout << "Crowd: " << count << " fans in " << jobFirst.size() - 1 << " jobs, "
+              << 5 * sizeof(float) + 1 << " bytes of state and " << sizeof(CrowdFan) << " of instance each" << std::endl;
+}
+
+bool crowdReady() {
+    return ready;
+}
+
+void startCrowdCheer(bool redScored) {
+    cheerLeft[redScored ? 0 : 1] = CHEER_SECONDS;
+}
+
+void toggleCrowdWave() {
+    waveOn = !waveOn;
+}
+
+int crowdFanCount() {
+    return (int)fans.size();
+}
+
+const CrowdFan* crowdFans() {
+    return fans.empty() ? 0 : &fans[0];
+}
+
+const unsigned char* crowdLifts() {
+    return liftBytes.empty() ? 0 : &liftBytes[0];
+}
+
+int crowdSectorFirstFan(int sector) {
+    return sectorFirst[sector];
+}
+
+const Bounds& crowdSectorBounds(int sector) {
+    return sectorBounds[sector];
+}
+
+// **********************************************
+// ************ UPDATE **************************
+// **********************************************
+
+// Fans [first, first + count): four at a time, then the rest one by one so
+// no job touches its neighbour's fans
+static void updateFans(int first, int count) {
+    const float* angle = &waveAngle[first];
+    const float* offset = &rhythm[first];
+    const float* keen = &enthusiasm[first];
+    const float* team = &side[first];
+    float* l = &lift[first];
+    unsigned char* out = &liftBytes[first];
+    float cheerSpan = step.cheerBlue - step.cheerRed;
+#ifdef __SSE2__
+    __m128 front = _mm_set1_ps(step.front), turn = _mm_set1_ps(360.0f), perTurn = _mm_set1_ps(1.0f / 360.0f);
+    __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), three = _mm_set1_ps(3.0f), zero = _mm_setzero_ps();
+    __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 perWidth = _mm_set1_ps(1.0f / WAVE_HALF_WIDTH), strength = _mm_set1_ps(step.strength);
+    __m128 bounce = _mm_set1_ps(step.bounce), cheerRed = _mm_set1_ps(step.cheerRed), span = _mm_set1_ps(cheerSpan);
+    __m128 base = _mm_set1_ps(0.6f), swing = _mm_set1_ps(0.4f), ease = _mm_set1_ps(step.ease), full = _mm_set1_ps(255.0f);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        // Degrees from the wave front, wrapped to -180..180
+        __m128 d = _mm_sub_ps(_mm_loadu_ps(angle + i), front);
+        d = _mm_sub_ps(d, _mm_mul_ps(turn, _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(d, perTurn)))));
+        __m128 w = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_and_ps(d, absMask), perWidth)));
+        w = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(w, w), _mm_sub_ps(three, _mm_mul_ps(two, w))), strength);
+
+        // Cheer: the fan's team level, bouncing on a triangle wave
+        __m128 x = _mm_add_ps(bounce, _mm_loadu_ps(offset + i));
+        __m128 tri = _mm_and_ps(_mm_mul_ps(two, _mm_sub_ps(x, _mm_cvtepi32_ps(_mm_cvtps_epi32(x)))), absMask);
+        __m128 c = _mm_add_ps(cheerRed, _mm_mul_ps(_mm_loadu_ps(team + i), span));
+        c = _mm_mul_ps(_mm_mul_ps(c, _mm_loadu_ps(keen + i)), _mm_add_ps(base, _mm_mul_ps(swing, tri)));
+
+        __m128 current = _mm_loadu_ps(l + i);
+        current = _mm_add_ps(current, _mm_mul_ps(_mm_sub_ps(_mm_max_ps(w, c), current), ease));
+        _mm_storeu_ps(l + i, current);
+
+        __m128i bytes = _mm_cvtps_epi32(_mm_mul_ps(current, full));
+        bytes = _mm_packs_epi32(bytes, bytes);
+        bytes = _mm_packus_epi16(bytes, bytes);
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(out + i, &packed, 4);
+    }
+#else
+    int i = 0;
+#endif
+    for (; i < count; ++i) {
+        float d = angle[i] - step.front;
+        d -= 360.0f * std::floor(d / 360.0f + 0.5f);
+        float w = std::max(0.0f, 1.0f - std::fabs(d) / WAVE_HALF_WIDTH);
+        w = w * w * (3.0f - 2.0f * w) * step.strength;
+
+        float x = step.bounce + offset[i];
+        float tri = std::fabs(2.0f * (x - std::floor(x + 0.5f)));
+        float c = (step.cheerRed + team[i] * cheerSpan) * keen[i] * (0.6f + 0.4f * tri);
+
+        l[i] += (std::max(w, c) - l[i]) * step.ease;
+        out[i] = (unsigned char)(l[i] * 255.0f + 0.5f);
+    }
+}
+
+static void updateJob(int job, int, void*) {
+    int first = jobFirst[job];
+    updateFans(first, jobFirst[job + 1] - first);
+}
+
+static void runUpdate() {
+    parallelFor((int)jobFirst.size() - 1, updateJob, 0);
+}
+
+// Straight to the pose the current wave and cheer call for
+static void settleCrowd() {
+    step.front = waveFront;
+    step.strength = waveStrength;
+    step.cheerRed = step.cheerBlue = 0.0f;
+    step.bounce = bouncePhase;
+    step.ease = 1.0f;
+    runUpdate();
+}
+
+void updateCrowd(float dt) {
+    if (!ready) return;
+    waveFront = std::fmod(waveFront + WAVE_DEGREES_PER_SECOND * dt, 360.0f);
+    float fade = dt / WAVE_FADE_SECONDS;
+    waveStrength = waveOn ? std::min(1.0f, waveStrength + fade) : std::max(0.0f, waveStrength - fade);
+    bouncePhase = std::fmod(bouncePhase + CHEER_BOUNCE_HZ * dt, 1.0f);
+
+    float cheer[2];
+    for (int t = 0; t < 2; ++t) {
+        cheer[t] = std::min(1.0f, std::max(0.0f, cheerLeft[t] / CHEER_FADE_SECONDS));
+        cheerLeft[t] = std::max(0.0f, cheerLeft[t] - dt);
+    }
+    step.front = waveFront;
+    step.strength = waveStrength;
+    step.cheerRed = cheer[0];
+    step.cheerBlue = cheer[1];
+    step.bounce = bouncePhase;
+    step.ease = std::min(1.0f, LIFT_RATE * dt);
+    runUpdate();
+}
+
+// **********************************************
+// ************ VERTICES ************************
+// **********************************************
+
+void buildCrowdVertices(int first, int count, float shade, CrowdVertex* out) {
+    unsigned char skin[3];
+    for (int k = 0; k < 3; ++k) skin[k] = (unsigned char)(CROWD_SKIN[k] * shade);
+    for (int i = first; i < first + count; ++i) {
+        const CrowdFan& f = fans[i];
+        float dx = -f.pos[0], dz = -f.pos[2];
+        float len = std::sqrt(dx * dx + dz * dz);
+        if (len > 0.0f) { dx /= len; dz /= len; }
+        float up = liftBytes[i] * (1.0f / 255.0f);
+        unsigned char shirt[4] = { (unsigned char)(f.color[0] * shade), (unsigned char)(f.color[1] * shade),
+                                   (unsigned char)(f.color[2] * shade), 255 };
+        for (int v = 0; v < CROWD_FAN_VERTICES; ++v) {
+            const float* c = CROWD_FIGURE[v];
+            // Across the fan is perpendicular to the way they face
+            out->pos[0] = f.pos[0] - dz * c[0];
+            out->pos[1] = f.pos[1] + c[1] + c[2] * up;
+            out->pos[2] = f.pos[2] + dx * c[0];
+            std::memcpy(out->color, c[3] != 0.0f ? skin : shirt, 3);
+            out->color[3] = 255;
+            ++out;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef CROWD_H
+#define CROWD_H
+
+#include "stadiumGeometry.h"
+#include "viewMath.h"
+#include <vector>
+
+// **********************************************
+// ************ ANIMATED CROWD ******************
+// **********************************************
+
+// A fan in every seat of the bowl, in the colours of the team their section
+// supports. They rise for a Mexican wave running round the oval and stand
+// and bounce when their team scores. The state is one small record per seat
+// in separate arrays (wave angle, rhythm, enthusiasm, side, lift), updated
+// by an SSE2 kernel four fans at a time in jobs that never cross a sector,
+// so the sectors run on the job system. The only thing that changes per
+// frame is a lift byte per fan: the shader raises the fan's figure by it,
+// so everything else is uploaded once. Nothing is allocated after initCrowd().
+
+// Static per fan, and the per-instance vertex layout with the lift byte
+struct CrowdFan {
+    float pos[3];            // seat centre
+    unsigned char color[4];  // shirt
+};
+
+// Each figure is three quads facing the pitch: shirt, head, raised arms.
+// Corners are x across, y up at lift 0, extra y at full lift, 1 for skin.
+const int CROWD_FAN_VERTICES = 18;
+extern const float CROWD_FIGURE[CROWD_FAN_VERTICES][4];
+extern const unsigned char CROWD_SKIN[3];
+
+// For the fallback without instancing and the software renderer
+struct CrowdVertex {
+    float pos[3];
+    unsigned char color[4];
+};
+
+// Seats as from generateSeatLayout(): sector order, sectorFirstSeat with
+// NUM_SEAT_SECTORS + 1 entries. Fans start settled at their current pose.
+void initCrowd(const std::vector<SeatPlacement>& seats, const unsigned int* sectorFirstSeat);
+bool crowdReady();
+
+// One simulation step. Uses the job system if started.
+void updateCrowd(float dt);
+
+// The scoring team's sections jump up and cheer for a while
+void startCrowdCheer(bool redScored);
+void toggleCrowdWave();
+
+int crowdFanCount();
+const CrowdFan* crowdFans();
+const unsigned char* crowdLifts(); // 0 seated .. 255 on their feet, arms up
+int crowdSectorFirstFan(int sector); // sector = NUM_SEAT_SECTORS gives the total
+const Bounds& crowdSectorBounds(int sector);
+
+// CROWD_FAN_VERTICES triangles' worth per fan for fans [first, first + count),
+// lit by shade
+void buildCrowdVertices(int first, int count, float shade, CrowdVertex* out);
+
+// crowdRender.cpp: uploads this frame's lifts, then the visible sectors
+void uploadCrowd();
+void drawCrowd(const Frustum& frustum);
+
+#endif
@@ -0,0 +1,166 @@
+#include "crowd.h"
+#include "glExtensions.h"
+#include "jobSystem.h"
+#include "renderStats.h"
+#include "stadium.h"
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "glTrace.h"
+
+// Instanced: the figure, the fans (uploaded once) and their lifts (every
+// frame) in three buffers. Without instancing every figure is built on the
+// CPU each frame and drawn from one vertex array.
+static bool started = false;
+static GLuint program = 0;
+static GLuint figureBuffer = 0, fanBuffer = 0, liftBuffer = 0, vertexBuffer = 0;
+static GLint shadeLoc = -1;
+static std::vector<CrowdVertex> vertices;
+static float frameShade = 1.0f;
+
+static const char* const CROWD_ATTRIBUTES[] = { "aCorner", "aFan", "aColor", "aLift", 0 };
+
+// Turned to face the pitch centre, raised by the lift, unlit like the particles
+static const char* CROWD_VS =
+    "#version 120\n"
+    "attribute vec4 aCorner;\n" // across, up, extra up at full lift, skin
+    "attribute vec3 aFan;\n"
+    "attribute vec4 aColor;\n"
+    "attribute float aLift;\n"
+    "uniform vec3 uSkin;\n"
+    "uniform float uShade;\n"
+    "varying vec3 vColor;\n"
+    "void main() {\n"
+    "    vec2 d = -aFan.xz;\n"
+    "    d = d / max(length(d), 0.001);\n"
+    "    vec3 world = aFan + vec3(-d.y * aCorner.x, aCorner.y + aCorner.z * aLift, d.x * aCorner.x);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(world, 1.0);\n"
+    "    vColor = mix(aColor.rgb, uSkin, aCorner.w) * uShade;\n"
+    "}\n";
+
+static const char* CROWD_FS =
+    "#version 120\n"
+    "varying vec3 vColor;\n"
+    "void main() { gl_FragColor = vec4(vColor, 1.0); }\n";
+
+static void startCrowdRender() {
+    started = true;
+    int count = crowdFanCount();
+    if (glExt.hasInstancing && glExt.hasShaders)
+        program = buildShaderProgram("crowd", CROWD_VS, CROWD_FS, CROWD_ATTRIBUTES);
+    if (program) {
+        glExt.GenBuffers(1, &figureBuffer);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, figureBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, sizeof(CROWD_FIGURE), CROWD_FIGURE, GL_STATIC_DRAW);
+        glExt.GenBuffers(1, &fanBuffer);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, fanBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, count * sizeof(CrowdFan), crowdFans(), GL_STATIC_DRAW);
+        glExt.GenBuffers(1, &liftBuffer);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, liftBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, count, 0, GL_STREAM_DRAW);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glExt.UseProgram(program);
+        glExt.Uniform3f(glExt.GetUniformLocation(program, "uSkin"), CROWD_SKIN[0] / 255.0f, CROWD_SKIN[1] / 255.0f,
+                        CROWD_SKIN[2] / 255.0f);
+        shadeLoc = glExt.GetUniformLocation(program, "uShade");
+        glExt.UseProgram(0);
+    } else {
+        vertices.resize((size_t)count * CROWD_FAN_VERTICES);
+        if (glExt.hasVertexBuffers) glExt.GenBuffers(1, &vertexBuffer);
+    }
+    std::cout << "Crowd: " << (program ? "instanced" : "vertex arrays") << ", "
+              << (program ? count : count * CROWD_FAN_VERTICES * (int)sizeof(CrowdVertex)) / 1024
+              << " KB uploaded per frame" << std::endl;
+}
+
+static void buildSectorJob(int sector, int, void*) {
+    int first = crowdSectorFirstFan(sector), count = crowdSectorFirstFan(sector + 1) - first;
+    buildCrowdVertices(first, count, frameShade, &vertices[(size_t)first * CROWD_FAN_VERTICES]);
+}
+
+void uploadCrowd() {
+    if (!crowdReady() || !crowdFanCount()) return;
+    if (!started) startCrowdRender();
+    frameShade = nightMode ? 0.7f : 1.0f;
+
+    if (program) {
+        // The lifts are all that move
+        glExt.BindBuffer(GL_ARRAY_BUFFER, liftBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, crowdFanCount(), 0, GL_STREAM_DRAW); // orphan last frame's copy
+        glExt.BufferSubData(GL_ARRAY_BUFFER, 0, crowdFanCount(), crowdLifts());
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+        return;
+    }
+    parallelFor(NUM_SEAT_SECTORS, buildSectorJob, 0);
+    if (vertexBuffer) {
+        size_t bytes = vertices.size() * sizeof(CrowdVertex);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, bytes, 0, GL_STREAM_DRAW);
+        glExt.BufferSubData(GL_ARRAY_BUFFER, 0, bytes, &vertices[0]);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+static void bindFanAttributes(int firstFan) {
+    const char* base = (const char*)0 + firstFan * sizeof(CrowdFan);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, fanBuffer);
+    glExt.VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(CrowdFan), base + offsetof(CrowdFan, pos));
+    glExt.VertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CrowdFan), base + offsetof(CrowdFan, color));
+    glExt.BindBuffer(GL_ARRAY_BUFFER, liftBuffer);
+    glExt.VertexAttribPointer(3, 1, GL_UNSIGNED_BYTE, GL_TRUE, 1, (const char*)0 + firstFan);
+}
+
+static void drawInstanced(const int* visible, int visibleCount) {
+    glExt.UseProgram(program);
+    glExt.Uniform1f(shadeLoc, frameShade);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, figureBuffer);
+    glExt.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+    for (int a = 0; a < 4; ++a) glExt.EnableVertexAttribArray(a);
+    for (int a = 1; a < 4; ++a) glExt.VertexAttribDivisor(a, 1);
+    for (int k = 0; k < visibleCount; ++k) {
+        int first = crowdSectorFirstFan(visible[k]), count = crowdSectorFirstFan(visible[k] + 1) - first;
+        bindFanAttributes(first);
+        glExt.DrawArraysInstanced(GL_TRIANGLES, 0, CROWD_FAN_VERTICES, count);
+    }
+    for (int a = 1; a < 4; ++a) glExt.VertexAttribDivisor(a, 0);
+    for (int a = 0; a < 4; ++a) glExt.DisableVertexAttribArray(a);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    glExt.UseProgram(0);
+}
+
+static void drawVertexArrays(const int* visible, int visibleCount) {
+    const char* base = 0;
+    if (vertexBuffer) glExt.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    else base = (const char*)&vertices[0];
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(CrowdVertex), base + offsetof(CrowdVertex, pos));
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(CrowdVertex), base + offsetof(CrowdVertex, color));
+    for (int k = 0; k < visibleCount; ++k) {
+        int first = crowdSectorFirstFan(visible[k]), count = crowdSectorFirstFan(visible[k] + 1) - first;
+        glDrawArrays(GL_TRIANGLES, first * CROWD_FAN_VERTICES, count * CROWD_FAN_VERTICES);
+    }
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    if (vertexBuffer) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void drawCrowd(const Frustum& frustum) {
+    if (!started) return;
+    int visible[NUM_SEAT_SECTORS], visibleCount = 0;
+    long fans = 0;
+    for (int s = 0; s < NUM_SEAT_SECTORS; ++s) {
+        int count = crowdSectorFirstFan(s + 1) - crowdSectorFirstFan(s);
+        if (!count || !boundsInFrustum(crowdSectorBounds(s), frustum)) continue;
+        visible[visibleCount++] = s;
+        fans += count;
+    }
+    if (!visibleCount) return;
+
+    glDisable(GL_LIGHTING);
+    if (program) drawInstanced(visible, visibleCount);
+    else drawVertexArrays(visible, visibleCount);
+    glEnable(GL_LIGHTING);
+    statsAdd(STAT_CROWD_FANS, fans);
+}
@@ -0,0 +1,91 @@
+#include "frameArena.h"
+#include "renderStats.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#ifdef __GNUC__
+#define NO_INLINE __attribute__((noinline))
+#else
+#define NO_INLINE
+#endif
+
+const size_t ARENA_ALIGN = 16;
+const size_t MIN_OVERFLOW_BLOCK = 64 * 1024;
+
+static char* blockStorage = 0; // as allocated; block is aligned within it
+static char* block = 0;
+static size_t blockSize = 0;
+static size_t used = 0;
+
+// Heap blocks borrowed by a frame that did not fit, freed at the reset
+static std::vector<char*> overflow;
+static char* overflowBlock = 0;
+static size_t overflowSize = 0, overflowUsed = 0;
+static size_t frameTotal = 0; // everything handed out this frame
+
+static size_t alignUp(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+static char* alignPointer(char* p) {
+    return (char*)alignUp((size_t)p);
+}
+
+static void allocateBlock(size_t bytes) {
+    delete[] blockStorage;
+    blockSize = alignUp(bytes);
+    blockStorage = new char[blockSize + ARENA_ALIGN];
+    block = alignPointer(blockStorage);
+}
+
+void initFrameArena(size_t bytes) {
+    allocateBlock(bytes);
+    used = 0;
+    overflow.reserve(16);
+}
+
+// Rare by design; out of line so a frame that keeps landing here shows up
+// under this name in a profile
+NO_INLINE static void* overflowAlloc(size_t bytes) {
+    if (overflowUsed + bytes > overflowSize) {
+        overflowSize = std::max(bytes, MIN_OVERFLOW_BLOCK);
+        char* storage = new char[overflowSize + ARENA_ALIGN];
+        overflow.push_back(storage);
+        overflowBlock = alignPointer(storage);
+        overflowUsed = 0;
+    }
+    void* p = overflowBlock + overflowUsed;
+    overflowUsed += bytes;
+    return p;
+}
+
+// Out of line on purpose: arena traffic gets its own line in a profile
+NO_INLINE void* frameAlloc(size_t bytes) {
+    bytes = alignUp(bytes ? bytes : 1);
+    frameTotal += bytes;
+    if (used + bytes <= blockSize) {
+        void* p = block + used;
+        used += bytes;
+        return p;
+    }
+    return overflowAlloc(bytes);
+}
+
+void frameArenaReset() {
+    statsAdd(STAT_ARENA_KB, (long)(frameTotal / 1024));
+    if (!overflow.empty()) {
+        for (size_t i = 0; i < overflow.size(); ++i) delete[] overflow[i];
+        overflow.clear();
+        overflowBlock = 0;
+        overflowSize = overflowUsed = 0;
+
+        // Room for this frame and then some, so the next one fits in one block
+        size_t grown = alignUp(frameTotal + frameTotal / 2);
+        std::cout << "Frame arena: " << frameTotal / 1024 << " KB used in one frame, growing to " << grown / 1024
+                  << " KB" << std::endl;
+        allocateBlock(grown);
+    }
+    used = 0;
+    frameTotal = 0;
+}
@@ -0,0 +1,30 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+
+// **********************************************
+// ************ FRAME ARENA *********************
+// **********************************************
+
+// Scratch memory for data that lives only until the frame is shown: sort
+// keys, visible lists, text. Allocation bumps a pointer in one block and
+// display() releases everything at once with frameArenaReset(). A frame
+// that outgrows the block borrows from the heap and the block is enlarged
+// at the reset, so a steady frame loop never calls malloc. Main thread only;
+// nothing is constructed or destroyed, so use it for plain data.
+
+void initFrameArena(size_t bytes);
+
+// 16-byte aligned, valid until the next frameArenaReset()
+void* frameAlloc(size_t bytes);
+
+template <typename T>
+T* frameAllocArray(size_t count) {
+    return static_cast<T*>(frameAlloc(count * sizeof(T)));
+}
+
+// End of display(): counts this frame's use in the stats and starts over
+void frameArenaReset();
+
+#endif
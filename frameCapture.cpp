@@ -0,0 +1,442 @@
+#include "frameCapture.h"
+#include "glExtensions.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+// How many frames a readback may stay in flight before it is collected.
+// Three is enough for the driver to finish the copy without a sync stall.
+const int PBO_RING_SIZE = 3;
+// Frames the encoder may lag behind before rendering has to wait for it.
+const int FRAME_POOL_SIZE = 8;
+
+typedef std::chrono::steady_clock CaptureClock;
+
+static double msSince(CaptureClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(CaptureClock::now() - start).count();
+}
+
+// --- State (render thread) ---
+static CaptureSettings settings;
+static bool active = false;
+static bool started = false;
+static bool frameReady = true;  // sim state for the next output frame is ready
+static float tickAccumulator = 0.0f;
+static int capWidth = 0, capHeight = 0;
+static int framesIssued = 0;
+
+static GLuint pbo[PBO_RING_SIZE];
+static int pboFrame[PBO_RING_SIZE]; // frame number held by each slot, -1 = empty
+
+// --- Frame pool shared with the encoder thread ---
+struct PooledFrame {
+    std::vector<unsigned char> bgra;
+    int index;
+};
+static PooledFrame pool[FRAME_POOL_SIZE];
+static int freeList[FRAME_POOL_SIZE];
+static int freeCount = 0;
+static int readyQueue[FRAME_POOL_SIZE];
+static int readyHead = 0, readyCount = 0;
+static bool encoderQuit = false;
+static std::mutex poolMutex;
+static std::condition_variable poolCond;
+static std::thread encoderThread;
+
+// --- Statistics ---
+static CaptureClock::time_point captureStart;
+static double readbackMs = 0.0;  // render thread: issuing reads + collecting ring slots
+static double stallMs = 0.0;     // render thread: waiting for a free pool frame
+static double encodeMs = 0.0;    // encoder thread: conversion + disk writes
+static int framesWritten = 0;
+
+// **********************************************
+// ************ ENCODERS (WORKER THREAD) ********
+// **********************************************
+
+static FILE* yuvOut = 0;
+static std::vector<unsigned char> scratch; // reused by the encoders, only touched by the worker
+
+static void writePPM(const PooledFrame& f) {
+    char path[512];
+    std::snprintf(path, sizeof(path), "%s/frame_%05d.ppm", settings.outputPath, f.index);
+    FILE* out = std::fopen(path, "wb");
+    if (!out) { std::cerr << "capture: cannot write " << path << std::endl; return; }
+    std::fprintf(out, "P6\n%d %d\n255\n", capWidth, capHeight);
+
+    // GL rows are bottom-up, image rows are top-down
+    scratch.resize((size_t)capWidth * capHeight * 3);
+    unsigned char* dst = &scratch[0];
+    for (int y = capHeight - 1; y >= 0; --y) {
+        const unsigned char* src = &f.bgra[(size_t)y * capWidth * 4];
+        for (int x = 0; x < capWidth; ++x, src += 4, dst += 3) {
+            dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0];
+        }
+    }
+    std::fwrite(&scratch[0], 1, scratch.size(), out);
+    std::fclose(out);
+}
+
+static unsigned int crcTable[256];
+
+static void initCrcTable() {
+    for (unsigned int n = 0; n < 256; ++n) {
+        unsigned int c = n;
+        for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        crcTable[n] = c;
+    }
+}
+
+static unsigned int crc32(unsigned int crc, const unsigned char* p, size_t n) {
+    crc = ~crc;
+    while (n--) crc = crcTable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<unsigned char>& v, unsigned int x) {
+    v.push_back((unsigned char)(x >> 24)); v.push_back((unsigned char)(x >> 16));
+    v.push_back((unsigned char)(x >> 8));  v.push_back((unsigned char)x);
+}
+
+static void writeChunk(FILE* out, const char* type, const unsigned char* data, size_t len) {
+    std::vector<unsigned char> head;
+    putBE32(head, (unsigned int)len);
+    head.insert(head.end(), type, type + 4);
+    std::fwrite(&head[0], 1, head.size(), out);
+    if (len) std::fwrite(data, 1, len, out);
+    unsigned int crc = crc32(crc32(0, (const unsigned char*)type, 4), data, len);
+    std::vector<unsigned char> tail;
+    putBE32(tail, crc);
+    std::fwrite(&tail[0], 1, 4, out);
+}
+
+// PNG with "stored" deflate blocks: a valid file with no compression cost,
+// so the encoder thread keeps up with rendering. Recompress offline if needed.
+static void writePNG(const PooledFrame& f) {
+    char path[512];
+    std::snprintf(path, sizeof(path), "%s/frame_%05d.png", settings.outputPath, f.index);
+    FILE* out = std::fopen(path, "wb");
+    if (!out) { std::cerr << "capture: cannot write " << path << std::endl; return; }
+
+    static const unsigned char signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    std::fwrite(signature, 1, 8, out);
+
+    std::vector<unsigned char> ihdr;
+    putBE32(ihdr, capWidth);
+    putBE32(ihdr, capHeight);
+    ihdr.push_back(8);  // bit depth
+    ihdr.push_back(2);  // colour type RGB
+    ihdr.push_back(0); ihdr.push_back(0); ihdr.push_back(0);
+    writeChunk(out, "IHDR", &ihdr[0], ihdr.size());
+
+    // Raw scanlines: filter byte 0 + RGB, top-down
+    size_t rowBytes = (size_t)capWidth * 3 + 1;
+    size_t rawSize = rowBytes * capHeight;
+    size_t numBlocks = (rawSize + 65534) / 65535;
+    scratch.resize(rawSize + 2 + numBlocks * 5 + 4);
+
+    unsigned char* raw = &scratch[0] + scratch.size() - rawSize; // build raw at the tail
+    for (int y = 0; y < capHeight; ++y) {
+        unsigned char* dst = raw + y * rowBytes;
+        const unsigned char* src = &f.bgra[(size_t)(capHeight - 1 - y) * capWidth * 4];
+        *dst++ = 0;
+        for (int x = 0; x < capWidth; ++x, src += 4, dst += 3) {
+            dst[0] = src[2]; dst[1] = src[1]; dst[2] = src[0];
+        }
+    }
+
+    // Adler-32 over the raw data
+    unsigned int a = 1, b = 0;
+    for (size_t i = 0; i < rawSize; ) {
+        size_t n = rawSize - i < 5552 ? rawSize - i : 5552;
+        for (size_t k = 0; k < n; ++k) { a += raw[i + k]; b += a; }
+        a %= 65521; b %= 65521; i += n;
+    }
+
+    // zlib header + stored blocks, moved forward over the raw copy in place
+    unsigned char* z = &scratch[0];
+    size_t pos = 0;
+    z[pos++] = 0x78; z[pos++] = 0x01;
+    for (size_t off = 0; off < rawSize; off += 65535) {
+        size_t len = rawSize - off < 65535 ? rawSize - off : 65535;
+        z[pos++] = (off + len == rawSize) ? 1 : 0;
+        z[pos++] = (unsigned char)(len & 0xFF);
+        z[pos++] = (unsigned char)(len >> 8);
+        z[pos++] = (unsigned char)(~len & 0xFF);
+        z[pos++] = (unsigned char)((~len >> 8) & 0xFF);
+        std::memmove(z + pos, raw + off, len);
+        pos += len;
+    }
+    unsigned int adler = (b << 16) | a;
+    z[pos++] = (unsigned char)(adler >> 24); z[pos++] = (unsigned char)(adler >> 16);
+    z[pos++] = (unsigned char)(adler >> 8);  z[pos++] = (unsigned char)adler;
+
+    writeChunk(out, "IDAT", z, pos);
+    writeChunk(out, "IEND", 0, 0);
+    std::fclose(out);
+}
+
+// BT.601 limited-range I420, the layout ffmpeg expects with -pix_fmt yuv420p.
+static void writeYUV(const PooledFrame& f) {
+    int w = capWidth & ~1, h = capHeight & ~1;
+    scratch.resize((size_t)w * h * 3 / 2);
+    unsigned char* yPlane = &scratch[0];
+    unsigned char* uPlane = yPlane + (size_t)w * h;
+    unsigned char* vPlane = uPlane + (size_t)(w / 2) * (h / 2);
+
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* src = &f.bgra[(size_t)(capHeight - 1 - y) * capWidth * 4];
+        unsigned char* dst = yPlane + (size_t)y * w;
+        for (int x = 0; x < w; ++x, src += 4) {
+            int r = src[2], g = src[1], bl = src[0];
+            dst[x] = (unsigned char)(((66 * r + 129 * g + 25 * bl + 128) >> 8) + 16);
+        }
+    }
+    for (int y = 0; y < h / 2; ++y) {
+        const unsigned char* row0 = &f.bgra[(size_t)(capHeight - 1 - 2 * y) * capWidth * 4];
+        const unsigned char* row1 = row0 - (size_t)capWidth * 4;
+        for (int x = 0; x < w / 2; ++x) {
+            const unsigned char* p0 = row0 + x * 8;
+            const unsigned char* p1 = row1 + x * 8;
+            int r = (p0[2] + p0[6] + p1[2] + p1[6] + 2) >> 2;
+            int g = (p0[1] + p0[5] + p1[1] + p1[5] + 2) >> 2;
+            int bl = (p0[0] + p0[4] + p1[0] + p1[4] + 2) >> 2;
+            uPlane[y * (w / 2) + x] = (unsigned char)(((-38 * r - 74 * g + 112 * bl + 128) >> 8) + 128);
+            vPlane[y * (w / 2) + x] = (unsigned char)(((112 * r - 94 * g - 18 * bl + 128) >> 8) + 128);
+        }
+    }
+    std::fwrite(&scratch[0], 1, scratch.size(), yuvOut);
+}
+
+static void encoderLoop() {
+    for (;;) {
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            while (readyCount == 0 && !encoderQuit) poolCond.wait(lock);
+            if (readyCount == 0) break;
+            slot = readyQueue[readyHead];
+            readyHead = (readyHead + 1) % FRAME_POOL_SIZE;
+            --readyCount;
+        }
+
+        CaptureClock::time_point t0 = CaptureClock::now();
+        switch (settings.format) {
+            case CAPTURE_PPM: writePPM(pool[slot]); break;
+            case CAPTURE_PNG: writePNG(pool[slot]); break;
+            case CAPTURE_YUV: writeYUV(pool[slot]); break;
+        }
+        double ms = msSince(t0);
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        encodeMs += ms;
+        ++framesWritten;
+        freeList[freeCount++] = slot;
+        poolCond.notify_all();
+    }
+}
+
+// **********************************************
+// ************ RENDER THREAD SIDE **************
+// **********************************************
+
+static int acquireFrame() {
+    CaptureClock::time_point t0 = CaptureClock::now();
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (freeCount == 0) poolCond.wait(lock);
+    stallMs += msSince(t0);
+    return freeList[--freeCount];
+}
+
+static void submitFrame(int slot) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    readyQueue[(readyHead + readyCount) % FRAME_POOL_SIZE] = slot;
+    ++readyCount;
+    poolCond.notify_all();
+}
+
+// Copies a finished readback out of its pixel buffer and queues it.
+static void collectSlot(int ringSlot) {
+    if (pboFrame[ringSlot] < 0) return;
+    int frame = acquireFrame();
+    size_t bytes = (size_t)capWidth * capHeight * 4;
+
+    glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, pbo[ringSlot]);
+    void* src = glExt.MapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+    if (src) {
+        std::memcpy(&pool[frame].bgra[0], src, bytes);
+        glExt.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    pool[frame].index = pboFrame[ringSlot];
+    pboFrame[ringSlot] = -1;
+    submitFrame(frame);
+}
+
+static bool startCapture(int width, int height) {
+    capWidth = width;
+    capHeight = height;
+    size_t bytes = (size_t)width * height * 4;
+
+    if (settings.format == CAPTURE_YUV) {
+        if (std::strcmp(settings.outputPath, "-") == 0) {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            yuvOut = stdout;
+        } else {
+            yuvOut = std::fopen(settings.outputPath, "wb");
+        }
+        if (!yuvOut) {
+            std::cerr << "capture: cannot open " << settings.outputPath << std::endl;
+            return false;
+        }
+        // Frame size and rate for the encoder command line, kept off stdout
+        std::cerr << "capture: rawvideo yuv420p " << (width & ~1) << "x" << (height & ~1)
+                  << " @ " << settings.fps << " fps" << std::endl;
+    }
+    if (settings.format == CAPTURE_PNG) initCrcTable();
+
+    for (int i = 0; i < FRAME_POOL_SIZE; ++i) {
+        pool[i].bgra.resize(bytes);
+        freeList[i] = i;
+    }
+    freeCount = FRAME_POOL_SIZE;
+    readyHead = readyCount = 0;
+    encoderQuit = false;
+
+    if (glExt.hasPixelBuffers) {
+        glExt.GenBuffers(PBO_RING_SIZE, pbo);
+        for (int i = 0; i < PBO_RING_SIZE; ++i) {
+            glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, pbo[i]);
+            glExt.BufferData(GL_PIXEL_PACK_BUFFER, bytes, 0, GL_STREAM_READ);
+            pboFrame[i] = -1;
+        }
+        glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    } else {
+        std::cerr << "capture: pixel buffer objects unavailable, using synchronous readback" << std::endl;
+    }
+
+    encoderThread = std::thread(encoderLoop);
+    captureStart = CaptureClock::now();
+    started = true;
+    return true;
+}
+
+void captureConfigure(const CaptureSettings& s) {
+    settings = s;
+    if (settings.fps <= 0.0f) settings.fps = 30.0f;
+    active = true;
+    started = false;
+    frameReady = true;
+    tickAccumulator = 0.0f;
+    framesIssued = 0;
+}
+
+bool captureIsActive() {
+    return active;
+}
+
+bool parseCaptureFormat(const char* name, CaptureFormat& format) {
+    if (std::strcmp(name, "ppm") == 0) format = CAPTURE_PPM;
+    else if (std::strcmp(name, "png") == 0) format = CAPTURE_PNG;
+    else if (std::strcmp(name, "yuv") == 0) format = CAPTURE_YUV;
+    else return false;
+    return true;
+}
+
+bool captureNextFrameStep(float simTickRate, int& ticks, float& orbitDeg) {
+    if (frameReady) return false;
+
+    // Carry the fractional tick so e.g. 60 Hz sim at 24 fps alternates 2,3,2,3...
+    tickAccumulator += simTickRate / settings.fps;
+    ticks = (int)tickAccumulator;
+    tickAccumulator -= (float)ticks;
+    orbitDeg = settings.orbitDegPerSec / settings.fps;
+    frameReady = true;
+    return true;
+}
+
+double captureTimeSeconds() {
+    return framesIssued / settings.fps;
+}
+
+bool captureFrame(int width, int height) {
+    if (!active) return false;
+    if (!frameReady) return true; // a redraw with no new simulation step (e.g. expose)
+
+    if (!started) {
+        if (!startCapture(width, height)) { active = false; return false; }
+    } else if (width != capWidth || height != capHeight) {
+        std::cerr << "capture: window resized during capture, stopping" << std::endl;
+        return false;
+    }
+
+    CaptureClock::time_point t0 = CaptureClock::now();
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    if (glExt.hasPixelBuffers) {
+        int ringSlot = framesIssued % PBO_RING_SIZE;
+        collectSlot(ringSlot); // the oldest read, issued PBO_RING_SIZE frames ago
+
+        glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, pbo[ringSlot]);
+        glReadPixels(0, 0, capWidth, capHeight, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+        glExt.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pboFrame[ringSlot] = framesIssued;
+    } else {
+        int frame = acquireFrame();
+        glReadPixels(0, 0, capWidth, capHeight, GL_BGRA, GL_UNSIGNED_BYTE, &pool[frame].bgra[0]);
+        pool[frame].index = framesIssued;
+        submitFrame(frame);
+    }
+    readbackMs += msSince(t0);
+
+    ++framesIssued;
+    frameReady = false;
+    return settings.frameCount <= 0 || framesIssued < settings.frameCount;
+}
+
+void captureEnd() {
+    if (!active) return;
+    active = false;
+    if (!started) return;
+
+    if (glExt.hasPixelBuffers) {
+        // Remaining slots in issue order
+        for (int k = 0; k < PBO_RING_SIZE; ++k) collectSlot((framesIssued + k) % PBO_RING_SIZE);
+        glExt.DeleteBuffers(PBO_RING_SIZE, pbo);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        encoderQuit = true;
+        poolCond.notify_all();
+    }
+    encoderThread.join();
+    if (yuvOut && yuvOut != stdout) std::fclose(yuvOut);
+    if (yuvOut == stdout) std::fflush(stdout);
+    yuvOut = 0;
+    started = false;
+
+    double totalMs = msSince(captureStart);
+    int n = framesIssued > 0 ? framesIssued : 1;
+    std::cerr << "capture: " << framesWritten << " frames in " << totalMs / 1000.0 << " s ("
+              << framesIssued * 1000.0 / (totalMs > 0.0 ? totalMs : 1.0) << " fps)"
+              << " | per frame: total " << totalMs / n << " ms"
+              << ", readback " << readbackMs / n << " ms"
+              << ", encoder stall " << stallMs / n << " ms"
+              << ", encode " << encodeMs / n << " ms (worker)" << std::endl;
+}
@@ -0,0 +1,48 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+// **********************************************
+// ************ OFFLINE FRAME CAPTURE ***********
+// **********************************************
+
+// Renders at a fixed output frame rate independent of wall-clock time.
+// The back buffer is read asynchronously through a ring of pixel-buffer
+// objects and handed to an encoder thread, so neither the readback nor the
+// disk writes hold up rendering.
+
+enum CaptureFormat {
+    CAPTURE_PPM, // numbered P6 images in a directory
+    CAPTURE_PNG, // numbered PNG images (uncompressed deflate) in a directory
+    CAPTURE_YUV  // raw I420 stream to one file, or "-" for stdout
+};
+
+struct CaptureSettings {
+    const char* outputPath;
+    CaptureFormat format;
+    float fps;            // output frame rate
+    int frameCount;       // stop after this many frames, 0 = until the window closes
+    float orbitDegPerSec; // optional slow camera orbit while recording
+};
+
+// Arms capture mode. Resources are created on the first captured frame so
+// the capture size follows the real window size.
+void captureConfigure(const CaptureSettings& settings);
+bool captureIsActive();
+bool parseCaptureFormat(const char* name, CaptureFormat& format);
+
+// Fixed-step clock: returns false while the previous output frame is still
+// waiting to be captured, otherwise the simulation ticks and camera orbit
+// that make up the next output frame.
+bool captureNextFrameStep(float simTickRate, int& ticks, float& orbitDeg);
+
+// Output-video time of the frame about to be captured, in seconds.
+double captureTimeSeconds();
+
+// Call after the scene is drawn and before glutSwapBuffers().
+// Returns false once the requested number of frames has been recorded.
+bool captureFrame(int width, int height);
+
+// Drains the readback ring, waits for the encoder and prints throughput.
+void captureEnd();
+
+#endif
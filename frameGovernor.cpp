@@ -0,0 +1,178 @@
+#include "frameGovernor.h"
+#include "glExtensions.h"
+#include "renderStats.h"
+#include "sceneObjects.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+struct QualityLevel {
+    float renderScale;
+    int detail;
+};
+
+// Best first. Resolution goes first; detail only once pixels alone fall short.
+static const QualityLevel LADDER[] = {
+    { 1.00f, 0 }, { 0.85f, 0 }, { 0.70f, 0 }, { 0.70f, 1 }, { 0.60f, 1 }, { 0.50f, 2 }
+};
+const int LADDER_SIZE = sizeof(LADDER) / sizeof(LADDER[0]);
+
+const float SMOOTHING = 0.1f;        // weight of the newest frame in the average
+const float SLOW_FRACTION = 1.08f;   // over budget by this much counts as slow
+const float FAST_FRACTION = 0.75f;   // under this fraction of the budget counts as fast
+const int SLOW_FRAMES_TO_DROP = 10;
+const int FAST_FRAMES_TO_RAISE = 60; // doubled after every bounce
+const int MAX_FAST_FRAMES_TO_RAISE = 960;
+const double BOUNCE_SECONDS = 3.0;   // a drop this soon after a raise undoes it
+const double SETTLED_SECONDS = 30.0; // no change for this long forgets past bounces
+const int GPU_TIMER_FRAMES = 4;      // timer queries in flight, read back as they finish
+
+typedef std::chrono::steady_clock GovernorClock;
+
+static bool active = false;
+static float budgetMs = 0.0f;
+static std::vector<QualityLevel> ladder(1, LADDER[0]);
+static int level = 0;
+
+static float averageMs = 0.0f;     // smoothed render cost, not the swap interval
+static int slowFrames = 0, fastFrames = 0;
+static int framesToRaise = FAST_FRAMES_TO_RAISE;
+static bool haveLastFrame = false;
+static GovernorClock::time_point lastFrame, lastChange;
+static bool lastChangeWasRaise = false;
+
+// GL_TIME_ELAPSED queries, a ring so a result is only read once the GPU
+// has it and never stalls the frame that asks
+static GLuint gpuTimers[GPU_TIMER_FRAMES];
+static bool gpuTimerIssued[GPU_TIMER_FRAMES];
+static int gpuTimerNext = 0;
+static bool gpuTimerRunning = false;
+static float gpuMs = 0.0f; // the newest finished frame
+
+void configureFrameGovernor(float targetFps, bool adjustDetail) {
+    active = false;
+    ladder.assign(1, LADDER[0]);
+    level = 0;
+    if (targetFps <= 0.0f) return;
+
+    for (int i = 1; i < LADDER_SIZE; ++i) {
+        QualityLevel q = LADDER[i];
+        if (!glExt.hasFramebuffers) q.renderScale = 1.0f;
+        if (!adjustDetail) q.detail = 0;
+        const QualityLevel& prev = ladder.back();
+        if (q.renderScale != prev.renderScale || q.detail != prev.detail) ladder.push_back(q);
+    }
+    if (ladder.size() == 1) {
+        std::cerr << "Governor: no framebuffer objects and detail changes not allowed, nothing to adjust" << std::endl;
+        return;
+    }
+
+    if (glExt.hasTimerQueries && !gpuTimers[0]) glExt.GenQueries(GPU_TIMER_FRAMES, gpuTimers);
+
+    active = true;
+    budgetMs = 1000.0f / targetFps;
+    averageMs = budgetMs;
+    haveLastFrame = false;
+    lastChange = GovernorClock::now();
+    std::cout << "Governor: holding " << targetFps << " fps (" << budgetMs << " ms), " << ladder.size()
+              << " quality levels" << (adjustDetail ? " including detail" : "")
+              << (glExt.hasTimerQueries ? ", timing CPU and GPU" : ", timing the CPU only") << std::endl;
+}
+
+bool frameGovernorActive() {
+    return active;
+}
+
+static void changeLevel(int newLevel, GovernorClock::time_point now) {
+    bool raise = newLevel < level;
+    double sinceChange = std::chrono::duration<double>(now - lastChange).count();
+    if (!raise && lastChangeWasRaise && sinceChange < BOUNCE_SECONDS) {
+        framesToRaise = std::min(framesToRaise * 2, MAX_FAST_FRAMES_TO_RAISE);
+    } else if (sinceChange > SETTLED_SECONDS) {
+        framesToRaise = FAST_FRAMES_TO_RAISE;
+    }
+
+    int oldDetail = ladder[level].detail;
+    level = newLevel;
+    lastChange = now;
+    lastChangeWasRaise = raise;
+    slowFrames = fastFrames = 0;
+    if (ladder[level].detail != oldDetail) invalidateDetailDependentObjects();
+
+    std::cout << "Governor: " << averageMs << " ms render cost against " << budgetMs << " ms, now "
+              << (int)(ladder[level].renderScale * 100.0f + 0.5f) << "% resolution, detail " << ladder[level].detail
+              << std::endl;
+}
+
+// Oldest first, so gpuMs ends up as the newest result available
+static void collectGpuTimers() {
+    for (int k = 0; k < GPU_TIMER_FRAMES; ++k) {
+        int i = (gpuTimerNext + k) % GPU_TIMER_FRAMES;
+        if (!gpuTimerIssued[i]) continue;
+        GLuint available = 0;
+        glExt.GetQueryObjectuiv(gpuTimers[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break; // later ones finish later
+        GLuint64 ns = 0;
+        glExt.GetQueryObjectui64v(gpuTimers[i], GL_QUERY_RESULT, &ns);
+        gpuMs = (float)(ns / 1.0e6);
+        gpuTimerIssued[i] = false;
+    }
+}
+
+void governorFrameBegin() {
+    if (!active || !glExt.hasTimerQueries || gpuTimerIssued[gpuTimerNext]) return; // ring full: skip this frame
+    glExt.BeginQuery(GL_TIME_ELAPSED, gpuTimers[gpuTimerNext]);
+    gpuTimerRunning = true;
+}
+
+void governorFrameRendered() {
+    if (!active) return;
+    GovernorClock::time_point now = GovernorClock::now();
+    if (gpuTimerRunning) {
+        glExt.EndQuery(GL_TIME_ELAPSED);
+        gpuTimerIssued[gpuTimerNext] = true;
+        gpuTimerNext = (gpuTimerNext + 1) % GPU_TIMER_FRAMES;
+        gpuTimerRunning = false;
+    }
+    if (glExt.hasTimerQueries) collectGpuTimers();
+    statsAdd(STAT_RENDER_SCALE, (long)(ladder[level].renderScale * 100.0f + 0.5f));
+    if (!haveLastFrame) return;
+
+    // CPU from the last swap up to this one (simulation included, the wait
+    // for vsync not), and the GPU time of a recent frame. The two run side
+    // by side and the elapsed query also counts the GPU waiting on the CPU,
+    // so the frame costs the larger of them rather than their sum.
+    float cpuMs = std::chrono::duration<float, std::milli>(now - lastFrame).count();
+    float ms = std::max(cpuMs, gpuMs);
+    statsAdd(STAT_FRAME_CPU_US, (long)(cpuMs * 1000.0f));
+    statsAdd(STAT_FRAME_GPU_US, (long)(gpuMs * 1000.0f));
+
+    // One hitch (window drag, disk stall) should not drag quality down on its own
+    if (ms > 4.0f * budgetMs) ms = 4.0f * budgetMs;
+    averageMs += SMOOTHING * (ms - averageMs);
+
+    slowFrames = averageMs > budgetMs * SLOW_FRACTION ? slowFrames + 1 : 0;
+    fastFrames = averageMs < budgetMs * FAST_FRACTION ? fastFrames + 1 : 0;
+    if (slowFrames >= SLOW_FRAMES_TO_DROP && level + 1 < (int)ladder.size()) changeLevel(level + 1, now);
+    else if (fastFrames >= framesToRaise && level > 0) changeLevel(level - 1, now);
+}
+
+void governorFrameDone() {
+    if (!active) return;
+    GovernorClock::time_point now = GovernorClock::now();
+    if (haveLastFrame) {
+        // For --stats only: with vsync it is rounded to whole refreshes
+        statsAdd(STAT_SWAP_INTERVAL_US, (long)std::chrono::duration<float, std::micro>(now - lastFrame).count());
+    }
+    haveLastFrame = true;
+    lastFrame = now;
+}
+
+float governorRenderScale() {
+    return ladder[level].renderScale;
+}
+
+int governorDetailLevel() {
+    return ladder[level].detail;
+}
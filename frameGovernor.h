@@ -0,0 +1,38 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+// **********************************************
+// ************ FRAME-TIME GOVERNOR *************
+// **********************************************
+
+// Holds the frame rate at a target on slow machines. It smooths each
+// frame's render cost (the larger of its CPU time up to the swap and its
+// GPU time from a GL_TIME_ELAPSED query, where the driver has them) and
+// steps along a quality ladder: first the director view is rendered
+// offscreen at a lower resolution and stretched to the window, then
+// (optionally) nets, railings and vegetation lose detail. Stepping down
+// needs a short run of slow frames, stepping back up a long run of fast
+// ones, and the wait to step up doubles each time a step up has to be
+// undone, so quality settles instead of oscillating.
+
+// targetFps <= 0 leaves the governor off (full quality always). Call after
+// loadGLExtensions(): without framebuffer objects only detail can change.
+void configureFrameGovernor(float targetFps, bool adjustDetail);
+bool frameGovernorActive();
+
+// Once per frame each: before the first GL call of the frame, just before
+// the swap, and after it. Not while capturing: offline frames have no
+// real-time budget. The time between swaps is only reported in --stats;
+// with vsync it never drops below a refresh, however cheap the frame.
+void governorFrameBegin();
+void governorFrameRendered();
+void governorFrameDone();
+
+// Fraction of the window size the director view renders at (1 = native).
+float governorRenderScale();
+
+// 0 full, 1 reduced, 2 minimal. Detail-dependent scene objects are
+// recompiled when it changes.
+int governorDetailLevel();
+
+#endif
@@ -0,0 +1,225 @@
+#include "geometryCache.h"
+#include "stadium.h"
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const size_t CACHE_ALIGNMENT = 64;
+static const char CACHE_MAGIC[8] = { 'S', 'T', 'A', 'D', 'G', 'E', 'O', 0 };
+
+struct GeometryCacheHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int headerSize;
+    unsigned long long paramsHash;
+    unsigned long long generation; // also the file's last 8 bytes, written last
+    unsigned long long checksum;   // of this header (with checksum 0) and the sector table
+    unsigned long long fileSize;
+    unsigned int seatCount;
+    unsigned int sectorCount;
+    // Byte offsets from the start of the file, each CACHE_ALIGNMENT aligned
+    unsigned long long sectorOffset;
+    unsigned long long seatOffset;
+    unsigned long long vertexOffset;
+    unsigned long long indexOffset;
+    unsigned long long trailerOffset;
+};
+
+static unsigned long long alignUp(unsigned long long offset) {
+    return (offset + CACHE_ALIGNMENT - 1) & ~(unsigned long long)(CACHE_ALIGNMENT - 1);
+}
+
+// Section offsets for a given seat count; shared by the writer and the validator
+static void layoutSections(GeometryCacheHeader& h, unsigned int seatCount) {
+    h.seatCount = seatCount;
+    h.sectorCount = NUM_SEAT_SECTORS;
+    h.sectorOffset = alignUp(sizeof(GeometryCacheHeader));
+    h.seatOffset = alignUp(h.sectorOffset + (NUM_SEAT_SECTORS + 1) * sizeof(unsigned int));
+    h.vertexOffset = alignUp(h.seatOffset + (unsigned long long)seatCount * sizeof(SeatPlacement));
+    h.indexOffset = alignUp(h.vertexOffset + (unsigned long long)seatCount * SEAT_VERTICES * sizeof(SeatVertex));
+    h.trailerOffset = alignUp(h.indexOffset + (unsigned long long)seatCount * SEAT_INDICES * sizeof(unsigned int));
+    h.fileSize = h.trailerOffset + sizeof(unsigned long long);
+}
+
+// FNV-1a over the header and the sector table: the parts the loader trusts
+// for offsets and ranges, and only a page or two of the file
+static unsigned long long headerChecksum(const GeometryCacheHeader& h, const unsigned int* sectorFirstSeat) {
+    GeometryCacheHeader copy = h;
+    copy.checksum = 0;
+    unsigned long long sum = 14695981039346656037ULL;
+    const unsigned char* parts[2] = { (const unsigned char*)&copy, (const unsigned char*)sectorFirstSeat };
+    size_t sizes[2] = { sizeof(copy), (NUM_SEAT_SECTORS + 1) * sizeof(unsigned int) };
+    for (int part = 0; part < 2; ++part) {
+        for (size_t i = 0; i < sizes[part]; ++i) {
+            sum ^= parts[part][i];
+            sum *= 1099511628211ULL;
+        }
+    }
+    return sum;
+}
+
+// --- Platform mapping ---
+
+static bool mapFile(const char* path, GeometryCacheView& view) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    void* base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+    if (!base) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    view.base = base;
+    view.size = (size_t)size.QuadPart;
+    view.fileHandle = file;
+    view.mappingHandle = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (base == MAP_FAILED) return false;
+    view.base = base;
+    view.size = (size_t)st.st_size;
+    view.fileHandle = 0;
+    view.mappingHandle = 0;
+#endif
+    return true;
+}
+
+void closeGeometryCache(GeometryCacheView& view) {
+    if (!view.base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(view.base);
+    CloseHandle((HANDLE)view.mappingHandle);
+    CloseHandle((HANDLE)view.fileHandle);
+#else
+    munmap(view.base, view.size);
+#endif
+    view.base = 0;
+    view.size = 0;
+}
+
+// --- Reading ---
+
+// A file of the right size can still be stale or damaged. The checksum
+// covers the header and sector table, and the generation stamp written
+// last at the end of the file must match the header's, so a file whose
+// tail is missing or from another save is caught without reading the
+// arrays in between. The sector ranges the seat queries index with must
+// also run from 0 to seatCount without going back.
+static bool sectionsConsistent(const GeometryCacheHeader& h, const GeometryCacheView& view) {
+    const char* base = (const char*)view.base;
+    unsigned long long trailer;
+    std::memcpy(&trailer, base + h.trailerOffset, sizeof(trailer));
+    if (trailer != h.generation || headerChecksum(h, view.sectorFirstSeat) != h.checksum) return false;
+
+    const unsigned int* first = view.sectorFirstSeat;
+    if (first[0] != 0 || first[NUM_SEAT_SECTORS] != view.seatCount) return false;
+    for (int s = 0; s < NUM_SEAT_SECTORS; ++s)
+        if (first[s + 1] < first[s]) return false;
+    return true;
+}
+
+bool openGeometryCache(const char* path, unsigned long long paramsHash, GeometryCacheView& view) {
+    std::memset(&view, 0, sizeof(view));
+    if (!mapFile(path, view)) return false;
+
+    const GeometryCacheHeader* h = (const GeometryCacheHeader*)view.base;
+    GeometryCacheHeader expected;
+    bool ok = view.size >= sizeof(GeometryCacheHeader) &&
+              std::memcmp(h->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+              h->version == GEOMETRY_CACHE_VERSION &&
+              h->headerSize == sizeof(GeometryCacheHeader) &&
+              h->paramsHash == paramsHash;
+    if (ok) {
+        layoutSections(expected, h->seatCount);
+        ok = h->sectorCount == expected.sectorCount && h->sectorOffset == expected.sectorOffset &&
+             h->seatOffset == expected.seatOffset && h->vertexOffset == expected.vertexOffset &&
+             h->indexOffset == expected.indexOffset && h->trailerOffset == expected.trailerOffset &&
+             h->fileSize == expected.fileSize &&
+             view.size >= expected.fileSize;
+    }
+    if (!ok) {
+        closeGeometryCache(view);
+        return false;
+    }
+
+    const char* base = (const char*)view.base;
+    view.seatCount = h->seatCount;
+    view.sectorFirstSeat = (const unsigned int*)(base + h->sectorOffset);
+    view.seats = (const SeatPlacement*)(base + h->seatOffset);
+    view.vertices = (const SeatVertex*)(base + h->vertexOffset);
+    view.indices = (const unsigned int*)(base + h->indexOffset);
+    if (!sectionsConsistent(*h, view)) {
+        closeGeometryCache(view);
+        return false;
+    }
+    return true;
+}
+
+// --- Writing ---
+
+static bool writeSection(FILE* f, unsigned long long offset, const void* data, size_t bytes) {
+    long pos = std::ftell(f);
+    static const char zeros[CACHE_ALIGNMENT] = { 0 };
+    if (pos < 0 || (unsigned long long)pos > offset) return false;
+    if (offset - pos && std::fwrite(zeros, 1, (size_t)(offset - pos), f) != offset - pos) return false;
+    return bytes == 0 || std::fwrite(data, 1, bytes, f) == bytes;
+}
+
+bool writeGeometryCache(const char* path, unsigned long long paramsHash, const unsigned int* sectorFirstSeat,
+                        const SeatPlacement* seats, const SeatVertex* vertices, const unsigned int* indices,
+                        unsigned int seatCount) {
+    GeometryCacheHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    h.version = GEOMETRY_CACHE_VERSION;
+    h.headerSize = sizeof(GeometryCacheHeader);
+    h.paramsHash = paramsHash;
+    layoutSections(h, seatCount);
+    // Different for every save, so a trailer left from another one never matches
+    h.generation = ((unsigned long long)std::time(0) << 32) ^ (unsigned long long)std::clock() ^ paramsHash;
+    h.checksum = headerChecksum(h, sectorFirstSeat);
+
+    std::string tempPath = std::string(path) + ".tmp";
+    FILE* f = std::fopen(tempPath.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1 &&
+              writeSection(f, h.sectorOffset, sectorFirstSeat, (NUM_SEAT_SECTORS + 1) * sizeof(unsigned int)) &&
+              writeSection(f, h.seatOffset, seats, (size_t)seatCount * sizeof(SeatPlacement)) &&
+              writeSection(f, h.vertexOffset, vertices, (size_t)seatCount * SEAT_VERTICES * sizeof(SeatVertex)) &&
+              writeSection(f, h.indexOffset, indices, (size_t)seatCount * SEAT_INDICES * sizeof(unsigned int)) &&
+              writeSection(f, h.trailerOffset, &h.generation, sizeof(h.generation));
+    ok = (std::fclose(f) == 0) && ok;
+
+#ifdef _WIN32
+    ok = ok && MoveFileExA(tempPath.c_str(), path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    ok = ok && std::rename(tempPath.c_str(), path) == 0;
+#endif
+    if (!ok) std::remove(tempPath.c_str());
+    return ok;
+}
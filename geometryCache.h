@@ -0,0 +1,47 @@
+#ifndef GEOMETRY_CACHE_H
+#define GEOMETRY_CACHE_H
+
+#include "stadiumGeometry.h"
+#include <cstddef>
+
+// **********************************************
+// ************ BINARY GEOMETRY CACHE ***********
+// **********************************************
+
+// The generated seating saved as one file: a fixed header followed by
+// 64-byte aligned arrays in the exact layout the vertex and index buffers
+// use, then a copy of the header's generation stamp. Loading maps the file
+// read-only and hands the arrays to the GPU without parsing or scanning
+// them. Files are in native byte order and tied to one stadiumParamsHash();
+// anything else is rejected and regenerated.
+
+const unsigned int GEOMETRY_CACHE_VERSION = 2;
+
+struct GeometryCacheView {
+    const unsigned int* sectorFirstSeat; // NUM_SEAT_SECTORS + 1 entries
+    const SeatPlacement* seats;
+    const SeatVertex* vertices;          // seatCount * SEAT_VERTICES
+    const unsigned int* indices;         // seatCount * SEAT_INDICES
+    unsigned int seatCount;
+
+    // Mapping, released by closeGeometryCache()
+    void* base;
+    size_t size;
+    void* fileHandle;
+    void* mappingHandle;
+};
+
+// Maps path and checks the header, its checksum, the generation stamp and
+// the sector ranges. Returns false (and leaves nothing open) when the file
+// is missing, truncated, from another version, for other parameters or
+// inconsistent.
+bool openGeometryCache(const char* path, unsigned long long paramsHash, GeometryCacheView& view);
+void closeGeometryCache(GeometryCacheView& view);
+
+// Writes to a temporary file and renames it over path, so a kiosk that loses
+// power mid-write never leaves a half-written cache behind.
+bool writeGeometryCache(const char* path, unsigned long long paramsHash, const unsigned int* sectorFirstSeat,
+                        const SeatPlacement* seats, const SeatVertex* vertices, const unsigned int* indices,
+                        unsigned int seatCount);
+
+#endif
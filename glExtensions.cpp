@@ -0,0 +1,175 @@
+#include "glExtensions.h"
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+
+GLExtensions glExt;
+
+// Looks up "name", then "name" + suffix (e.g. glGenBuffersARB) on older drivers.
+static void* lookupProc(const char* name, const char* suffix) {
+    void* p = (void*)glutGetProcAddress(name);
+    if (!p && suffix) {
+        char buf[128];
+        std::strncpy(buf, name, sizeof(buf) - 8);
+        buf[sizeof(buf) - 8] = '\0';
+        std::strcat(buf, suffix);
+        p = (void*)glutGetProcAddress(buf);
+    }
+    return p;
+}
+
+#define LOAD_PROC(type, field, name, suffix) \
+    (glExt.field = (type)lookupProc(name, suffix), glExt.field != 0)
+
+static bool hasExtension(const char* name) {
+    const char* list = (const char*)glGetString(GL_EXTENSIONS);
+    if (!list) return false;
+    size_t len = std::strlen(name);
+    for (const char* p = std::strstr(list, name); p; p = std::strstr(p + len, name)) {
+        bool startOk = (p == list) || p[-1] == ' ';
+        bool endOk = p[len] == ' ' || p[len] == '\0';
+        if (startOk && endOk) return true;
+    }
+    return false;
+}
+
+// Parses "major.minor" off the front of GL_VERSION.
+static int glVersionTimesTen() {
+    const char* v = (const char*)glGetString(GL_VERSION);
+    if (!v) return 10;
+    int major = std::atoi(v);
+    const char* dot = std::strchr(v, '.');
+    int minor = dot ? std::atoi(dot + 1) : 0;
+    return major * 10 + minor;
+}
+
+void loadGLExtensions() {
+    std::memset(&glExt, 0, sizeof(glExt));
+    int version = glVersionTimesTen();
+
+    // --- Buffer objects + pixel pack/unpack targets ---
+    bool bufferOk = true;
+    bufferOk &= LOAD_PROC(PFNGLGENBUFFERSPROC, GenBuffers, "glGenBuffers", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLDELETEBUFFERSPROC, DeleteBuffers, "glDeleteBuffers", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLBINDBUFFERPROC, BindBuffer, "glBindBuffer", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLBUFFERDATAPROC, BufferData, "glBufferData", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLBUFFERSUBDATAPROC, BufferSubData, "glBufferSubData", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLMAPBUFFERPROC, MapBuffer, "glMapBuffer", "ARB");
+    bufferOk &= LOAD_PROC(PFNGLUNMAPBUFFERPROC, UnmapBuffer, "glUnmapBuffer", "ARB");
+    glExt.hasVertexBuffers = bufferOk && version >= 15;
+    glExt.hasPixelBuffers = bufferOk &&
+        (version >= 21 || hasExtension("GL_ARB_pixel_buffer_object"));
+
+    // --- Occlusion queries (the ARB entry points take the same GL_SAMPLES_PASSED) ---
+    bool queryOk = true;
+    queryOk &= LOAD_PROC(PFNGLGENQUERIESPROC, GenQueries, "glGenQueries", "ARB");
+    queryOk &= LOAD_PROC(PFNGLDELETEQUERIESPROC, DeleteQueries, "glDeleteQueries", "ARB");
+    queryOk &= LOAD_PROC(PFNGLBEGINQUERYPROC, BeginQuery, "glBeginQuery", "ARB");
+    queryOk &= LOAD_PROC(PFNGLENDQUERYPROC, EndQuery, "glEndQuery", "ARB");
+    queryOk &= LOAD_PROC(PFNGLGETQUERYOBJECTUIVPROC, GetQueryObjectuiv, "glGetQueryObjectuiv", "ARB");
+    glExt.hasOcclusionQueries = queryOk && (version >= 15 || hasExtension("GL_ARB_occlusion_query"));
+
+    // --- GPU timers (EXT_timer_query names the 64-bit read with a suffix) ---
+    bool timerOk = glExt.hasOcclusionQueries;
+    timerOk &= LOAD_PROC(PFNGLGETQUERYOBJECTUI64VPROC, GetQueryObjectui64v, "glGetQueryObjectui64v", "EXT");
+    glExt.hasTimerQueries = timerOk &&
+        (version >= 33 || hasExtension("GL_ARB_timer_query") || hasExtension("GL_EXT_timer_query"));
+
+    // --- Framebuffer objects (EXT entry points share signatures and enums) ---
+    bool fboOk = true;
+    fboOk &= LOAD_PROC(PFNGLGENFRAMEBUFFERSPROC, GenFramebuffers, "glGenFramebuffers", "EXT");
+    fboOk &= LOAD_PROC(PFNGLDELETEFRAMEBUFFERSPROC, DeleteFramebuffers, "glDeleteFramebuffers", "EXT");
+    fboOk &= LOAD_PROC(PFNGLBINDFRAMEBUFFERPROC, BindFramebuffer, "glBindFramebuffer", "EXT");
+    fboOk &= LOAD_PROC(PFNGLFRAMEBUFFERTEXTURE2DPROC, FramebufferTexture2D, "glFramebufferTexture2D", "EXT");
+    fboOk &= LOAD_PROC(PFNGLGENRENDERBUFFERSPROC, GenRenderbuffers, "glGenRenderbuffers", "EXT");
+    fboOk &= LOAD_PROC(PFNGLDELETERENDERBUFFERSPROC, DeleteRenderbuffers, "glDeleteRenderbuffers", "EXT");
+    fboOk &= LOAD_PROC(PFNGLBINDRENDERBUFFERPROC, BindRenderbuffer, "glBindRenderbuffer", "EXT");
+    fboOk &= LOAD_PROC(PFNGLRENDERBUFFERSTORAGEPROC, RenderbufferStorage, "glRenderbufferStorage", "EXT");
+    fboOk &= LOAD_PROC(PFNGLFRAMEBUFFERRENDERBUFFERPROC, FramebufferRenderbuffer, "glFramebufferRenderbuffer", "EXT");
+    fboOk &= LOAD_PROC(PFNGLCHECKFRAMEBUFFERSTATUSPROC, CheckFramebufferStatus, "glCheckFramebufferStatus", "EXT");
+    glExt.hasFramebuffers = fboOk &&
+        (version >= 30 || hasExtension("GL_ARB_framebuffer_object") || hasExtension("GL_EXT_framebuffer_object"));
+
+    // --- GLSL programs ---
+    bool shaderOk = version >= 20;
+    shaderOk &= LOAD_PROC(PFNGLCREATESHADERPROC, CreateShader, "glCreateShader", 0);
+    shaderOk &= LOAD_PROC(PFNGLDELETESHADERPROC, DeleteShader, "glDeleteShader", 0);
+    shaderOk &= LOAD_PROC(PFNGLSHADERSOURCEPROC, ShaderSource, "glShaderSource", 0);
+    shaderOk &= LOAD_PROC(PFNGLCOMPILESHADERPROC, CompileShader, "glCompileShader", 0);
+    shaderOk &= LOAD_PROC(PFNGLGETSHADERIVPROC, GetShaderiv, "glGetShaderiv", 0);
+    shaderOk &= LOAD_PROC(PFNGLGETSHADERINFOLOGPROC, GetShaderInfoLog, "glGetShaderInfoLog", 0);
+    shaderOk &= LOAD_PROC(PFNGLCREATEPROGRAMPROC, CreateProgram, "glCreateProgram", 0);
+    shaderOk &= LOAD_PROC(PFNGLATTACHSHADERPROC, AttachShader, "glAttachShader", 0);
+    shaderOk &= LOAD_PROC(PFNGLBINDATTRIBLOCATIONPROC, BindAttribLocation, "glBindAttribLocation", 0);
+    shaderOk &= LOAD_PROC(PFNGLLINKPROGRAMPROC, LinkProgram, "glLinkProgram", 0);
+    shaderOk &= LOAD_PROC(PFNGLGETPROGRAMIVPROC, GetProgramiv, "glGetProgramiv", 0);
+    shaderOk &= LOAD_PROC(PFNGLGETPROGRAMINFOLOGPROC, GetProgramInfoLog, "glGetProgramInfoLog", 0);
+    shaderOk &= LOAD_PROC(PFNGLUSEPROGRAMPROC, UseProgram, "glUseProgram", 0);
+    shaderOk &= LOAD_PROC(PFNGLGETUNIFORMLOCATIONPROC, GetUniformLocation, "glGetUniformLocation", 0);
+    shaderOk &= LOAD_PROC(PFNGLUNIFORM1IPROC, Uniform1i, "glUniform1i", 0);
+    shaderOk &= LOAD_PROC(PFNGLUNIFORM1FPROC, Uniform1f, "glUniform1f", 0);
+    shaderOk &= LOAD_PROC(PFNGLUNIFORM2FPROC, Uniform2f, "glUniform2f", 0);
+    shaderOk &= LOAD_PROC(PFNGLUNIFORM3FPROC, Uniform3f, "glUniform3f", 0);
+    shaderOk &= LOAD_PROC(PFNGLUNIFORM4FPROC, Uniform4f, "glUniform4f", 0);
+    shaderOk &= LOAD_PROC(PFNGLVERTEXATTRIBPOINTERPROC, VertexAttribPointer, "glVertexAttribPointer", 0);
+    shaderOk &= LOAD_PROC(PFNGLENABLEVERTEXATTRIBARRAYPROC, EnableVertexAttribArray, "glEnableVertexAttribArray", 0);
+    shaderOk &= LOAD_PROC(PFNGLDISABLEVERTEXATTRIBARRAYPROC, DisableVertexAttribArray, "glDisableVertexAttribArray", 0);
+    glExt.hasShaders = shaderOk;
+
+    // --- Instanced arrays (core 3.3, or the ARB extension on older drivers) ---
+    bool instOk = glExt.hasShaders && glExt.hasVertexBuffers;
+    instOk &= LOAD_PROC(PFNGLVERTEXATTRIBDIVISORPROC, VertexAttribDivisor, "glVertexAttribDivisor", "ARB");
+    instOk &= LOAD_PROC(PFNGLDRAWARRAYSINSTANCEDPROC, DrawArraysInstanced, "glDrawArraysInstanced", "ARB");
+    glExt.hasInstancing = instOk && (version >= 33 || hasExtension("GL_ARB_instanced_arrays"));
+
+    std::cout << "OpenGL " << (const char*)glGetString(GL_VERSION)
+              << " (" << (const char*)glGetString(GL_RENDERER) << ")"
+              << (glExt.hasPixelBuffers ? ", pixel buffers" : "")
+              << (glExt.hasFramebuffers ? ", framebuffers" : "")
+              << (glExt.hasOcclusionQueries ? ", occlusion queries" : "")
+              << (glExt.hasTimerQueries ? ", timer queries" : "")
+              << (glExt.hasInstancing ? ", instancing" : "") << std::endl;
+}
+
+static GLuint compileShader(const char* name, GLenum type, const char* source) {
+    GLuint shader = glExt.CreateShader(type);
+    glExt.ShaderSource(shader, 1, &source, 0);
+    glExt.CompileShader(shader);
+    GLint ok = 0;
+    glExt.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[2048];
+        glExt.GetShaderInfoLog(shader, sizeof(log), 0, log);
+        std::cerr << name << (type == GL_VERTEX_SHADER ? " vertex" : " fragment")
+                  << " shader failed:\n" << log << std::endl;
+        glExt.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildShaderProgram(const char* name, const char* vertexSource, const char* fragmentSource,
+                          const char* const* attributes) {
+    if (!glExt.hasShaders) return 0;
+    GLuint vs = compileShader(name, GL_VERTEX_SHADER, vertexSource);
+    GLuint fs = compileShader(name, GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vs || !fs) return 0;
+
+    GLuint program = glExt.CreateProgram();
+    glExt.AttachShader(program, vs);
+    glExt.AttachShader(program, fs);
+    for (int i = 0; attributes && attributes[i]; ++i) glExt.BindAttribLocation(program, i, attributes[i]);
+    glExt.LinkProgram(program);
+    glExt.DeleteShader(vs); // flagged, freed with the program
+    glExt.DeleteShader(fs);
+
+    GLint ok = 0;
+    glExt.GetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[2048];
+        glExt.GetProgramInfoLog(program, sizeof(log), 0, log);
+        std::cerr << name << " program failed to link:\n" << log << std::endl;
+        return 0;
+    }
+    return program;
+}
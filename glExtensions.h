@@ -0,0 +1,93 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <GL/glut.h>
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+
+// **********************************************
+// ************ GL EXTENSION LOADER *************
+// **********************************************
+
+// opengl32.dll only exports OpenGL 1.1, so everything newer is fetched at
+// runtime through glutGetProcAddress(). Each feature group has a flag that is
+// only set when every entry point in the group was found.
+struct GLExtensions {
+    // --- Buffer objects (OpenGL 1.5 vertex buffers / 2.1 pixel buffers) ---
+    bool hasVertexBuffers;
+    bool hasPixelBuffers;
+    PFNGLGENBUFFERSPROC GenBuffers;
+    PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLBINDBUFFERPROC BindBuffer;
+    PFNGLBUFFERDATAPROC BufferData;
+    PFNGLBUFFERSUBDATAPROC BufferSubData;
+    PFNGLMAPBUFFERPROC MapBuffer;
+    PFNGLUNMAPBUFFERPROC UnmapBuffer;
+
+    // --- Occlusion queries (OpenGL 1.5 / ARB_occlusion_query) ---
+    bool hasOcclusionQueries;
+    PFNGLGENQUERIESPROC GenQueries;
+    PFNGLDELETEQUERIESPROC DeleteQueries;
+    PFNGLBEGINQUERYPROC BeginQuery;
+    PFNGLENDQUERYPROC EndQuery;
+    PFNGLGETQUERYOBJECTUIVPROC GetQueryObjectuiv;
+
+    // --- Timer queries (OpenGL 3.3 / ARB_timer_query, on the query entry points above) ---
+    bool hasTimerQueries;
+    PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+
+    // --- Framebuffer objects (OpenGL 3.0 / EXT_framebuffer_object) ---
+    bool hasFramebuffers;
+    PFNGLGENFRAMEBUFFERSPROC GenFramebuffers;
+    PFNGLDELETEFRAMEBUFFERSPROC DeleteFramebuffers;
+    PFNGLBINDFRAMEBUFFERPROC BindFramebuffer;
+    PFNGLFRAMEBUFFERTEXTURE2DPROC FramebufferTexture2D;
+    PFNGLGENRENDERBUFFERSPROC GenRenderbuffers;
+    PFNGLDELETERENDERBUFFERSPROC DeleteRenderbuffers;
+    PFNGLBINDRENDERBUFFERPROC BindRenderbuffer;
+    PFNGLRENDERBUFFERSTORAGEPROC RenderbufferStorage;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC FramebufferRenderbuffer;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC CheckFramebufferStatus;
+
+    // --- GLSL programs (OpenGL 2.0) ---
+    bool hasShaders;
+    PFNGLCREATESHADERPROC CreateShader;
+    PFNGLDELETESHADERPROC DeleteShader;
+    PFNGLSHADERSOURCEPROC ShaderSource;
+    PFNGLCOMPILESHADERPROC CompileShader;
+    PFNGLGETSHADERIVPROC GetShaderiv;
+    PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+    PFNGLCREATEPROGRAMPROC CreateProgram;
+    PFNGLATTACHSHADERPROC AttachShader;
+    PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+    PFNGLLINKPROGRAMPROC LinkProgram;
+    PFNGLGETPROGRAMIVPROC GetProgramiv;
+    PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+    PFNGLUSEPROGRAMPROC UseProgram;
+    PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+    PFNGLUNIFORM1IPROC Uniform1i;
+    PFNGLUNIFORM1FPROC Uniform1f;
+    PFNGLUNIFORM2FPROC Uniform2f;
+    PFNGLUNIFORM3FPROC Uniform3f;
+    PFNGLUNIFORM4FPROC Uniform4f;
+    PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+    PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+    PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+
+    // --- Instanced arrays (OpenGL 3.3 / ARB_instanced_arrays) ---
+    bool hasInstancing;
+    PFNGLVERTEXATTRIBDIVISORPROC VertexAttribDivisor;
+    PFNGLDRAWARRAYSINSTANCEDPROC DrawArraysInstanced;
+};
+
+extern GLExtensions glExt;
+
+// Call once after glutCreateWindow(), when a context is current.
+void loadGLExtensions();
+
+// Compiles and links a GLSL program; attribute names are bound to locations
+// 0, 1, 2... in order (list ends with 0). Returns 0 and prints the log on failure.
+GLuint buildShaderProgram(const char* name, const char* vertexSource, const char* fragmentSource,
+                          const char* const* attributes);
+
+#endif
@@ -0,0 +1,93 @@
+#include "glTrace.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+bool glTraceRecording = false;
+
+// Function ids by the address of their __func__, which is the same string
+// every time a function passes it
+const int FUNCTION_TABLE_SIZE = 2048;
+const int MAX_TRACED_FUNCTIONS = 1024; // later ones are recorded as id 0
+const size_t FRAME_BUFFER_RESERVE = 1 << 20;
+
+static FILE* traceFile = 0;
+static const char* tracePath = 0;
+static int firstFrame = 0, lastFrame = 0;
+static int frameIndex = 0;
+static std::vector<unsigned char> frameRecords; // written out when the frame ends
+static const char* functionKeys[FUNCTION_TABLE_SIZE];
+static unsigned short functionIds[FUNCTION_TABLE_SIZE];
+static int functionCount = 0;
+static long callsRecorded = 0, bytesWritten = 0;
+static int framesRecorded = 0;
+
+static void putRecord(int op, int function, const void* payload, int bytes) {
+    size_t at = frameRecords.size();
+    frameRecords.resize(at + GL_TRACE_HEADER_BYTES + bytes);
+    unsigned char* p = &frameRecords[at];
+    p[0] = (unsigned char)op;
+    p[1] = (unsigned char)(op >> 8);
+    p[2] = (unsigned char)function;
+    p[3] = (unsigned char)(function >> 8);
+    p[4] = (unsigned char)bytes;
+    p[5] = (unsigned char)(bytes >> 8);
+    if (bytes) std::memcpy(p + GL_TRACE_HEADER_BYTES, payload, bytes);
+}
+
+static int functionId(const char* function) {
+    size_t slot = ((size_t)function >> 3) % FUNCTION_TABLE_SIZE;
+    while (functionKeys[slot] && functionKeys[slot] != function) slot = (slot + 1) % FUNCTION_TABLE_SIZE;
+    if (functionKeys[slot]) return functionIds[slot];
+    if (functionCount == MAX_TRACED_FUNCTIONS) return 0;
+
+    functionKeys[slot] = function;
+    functionIds[slot] = (unsigned short)++functionCount;
+    putRecord(GLT_FUNCTION, functionCount, function, (int)std::strlen(function));
+    return functionCount;
+}
+
+void glTraceCall(int op, const char* function, const void* payload, int bytes) {
+    putRecord(op, functionId(function), payload, bytes);
+    ++callsRecorded;
+}
+
+int glTraceFontId(void* font) {
+    if (font == GLUT_STROKE_ROMAN) return GLT_FONT_STROKE_ROMAN;
+    if (font == GLUT_BITMAP_HELVETICA_12) return GLT_FONT_HELVETICA_12;
+    return GLT_FONT_OTHER;
+}
+
+void glTraceConfigure(const char* path, int first, int last) {
+    traceFile = std::fopen(path, "wb");
+    if (!traceFile) {
+        std::fprintf(stderr, "GL trace: cannot write %s\n", path);
+        return;
+    }
+    std::fwrite(GL_TRACE_MAGIC, 1, sizeof(GL_TRACE_MAGIC), traceFile);
+    tracePath = path;
+    firstFrame = first;
+    lastFrame = last < first ? first : last;
+    frameRecords.reserve(FRAME_BUFFER_RESERVE);
+    // Frame 0 runs from here to the first swap, so it also holds the start-up state
+    glTraceRecording = firstFrame == 0;
+}
+
+void glTraceFrameEnd() {
+    if (!traceFile) return;
+    if (glTraceRecording) {
+        putRecord(GLT_FRAME, 0, 0, 0);
+        std::fwrite(&frameRecords[0], 1, frameRecords.size(), traceFile);
+        bytesWritten += (long)frameRecords.size();
+        frameRecords.clear();
+        ++framesRecorded;
+    }
+    ++frameIndex;
+    glTraceRecording = frameIndex >= firstFrame && frameIndex <= lastFrame;
+    if (frameIndex <= lastFrame) return;
+
+    std::fclose(traceFile);
+    traceFile = 0;
+    std::printf("GL trace: %d frames, %ld calls from %d functions, %ld KB written to %s\n",
+                framesRecorded, callsRecorded, functionCount, bytesWritten / 1024, tracePath);
+}
@@ -0,0 +1,455 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <GL/glut.h>
+#include <GL/freeglut.h>
+#include <GL/glu.h>
+#include <cstring>
+
+// **********************************************
+// ************ GL COMMAND TRACE ****************
+// **********************************************
+
+// Records the GL, GLU and GLUT calls the renderer makes, each tagged with
+// the function that made it, into a binary file that glTraceReplay
+// re-issues and breaks down. Files that draw include this header after
+// their other includes; from then on the calls below go through a wrapper
+// that costs one branch while nothing is being recorded. glExt entry
+// points and read-backs are not traced, and texture uploads only carry
+// their pixels when they fit in a record.
+//
+// File: "GLTRACE1", then records of u16 op, u16 function id, u16 payload
+// bytes and the payload. Arguments are 32-bit words (doubles are narrowed
+// to float, pointers kept as their low 32 bits); the vector forms carry
+// their values. GLT_FUNCTION names a function id the first time it is
+// used and GLT_FRAME ends a frame.
+
+#define GL_TRACE_CALLS(X) \
+    X(glBegin) X(glEnd) X(glVertex2f) X(glVertex3f) X(glVertex3fv) X(glNormal3fv) \
+    X(glColor3f) X(glColor4f) X(glColor3fv) X(glColor3ub) X(glTexCoord2f) \
+    X(glPushMatrix) X(glPopMatrix) X(glLoadIdentity) X(glMatrixMode) X(glTranslatef) \
+    X(glRotatef) X(glScalef) X(glLoadMatrixf) X(glMultMatrixf) X(glOrtho) \
+    X(glEnable) X(glDisable) X(glPushAttrib) X(glPopAttrib) X(glLightf) X(glLightfv) \
+    X(glFogf) X(glFogi) X(glFogfv) X(glBlendFunc) X(glDepthMask) X(glColorMask) \
+    X(glLineWidth) X(glPointSize) X(glBindTexture) X(glTexParameteri) X(glClear) \
+    X(glViewport) X(glRectf) X(glRasterPos2f) X(glNewList) X(glEndList) X(glCallList) \
+    X(glGenLists) X(glDeleteLists) X(glClearColor) X(glTexImage2D) X(glTexSubImage2D) \
+    X(glEnableClientState) X(glDisableClientState) X(glVertexPointer) X(glNormalPointer) \
+    X(glColorPointer) X(glDrawArrays) X(glDrawElements) \
+    X(gluPerspective) X(gluLookAt) \
+    X(glutSolidCube) X(glutWireCube) X(glutSolidSphere) X(glutStrokeCharacter) X(glutBitmapString)
+
+#define GL_TRACE_ENUM(name) GLT_##name,
+enum GLTraceOp {
+    GL_TRACE_CALLS(GL_TRACE_ENUM)
+    GLT_FUNCTION, // payload: the name of the function id in the header
+    GLT_FRAME,
+    NUM_GL_TRACE_OPS
+};
+#undef GL_TRACE_ENUM
+
+const char GL_TRACE_MAGIC[8] = { 'G', 'L', 'T', 'R', 'A', 'C', 'E', '1' };
+const int GL_TRACE_HEADER_BYTES = 6;
+const int GL_TRACE_MAX_PAYLOAD = 0xffff;
+
+// GLUT fonts are pointers; the trace keeps which one
+enum GLTraceFont { GLT_FONT_STROKE_ROMAN, GLT_FONT_HELVETICA_12, GLT_FONT_OTHER };
+
+union GLTraceWord {
+    GLuint u;
+    GLint i;
+    GLfloat f;
+};
+
+#define GL_TRACE_NAME(name) #name,
+inline const char* glTraceOpName(int op) {
+    static const char* const NAMES[NUM_GL_TRACE_OPS] = { GL_TRACE_CALLS(GL_TRACE_NAME) "function", "frame" };
+    return op >= 0 && op < NUM_GL_TRACE_OPS ? NAMES[op] : "?";
+}
+#undef GL_TRACE_NAME
+
+#ifndef GL_TRACE_NO_WRAPPERS
+
+// --- Recording (glTrace.cpp) ---
+
+// Records frames first..last (0 = the first display()) into path.
+void glTraceConfigure(const char* path, int firstFrame, int lastFrame);
+// After the buffers are swapped: closes the frame, starts or stops recording
+void glTraceFrameEnd();
+
+extern bool glTraceRecording;
+void glTraceCall(int op, const char* function, const void* payload, int bytes);
+int glTraceFontId(void* font);
+
+// --- Wrappers, one shape per signature ---
+
+#define GLT_WRAP_0(name) \
+    inline void glt_##name(const char* fn) { \
+        if (glTraceRecording) glTraceCall(GLT_##name, fn, 0, 0); \
+        name(); \
+    }
+#define GLT_WRAP_U(name, T) \
+    inline void glt_##name(const char* fn, T a) { \
+        if (glTraceRecording) { GLTraceWord w[1]; w[0].u = a; glTraceCall(GLT_##name, fn, w, sizeof(w)); } \
+        name(a); \
+    }
+#define GLT_WRAP_UU(name, TA, TB) \
+    inline void glt_##name(const char* fn, TA a, TB b) { \
+        if (glTraceRecording) { GLTraceWord w[2]; w[0].u = a; w[1].u = b; glTraceCall(GLT_##name, fn, w, sizeof(w)); } \
+        name(a, b); \
+    }
+#define GLT_WRAP_F(name) \
+    inline void glt_##name(const char* fn, GLfloat a) { \
+        if (glTraceRecording) glTraceCall(GLT_##name, fn, &a, sizeof(a)); \
+        name(a); \
+    }
+#define GLT_WRAP_FF(name) \
+    inline void glt_##name(const char* fn, GLfloat a, GLfloat b) { \
+        if (glTraceRecording) { GLfloat w[2] = { a, b }; glTraceCall(GLT_##name, fn, w, sizeof(w)); } \
+        name(a, b); \
+    }
+#define GLT_WRAP_FFF(name) \
+    inline void glt_##name(const char* fn, GLfloat a, GLfloat b, GLfloat c) { \
+        if (glTraceRecording) { GLfloat w[3] = { a, b, c }; glTraceCall(GLT_##name, fn, w, sizeof(w)); } \
+        name(a, b, c); \
+    }
+#define GLT_WRAP_FFFF(name) \
+    inline void glt_##name(const char* fn, GLfloat a, GLfloat b, GLfloat c, GLfloat d) { \
+        if (glTraceRecording) { GLfloat w[4] = { a, b, c, d }; glTraceCall(GLT_##name, fn, w, sizeof(w)); } \
+        name(a, b, c, d); \
+    }
+#define GLT_WRAP_FV(name, count) \
+    inline void glt_##name(const char* fn, const GLfloat* v) { \
+        if (glTraceRecording) glTraceCall(GLT_##name, fn, v, (count) * sizeof(GLfloat)); \
+        name(v); \
+    }
+
+GLT_WRAP_U(glBegin, GLenum)
+GLT_WRAP_0(glEnd)
+GLT_WRAP_FF(glVertex2f)
+GLT_WRAP_FFF(glVertex3f)
+GLT_WRAP_FV(glVertex3fv, 3)
+GLT_WRAP_FV(glNormal3fv, 3)
+GLT_WRAP_FFF(glColor3f)
+GLT_WRAP_FFFF(glColor4f)
+GLT_WRAP_FV(glColor3fv, 3)
+GLT_WRAP_FF(glTexCoord2f)
+GLT_WRAP_0(glPushMatrix)
+GLT_WRAP_0(glPopMatrix)
+GLT_WRAP_0(glLoadIdentity)
+GLT_WRAP_U(glMatrixMode, GLenum)
+GLT_WRAP_FFF(glTranslatef)
+GLT_WRAP_FFFF(glRotatef)
+GLT_WRAP_FFF(glScalef)
+GLT_WRAP_FV(glLoadMatrixf, 16)
+GLT_WRAP_FV(glMultMatrixf, 16)
+GLT_WRAP_U(glEnable, GLenum)
+GLT_WRAP_U(glDisable, GLenum)
+GLT_WRAP_U(glPushAttrib, GLbitfield)
+GLT_WRAP_0(glPopAttrib)
+GLT_WRAP_UU(glBlendFunc, GLenum, GLenum)
+GLT_WRAP_U(glDepthMask, GLboolean)
+GLT_WRAP_F(glLineWidth)
+GLT_WRAP_F(glPointSize)
+GLT_WRAP_UU(glBindTexture, GLenum, GLuint)
+GLT_WRAP_U(glClear, GLbitfield)
+GLT_WRAP_FFFF(glRectf)
+GLT_WRAP_FFFF(glClearColor)
+GLT_WRAP_FF(glRasterPos2f)
+GLT_WRAP_UU(glNewList, GLuint, GLenum)
+GLT_WRAP_0(glEndList)
+GLT_WRAP_U(glCallList, GLuint)
+GLT_WRAP_UU(glDeleteLists, GLuint, GLsizei)
+GLT_WRAP_U(glEnableClientState, GLenum)
+GLT_WRAP_U(glDisableClientState, GLenum)
+
+// --- Mixed signatures ---
+
+inline void glt_glColor3ub(const char* fn, GLubyte r, GLubyte g, GLubyte b) {
+    if (glTraceRecording) { GLTraceWord w[3]; w[0].u = r; w[1].u = g; w[2].u = b; glTraceCall(GLT_glColor3ub, fn, w, sizeof(w)); }
+    glColor3ub(r, g, b);
+}
+
+inline void glt_glOrtho(const char* fn, GLdouble l, GLdouble r, GLdouble b, GLdouble t, GLdouble n, GLdouble f) {
+    if (glTraceRecording) {
+        GLfloat w[6] = { (GLfloat)l, (GLfloat)r, (GLfloat)b, (GLfloat)t, (GLfloat)n, (GLfloat)f };
+        glTraceCall(GLT_glOrtho, fn, w, sizeof(w));
+    }
+    glOrtho(l, r, b, t, n, f);
+}
+
+inline void glt_glLightf(const char* fn, GLenum light, GLenum pname, GLfloat v) {
+    if (glTraceRecording) { GLTraceWord w[3]; w[0].u = light; w[1].u = pname; w[2].f = v; glTraceCall(GLT_glLightf, fn, w, sizeof(w)); }
+    glLightf(light, pname, v);
+}
+
+inline void glt_glLightfv(const char* fn, GLenum light, GLenum pname, const GLfloat* v) {
+    if (glTraceRecording) {
+        int count = pname == GL_SPOT_DIRECTION ? 3 : pname == GL_SPOT_EXPONENT || pname == GL_SPOT_CUTOFF ||
+                    pname == GL_CONSTANT_ATTENUATION || pname == GL_LINEAR_ATTENUATION ||
+                    pname == GL_QUADRATIC_ATTENUATION ? 1 : 4;
+        GLTraceWord w[6];
+        w[0].u = light;
+        w[1].u = pname;
+        for (int i = 0; i < count; ++i) w[2 + i].f = v[i];
+        glTraceCall(GLT_glLightfv, fn, w, (2 + count) * sizeof(GLTraceWord));
+    }
+    glLightfv(light, pname, v);
+}
+
+inline void glt_glFogf(const char* fn, GLenum pname, GLfloat v) {
+    if (glTraceRecording) { GLTraceWord w[2]; w[0].u = pname; w[1].f = v; glTraceCall(GLT_glFogf, fn, w, sizeof(w)); }
+    glFogf(pname, v);
+}
+
+inline void glt_glFogi(const char* fn, GLenum pname, GLint v) {
+    if (glTraceRecording) { GLTraceWord w[2]; w[0].u = pname; w[1].i = v; glTraceCall(GLT_glFogi, fn, w, sizeof(w)); }
+    glFogi(pname, v);
+}
+
+inline void glt_glFogfv(const char* fn, GLenum pname, const GLfloat* v) {
+    if (glTraceRecording) {
+        int count = pname == GL_FOG_COLOR ? 4 : 1;
+        GLTraceWord w[5];
+        w[0].u = pname;
+        for (int i = 0; i < count; ++i) w[1 + i].f = v[i];
+        glTraceCall(GLT_glFogfv, fn, w, (1 + count) * sizeof(GLTraceWord));
+    }
+    glFogfv(pname, v);
+}
+
+inline void glt_glColorMask(const char* fn, GLboolean r, GLboolean g, GLboolean b, GLboolean a) {
+    if (glTraceRecording) { GLTraceWord w[4]; w[0].u = r; w[1].u = g; w[2].u = b; w[3].u = a; glTraceCall(GLT_glColorMask, fn, w, sizeof(w)); }
+    glColorMask(r, g, b, a);
+}
+
+inline void glt_glTexParameteri(const char* fn, GLenum target, GLenum pname, GLint v) {
+    if (glTraceRecording) { GLTraceWord w[3]; w[0].u = target; w[1].u = pname; w[2].i = v; glTraceCall(GLT_glTexParameteri, fn, w, sizeof(w)); }
+    glTexParameteri(target, pname, v);
+}
+
+inline void glt_glViewport(const char* fn, GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (glTraceRecording) { GLTraceWord w[4]; w[0].i = x; w[1].i = y; w[2].i = width; w[3].i = height; glTraceCall(GLT_glViewport, fn, w, sizeof(w)); }
+    glViewport(x, y, width, height);
+}
+
+inline void glt_glVertexPointer(const char* fn, GLint size, GLenum type, GLsizei stride, const GLvoid* p) {
+    if (glTraceRecording) {
+        GLTraceWord w[4]; w[0].i = size; w[1].u = type; w[2].i = stride; w[3].u = (GLuint)(size_t)p;
+        glTraceCall(GLT_glVertexPointer, fn, w, sizeof(w));
+    }
+    glVertexPointer(size, type, stride, p);
+}
+
+inline void glt_glNormalPointer(const char* fn, GLenum type, GLsizei stride, const GLvoid* p) {
+    if (glTraceRecording) {
+        GLTraceWord w[3]; w[0].u = type; w[1].i = stride; w[2].u = (GLuint)(size_t)p;
+        glTraceCall(GLT_glNormalPointer, fn, w, sizeof(w));
+    }
+    glNormalPointer(type, stride, p);
+}
+
+inline void glt_glColorPointer(const char* fn, GLint size, GLenum type, GLsizei stride, const GLvoid* p) {
+    if (glTraceRecording) {
+        GLTraceWord w[4]; w[0].i = size; w[1].u = type; w[2].i = stride; w[3].u = (GLuint)(size_t)p;
+        glTraceCall(GLT_glColorPointer, fn, w, sizeof(w));
+    }
+    glColorPointer(size, type, stride, p);
+}
+
+inline void glt_glDrawArrays(const char* fn, GLenum mode, GLint first, GLsizei count) {
+    if (glTraceRecording) { GLTraceWord w[3]; w[0].u = mode; w[1].i = first; w[2].i = count; glTraceCall(GLT_glDrawArrays, fn, w, sizeof(w)); }
+    glDrawArrays(mode, first, count);
+}
+
+inline void glt_glDrawElements(const char* fn, GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+    if (glTraceRecording) {
+        GLTraceWord w[4]; w[0].u = mode; w[1].i = count; w[2].u = type; w[3].u = (GLuint)(size_t)indices;
+        glTraceCall(GLT_glDrawElements, fn, w, sizeof(w));
+    }
+    glDrawElements(mode, count, type, indices);
+}
+
+// Payload: the range, then the first id so replay can map the ids
+inline GLuint glt_glGenLists(const char* fn, GLsizei range) {
+    GLuint first = glGenLists(range);
+    if (glTraceRecording) { GLTraceWord w[2]; w[0].i = range; w[1].u = first; glTraceCall(GLT_glGenLists, fn, w, sizeof(w)); }
+    return first;
+}
+
+// Payload: the arguments, then the pixels if they are bytes of RGBA and
+// fit in the record; otherwise replay allocates the texture without them
+inline int glTracePixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels,
+                             int argumentBytes) {
+    if (!pixels || format != GL_RGBA || type != GL_UNSIGNED_BYTE) return 0;
+    long bytes = 4L * width * height;
+    return bytes <= GL_TRACE_MAX_PAYLOAD - argumentBytes ? (int)bytes : 0;
+}
+
+inline void glt_glTexImage2D(const char* fn, GLenum target, GLint level, GLint internalFormat, GLsizei width,
+                             GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+    if (glTraceRecording) {
+        static unsigned char payload[GL_TRACE_MAX_PAYLOAD];
+        GLTraceWord w[8];
+        w[0].u = target; w[1].i = level; w[2].i = internalFormat; w[3].i = width;
+        w[4].i = height; w[5].i = border; w[6].u = format; w[7].u = type;
+        int pixelBytes = glTracePixelBytes(width, height, format, type, pixels, sizeof(w));
+        std::memcpy(payload, w, sizeof(w));
+        if (pixelBytes) std::memcpy(payload + sizeof(w), pixels, pixelBytes);
+        glTraceCall(GLT_glTexImage2D, fn, payload, (int)sizeof(w) + pixelBytes);
+    }
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+inline void glt_glTexSubImage2D(const char* fn, GLenum target, GLint level, GLint x, GLint y, GLsizei width,
+                                GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+    if (glTraceRecording) {
+        static unsigned char payload[GL_TRACE_MAX_PAYLOAD];
+        GLTraceWord w[8];
+        w[0].u = target; w[1].i = level; w[2].i = x; w[3].i = y;
+        w[4].i = width; w[5].i = height; w[6].u = format; w[7].u = type;
+        int pixelBytes = glTracePixelBytes(width, height, format, type, pixels, sizeof(w));
+        std::memcpy(payload, w, sizeof(w));
+        if (pixelBytes) std::memcpy(payload + sizeof(w), pixels, pixelBytes);
+        glTraceCall(GLT_glTexSubImage2D, fn, payload, (int)sizeof(w) + pixelBytes);
+    }
+    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+}
+
+inline void glt_gluPerspective(const char* fn, GLdouble fovy, GLdouble aspect, GLdouble zNear, GLdouble zFar) {
+    if (glTraceRecording) {
+        GLfloat w[4] = { (GLfloat)fovy, (GLfloat)aspect, (GLfloat)zNear, (GLfloat)zFar };
+        glTraceCall(GLT_gluPerspective, fn, w, sizeof(w));
+    }
+    gluPerspective(fovy, aspect, zNear, zFar);
+}
+
+inline void glt_gluLookAt(const char* fn, GLdouble ex, GLdouble ey, GLdouble ez, GLdouble cx, GLdouble cy, GLdouble cz,
+                          GLdouble ux, GLdouble uy, GLdouble uz) {
+    if (glTraceRecording) {
+        GLfloat w[9] = { (GLfloat)ex, (GLfloat)ey, (GLfloat)ez, (GLfloat)cx, (GLfloat)cy, (GLfloat)cz,
+                         (GLfloat)ux, (GLfloat)uy, (GLfloat)uz };
+        glTraceCall(GLT_gluLookAt, fn, w, sizeof(w));
+    }
+    gluLookAt(ex, ey, ez, cx, cy, cz, ux, uy, uz);
+}
+
+inline void glt_glutSolidCube(const char* fn, GLdouble size) {
+    if (glTraceRecording) { GLfloat w[1] = { (GLfloat)size }; glTraceCall(GLT_glutSolidCube, fn, w, sizeof(w)); }
+    glutSolidCube(size);
+}
+
+inline void glt_glutWireCube(const char* fn, GLdouble size) {
+    if (glTraceRecording) { GLfloat w[1] = { (GLfloat)size }; glTraceCall(GLT_glutWireCube, fn, w, sizeof(w)); }
+    glutWireCube(size);
+}
+
+inline void glt_glutSolidSphere(const char* fn, GLdouble radius, GLint slices, GLint stacks) {
+    if (glTraceRecording) {
+        GLTraceWord w[3]; w[0].f = (GLfloat)radius; w[1].i = slices; w[2].i = stacks;
+        glTraceCall(GLT_glutSolidSphere, fn, w, sizeof(w));
+    }
+    glutSolidSphere(radius, slices, stacks);
+}
+
+inline void glt_glutStrokeCharacter(const char* fn, void* font, int character) {
+    if (glTraceRecording) {
+        GLTraceWord w[2]; w[0].i = glTraceFontId(font); w[1].i = character;
+        glTraceCall(GLT_glutStrokeCharacter, fn, w, sizeof(w));
+    }
+    glutStrokeCharacter(font, character);
+}
+
+// Payload: the font id byte, then the text
+inline void glt_glutBitmapString(const char* fn, void* font, const unsigned char* text) {
+    if (glTraceRecording) {
+        unsigned char payload[256];
+        payload[0] = (unsigned char)glTraceFontId(font);
+        int length = 0;
+        while (text[length] && length < (int)sizeof(payload) - 1) {
+            payload[1 + length] = text[length];
+            ++length;
+        }
+        glTraceCall(GLT_glutBitmapString, fn, payload, 1 + length);
+    }
+    glutBitmapString(font, text);
+}
+
+#undef GLT_WRAP_0
+#undef GLT_WRAP_U
+#undef GLT_WRAP_UU
+#undef GLT_WRAP_F
+#undef GLT_WRAP_FF
+#undef GLT_WRAP_FFF
+#undef GLT_WRAP_FFFF
+#undef GLT_WRAP_FV
+
+// --- Every call below this point goes through its wrapper ---
+
+#define glEnd() glt_glEnd(__func__)
+#define glPushMatrix() glt_glPushMatrix(__func__)
+#define glPopMatrix() glt_glPopMatrix(__func__)
+#define glLoadIdentity() glt_glLoadIdentity(__func__)
+#define glPopAttrib() glt_glPopAttrib(__func__)
+#define glEndList() glt_glEndList(__func__)
+#define glBegin(...) glt_glBegin(__func__, __VA_ARGS__)
+#define glVertex2f(...) glt_glVertex2f(__func__, __VA_ARGS__)
+#define glVertex3f(...) glt_glVertex3f(__func__, __VA_ARGS__)
+#define glVertex3fv(...) glt_glVertex3fv(__func__, __VA_ARGS__)
+#define glNormal3fv(...) glt_glNormal3fv(__func__, __VA_ARGS__)
+#define glColor3f(...) glt_glColor3f(__func__, __VA_ARGS__)
+#define glColor4f(...) glt_glColor4f(__func__, __VA_ARGS__)
+#define glColor3fv(...) glt_glColor3fv(__func__, __VA_ARGS__)
+#define glColor3ub(...) glt_glColor3ub(__func__, __VA_ARGS__)
+#define glTexCoord2f(...) glt_glTexCoord2f(__func__, __VA_ARGS__)
+#define glMatrixMode(...) glt_glMatrixMode(__func__, __VA_ARGS__)
+#define glTranslatef(...) glt_glTranslatef(__func__, __VA_ARGS__)
+#define glRotatef(...) glt_glRotatef(__func__, __VA_ARGS__)
+#define glScalef(...) glt_glScalef(__func__, __VA_ARGS__)
+#define glLoadMatrixf(...) glt_glLoadMatrixf(__func__, __VA_ARGS__)
+#define glMultMatrixf(...) glt_glMultMatrixf(__func__, __VA_ARGS__)
+#define glOrtho(...) glt_glOrtho(__func__, __VA_ARGS__)
+#define glEnable(...) glt_glEnable(__func__, __VA_ARGS__)
+#define glDisable(...) glt_glDisable(__func__, __VA_ARGS__)
+#define glPushAttrib(...) glt_glPushAttrib(__func__, __VA_ARGS__)
+#define glLightf(...) glt_glLightf(__func__, __VA_ARGS__)
+#define glLightfv(...) glt_glLightfv(__func__, __VA_ARGS__)
+#define glFogf(...) glt_glFogf(__func__, __VA_ARGS__)
+#define glFogi(...) glt_glFogi(__func__, __VA_ARGS__)
+#define glFogfv(...) glt_glFogfv(__func__, __VA_ARGS__)
+#define glBlendFunc(...) glt_glBlendFunc(__func__, __VA_ARGS__)
+#define glDepthMask(...) glt_glDepthMask(__func__, __VA_ARGS__)
+#define glColorMask(...) glt_glColorMask(__func__, __VA_ARGS__)
+#define glLineWidth(...) glt_glLineWidth(__func__, __VA_ARGS__)
+#define glPointSize(...) glt_glPointSize(__func__, __VA_ARGS__)
+#define glBindTexture(...) glt_glBindTexture(__func__, __VA_ARGS__)
+#define glTexParameteri(...) glt_glTexParameteri(__func__, __VA_ARGS__)
+#define glClear(...) glt_glClear(__func__, __VA_ARGS__)
+#define glViewport(...) glt_glViewport(__func__, __VA_ARGS__)
+#define glRectf(...) glt_glRectf(__func__, __VA_ARGS__)
+#define glRasterPos2f(...) glt_glRasterPos2f(__func__, __VA_ARGS__)
+#define glNewList(...) glt_glNewList(__func__, __VA_ARGS__)
+#define glCallList(...) glt_glCallList(__func__, __VA_ARGS__)
+#define glGenLists(...) glt_glGenLists(__func__, __VA_ARGS__)
+#define glDeleteLists(...) glt_glDeleteLists(__func__, __VA_ARGS__)
+#define glClearColor(...) glt_glClearColor(__func__, __VA_ARGS__)
+#define glTexImage2D(...) glt_glTexImage2D(__func__, __VA_ARGS__)
+#define glTexSubImage2D(...) glt_glTexSubImage2D(__func__, __VA_ARGS__)
+#define glEnableClientState(...) glt_glEnableClientState(__func__, __VA_ARGS__)
+#define glDisableClientState(...) glt_glDisableClientState(__func__, __VA_ARGS__)
+#define glVertexPointer(...) glt_glVertexPointer(__func__, __VA_ARGS__)
+#define glNormalPointer(...) glt_glNormalPointer(__func__, __VA_ARGS__)
+#define glColorPointer(...) glt_glColorPointer(__func__, __VA_ARGS__)
+#define glDrawArrays(...) glt_glDrawArrays(__func__, __VA_ARGS__)
+#define glDrawElements(...) glt_glDrawElements(__func__, __VA_ARGS__)
+#define gluPerspective(...) glt_gluPerspective(__func__, __VA_ARGS__)
+#define gluLookAt(...) glt_gluLookAt(__func__, __VA_ARGS__)
+#define glutSolidCube(...) glt_glutSolidCube(__func__, __VA_ARGS__)
+#define glutWireCube(...) glt_glutWireCube(__func__, __VA_ARGS__)
+#define glutSolidSphere(...) glt_glutSolidSphere(__func__, __VA_ARGS__)
+#define glutStrokeCharacter(...) glt_glutStrokeCharacter(__func__, __VA_ARGS__)
+#define glutBitmapString(...) glt_glutBitmapString(__func__, __VA_ARGS__)
+
+#endif // GL_TRACE_NO_WRAPPERS
+
+#endif
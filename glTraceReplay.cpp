@@ -0,0 +1,328 @@
+// **********************************************
+// ************ GL TRACE REPLAY *****************
+// **********************************************
+
+// Reads a trace written with --gl-trace, re-issues it as fast as it can into
+// a hidden window and reports the calls per frame by type and by the
+// function that made them, with the time the driver took. Built from
+// GLTRACEREPLAY.dev.
+//
+// The trace keeps arguments, not vertex buffers or client arrays, so array
+// draws and their pointer setup are counted but not re-issued, and a list
+// is only called if the trace also recorded it being compiled (record from
+// frame 0 to include the start-up lists). Texture uploads replay their
+// pixels when the trace carries them and allocate the texture when it does
+// not. Text is replayed in the two fonts
+// the stadium uses. --null decodes without GL, which times the trace format
+// on its own.
+
+#define GL_TRACE_NO_WRAPPERS
+#include "glTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock ReplayClock;
+
+struct TraceRecord {
+    int op;
+    int function;
+    size_t payload; // offset into the file
+    int bytes;
+};
+
+struct TraceFrame {
+    size_t firstRecord, endRecord;
+    long calls;
+    double bestMs;
+};
+
+static std::vector<unsigned char> traceData;
+static std::vector<TraceRecord> records;
+static std::vector<TraceFrame> frames;
+static std::vector<std::string> functionNames; // by id; 0 = "?"
+static std::map<GLuint, GLuint> listIds;        // recorded list -> replay list
+static long skippedCalls = 0;
+static unsigned int decodeChecksum = 0; // keeps --null's decoding from being optimized away
+
+// **********************************************
+// ************ LOADING *************************
+// **********************************************
+
+static bool loadTrace(const char* path) {
+    FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    unsigned char buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), f)) > 0) traceData.insert(traceData.end(), buffer, buffer + got);
+    std::fclose(f);
+    return traceData.size() >= sizeof(GL_TRACE_MAGIC) &&
+           std::memcmp(&traceData[0], GL_TRACE_MAGIC, sizeof(GL_TRACE_MAGIC)) == 0;
+}
+
+// Splits the file into records and frames; false if it is cut short
+static bool decodeTrace() {
+    functionNames.assign(1, "?");
+    size_t at = sizeof(GL_TRACE_MAGIC);
+    TraceFrame frame = { 0, 0, 0, 0.0 };
+    while (at + GL_TRACE_HEADER_BYTES <= traceData.size()) {
+        const unsigned char* p = &traceData[at];
+        TraceRecord r;
+        r.op = p[0] | p[1] << 8;
+        r.function = p[2] | p[3] << 8;
+        r.bytes = p[4] | p[5] << 8;
+        r.payload = at + GL_TRACE_HEADER_BYTES;
+        at = r.payload + r.bytes;
+        if (at > traceData.size() || r.op >= NUM_GL_TRACE_OPS) return false;
+
+        if (r.op == GLT_FUNCTION) {
+            if ((int)functionNames.size() <= r.function) functionNames.resize(r.function + 1, "?");
+            functionNames[r.function].assign((const char*)&traceData[r.payload], r.bytes);
+        } else if (r.op == GLT_FRAME) {
+            frame.endRecord = records.size();
+            frames.push_back(frame);
+            frame.firstRecord = records.size();
+            frame.calls = 0;
+        } else {
+            records.push_back(r);
+            ++frame.calls;
+        }
+    }
+    return at == traceData.size();
+}
+
+// **********************************************
+// ************ REPLAY **************************
+// **********************************************
+
+static void replayRecord(const TraceRecord& r) {
+    GLTraceWord w[16];
+    if (r.bytes) std::memcpy(w, &traceData[r.payload], std::min(r.bytes, (int)sizeof(w)));
+    const GLfloat* v = &w[0].f;
+
+    switch (r.op) {
+    case GLT_glBegin: glBegin(w[0].u); break;
+    case GLT_glEnd: glEnd(); break;
+    case GLT_glVertex2f: glVertex2f(v[0], v[1]); break;
+    case GLT_glVertex3f: glVertex3f(v[0], v[1], v[2]); break;
+    case GLT_glVertex3fv: glVertex3fv(v); break;
+    case GLT_glNormal3fv: glNormal3fv(v); break;
+    case GLT_glColor3f: glColor3f(v[0], v[1], v[2]); break;
+    case GLT_glColor4f: glColor4f(v[0], v[1], v[2], v[3]); break;
+    case GLT_glColor3fv: glColor3fv(v); break;
+    case GLT_glColor3ub: glColor3ub((GLubyte)w[0].u, (GLubyte)w[1].u, (GLubyte)w[2].u); break;
+    case GLT_glTexCoord2f: glTexCoord2f(v[0], v[1]); break;
+    case GLT_glPushMatrix: glPushMatrix(); break;
+    case GLT_glPopMatrix: glPopMatrix(); break;
+    case GLT_glLoadIdentity: glLoadIdentity(); break;
+    case GLT_glMatrixMode: glMatrixMode(w[0].u); break;
+    case GLT_glTranslatef: glTranslatef(v[0], v[1], v[2]); break;
+    case GLT_glRotatef: glRotatef(v[0], v[1], v[2], v[3]); break;
+    case GLT_glScalef: glScalef(v[0], v[1], v[2]); break;
+    case GLT_glLoadMatrixf: glLoadMatrixf(v); break;
+    case GLT_glMultMatrixf: glMultMatrixf(v); break;
+    case GLT_glOrtho: glOrtho(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+    case GLT_glEnable: glEnable(w[0].u); break;
+    case GLT_glDisable: glDisable(w[0].u); break;
+    case GLT_glPushAttrib: glPushAttrib(w[0].u); break;
+    case GLT_glPopAttrib: glPopAttrib(); break;
+    case GLT_glLightf: glLightf(w[0].u, w[1].u, w[2].f); break;
+    case GLT_glLightfv: glLightfv(w[0].u, w[1].u, v + 2); break;
+    case GLT_glFogf: glFogf(w[0].u, w[1].f); break;
+    case GLT_glFogi: glFogi(w[0].u, w[1].i); break;
+    case GLT_glFogfv: glFogfv(w[0].u, v + 1); break;
+    case GLT_glBlendFunc: glBlendFunc(w[0].u, w[1].u); break;
+    case GLT_glDepthMask: glDepthMask((GLboolean)w[0].u); break;
+    case GLT_glColorMask: glColorMask((GLboolean)w[0].u, (GLboolean)w[1].u, (GLboolean)w[2].u, (GLboolean)w[3].u); break;
+    case GLT_glLineWidth: glLineWidth(v[0]); break;
+    case GLT_glPointSize: glPointSize(v[0]); break;
+    case GLT_glBindTexture: glBindTexture(w[0].u, w[1].u); break;
+    case GLT_glTexParameteri: glTexParameteri(w[0].u, w[1].u, w[2].i); break;
+    case GLT_glClear: glClear(w[0].u); break;
+    case GLT_glViewport: glViewport(w[0].i, w[1].i, w[2].i, w[3].i); break;
+    case GLT_glRectf: glRectf(v[0], v[1], v[2], v[3]); break;
+    case GLT_glRasterPos2f: glRasterPos2f(v[0], v[1]); break;
+    case GLT_glNewList: {
+        GLuint& list = listIds[w[0].u];
+        if (!list) list = glGenLists(1);
+        glNewList(list, w[1].u);
+        break;
+    }
+    case GLT_glEndList: glEndList(); break;
+    case GLT_glGenLists: {
+        GLuint first = glGenLists(w[0].i);
+        for (int k = 0; k < w[0].i; ++k) listIds[w[1].u + k] = first + k;
+        break;
+    }
+    case GLT_glDeleteLists:
+        for (GLuint k = 0; k < w[1].u; ++k) {
+            std::map<GLuint, GLuint>::iterator list = listIds.find(w[0].u + k);
+            if (list == listIds.end()) continue;
+            glDeleteLists(list->second, 1);
+            listIds.erase(list);
+        }
+        break;
+    case GLT_glClearColor: glClearColor(v[0], v[1], v[2], v[3]); break;
+    case GLT_glTexImage2D:
+    case GLT_glTexSubImage2D: {
+        const int argumentBytes = 8 * sizeof(GLTraceWord);
+        const GLvoid* pixels = r.bytes > argumentBytes ? &traceData[r.payload + argumentBytes] : 0;
+        if (r.op == GLT_glTexImage2D)
+            glTexImage2D(w[0].u, w[1].i, w[2].i, w[3].i, w[4].i, w[5].i, w[6].u, w[7].u, pixels);
+        else if (pixels)
+            glTexSubImage2D(w[0].u, w[1].i, w[2].i, w[3].i, w[4].i, w[5].i, w[6].u, w[7].u, pixels);
+        else
+            ++skippedCalls; // the pixels did not fit in the record
+        break;
+    }
+    case GLT_glCallList: {
+        std::map<GLuint, GLuint>::const_iterator list = listIds.find(w[0].u);
+        if (list != listIds.end()) glCallList(list->second);
+        else ++skippedCalls; // compiled before the trace started
+        break;
+    }
+    case GLT_gluPerspective: gluPerspective(v[0], v[1], v[2], v[3]); break;
+    case GLT_gluLookAt: gluLookAt(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8]); break;
+    case GLT_glutSolidCube: glutSolidCube(v[0]); break;
+    case GLT_glutWireCube: glutWireCube(v[0]); break;
+    case GLT_glutSolidSphere: glutSolidSphere(w[0].f, w[1].i, w[2].i); break;
+    case GLT_glutStrokeCharacter: glutStrokeCharacter(GLUT_STROKE_ROMAN, w[1].i); break;
+    case GLT_glutBitmapString: {
+        unsigned char text[256];
+        int length = std::min(r.bytes - 1, (int)sizeof(text) - 1);
+        std::memcpy(text, &traceData[r.payload + 1], length);
+        text[length] = 0;
+        glutBitmapString(GLUT_BITMAP_HELVETICA_12, text);
+        break;
+    }
+    default: ++skippedCalls; // client arrays and array draws: the data is not in the trace
+    }
+}
+
+static double replayFrame(const TraceFrame& frame, bool useGL) {
+    ReplayClock::time_point start = ReplayClock::now();
+    if (useGL) {
+        for (size_t i = frame.firstRecord; i < frame.endRecord; ++i) replayRecord(records[i]);
+        glFinish();
+    } else {
+        // Decode only: touch every payload as replayRecord would
+        for (size_t i = frame.firstRecord; i < frame.endRecord; ++i) {
+            const TraceRecord& r = records[i];
+            for (int b = 0; b < r.bytes; ++b) decodeChecksum += traceData[r.payload + b];
+        }
+    }
+    return std::chrono::duration<double, std::milli>(ReplayClock::now() - start).count();
+}
+
+// **********************************************
+// ************ REPORT **************************
+// **********************************************
+
+struct CountRow {
+    std::string name;
+    long calls;
+};
+
+static bool byCallsDescending(const CountRow& a, const CountRow& b) {
+    return a.calls > b.calls;
+}
+
+static void printTable(const char* title, std::vector<CountRow>& rows, long totalCalls) {
+    std::sort(rows.begin(), rows.end(), byCallsDescending);
+    std::printf("\n%s (calls per frame, share)\n", title);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (!rows[i].calls) continue;
+        std::printf("  %-28s %12.1f %6.1f%%\n", rows[i].name.c_str(), (double)rows[i].calls / frames.size(),
+                    100.0 * rows[i].calls / totalCalls);
+    }
+}
+
+static void printReport(bool useGL) {
+    long totalCalls = (long)records.size();
+    std::vector<CountRow> byType(NUM_GL_TRACE_OPS), byFunction(functionNames.size());
+    for (int op = 0; op < NUM_GL_TRACE_OPS; ++op) {
+        byType[op].name = glTraceOpName(op);
+        byType[op].calls = 0;
+    }
+    for (size_t f = 0; f < functionNames.size(); ++f) {
+        byFunction[f].name = functionNames[f];
+        byFunction[f].calls = 0;
+    }
+    for (size_t i = 0; i < records.size(); ++i) {
+        ++byType[records[i].op].calls;
+        if (records[i].function < (int)byFunction.size()) ++byFunction[records[i].function].calls;
+    }
+
+    std::printf("\n%-6s %10s %12s\n", "frame", "calls", useGL ? "replay ms" : "decode ms");
+    double totalMs = 0.0;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        std::printf("%-6d %10ld %12.3f\n", (int)f, frames[f].calls, frames[f].bestMs);
+        totalMs += frames[f].bestMs;
+    }
+    printTable("By call", byType, totalCalls);
+    printTable("By function", byFunction, totalCalls);
+
+    std::printf("\nReplay: %.3f ms per frame, %.1f ns per call", totalMs / frames.size(),
+                totalCalls ? 1e6 * totalMs / totalCalls : 0.0);
+    if (useGL) std::printf(", %ld calls not re-issued per frame", skippedCalls / (long)frames.size());
+    std::printf("\n");
+}
+
+// **********************************************
+// ************ MAIN ****************************
+// **********************************************
+
+int main(int argc, char** argv) {
+    const char* path = 0;
+    bool useGL = true;
+    int repeat = 5;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : 0;
+        if (std::strcmp(argv[i], "--null") == 0) useGL = false;
+        else if (std::strcmp(argv[i], "--repeat") == 0 && value) { repeat = std::max(1, std::atoi(value)); ++i; }
+        else if (argv[i][0] != '-' && !path) path = argv[i];
+        else usage = true;
+    }
+    if (!path || usage) {
+        std::printf("Usage: %s <trace file> [--null] [--repeat <n, default 5>]\n", argv[0]);
+        return 1;
+    }
+    if (!loadTrace(path)) {
+        std::printf("Cannot read GL trace %s\n", path);
+        return 1;
+    }
+    if (!decodeTrace()) std::printf("Trace is cut short; replaying the complete frames\n");
+    if (frames.empty()) {
+        std::printf("No complete frames in %s\n", path);
+        return 1;
+    }
+    std::printf("Trace: %d frames, %ld calls from %d functions, %ld KB\n", (int)frames.size(),
+                (long)records.size(), (int)functionNames.size() - 1, (long)(traceData.size() / 1024));
+
+    if (useGL) {
+        glutInit(&argc, argv);
+        glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
+        glutInitWindowSize(1280, 720);
+        glutCreateWindow("GL trace replay");
+        glutHideWindow();
+        glEnable(GL_DEPTH_TEST);
+        std::printf("Replaying on %s\n", (const char*)glGetString(GL_RENDERER));
+    }
+
+    // Best of several passes; lists compiled in the first are reused after
+    for (int pass = 0; pass < repeat; ++pass) {
+        skippedCalls = 0; // the last pass is the one reported
+        for (size_t f = 0; f < frames.size(); ++f) {
+            double ms = replayFrame(frames[f], useGL);
+            if (pass == 0 || ms < frames[f].bestMs) frames[f].bestMs = ms;
+        }
+    }
+    printReport(useGL);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "heapTracking.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef __GNUC__
+#define NO_INLINE __attribute__((noinline))
+#else
+#define NO_INLINE
+#endif
+
+static thread_local long threadAllocations = 0;
+static thread_local long threadBytes = 0;
+static std::atomic<long> processAllocations(0);
+static std::atomic<long> processBytes(0);
+
+// Out of line and under its own name so heap traffic stands out in a profile
+NO_INLINE static void countHeapAllocation(size_t size) {
+    ++threadAllocations;
+    threadBytes += (long)size;
+    processAllocations.fetch_add(1, std::memory_order_relaxed);
+    processBytes.fetch_add((long)size, std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    countHeapAllocation(size);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+HeapCounts threadHeapCounts() {
+    HeapCounts c = { threadAllocations, threadBytes };
+    return c;
+}
+
+HeapCounts processHeapCounts() {
+    HeapCounts c = { processAllocations.load(std::memory_order_relaxed), processBytes.load(std::memory_order_relaxed) };
+    return c;
+}
@@ -0,0 +1,21 @@
+#ifndef HEAP_TRACKING_H
+#define HEAP_TRACKING_H
+
+// **********************************************
+// ************ HEAP ALLOCATION COUNTS **********
+// **********************************************
+
+// Linking heapTracking.cpp replaces the global operator new and delete with
+// versions that count every allocation, per thread and for the whole
+// process, so a loop that should not touch the heap can prove it. The cost
+// is an increment beside each malloc.
+
+struct HeapCounts {
+    long allocations;
+    long bytes;
+};
+
+HeapCounts threadHeapCounts();  // made by the calling thread so far
+HeapCounts processHeapCounts(); // made by every thread so far
+
+#endif
@@ -0,0 +1,271 @@
+#include "heatMap.h"
+#include "glExtensions.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "glTrace.h"
+
+const float HEAT_CELL_SIZE = 1.0f;
+const float HEAT_SMOOTH_SIGMA = 1.5f; // in cells
+const float HEAT_OVERLAY_HEIGHT = 0.025f; // between the grass and the pitch lines
+
+// Rebase the decay weight long before a float cell could overflow
+const double DECAY_REBASE_WEIGHT = 1e30;
+
+// Texture is a power of two; the grid fills its lower-left corner
+const int HEAT_TEXTURE_W = 128;
+const int HEAT_TEXTURE_H = 64;
+
+const unsigned short OFF_PITCH = 0xFFFF;
+
+enum HeatTarget {
+    TARGET_OFF = -1,
+    TARGET_BALL,
+    TARGET_RED_TEAM,
+    TARGET_BLUE_TEAM,
+    TARGET_FIRST_PLAYER,
+    NUM_HEAT_TARGETS = TARGET_FIRST_PLAYER + NUM_PLAYERS
+};
+
+struct HeatEntity {
+    std::vector<float> total;         // samples per cell over the whole match
+    std::vector<float> decayed;       // each sample weighted by decayWeight at the time
+    std::vector<int> windowCount;     // samples per cell still inside the ring
+    std::vector<unsigned short> ring; // cell of each of the last windowTicks ticks
+    unsigned short tickCell;          // recorded this tick, not yet applied
+    float totalMax, decayedMax;
+};
+
+static HeatEntity entities[NUM_HEAT_ENTITIES];
+static int cellsX = 0, cellsZ = 0;
+static int windowTicks = 1, ringHead = 0;
+static double decayWeight = 1.0, decayGrowth = 1.0;
+
+static int target = TARGET_OFF;
+static HeatMapMode mode = HEAT_WHOLE_MATCH;
+static bool smoothing = false;
+static bool textureDirty = true;
+static GLuint texture = 0;
+
+// Scratch for building the texture
+static std::vector<float> shown, blurred;
+static std::vector<unsigned char> texels;
+
+// **********************************************
+// ************ ACCUMULATION ********************
+// **********************************************
+
+void initHeatMaps(float tickRate) {
+    cellsX = (int)std::ceil(2.0f * FIELD_X_RADIUS / HEAT_CELL_SIZE);
+    cellsZ = (int)std::ceil(2.0f * FIELD_Z_RADIUS / HEAT_CELL_SIZE);
+    windowTicks = std::max(1, (int)(HEAT_WINDOW_SECONDS * tickRate));
+    decayGrowth = std::pow(2.0, 1.0 / (HEAT_HALF_LIFE_SECONDS * tickRate));
+    resetHeatMaps();
+}
+
+void resetHeatMaps() {
+    int cells = cellsX * cellsZ;
+    for (int e = 0; e < NUM_HEAT_ENTITIES; ++e) {
+        HeatEntity& h = entities[e];
+        h.total.assign(cells, 0.0f);
+        h.decayed.assign(cells, 0.0f);
+        h.windowCount.assign(cells, 0);
+        h.ring.assign(windowTicks, OFF_PITCH);
+        h.tickCell = OFF_PITCH;
+        h.totalMax = h.decayedMax = 0.0f;
+    }
+    ringHead = 0;
+    decayWeight = 1.0;
+    textureDirty = true;
+}
+
+void recordHeatSample(int entity, float x, float z) {
+    if (entity < 0 || entity >= NUM_HEAT_ENTITIES) return;
+    int cx = (int)std::floor((x + FIELD_X_RADIUS) / HEAT_CELL_SIZE);
+    int cz = (int)std::floor((z + FIELD_Z_RADIUS) / HEAT_CELL_SIZE);
+    bool onPitch = cx >= 0 && cx < cellsX && cz >= 0 && cz < cellsZ;
+    entities[entity].tickCell = onPitch ? (unsigned short)(cz * cellsX + cx) : OFF_PITCH;
+}
+
+// Scales every decayed grid back down; runs once in thousands of ticks.
+static void rebaseDecay() {
+    float scale = (float)(1.0 / decayWeight);
+    for (int e = 0; e < NUM_HEAT_ENTITIES; ++e) {
+        HeatEntity& h = entities[e];
+        for (size_t c = 0; c < h.decayed.size(); ++c) h.decayed[c] *= scale;
+        h.decayedMax *= scale;
+    }
+    decayWeight = 1.0;
+}
+
+void endHeatTick() {
+    if (cellsX == 0) return;
+    float weight = (float)decayWeight;
+    for (int e = 0; e < NUM_HEAT_ENTITIES; ++e) {
+        HeatEntity& h = entities[e];
+        unsigned short cell = h.tickCell;
+        if (cell != OFF_PITCH) {
+            h.totalMax = std::max(h.totalMax, h.total[cell] += 1.0f);
+            h.decayedMax = std::max(h.decayedMax, h.decayed[cell] += weight);
+        }
+
+        // The oldest tick leaves the window as this one enters it
+        unsigned short old = h.ring[ringHead];
+        if (old != OFF_PITCH) --h.windowCount[old];
+        if (cell != OFF_PITCH) ++h.windowCount[cell];
+        h.ring[ringHead] = cell;
+        h.tickCell = OFF_PITCH;
+    }
+    ringHead = (ringHead + 1) % windowTicks;
+
+    decayWeight *= decayGrowth;
+    if (decayWeight > DECAY_REBASE_WEIGHT) rebaseDecay();
+    if (target != TARGET_OFF) textureDirty = true;
+}
+
+// **********************************************
+// ************ OVERLAY *************************
+// **********************************************
+
+static const char* MODE_NAMES[NUM_HEAT_MAP_MODES] = { "whole match", "decaying", "last 2 minutes" };
+
+static void printTarget() {
+    std::cout << "Heat map: ";
+    if (target == TARGET_OFF) std::cout << "off";
+    else if (target == TARGET_BALL) std::cout << "ball";
+    else if (target == TARGET_RED_TEAM) std::cout << "red team";
+    else if (target == TARGET_BLUE_TEAM) std::cout << "blue team";
+    else {
+        int player = target - TARGET_FIRST_PLAYER;
+        std::cout << (player < NUM_PLAYERS / 2 ? "red" : "blue") << " player " << player % (NUM_PLAYERS / 2) + 1;
+    }
+    if (target != TARGET_OFF) std::cout << ", " << MODE_NAMES[mode] << (smoothing ? ", smoothed" : "");
+    std::cout << std::endl;
+}
+
+void cycleHeatMapTarget() {
+    target = target + 1 == NUM_HEAT_TARGETS ? TARGET_OFF : target + 1;
+    textureDirty = true;
+    printTarget();
+}
+
+void cycleHeatMapMode() {
+    mode = (HeatMapMode)((mode + 1) % NUM_HEAT_MAP_MODES);
+    textureDirty = true;
+    printTarget();
+}
+
+void toggleHeatMapSmoothing() {
+    smoothing = !smoothing;
+    textureDirty = true;
+    printTarget();
+}
+
+// Adds one entity's grid in the current mode into shown
+static void addEntity(const HeatEntity& h) {
+    for (size_t c = 0; c < shown.size(); ++c) {
+        if (mode == HEAT_WHOLE_MATCH) shown[c] += h.total[c];
+        else if (mode == HEAT_DECAY) shown[c] += h.decayed[c];
+        else shown[c] += (float)h.windowCount[c];
+    }
+}
+
+// Separable Gaussian, edges clamped
+static void smoothShown() {
+    static std::vector<float> kernel;
+    int radius = (int)std::ceil(3.0f * HEAT_SMOOTH_SIGMA);
+    if (kernel.empty()) {
+        float sum = 0.0f;
+        for (int k = -radius; k <= radius; ++k) {
+            kernel.push_back(std::exp(-0.5f * k * k / (HEAT_SMOOTH_SIGMA * HEAT_SMOOTH_SIGMA)));
+            sum += kernel.back();
+        }
+        for (size_t k = 0; k < kernel.size(); ++k) kernel[k] /= sum;
+    }
+    blurred.assign(shown.size(), 0.0f);
+    for (int z = 0; z < cellsZ; ++z)
+        for (int x = 0; x < cellsX; ++x)
+            for (int k = -radius; k <= radius; ++k)
+                blurred[z * cellsX + x] += kernel[k + radius] * shown[z * cellsX + std::min(std::max(x + k, 0), cellsX - 1)];
+    std::fill(shown.begin(), shown.end(), 0.0f);
+    for (int z = 0; z < cellsZ; ++z)
+        for (int x = 0; x < cellsX; ++x)
+            for (int k = -radius; k <= radius; ++k)
+                shown[z * cellsX + x] += kernel[k + radius] * blurred[std::min(std::max(z + k, 0), cellsZ - 1) * cellsX + x];
+}
+
+// Blue through green and yellow to red, fading out towards zero
+static void rampColor(float t, unsigned char* out) {
+    float r = std::min(std::max(2.0f * t - 0.5f, 0.0f), 1.0f);
+    float g = t < 0.75f ? std::min(2.0f * t, 1.0f) : 1.0f - 4.0f * (t - 0.75f);
+    float b = std::max(1.0f - 2.0f * t, 0.0f);
+    out[0] = (unsigned char)(255.0f * r);
+    out[1] = (unsigned char)(255.0f * g);
+    out[2] = (unsigned char)(255.0f * b);
+    out[3] = t > 0.0f ? (unsigned char)(190.0f * std::min(0.3f + t, 1.0f)) : 0;
+}
+
+void updateHeatMapTexture() {
+    if (target == TARGET_OFF || !textureDirty || cellsX == 0) return;
+    textureDirty = false;
+
+    shown.assign(cellsX * cellsZ, 0.0f);
+    if (target == TARGET_BALL) addEntity(entities[HEAT_ENTITY_BALL]);
+    else if (target == TARGET_RED_TEAM || target == TARGET_BLUE_TEAM) {
+        PlayerSpot spots[NUM_PLAYERS];
+        currentPlayerSpots(spots);
+        for (int p = 0; p < NUM_PLAYERS; ++p)
+            if (spots[p].isTeamRed == (target == TARGET_RED_TEAM)) addEntity(entities[1 + p]);
+    } else {
+        addEntity(entities[1 + target - TARGET_FIRST_PLAYER]);
+    }
+    if (smoothing) smoothShown();
+
+    float peak = 0.0f;
+    for (size_t c = 0; c < shown.size(); ++c) peak = std::max(peak, shown[c]);
+    float scale = peak > 0.0f ? 1.0f / peak : 0.0f;
+    texels.resize(shown.size() * 4);
+    for (size_t c = 0; c < shown.size(); ++c) rampColor(shown[c] * scale, &texels[c * 4]);
+
+    if (!texture) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        std::vector<unsigned char> clear(HEAT_TEXTURE_W * HEAT_TEXTURE_H * 4, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, HEAT_TEXTURE_W, HEAT_TEXTURE_H, 0, GL_RGBA, GL_UNSIGNED_BYTE, &clear[0]);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, cellsX, cellsZ, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void drawHeatMapOverlay() {
+    if (target == TARGET_OFF || !texture) return;
+    float u = (float)cellsX / HEAT_TEXTURE_W, v = (float)cellsZ / HEAT_TEXTURE_H;
+    float x = cellsX * HEAT_CELL_SIZE * 0.5f, z = cellsZ * HEAT_CELL_SIZE * 0.5f;
+
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthMask(GL_FALSE);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex3f(-x, HEAT_OVERLAY_HEIGHT, -z);
+    glTexCoord2f(0.0f, v);    glVertex3f(-x, HEAT_OVERLAY_HEIGHT, z);
+    glTexCoord2f(u, v);       glVertex3f(x, HEAT_OVERLAY_HEIGHT, z);
+    glTexCoord2f(u, 0.0f);    glVertex3f(x, HEAT_OVERLAY_HEIGHT, -z);
+    glEnd();
+
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+    glEnable(GL_LIGHTING);
+}
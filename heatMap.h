@@ -0,0 +1,50 @@
+#ifndef HEAT_MAP_H
+#define HEAT_MAP_H
+
+#include "stadium.h"
+
+// **********************************************
+// ************ PITCH HEAT MAPS *****************
+// **********************************************
+
+// Where the ball and each player spent their time, binned into one-unit
+// cells over the pitch (FIELD_X_RADIUS x FIELD_Z_RADIUS). Every sample is a
+// constant amount of work in all three modes at once, however long the
+// match runs: the whole-match grid just counts, the decay grid adds an
+// ever-growing weight instead of fading every cell, and the window grid
+// subtracts the sample that drops out of its ring. The overlay is a blended
+// texture on the grass, rebuilt only when the shown grid has changed.
+
+enum HeatMapMode {
+    HEAT_WHOLE_MATCH,
+    HEAT_DECAY,       // recent play weighted most, half-life HEAT_HALF_LIFE_SECONDS
+    HEAT_WINDOW,      // only the last HEAT_WINDOW_SECONDS
+    NUM_HEAT_MAP_MODES
+};
+
+const float HEAT_HALF_LIFE_SECONDS = 30.0f;
+const float HEAT_WINDOW_SECONDS = 120.0f;
+
+// Entity 0 is the ball, 1 + i is player i of currentPlayerSpots()
+const int HEAT_ENTITY_BALL = 0;
+const int NUM_HEAT_ENTITIES = 1 + NUM_PLAYERS;
+
+// tickRate is how many ticks make a second, for the half-life and window.
+void initHeatMaps(float tickRate);
+void resetHeatMaps();
+
+// One tick: record every entity (from the simulation or a tracking stream),
+// then end the tick. Positions off the pitch still count towards the window.
+void recordHeatSample(int entity, float x, float z);
+void endHeatTick();
+
+// Keys: off -> ball -> red team -> blue team -> each player -> off
+void cycleHeatMapTarget();
+void cycleHeatMapMode();
+void toggleHeatMapSmoothing();  // Gaussian blur of the shown grid
+
+// Refreshes the overlay texture if needed; once a frame, outside display lists.
+void updateHeatMapTexture();
+void drawHeatMapOverlay();
+
+#endif
@@ -0,0 +1,87 @@
+#include "jobSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::vector<std::thread> threads;
+static std::mutex poolMutex;
+static std::condition_variable workReady, workDone;
+static bool stopping = false;
+
+// The loop currently being run; jobs are claimed with an atomic counter
+static JobFunction currentFn = 0;
+static void* currentContext = 0;
+static int currentCount = 0;
+static std::atomic<int> nextJob(0);
+static int finishedWorkers = 0;
+static unsigned int generation = 0;
+
+static void runJobs(int worker) {
+    for (;;) {
+        int job = nextJob.fetch_add(1);
+        if (job >= currentCount) return;
+        currentFn(job, worker, currentContext);
+    }
+}
+
+static void workerLoop(int worker) {
+    unsigned int seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(poolMutex);
+            workReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runJobs(worker);
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (++finishedWorkers == (int)threads.size()) workDone.notify_one();
+    }
+}
+
+void initJobSystem(int count) {
+    if (!threads.empty()) return;
+    if (count <= 0) count = (int)std::thread::hardware_concurrency();
+    if (count < 1) count = 1;
+    stopping = false;
+    for (int i = 1; i < count; ++i) threads.push_back(std::thread(workerLoop, i));
+}
+
+void shutdownJobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+    threads.clear();
+}
+
+int jobWorkerCount() {
+    return (int)threads.size() + 1;
+}
+
+void parallelFor(int jobCount, JobFunction fn, void* context) {
+    if (jobCount <= 0) return;
+    if (threads.empty() || jobCount == 1) {
+        for (int i = 0; i < jobCount; ++i) fn(i, 0, context);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        currentFn = fn;
+        currentContext = context;
+        currentCount = jobCount;
+        nextJob.store(0);
+        finishedWorkers = 0;
+        ++generation;
+    }
+    workReady.notify_all();
+    runJobs(0);
+
+    std::unique_lock<std::mutex> lock(poolMutex);
+    workDone.wait(lock, [] { return finishedWorkers == (int)threads.size(); });
+}
@@ -0,0 +1,22 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+// **********************************************
+// ************ WORKER THREAD POOL **************
+// **********************************************
+
+// A fixed pool of threads for data-parallel loops. parallelFor() splits a
+// range into jobs, runs them on the pool and the calling thread, and
+// returns when all are done. Jobs must not call parallelFor() themselves.
+
+typedef void (*JobFunction)(int job, int worker, void* context);
+
+// threads <= 0 uses one per core. The caller counts as worker 0.
+void initJobSystem(int threads);
+void shutdownJobSystem();
+int jobWorkerCount();
+
+// Runs fn(job, worker, context) for job = 0 .. jobCount - 1.
+void parallelFor(int jobCount, JobFunction fn, void* context);
+
+#endif
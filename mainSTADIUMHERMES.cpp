@@ -4,74 +4,90 @@
 #include <GL/glu.h>
 #include <string>
 #include <iostream>
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include "stadium.h"
+#include "glExtensions.h"
+#include "frameCapture.h"
+#include "multiView.h"
+#include "sceneObjects.h"
+#include "renderStats.h"
+#include "vegetation.h"
+#include "cityTiles.h"
+#include "seatingMesh.h"
+#include "stadiumGeometry.h"
+#include "softScene.h"
+#include "stadiumScene.h"
+#include "seatInventory.h"
+#include "seatPicking.h"
+#include "seatOccupancy.h"
+#include "heatMap.h"
+#include "frameGovernor.h"
+#include "particles.h"
+#include "crowd.h"
+#include "jobSystem.h"
+#include "spectatorServer.h"
+#include "spectatorNet.h"
+#include "frameArena.h"
+#include "sceneGraph.h"
+#include "occlusionCulling.h"
+#include "viewMath.h"
+#include "simdMath.h"
+#include <chrono>
+#include "glTrace.h"
 
 // Window dimensions
 int windowWidth = 1200;
 int windowHeight = 800;
 // Global variable to control floodlight state
 bool nightMode = false; // Default to day (lights off)
-// --- GAME ANIMATION VARIABLES ---
-bool isPlaying = false;
-int animStage = 0; // 0=Wait, 1=Run Up, 2=Ball Flying
-
-// Positions
-float ballX = 0.0f, ballZ = 0.0f, ballRot = 0.0f;
-float strikerX = -6.0f, strikerZ = 0.0f; // Start behind the ball
-float goalieZ = 0.0f;
-
-// Velocities
-float ballVelX = 0.0f, ballVelZ = 0.0f;
+// Trees and shrubs scattered around the stadium (--trees)
+int vegetationCount = 4000;
 
-// **********************************************
-// ************ CAMERA VARIABLES ****************
-// **********************************************
-float angleY = 0.0f;
-float angleX = 20.0f;
-float camDist = 140.0f; 
-float cameraHeight = 25.0f;
-float lookAtHeight = 0.0f;
+// Memory budget for the streamed city tiles (--city-budget)
+int cityBudgetMB = 16;
 
-float cameraX = 0.0f, cameraY = cameraHeight, cameraZ = camDist;
-float targetX = 0.0f, targetY = lookAtHeight, targetZ = 0.0f;
+// Seating geometry cache (--geometry-cache / --no-geometry-cache)
+const char* geometryCachePath = "stadium_geometry.cache";
 
-float deltaAngleY = 0.0f, deltaAngleX = 0.0f, deltaMove = 0.0f;
+// Headless CPU rendering (--software / --software-threads / --software-bench)
+const char* softwareOutputPath = 0;
+int softwareThreads = 0;
+bool softwareBenchmark = false;
 
-// **********************************************
-// ************ DIMENSIONS (FIXED) **************
-// **********************************************
+// Live seat colours from a ticketing feed (--occupancy-feed)
+const char* occupancyFeed = 0;
 
-// 1. INCREASE TRACK SIZE to accommodate the field corners
-const float TRACK_INNER_X_RADIUS = 55.0f; 
-const float TRACK_INNER_Z_RADIUS = 38.0f; // Made wider to prevent corner overlap
+// Dynamic resolution (--target-fps / --governor-detail)
+float targetFps = 0.0f;
+bool governorDetail = false;
 
-const float TRACK_WIDTH = 10.0f; 
-const float TRACK_OUTER_X_RADIUS = TRACK_INNER_X_RADIUS + TRACK_WIDTH;
-const float TRACK_OUTER_Z_RADIUS = TRACK_INNER_Z_RADIUS + TRACK_WIDTH;
+// Rain and goal celebration particles (--particles / --particle-threads)
+int particleCapacity = 200000;
+int particleThreads = 1;
 
-// 2. SHRINK FIELD SIZE to ensure corners don't touch the track
-// The field is now significantly smaller than the track inner radius
-const float FIELD_X_RADIUS = 40.0f; // Leaves ~15 units of "D" area length
-const float FIELD_Z_RADIUS = 24.0f; // Leaves ~14 units of side area width
+// A fan in every seat (--no-crowd leaves the bowl empty)
+bool crowdEnabled = true;
 
-// Corner Check: (40/55)^2 + (24/38)^2 = 0.53 + 0.40 = 0.93 < 1.0 (Safe inside)
+// Scratch for one frame's transient render data; grows if a frame needs more
+const size_t FRAME_ARENA_BYTES = 256 * 1024;
 
-const float SEATING_BASE_X_RADIUS = TRACK_OUTER_X_RADIUS;
-const float SEATING_BASE_Z_RADIUS = TRACK_OUTER_Z_RADIUS;
+// Remote displays (--spectator-port / --spectator-loopback / --spectator-loss)
+int spectatorPort = 0;
+int spectatorLoopbackClients = 0;
+float spectatorLoss = 2.0f;
+const float SPECTATOR_LOOPBACK_SECONDS = 30.0f;
 
-const int NUM_TIERS = 8;       
-const float TIER_HEIGHT = 1.2f; 
-const float TIER_DEPTH_INCREASE_X = 1.2f;
-const float TIER_DEPTH_INCREASE_Z = 1.2f;
+// --spectator-connect: the match comes from that server instead of our own simulation
+const char* spectatorServerAddress = 0;
 
-const float MAX_SEATING_X_RADIUS = SEATING_BASE_X_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_X;
-const float MAX_SEATING_Z_RADIUS = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
+// What the last click landed on, highlighted in every view
+PickResult pickedObject = { PICK_NOTHING, 0.0f, { 0.0f, 0.0f, 0.0f }, -1, -1, 0 };
 
-const float STADIUM_TOTAL_HEIGHT = (NUM_TIERS - 1) * TIER_HEIGHT;
-const float MAIN_GRANDSTAND_WIDTH = 120.0f; 
+// Launch time, for the startup-to-first-frame report
+std::chrono::steady_clock::time_point launchTime;
+bool firstFrameShown = false;
 
 GLUquadricObj *quadric;
 
@@ -79,141 +95,65 @@ GLUquadricObj *quadric;
 // ************ DRAWING FUNCTIONS ***************
 // **********************************************
 
-void drawSeat() {
-    glColor3f(0.1f, 0.1f, 0.9f);
-    glPushMatrix();
-    glScalef(0.8f, 0.4f, 0.6f); 
-    glutSolidCube(1.0);
-    glPopMatrix();
-}
-
-void drawOvalSeatRow(float baseX, float baseZ, float y, float tierIncreaseX, float tierIncreaseZ, float angleOffset) {
-    float currentRadiusX = baseX + tierIncreaseX;
-    float currentRadiusZ = baseZ + tierIncreaseZ;
-    
-    // Calculate seats based on circumference
-    float h_val = pow(currentRadiusX - currentRadiusZ, 2) / pow(currentRadiusX + currentRadiusZ, 2);
-    float circumference = M_PI * (currentRadiusX + currentRadiusZ) * (1 + (3 * h_val) / (10 + sqrt(4 - 3 * h_val)));
-    
-    int numSeats = (int)(circumference * 1.1f); 
-    float angleStep = 360.0f / (float)numSeats;
-    
-    // GAP SETTING: How wide is the opening in degrees?
-    float gapWidth = 14.0f; 
-
-    for (int i = 0; i < numSeats; ++i) {
-        float angleDeg = angleOffset + i * angleStep;
-        
-        // Normalize angle to 0-360 range
-        while(angleDeg >= 360.0f) angleDeg -= 360.0f;
-        while(angleDeg < 0.0f) angleDeg += 360.0f;
-
-        // --- CUT THE TIERS ---
-        // Gate A is at 0 degrees (360). Skip seats near 0.
-        if (angleDeg < gapWidth || angleDeg > 360.0f - gapWidth) continue;
-
-        // Gate B is at 180 degrees. Skip seats near 180.
-        if (angleDeg > 180.0f - gapWidth && angleDeg < 180.0f + gapWidth) continue;
-        // ---------------------
-
-        float angle = angleDeg * M_PI / 180.0f;
-        float currentX = currentRadiusX * cos(angle);
-        float currentZ = currentRadiusZ * sin(angle);
-
-        glPushMatrix();
-        glTranslatef(currentX, y, currentZ);
-        glRotatef(90.0f - angleDeg, 0.0f, 1.0f, 0.0f);
-        drawSeat();
-        glPopMatrix();
-    }
-}
-
-void drawStadiumSeatingBowl() {
-    for (int i = 0; i < NUM_TIERS; ++i) {
-        float currentY = i * TIER_HEIGHT;
-        float stagger = (i % 2 == 0) ? 0.0f : 0.5f;
-        drawOvalSeatRow(SEATING_BASE_X_RADIUS, SEATING_BASE_Z_RADIUS, currentY,
-                        i * TIER_DEPTH_INCREASE_X, i * TIER_DEPTH_INCREASE_Z, stagger);
+// One part of the stadium scene description (stadiumScene.h). Bulbs that
+// glow at night are drawn with lighting off.
+void drawStadiumPart(int part) {
+    const StadiumVertex* v = stadiumVertices();
+    bool lit = true;
+    for (int i = stadiumPartFirstShape(part); i < stadiumPartFirstShape(part + 1); ++i) {
+        const StadiumShape& s = stadiumShape(i);
+        float color[3];
+        bool shapeLit = stadiumShapeLook(s, nightMode, color);
+        if (shapeLit != lit) {
+            if (shapeLit) glEnable(GL_LIGHTING);
+            else glDisable(GL_LIGHTING);
+            lit = shapeLit;
+        }
+        glColor3fv(color);
+        if (s.kind == STADIUM_BOX) {
+            glPushMatrix();
+            glMultMatrixf(s.matrix);
+            glutSolidCube(1.0);
+            glPopMatrix();
+        } else if (s.kind == STADIUM_TRIANGLES) {
+            // No glNormal: the ground and facade keep the normal left current,
+            // as they always have here; the normals are for the software renderer
+            glBegin(GL_TRIANGLES);
+            for (int k = s.first; k < s.first + s.count; ++k) glVertex3fv(v[k].pos);
+            glEnd();
+        } else {
+            glLineWidth(s.lineWidth);
+            glBegin(s.loop ? GL_LINE_LOOP : GL_LINE_STRIP);
+            for (int k = s.first; k < s.first + s.count; ++k) glVertex3fv(v[k].pos);
+            glEnd();
+            glLineWidth(1.0f);
+        }
     }
+    if (!lit) glEnable(GL_LIGHTING);
 }
 
 void drawMainGrandstandRoof() {
-    glColor3f(0.8f, 0.8f, 0.9f); 
-    float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
+    drawStadiumPart(STADIUM_ROOF);
 
-    glPushMatrix();
-    glTranslatef(0.0f, STADIUM_TOTAL_HEIGHT + 10.0f, -topTierZ - 15.0f); 
-    glPushMatrix();
-    glScalef(MAIN_GRANDSTAND_WIDTH, 2.0f, 65.0f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-    
+    // The wireframe underside
+    float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
     glColor3f(0.3f, 0.3f, 0.3f);
     glPushMatrix();
-    glTranslatef(0.0f, -2.0f, 0.0f);
+    glTranslatef(0.0f, STADIUM_TOTAL_HEIGHT + 10.0f - 2.0f, -topTierZ - 15.0f);
     glScalef(MAIN_GRANDSTAND_WIDTH - 2.0f, 1.0f, 60.0f);
     glutWireCube(1.0);
     glPopMatrix();
-    glPopMatrix();
-}
-
-void drawMainGrandstandColumns() {
-    glColor3f(0.6f, 0.6f, 0.65f); 
-    float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
-    float roofHeight = STADIUM_TOTAL_HEIGHT + 10.0f;
-    float columnZ = -topTierZ - 15.0f; 
-
-    int numColumns = 8; 
-    float columnSpacing = (MAIN_GRANDSTAND_WIDTH - 10.0f) / (numColumns - 1);
-    float startX = -(MAIN_GRANDSTAND_WIDTH - 10.0f) / 2.0f;
-
-    for (int i = 0; i < numColumns; ++i) {
-        glPushMatrix();
-        glTranslatef(startX + i * columnSpacing, roofHeight / 2.0f, columnZ);
-        glScalef(2.0f, roofHeight, 2.0f); 
-        glutSolidCube(1.0);
-        glPopMatrix();
-    }
-}
-
-void drawGrandstandFacade() {
-    glColor3f(0.7f, 0.7f, 0.7f);
-    float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
-    float facadeZ = -topTierZ - 12.0f;
-
-    glPushMatrix();
-    glTranslatef(0.0f, STADIUM_TOTAL_HEIGHT / 2.0f, facadeZ);
-    glScalef(MAIN_GRANDSTAND_WIDTH, STADIUM_TOTAL_HEIGHT, 1.0f);
-    glutSolidCube(1.0);
-    glPopMatrix();
 }
 
-void drawVIPSeating() {
-    glColor3f(0.8f, 0.0f, 0.0f); 
-    float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
-    float vipY = STADIUM_TOTAL_HEIGHT + 2.0f;
-    float vipZ = -topTierZ - 5.0f;
-
-    glPushMatrix();
-    glTranslatef(0.0f, vipY, vipZ);
-    glPushMatrix();
-    glScalef(MAIN_GRANDSTAND_WIDTH * 0.6f, 1.0f, 10.0f);
-    glColor3f(0.2f, 0.2f, 0.2f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    glColor3f(0.8f, 0.1f, 0.1f);
-    for(float x = -MAIN_GRANDSTAND_WIDTH * 0.25f; x < MAIN_GRANDSTAND_WIDTH * 0.25f; x+=2.0f) {
-        glPushMatrix();
-        glTranslatef(x, 1.0f, -2.0f);
-        glutSolidCube(1.0);
-        glPopMatrix();
-    }
-    glPopMatrix();
+// Stroke-font text centred on the current origin, in font units
+void drawCenteredStrokeText(const char* text) {
+    float textWidth = 0.0f;
+    for (const char* c = text; *c; ++c) textWidth += glutStrokeWidth(GLUT_STROKE_ROMAN, *c);
+    glTranslatef(-textWidth / 2.0f, 0.0f, 0.0f);
+    for (const char* c = text; *c; ++c) glutStrokeCharacter(GLUT_STROKE_ROMAN, *c);
 }
 
 void drawStadiumName() {
-    std::string text = "ASTU STADIUM";
     glColor3f(1.0f, 1.0f, 0.0f); 
 
     float topTierZ = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
@@ -222,185 +162,37 @@ void drawStadiumName() {
 
     glPushMatrix();
     glTranslatef(0.0f, textY, textZ);
-    float textWidth = 0.0f;
-    for (std::string::size_type i = 0; i < text.size(); ++i) textWidth += glutStrokeWidth(GLUT_STROKE_ROMAN, (int)text[i]);
     glScalef(0.02f, 0.02f, 0.02f); 
-    glTranslatef(-textWidth / 2.0f, 0.0f, 0.0f);
     glLineWidth(3.0f);
-    for (std::string::size_type i = 0; i < text.size(); ++i) glutStrokeCharacter(GLUT_STROKE_ROMAN, (int)text[i]);
+    drawCenteredStrokeText("ASTU STADIUM");
     glLineWidth(1.0f);
     glPopMatrix();
 }
 
-void drawStoneFacade() {
-    glColor3f(0.5f, 0.5f, 0.55f); 
-    float facadeHeight = STADIUM_TOTAL_HEIGHT;
-    
-    // We draw two separate strips to leave holes at 0 and 180 degrees
-    float gap = 14.0f; // Must match the seat gap roughly
-    int segments = 60; // Resolution per side
-
-    // ARC 1: Back side (approx 15 to 165 degrees)
-    float start1 = gap;
-    float end1 = 180.0f - gap;
-
-    glPushMatrix();
-    glBegin(GL_QUAD_STRIP);
-    for (int i = 0; i <= segments; ++i) {
-        float t = (float)i / (float)segments;
-        float angDeg = start1 * (1.0f - t) + end1 * t; // Interpolate angle
-        float angRad = angDeg * M_PI / 180.0f;
-
-        float x = MAX_SEATING_X_RADIUS * cos(angRad);
-        float z = MAX_SEATING_Z_RADIUS * sin(angRad);
-        glVertex3f(x, facadeHeight, z);
-        glVertex3f(x, -5.0f, z); 
-    }
-    glEnd();
-    glPopMatrix();
-
-    // ARC 2: Front side (approx 195 to 345 degrees)
-    float start2 = 180.0f + gap;
-    float end2 = 360.0f - gap;
-
-    glPushMatrix();
-    glBegin(GL_QUAD_STRIP);
-    for (int i = 0; i <= segments; ++i) {
-        float t = (float)i / (float)segments;
-        float angDeg = start2 * (1.0f - t) + end2 * t; 
-        float angRad = angDeg * M_PI / 180.0f;
-
-        float x = MAX_SEATING_X_RADIUS * cos(angRad);
-        float z = MAX_SEATING_Z_RADIUS * sin(angRad);
-        glVertex3f(x, facadeHeight, z);
-        glVertex3f(x, -5.0f, z); 
-    }
-    glEnd();
-    glPopMatrix();
-}
 void drawSafetyRailing() {
     glColor3f(0.9f, 0.9f, 0.9f); 
     float railingHeight = 2.0f;
     float rX = MAX_SEATING_X_RADIUS + 0.5f;
     float rZ = MAX_SEATING_Z_RADIUS + 0.5f;
-    int segments = 100;
+    int segments = 100 >> governorDetailLevel();
+    float ring[2 * (100 + 1)];
+    ellipseArcPoints(rX, rZ, 0.0f, 360.0f, segments, ring);
 
     glPushMatrix();
     glTranslatef(0.0f, STADIUM_TOTAL_HEIGHT + railingHeight, 0.0f);
     glBegin(GL_LINE_LOOP);
     for (int i = 0; i < segments; ++i) {
-        float angle = 2.0f * M_PI * i / segments;
-        glVertex3f(rX * cos(angle), 0.0f, rZ * sin(angle));
+        glVertex3f(ring[2 * i], 0.0f, ring[2 * i + 1]);
     }
     glEnd();
     glPopMatrix();
 }
 
-// NEW FUNCTION: Fills the entire inside of the track with grass
-// This prevents empty space between the rectangular field and the oval track
-void drawInnerGrass() {
-    glColor3f(0.0f, 0.5f, 0.0f); // Grass Green
-    glPushMatrix();
-    glTranslatef(0.0f, 0.01f, 0.0f); // Just above ground
-
-    int segments = 100;
-    glBegin(GL_POLYGON); // Fill the oval
-    for (int i = 0; i < segments; ++i) {
-        float angle = 2.0f * M_PI * i / segments;
-        glVertex3f(TRACK_INNER_X_RADIUS * cos(angle), 0.0f, TRACK_INNER_Z_RADIUS * sin(angle));
-    }
-    glEnd();
-    glPopMatrix();
-}
-
-void drawFootballPitch() {
-    // We don't draw the green quad for the field anymore, because drawInnerGrass covers it.
-    // We only draw the LINES on top.
-    
-    glPushMatrix();
-    glTranslatef(0.0f, 0.04f, 0.0f); // Slightly above the grass
-
-    // Lines
-    glColor3f(1.0f, 1.0f, 1.0f); 
-    glLineWidth(2.0f);
-    
-    // Outer boundary
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(-FIELD_X_RADIUS, 0.0f, -FIELD_Z_RADIUS);
-    glVertex3f( FIELD_X_RADIUS, 0.0f, -FIELD_Z_RADIUS);
-    glVertex3f( FIELD_X_RADIUS, 0.0f,  FIELD_Z_RADIUS);
-    glVertex3f(-FIELD_X_RADIUS, 0.0f,  FIELD_Z_RADIUS);
-    glEnd();
-
-    // Halfway line
-    glBegin(GL_LINES);
-    glVertex3f(0.0f, 0.0f, FIELD_Z_RADIUS);
-    glVertex3f(0.0f, 0.0f, -FIELD_Z_RADIUS);
-    glEnd();
-
-    // Center circle
-    glBegin(GL_LINE_LOOP);
-    float centerCircleRadius = 9.0f; 
-    for (int i = 0; i < 50; ++i) {
-        float angle = 2.0f * M_PI * i / 50.0f;
-        glVertex3f(centerCircleRadius * cos(angle), 0.0f, centerCircleRadius * sin(angle));
-    }
-    glEnd();
 
-    // Penalty Areas
-    float boxDepth = 16.0f;
-    float boxWidth = 30.0f; 
-
-    // +X Box
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(FIELD_X_RADIUS, 0.0f, -boxWidth/2);
-    glVertex3f(FIELD_X_RADIUS - boxDepth, 0.0f, -boxWidth/2);
-    glVertex3f(FIELD_X_RADIUS - boxDepth, 0.0f, boxWidth/2);
-    glVertex3f(FIELD_X_RADIUS, 0.0f, boxWidth/2);
-    glEnd();
 
-    // -X Box
-    glBegin(GL_LINE_LOOP);
-    glVertex3f(-FIELD_X_RADIUS, 0.0f, -boxWidth/2);
-    glVertex3f(-FIELD_X_RADIUS + boxDepth, 0.0f, -boxWidth/2);
-    glVertex3f(-FIELD_X_RADIUS + boxDepth, 0.0f, boxWidth/2);
-    glVertex3f(-FIELD_X_RADIUS, 0.0f, boxWidth/2);
-    glEnd();
-
-    glPopMatrix();
-}
-
-void drawAthleticsTrack() {
-    glColor3f(0.8f, 0.2f, 0.1f); // Burnt orange track
-    glPushMatrix();
-    glTranslatef(0.0f, 0.02f, 0.0f); 
-
-    int segments = 120;
-    glBegin(GL_QUAD_STRIP);
-    for (int i = 0; i <= segments; ++i) {
-        float angle = 2.0f * M_PI * i / segments;
-        glVertex3f(TRACK_OUTER_X_RADIUS * cos(angle), 0.0f, TRACK_OUTER_Z_RADIUS * sin(angle));
-        glVertex3f(TRACK_INNER_X_RADIUS * cos(angle), 0.0f, TRACK_INNER_Z_RADIUS * sin(angle));
-    }
-    glEnd();
-    
-    // Track lines
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glLineWidth(1.0f);
-    for(int lane=1; lane<4; lane++) {
-        float rX = TRACK_INNER_X_RADIUS + (lane * (TRACK_WIDTH/4.0f));
-        float rZ = TRACK_INNER_Z_RADIUS + (lane * (TRACK_WIDTH/4.0f));
-        glBegin(GL_LINE_LOOP);
-        for (int i = 0; i <= segments; ++i) {
-             float angle = 2.0f * M_PI * i / segments;
-             glVertex3f(rX * cos(angle), 0.05f, rZ * sin(angle));
-        }
-        glEnd();
-    }
-    glPopMatrix();
-}
 
 void drawGoalNet(float width, float height, float depth) {
+    float mesh = 0.5f * (1 << governorDetailLevel()); // coarser when the governor cuts detail
     glColor4f(0.9f, 0.9f, 0.9f, 0.3f); 
     glDisable(GL_LIGHTING); 
     glEnable(GL_BLEND);
@@ -408,11 +200,11 @@ void drawGoalNet(float width, float height, float depth) {
     glLineWidth(1.0f);
 
     glBegin(GL_LINES);
-    for (float x = -width / 2; x <= width / 2; x += 0.5f) {
+    for (float x = -width / 2; x <= width / 2; x += mesh) {
         glVertex3f(x, 0.0f, depth); glVertex3f(x, height, depth);
         glVertex3f(x, height, 0.0f); glVertex3f(x, height, depth);
     }
-    for (float y = 0.0f; y <= height; y += 0.5f) {
+    for (float y = 0.0f; y <= height; y += mesh) {
         glVertex3f(-width / 2, y, depth); glVertex3f(width / 2, y, depth);
         glVertex3f(-width / 2, y, 0.0f); glVertex3f(-width / 2, y, depth);
         glVertex3f(width / 2, y, 0.0f); glVertex3f(width / 2, y, depth);
@@ -423,132 +215,16 @@ void drawGoalNet(float width, float height, float depth) {
 }
 
 void drawGoalposts() {
-    glColor3f(1.0f, 1.0f, 1.0f); 
-    float postR = 0.15f; 
-    float postH = 2.44f; 
-    float crossW = 7.32f; 
-    
-    // CHANGED: Make net depth negative to extend backwards
-    float netD = -2.0f; 
-
-    // Goal +X (Right side of screen, facing Left)
-    glPushMatrix();
-    glTranslatef(FIELD_X_RADIUS, 0.0f, 0.0f);
-    glRotatef(-90.0f, 0.0f, 1.0f, 0.0f); 
-
-    // Draw Posts
-    glPushMatrix(); glTranslatef(-crossW/2, postH/2, 0.0f); glScalef(postR, postH, postR); glutSolidCube(1.0); glPopMatrix();
-    glPushMatrix(); glTranslatef(crossW/2, postH/2, 0.0f); glScalef(postR, postH, postR); glutSolidCube(1.0); glPopMatrix();
-    glPushMatrix(); glTranslatef(0.0f, postH, 0.0f); glScalef(crossW, postR, postR); glutSolidCube(1.0); glPopMatrix();
-    
-    // Draw Net
-    glPushMatrix(); 
-    // CHANGED: Translate to -postR (back of the post) instead of +postR (front)
-    glTranslatef(0.0f, 0.0f, -postR); 
-    drawGoalNet(crossW, postH, netD); 
-    glPopMatrix();
-    
-    glPopMatrix();
-
-    // Goal -X (Left side of screen, facing Right)
-    glPushMatrix();
-    glTranslatef(-FIELD_X_RADIUS, 0.0f, 0.0f);
-    glRotatef(90.0f, 0.0f, 1.0f, 0.0f); 
-
-    // Draw Posts
-    glPushMatrix(); glTranslatef(-crossW/2, postH/2, 0.0f); glScalef(postR, postH, postR); glutSolidCube(1.0); glPopMatrix();
-    glPushMatrix(); glTranslatef(crossW/2, postH/2, 0.0f); glScalef(postR, postH, postR); glutSolidCube(1.0); glPopMatrix();
-    glPushMatrix(); glTranslatef(0.0f, postH, 0.0f); glScalef(crossW, postR, postR); glutSolidCube(1.0); glPopMatrix();
-    
-    // Draw Net
-    glPushMatrix(); 
-    // CHANGED: Translate to -postR (back of the post) instead of +postR (front)
-    glTranslatef(0.0f, 0.0f, -postR); 
-    drawGoalNet(crossW, postH, netD); 
-    glPopMatrix();
-    
-    glPopMatrix();
-}
-void drawTeamBenches() {
-    // ADJUSTMENT: Moved further out (8.0f offset instead of 3.5f)
-    // Field boundary is at 24.0f, Track starts at 38.0f. 
-    // This places the benches around 32.0f, safely in the grass area.
-    float benchZ = -FIELD_Z_RADIUS - 8.0f; 
-    
-    float benchWidth = 8.0f;
-    float benchHeight = 2.2f;
-    float benchDepth = 1.5f;
-
-    // Define positions (Left and Right of the halfway line)
-    float positions[2] = { -15.0f, 15.0f }; // Moved slightly further apart along X as well
-    
-    // Define Team Colors (Red for one, Blue for the other)
-    float colors[2][3] = { {0.9f, 0.2f, 0.2f}, {0.2f, 0.2f, 0.9f} };
+    drawStadiumPart(STADIUM_GOALS);
 
-    for(int i = 0; i < 2; i++) {
+    // The nets hang behind the posts
+    for (int goal = 0; goal < 2; ++goal) {
+        float frame[16];
+        stadiumGoalFrame(goal, frame);
         glPushMatrix();
-        // Translate to position
-        glTranslatef(positions[i], 0.0f, benchZ);
-        
-        // No rotation needed on this side (Negative Z). 
-        // The benches are drawn facing Positive Z (towards the field center) by default.
-        
-        // --- Draw Structure (Dugout Shell) ---
-        glColor3f(0.3f, 0.3f, 0.35f); // Dark Grey/Metal color
-
-        // Roof
-        glPushMatrix();
-        glTranslatef(0.0f, benchHeight, 0.0f);
-        glScalef(benchWidth, 0.1f, benchDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // Back Wall
-        glPushMatrix();
-        glTranslatef(0.0f, benchHeight / 2.0f, -benchDepth / 2.0f);
-        glScalef(benchWidth, benchHeight, 0.1f);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // Left Wall
-        glPushMatrix();
-        glTranslatef(-benchWidth / 2.0f, benchHeight / 2.0f, 0.0f);
-        glScalef(0.1f, benchHeight, benchDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // Right Wall
-        glPushMatrix();
-        glTranslatef(benchWidth / 2.0f, benchHeight / 2.0f, 0.0f);
-        glScalef(0.1f, benchHeight, benchDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // --- Draw Seats ---
-        glColor3fv(colors[i]); // Set team color
-        
-        int numSeats = 6;
-        float seatSpacing = (benchWidth - 0.5f) / numSeats;
-        float startX = -(benchWidth / 2.0f) + (seatSpacing / 2.0f) + 0.25f;
-
-        for(int s = 0; s < numSeats; s++) {
-            float seatX = startX + (s * seatSpacing);
-            
-            // Seat Base
-            glPushMatrix();
-            glTranslatef(seatX, 0.4f, 0.0f);
-            glScalef(0.8f, 0.1f, 0.8f);
-            glutSolidCube(1.0);
-            glPopMatrix();
-
-            // Seat Back
-            glPushMatrix();
-            glTranslatef(seatX, 0.7f, -0.35f);
-            glScalef(0.8f, 0.6f, 0.1f);
-            glutSolidCube(1.0);
-            glPopMatrix();
-        }
-
+        glMultMatrixf(frame);
+        glTranslatef(0.0f, 0.0f, -GOAL_POST_SIZE);
+        drawGoalNet(GOAL_WIDTH, GOAL_HEIGHT, -2.0f);
         glPopMatrix();
     }
 }
@@ -556,25 +232,6 @@ void drawTeamBenches() {
 // ************ CAMERA & SETUP ******************
 // **********************************************
 
-void computeCameraPosition() {
-    angleY += deltaAngleY;
-    angleX += deltaAngleX;
-    if (angleX > 89.0f) angleX = 89.0f;
-    if (angleX < 5.0f) angleX = 5.0f; 
-
-    camDist += deltaMove;
-    if (camDist < 20.0f) camDist = 20.0f;
-    if (camDist > 300.0f) camDist = 300.0f; 
-
-    float radY = angleY * M_PI / 180.0f;
-    float radX = angleX * M_PI / 180.0f;
-
-    cameraY = lookAtHeight + camDist * sin(radX);
-    float distXZ = camDist * cos(radX);
-    cameraX = distXZ * sin(radY);
-    cameraZ = distXZ * cos(radY);
-}
-
 void pressKey(int key, int xx, int yy) {
     switch (key) {
         case GLUT_KEY_LEFT: deltaAngleY = -1.0f; break; 
@@ -604,157 +261,19 @@ void updateCamera(void) {
     }
 }
 void drawEntranceGates() {
-    float gateWidth = 16.0f;
-    float gateHeight = 12.0f;
-    float gateDepth = 4.0f;
-    
-    // Position at the outer seating radius
-    float rX = MAX_SEATING_X_RADIUS; 
-    float rZ = MAX_SEATING_Z_RADIUS;
-
-    float angles[2] = { 0.0f, 180.0f };
-    std::string labels[2] = { "GATE A", "GATE B" };
-
-    for(int i=0; i<2; i++) {
-        glPushMatrix();
-        
-        float angleRad = angles[i] * M_PI / 180.0f;
-        // Move slightly inward so the columns sit inside the gap
-        float x = (rX - 2.0f) * cos(angleRad); 
-        float z = (rZ - 2.0f) * sin(angleRad);
-        
-        glTranslatef(x, 0.0f, z);
-        glRotatef(angles[i] + 90.0f, 0.0f, 1.0f, 0.0f); 
-
-        // --- Draw Gate Frame ---
-        glColor3f(0.5f, 0.5f, 0.55f); 
-        
-        // Left Pillar
-        glPushMatrix();
-        glTranslatef(-gateWidth/2 + 1.5f, gateHeight/2, 0.0f);
-        glScalef(3.0f, gateHeight, gateDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // Right Pillar
-        glPushMatrix();
-        glTranslatef(gateWidth/2 - 1.5f, gateHeight/2, 0.0f);
-        glScalef(3.0f, gateHeight, gateDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // Top Arch/Beam
-        glPushMatrix();
-        glTranslatef(0.0f, gateHeight - 1.5f, 0.0f);
-        glScalef(gateWidth, 3.0f, gateDepth);
-        glutSolidCube(1.0);
-        glPopMatrix();
-        
-        // --- Gate Sign Board ---
-        glColor3f(0.1f, 0.1f, 0.4f); 
-        glPushMatrix();
-        glTranslatef(0.0f, gateHeight + 2.0f, 0.0f);
-        glScalef(gateWidth * 0.8f, 3.0f, 0.5f);
-        glutSolidCube(1.0);
-        glPopMatrix();
-
-        // --- Gate Text ---
-        glColor3f(1.0f, 1.0f, 0.0f); 
-        glPushMatrix();
-        glTranslatef(0.0f, gateHeight + 1.5f, 0.5f); 
-        float textWidth = 0.0f;
-       
-        glScalef(0.025f, 0.025f, 0.025f);
-        glTranslatef(-textWidth / 2.0f, 0.0f, 0.0f);
-        glLineWidth(3.0f);
-        
-        glLineWidth(1.0f);
-        glPopMatrix();
-
-        // --- REMOVED BLACKOUT BOX HERE ---
-        // The gate is now open air.
+    drawStadiumPart(STADIUM_GATES);
+}
 
-        // --- Ground Walkway (Extends Inside) ---
-        // Draws a concrete path from outside, through the gate, onto the track edge
-        glColor3f(0.55f, 0.55f, 0.6f);
-        glPushMatrix();
-        glTranslatef(0.0f, 0.05f, 5.0f); // 5.0f offset to center it through the gate
-        // Length 30.0f ensures it covers the gap from outside to the track
-        glScalef(gateWidth - 4.0f, 0.1f, 30.0f); 
-        glutSolidCube(1.0);
-        glPopMatrix();
+// --- 4. ACTUAL OPENGL LIGHT SOURCE ---
+// Kept apart from the tower geometry: the lights must be set for every camera
+// after its view transform, even when the tower itself is culled from that view.
+void applyFloodlight(float x, float z, float angleRotation, int lightIndex) {
+    float poleHeight = 65.0f;
 
-        glPopMatrix();
-    }
-}
-// Helper function to draw a single tower
-void drawFloodlightTower(float x, float z, float angleRotation, int lightIndex) {
-    float poleHeight = 65.0f; 
-    float poleWidth = 2.5f;
-    
     glPushMatrix();
     glTranslatef(x, 0.0f, z);
     glRotatef(angleRotation, 0.0f, 1.0f, 0.0f);
 
-    // --- 1. The Mast (Pole) ---
-    glColor3f(0.6f, 0.65f, 0.7f); // Steel Grey
-    glPushMatrix();
-    glTranslatef(0.0f, poleHeight / 2.0f, 0.0f);
-    glScalef(poleWidth, poleHeight, poleWidth);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- 2. The Light Head (Panel) ---
-    float headWidth = 14.0f;
-    float headHeight = 8.0f;
-    float headDepth = 2.0f;
-
-    glPushMatrix();
-    glTranslatef(0.0f, poleHeight, 0.0f); 
-    glRotatef(25.0f, 1.0f, 0.0f, 0.0f);   
-
-    // Panel Backing
-    glColor3f(0.2f, 0.2f, 0.25f); 
-    glPushMatrix();
-    glScalef(headWidth, headHeight, headDepth);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- 3. The Bulbs (Glowing White) ---
-    if (nightMode) { // Only make bulbs glow if it's night
-        glDisable(GL_LIGHTING); 
-        glColor3f(1.0f, 1.0f, 0.2f); // Pure White
-        
-        float startX = -headWidth / 2.0f + 1.5f;
-        float startY = -headHeight / 2.0f + 1.5f;
-        
-        for (int i = 0; i < 4; i++) {
-            for (int j = 0; j < 3; j++) {
-                glPushMatrix();
-                glTranslatef(startX + (i * 3.5f), startY + (j * 2.5f), 1.1f); 
-                glScalef(2.5f, 1.5f, 0.5f);
-                glutSolidCube(1.0);
-                glPopMatrix();
-            }
-        }
-        glEnable(GL_LIGHTING); // Re-enable lighting
-    } else { // If it's day, draw bulbs as white plastic, not glowing
-        glColor3f(0.9f, 0.9f, 0.9f); // Just white plastic
-        float startX = -headWidth / 2.0f + 1.5f;
-        float startY = -headHeight / 2.0f + 1.5f;
-        for (int i = 0; i < 4; i++) {
-            for (int j = 0; j < 3; j++) {
-                glPushMatrix();
-                glTranslatef(startX + (i * 3.5f), startY + (j * 2.5f), 1.1f); 
-                glScalef(2.5f, 1.5f, 0.5f);
-                glutSolidCube(1.0);
-                glPopMatrix();
-            }
-        }
-    }
-    glPopMatrix(); // End Head transformation
-
-    // --- 4. ACTUAL OPENGL LIGHT SOURCE ---
     // Only enable these lights if nightMode is true
     if (nightMode) {
         GLfloat lightColor[] = { 0.6f, 0.6f, 0.6f, 1.0f }; // Dimmer spot light
@@ -776,286 +295,239 @@ void drawFloodlightTower(float x, float z, float angleRotation, int lightIndex)
     glPopMatrix();
 }
 
-// The drawAllFloodlights function itself doesn't need significant changes,
-// it just calls drawFloodlightTower which now handles the conditional logic.
-void drawAllFloodlights() {
-    float distX = 85.0f;
-    float distZ = 65.0f;
-
-    // 1. Corner +X, +Z (Top Right) -> Faces Center (-135 deg roughly)
-    drawFloodlightTower(distX, distZ, 225.0f, GL_LIGHT1);
-
-    // 2. Corner -X, +Z (Top Left) -> Faces Center (-45 deg roughly)
-    drawFloodlightTower(-distX, distZ, 135.0f, GL_LIGHT2);
-
-    // 3. Corner -X, -Z (Bottom Left) -> Faces Center (45 deg roughly)
-    drawFloodlightTower(-distX, -distZ, 45.0f, GL_LIGHT3);
-
-    // 4. Corner +X, -Z (Bottom Right) -> Faces Center (135 deg roughly)
-    drawFloodlightTower(distX, -distZ, 315.0f, GL_LIGHT4);
-}
-void drawTree(float x, float z) {
-    glPushMatrix();
-    glTranslatef(x, 0.0f, z);
-
-    // --- Trunk ---
-    glColor3f(0.4f, 0.26f, 0.13f); // Wood Brown
-    glPushMatrix();
-    glTranslatef(0.0f, 2.0f, 0.0f); // Lift trunk center
-    glScalef(1.5f, 4.0f, 1.5f);     // Tall and thin
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- Leaves (3 Tiered Cones) ---
-    glColor3f(0.05f, 0.4f, 0.05f); // Dark Green
-
-    // Bottom Tier
-    glPushMatrix();
-    glTranslatef(0.0f, 4.0f, 0.0f);
-    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f); // Point up
-    glutSolidCone(5.0, 6.0, 10, 2);      // Base, Height, Slices, Stacks
-    glPopMatrix();
-
-    // Middle Tier
-    glPushMatrix();
-    glTranslatef(0.0f, 6.5f, 0.0f);
-    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-    glutSolidCone(4.0, 5.5, 10, 2);
-    glPopMatrix();
-
-    // Top Tier
-    glPushMatrix();
-    glTranslatef(0.0f, 9.0f, 0.0f);
-    glRotatef(-90.0f, 1.0f, 0.0f, 0.0f);
-    glutSolidCone(2.5, 5.0, 10, 2);
-    glPopMatrix();
+// 1. Corner +X, +Z (Top Right) -> Faces Center (-135 deg roughly)
+// 2. Corner -X, +Z (Top Left) -> Faces Center (-45 deg roughly)
+// 3. Corner -X, -Z (Bottom Left) -> Faces Center (45 deg roughly)
+// 4. Corner +X, -Z (Bottom Right) -> Faces Center (135 deg roughly)
+const FloodlightTower FLOODLIGHT_TOWERS[NUM_FLOODLIGHT_TOWERS] = {
+    {  85.0f,  65.0f, 225.0f, GL_LIGHT1 },
+    { -85.0f,  65.0f, 135.0f, GL_LIGHT2 },
+    { -85.0f, -65.0f,  45.0f, GL_LIGHT3 },
+    {  85.0f, -65.0f, 315.0f, GL_LIGHT4 }
+};
 
-    glPopMatrix();
+void applyAllFloodlights() {
+    for (int i = 0; i < NUM_FLOODLIGHT_TOWERS; ++i) {
+        const FloodlightTower& t = FLOODLIGHT_TOWERS[i];
+        applyFloodlight(t.x, t.z, t.angleRotation, t.lightIndex);
+    }
 }
 
-void drawSurroundingTrees() {
+// Position of tree i in the ring. Returns false for trees left out in front of the gates.
+bool surroundingTreePosition(int i, float& x, float& z) {
     float treeRadiusX = 115.0f; // Wider than the stadium
     float treeRadiusZ = 95.0f;
-    int numTrees = 10;
-
-    for (int i = 0; i < numTrees; i++) {
-        float theta = 2.0f * M_PI * i / numTrees;
-        float angleDeg = theta * 180.0f / M_PI;
-        
-        // Normalize angle to 0-360
-        while(angleDeg >= 360.0f) angleDeg -= 360.0f;
-        while(angleDeg < 0.0f) angleDeg += 360.0f;
-
-        // --- GAP LOGIC ---
-        // Don't draw trees in front of Gate A (0 degrees) or Gate B (180 degrees)
-        float gapSize = 15.0f;
-        
-        // Check Gate A (Around 0/360)
-        if (angleDeg < gapSize || angleDeg > 360.0f - gapSize) continue;
-        
-        // Check Gate B (Around 180)
-        if (angleDeg > 180.0f - gapSize && angleDeg < 180.0f + gapSize) continue;
-
-        float x = treeRadiusX * cos(theta);
-        float z = treeRadiusZ * sin(theta);
-        
-        // Add a little randomness to the position so they aren't in a perfect robot line
-        // (Optional: simple offset based on index)
-        float offset = (i % 2 == 0) ? 3.0f : -3.0f; 
-        
-        drawTree(x + offset, z + offset);
-    }
-}
-void drawPlayer(float x, float z, bool isTeamRed, float rotation) {
-    glPushMatrix();
-    glTranslatef(x, 0.0f, z);
-    glRotatef(rotation, 0.0f, 1.0f, 0.0f);
-
-    // Dimensions
-    float bodyWidth = 0.6f;
-    float bodyHeight = 0.7f;
-    float legHeight = 0.9f;
-    float headRadius = 0.25f;
-
-    // --- 1. Legs (White Shorts/Socks) ---
-    glColor3f(1.0f, 1.0f, 1.0f); 
-    
-    // Left Leg
-    glPushMatrix();
-    glTranslatef(-0.15f, legHeight / 2.0f, 0.0f);
-    glScalef(0.2f, legHeight, 0.2f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // Right Leg
-    glPushMatrix();
-    glTranslatef(0.15f, legHeight / 2.0f, 0.0f);
-    glScalef(0.2f, legHeight, 0.2f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- 2. Torso (Team Color Shirt) ---
-    if (isTeamRed) glColor3f(0.9f, 0.1f, 0.1f); // Red Team
-    else           glColor3f(0.1f, 0.1f, 0.9f); // Blue Team
-
-    glPushMatrix();
-    glTranslatef(0.0f, legHeight + (bodyHeight / 2.0f), 0.0f);
-    glScalef(bodyWidth, bodyHeight, 0.3f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- 3. Arms (Skin Tone) ---
-    glColor3f(0.87f, 0.72f, 0.53f); // Beige/Skin
-
-    // Left Arm
-    glPushMatrix();
-    glTranslatef(-bodyWidth/2.0f - 0.1f, legHeight + bodyHeight - 0.2f, 0.0f);
-    glScalef(0.15f, 0.5f, 0.15f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // Right Arm
-    glPushMatrix();
-    glTranslatef(bodyWidth/2.0f + 0.1f, legHeight + bodyHeight - 0.2f, 0.0f);
-    glScalef(0.15f, 0.5f, 0.15f);
-    glutSolidCube(1.0);
-    glPopMatrix();
-
-    // --- 4. Head (Skin Tone) ---
-    glPushMatrix();
-    glTranslatef(0.0f, legHeight + bodyHeight + headRadius, 0.0f);
-    glutSolidSphere(headRadius, 10, 10);
-    glPopMatrix();
-
-    glPopMatrix();
-}
-
-void drawFootball() {
-    float ballRadius = 0.25f;
-    
-    glPushMatrix();
-    // CHANGED: Use variables
-    glTranslatef(ballX, ballRadius, ballZ); 
-    
-    // Rotate ball as it moves (visual effect)
-    glRotatef(ballRot, 0.0f, 0.0f, -1.0f); 
+    int numTrees = NUM_SURROUNDING_TREES;
 
-    // Main White Ball
-    glColor3f(1.0f, 1.0f, 1.0f);
-    glutSolidSphere(ballRadius, 12, 12);
+    float theta = 2.0f * M_PI * i / numTrees;
+    float angleDeg = theta * 180.0f / M_PI;
     
-    // Shadow
-    glDisable(GL_LIGHTING);
-    glColor3f(0.1f, 0.1f, 0.1f);
-    glPushMatrix();
-    // Shadow doesn't rotate with ball, stays on ground relative to ball center
-    glRotatef(-ballRot, 0.0f, 0.0f, -1.0f); 
-    glTranslatef(0.0f, -ballRadius + 0.02f, 0.0f);
-    glScalef(1.0f, 0.01f, 1.0f);
-    glutSolidSphere(ballRadius, 8, 8);
-    glPopMatrix();
-    glEnable(GL_LIGHTING);
+    // Normalize angle to 0-360
+    while(angleDeg >= 360.0f) angleDeg -= 360.0f;
+    while(angleDeg < 0.0f) angleDeg += 360.0f;
+
+    // --- GAP LOGIC ---
+    // Don't draw trees in front of Gate A (0 degrees) or Gate B (180 degrees)
+    if (inGateClearance(angleDeg, TREE_GATE_CLEARANCE_DEGREES)) return false;
+
+    // Add a little randomness to the position so they aren't in a perfect robot line
+    // (Optional: simple offset based on index)
+    float offset = (i % 2 == 0) ? 3.0f : -3.0f; 
+
+    x = treeRadiusX * cos(theta) + offset;
+    z = treeRadiusZ * sin(theta) + offset;
+    return true;
+}
+
+// --- Players and ball as scene graph nodes ---
+
+const float BALL_RADIUS = 0.25f;
+
+static int figureNodes[NUM_MATCH_FIGURES];
+static int partNodes[NUM_MATCH_FIGURES][NUM_FIGURE_PARTS];
+static int ballNode = -1, ballSpinNode = -1;
+
+// A box or sphere under parent, placed like glTranslatef then glScalef
+static int addPart(int parent, float tx, float ty, float tz, float sx, float sy, float sz) {
+    float t[16], s[16], m[16];
+    translationMatrix(tx, ty, tz, t);
+    scalingMatrix(sx, sy, sz, s);
+    multiplyMatrices(t, s, m);
+    return addSceneNode(parent, m);
+}
+
+// A root for position and facing, set every frame, and the body parts
+// under it, posed every frame by the skeletal animation
+static void addFigureNodes(int figure, bool isTeamRed) {
+    float identity[16];
+    scalingMatrix(1.0f, 1.0f, 1.0f, identity);
+    int root = figureNodes[figure] = addSceneNode(-1, identity);
+    for (int p = 0; p < NUM_FIGURE_PARTS; ++p) partNodes[figure][p] = addSceneNode(root, identity);
+
+    int* parts = partNodes[figure];
+    // Legs (White Shorts/Socks)
+    for (int p = PART_RIGHT_THIGH; p <= PART_LEFT_SHIN; ++p) setSceneNodeLook(parts[p], SHAPE_CUBE, 0, 1.0f, 1.0f, 1.0f, true);
+    // Torso (Team Color Shirt)
+    if (isTeamRed) setSceneNodeLook(parts[PART_TORSO], SHAPE_CUBE, 0, 0.9f, 0.1f, 0.1f, true); // Red Team
+    else           setSceneNodeLook(parts[PART_TORSO], SHAPE_CUBE, 0, 0.1f, 0.1f, 0.9f, true); // Blue Team
+    // Arms and head (Skin Tone)
+    setSceneNodeLook(parts[PART_RIGHT_ARM], SHAPE_CUBE, 0, 0.87f, 0.72f, 0.53f, true);
+    setSceneNodeLook(parts[PART_LEFT_ARM], SHAPE_CUBE, 0, 0.87f, 0.72f, 0.53f, true);
+    setSceneNodeLook(parts[PART_HEAD], SHAPE_SPHERE, 10, 0.87f, 0.72f, 0.53f, true);
+}
+
+static void buildMatchSceneGraph() {
+    clearSceneGraph();
+    AnimFigure figures[NUM_MATCH_FIGURES];
+    bool isTeamRed[NUM_MATCH_FIGURES];
+    currentMatchFigures(figures, isTeamRed);
+    for (int i = 0; i < NUM_MATCH_FIGURES; ++i) addFigureNodes(i, isTeamRed[i]);
+
+    // Ball: position, then the spin under it; the shadow hangs off the
+    // position so it stays flat on the grass
+    float identity[16];
+    scalingMatrix(1.0f, 1.0f, 1.0f, identity);
+    ballNode = addSceneNode(-1, identity);
+    ballSpinNode = addSceneNode(ballNode, identity);
+    setSceneNodeLook(addPart(ballSpinNode, 0.0f, 0.0f, 0.0f, BALL_RADIUS, BALL_RADIUS, BALL_RADIUS),
+                     SHAPE_SPHERE, 12, 1.0f, 1.0f, 1.0f, true);
+    setSceneNodeLook(addPart(ballNode, 0.0f, -BALL_RADIUS + 0.02f, 0.0f, BALL_RADIUS, BALL_RADIUS * 0.01f, BALL_RADIUS),
+                     SHAPE_SPHERE, 8, 0.1f, 0.1f, 0.1f, false);
+}
+
+void updateMatchSceneGraph() {
+    if (ballNode < 0) buildMatchSceneGraph();
+
+    AnimFigure figures[NUM_MATCH_FIGURES];
+    bool isTeamRed[NUM_MATCH_FIGURES];
+    currentMatchFigures(figures, isTeamRed);
+    const float* poses[NUM_MATCH_FIGURES];
+    resolveFigurePoses(figures, NUM_MATCH_FIGURES, poses);
+
+    float x[NUM_MATCH_FIGURES], z[NUM_MATCH_FIGURES], yaw[NUM_MATCH_FIGURES], roots[NUM_MATCH_FIGURES * 16];
+    for (int i = 0; i < NUM_MATCH_FIGURES; ++i) {
+        x[i] = figures[i].x;
+        z[i] = figures[i].z;
+        yaw[i] = figures[i].yawDeg;
+    }
+    composeYawTransforms(x, 0, z, yaw, 0, NUM_MATCH_FIGURES, roots);
+    for (int i = 0; i < NUM_MATCH_FIGURES; ++i) {
+        setSceneNodeLocal(figureNodes[i], roots + 16 * i);
+        for (int p = 0; p < NUM_FIGURE_PARTS; ++p) setSceneNodeLocal(partNodes[i][p], poses[i] + 16 * p);
+    }
 
-    glPopMatrix();
+    float m[16];
+    translationMatrix(ballX, BALL_RADIUS, ballZ, m);
+    setSceneNodeLocal(ballNode, m);
+    rotationMatrix(ballRot, 0.0f, 0.0f, -1.0f, m); // Rotate ball as it moves (visual effect)
+    setSceneNodeLocal(ballSpinNode, m);
+
+    updateSceneGraph();
+}
+
+// One heat-map tick: where the ball and every player are now
+void recordGameHeat() {
+    PlayerSpot spots[NUM_PLAYERS];
+    currentPlayerSpots(spots);
+    recordHeatSample(HEAT_ENTITY_BALL, ballX, ballZ);
+    for (int i = 0; i < NUM_PLAYERS; ++i) recordHeatSample(1 + i, spots[i].x, spots[i].z);
+    endHeatTick();
+}
+
+// The match as the server shows it: ball, striker and goalie, camera and
+// night mode. The rest of the players stand still, and the goal is
+// celebrated when the ball crosses the line, as updateGameLogic() does.
+void followSpectatorServer() {
+    MatchState s;
+    if (!updateSpectatorDisplay(s)) return;
+    bool crossed = s.animStage == 2 && ballX <= FIELD_X_RADIUS && s.ballX > FIELD_X_RADIUS;
+    isPlaying = false; // updateGameLogic() only advances the idle clips
+    animStage = s.animStage;
+    ballX = s.ballX;
+    ballZ = s.ballZ;
+    ballRot = s.ballRot;
+    const int striker = NUM_PLAYERS / 2 - 1, goalie = NUM_PLAYERS / 2; // see currentPlayerSpots()
+    strikerX = s.playerX[striker];
+    strikerZ = s.playerZ[striker];
+    goalieZ = s.playerZ[goalie];
+    cameraX = s.eye[0]; cameraY = s.eye[1]; cameraZ = s.eye[2];
+    targetX = s.target[0]; targetY = s.target[1]; targetZ = s.target[2];
+    if (s.night != nightMode) toggleNightMode();
+    if (crossed) {
+        startGoalCelebration();
+        startCrowdCheer(true);
+    }
 }
-void drawTeams() {
-    // --- RED TEAM (Left Side, Facing Right) ---
-    float rotRed = 90.0f;
-    
-    drawPlayer(-38.0f, 0.0f, true, rotRed);   // Goalkeeper
-    drawPlayer(-25.0f, -10.0f, true, rotRed); // Defender
-    drawPlayer(-25.0f, 10.0f, true, rotRed);  // Defender
-    drawPlayer(-10.0f, -5.0f, true, rotRed);  // Midfielder
-    drawPlayer(-5.0f, 15.0f, true, rotRed);   // Midfielder
-    
-    // CHANGED: The Striker now uses dynamic variables
-    drawPlayer(strikerX, strikerZ, true, rotRed); 
-
-    // --- BLUE TEAM (Right Side, Facing Left) ---
-    float rotBlue = -90.0f;
 
-    // CHANGED: The Goalie now uses dynamic variables (moves Z to dive)
-    drawPlayer(38.0f, goalieZ, false, rotBlue);   
-    
-    drawPlayer(25.0f, -8.0f, false, rotBlue);  // Defender
-    drawPlayer(25.0f, 8.0f, false, rotBlue);   // Defender
-    drawPlayer(15.0f, 0.0f, false, rotBlue);   // Midfielder
-    drawPlayer(8.0f, -15.0f, false, rotBlue);  // Midfielder
-    drawPlayer(5.0f, 5.0f, false, rotBlue);    // Striker
+// One fixed simulation tick: players and ball, heat maps, particles, crowd
+void stepSimulation() {
+    if (spectatorServerAddress) followSpectatorServer();
+    updateGameLogic();
+    recordGameHeat();
+    updateParticles(1.0f / SIM_TICK_RATE, nightMode); // it rains at night
+    updateCrowd(1.0f / SIM_TICK_RATE);
 }
-void updateGameLogic() {
-    if (!isPlaying) return;
 
-    // STAGE 1: Striker Runs to Ball
-    if (animStage == 1) {
-        if (strikerX < -0.8f) {
-            strikerX += 0.15f; // Run speed
-        } else {
-            // Reached ball, KICK!
-            animStage = 2;
-            ballVelX = 0.8f;  // Fast shot X
-            ballVelZ = 0.25f; // Slight curve Z
-        }
-    }
-
-    // STAGE 2: Ball Flies & Goalie Dives
-    if (animStage == 2) {
-        // Move Ball
-        ballX += ballVelX;
-        ballZ += ballVelZ;
-        ballRot += 20.0f; // Spin
-
-        // Move Goalie (Simple AI: Move towards ball Z)
-        // Only if ball is getting close
-        if (ballX > 20.0f) {
-            if (goalieZ < ballZ) goalieZ += 0.15f;
-            if (goalieZ > ballZ) goalieZ -= 0.15f;
-        }
-
-        // Friction / Stop condition
-        if (ballX > 45.0f) { // Ball passed goal line
-            ballVelX *= 0.95f; // Slow down
-            ballVelZ *= 0.95f;
-            if (ballVelX < 0.01f) isPlaying = false; // Stop
+// Rename/Create this central idle function
+void idle() {
+    updateSpectatorServer();
+    if (captureIsActive()) {
+        // Offline capture: each output frame advances a fixed slice of simulated time,
+        // however long it took to render and write out.
+        int ticks = 0;
+        float orbitDeg = 0.0f;
+        if (captureNextFrameStep(SIM_TICK_RATE, ticks, orbitDeg)) {
+            for (int i = 0; i < ticks; ++i) stepSimulation();
+            angleY += orbitDeg;
+            computeCameraPosition();
         }
+        glutPostRedisplay();
+        return;
     }
-}
 
-// Rename/Create this central idle function
-void idle() {
-    updateGameLogic(); // Move players/ball
-    updateCamera();    // Move camera (if keys pressed)
+    stepSimulation(); // Move players/ball
+    if (!spectatorServerAddress) updateCamera(); // Move camera (if keys pressed); a server's display follows its director
     glutPostRedisplay();
 }
-void display() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glLoadIdentity();
+// Presentation time: wall clock normally, output-video time while capturing
+double viewClockSeconds() {
+    if (captureIsActive()) return captureTimeSeconds();
+    return glutGet(GLUT_ELAPSED_TIME) / 1000.0;
+}
 
-    gluLookAt(cameraX, cameraY, cameraZ,
-              targetX, targetY, targetZ,
-              0.0f, 1.0f, 0.0f);
-
-    // Draw all components
-    drawInnerGrass();     // NEW: Fills the gap between track and field
-    drawAthleticsTrack(); // Red track ring
-    drawFootballPitch();  // White lines on top of grass
-    drawGoalposts();
-    drawTeamBenches();
-    drawEntranceGates();
-    drawAllFloodlights();
-	drawSurroundingTrees();
-	drawFootball();
-    drawTeams(); 
-    drawStadiumSeatingBowl();
-    drawMainGrandstandRoof();
-    drawMainGrandstandColumns();
-    drawGrandstandFacade();
-    drawVIPSeating();
-    drawStadiumName();
-    drawStoneFacade();
-    drawSafetyRailing();
+void display() {
+    statsFrameBegin();
+    if (!captureIsActive()) governorFrameBegin();
+    updateSeatOccupancy();
+    updateHeatMapTexture();
+    uploadParticles();
+    uploadCrowd();
+    updateMatchSceneGraph();
+
+    // Every camera (window, monitors, jumbotron) from one shared frame
+    renderBroadcastFrame(viewClockSeconds());
+
+    // Read the finished back buffer before it is swapped away
+    if (captureIsActive() && !captureFrame(windowWidth, windowHeight)) {
+        frameArenaReset();
+        captureEnd();
+        glutLeaveMainLoop();
+        return;
+    }
 
+    if (!captureIsActive()) governorFrameRendered();
     glutSwapBuffers();
+    glTraceFrameEnd();
+    if (!captureIsActive()) governorFrameDone();
+    frameArenaReset(); // this frame's scratch is no longer needed
+    statsFrameEnd();
+
+    if (!firstFrameShown) {
+        glFinish(); // count the first frame as shown only once the GPU is done with it
+        firstFrameShown = true;
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - launchTime).count();
+        std::cout << "Startup: first frame after " << ms << " ms" << std::endl;
+    }
 }
 
 void reshape(int w, int h) {
@@ -1064,7 +536,7 @@ void reshape(int w, int h) {
     glViewport(0, 0, w, h);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluPerspective(60.0, (double)w / (double)h, 1.0, 500.0);
+    gluPerspective(60.0, (double)w / (double)h, 1.0, VIEW_FAR_DISTANCE);
     glMatrixMode(GL_MODELVIEW);
 }
 
@@ -1100,6 +572,8 @@ void init() {
 void toggleNightMode() {
     nightMode = !nightMode; // Flip the state
 
+    invalidateNightDependentObjects(); // Floodlight bulbs change colour
+
     // Update background color immediately
     if (nightMode) {
         glClearColor(0.1f, 0.1f, 0.2f, 1.0f); 
@@ -1114,22 +588,258 @@ void keyboardHandler(unsigned char key, int x, int y) {
         toggleNightMode();
     }
     
+    // Broadcast: C toggles the inset monitors, J picks the jumbotron camera
+    if (key == 'c' || key == 'C') cycleBroadcastLayout();
+    if (key == 'j' || key == 'J') cycleJumbotronCamera();
+
+    // O switches occlusion culling, to compare frame times with --stats
+    if (key == 'o' || key == 'O') toggleOcclusionCulling();
+
+    // Heat maps: H picks ball/team/player, M the time mode, G toggles smoothing
+    if (key == 'h' || key == 'H') cycleHeatMapTarget();
+    if (key == 'm' || key == 'M') cycleHeatMapMode();
+    if (key == 'g' || key == 'G') toggleHeatMapSmoothing();
+
+    // W starts or stops the Mexican wave
+    if (key == 'w' || key == 'W') toggleCrowdWave();
+
     // --- NEW: Press R to Start ---
     if (key == 'r' || key == 'R') {
-        isPlaying = true;
-        animStage = 1; // Start Running
-        
-        // Reset Positions
-        ballX = 0.0f; ballZ = 0.0f; ballRot = 0.0f;
-        strikerX = -6.0f; strikerZ = 0.0f;
-        goalieZ = 0.0f;
-        ballVelX = 0.0f; ballVelZ = 0.0f;
+        startKick();
+    }
+}
+// **********************************************
+// ************ MOUSE PICKING *******************
+// **********************************************
+
+static const char* PRICE_BAND_NAMES[NUM_PRICE_BANDS] = { "premium", "sideline", "corner", "end" };
+static const char* SEAT_STATE_NAMES[] = { "free", "held", "sold", "unknown" };
+
+// Casts the click through the director camera's matrices; the window shows
+// the director view full size.
+void pickUnderCursor(int x, int y) {
+    float eye[3] = { cameraX, cameraY, cameraZ }, target[3] = { targetX, targetY, targetZ }, up[3] = { 0, 1, 0 };
+    float projection[16], view[16], viewProj[16];
+    perspectiveMatrix(60.0f, (float)windowWidth / (float)windowHeight, 1.0f, VIEW_FAR_DISTANCE, projection);
+    lookAtMatrix(eye, target, up, view);
+    multiplyMatrices(projection, view, viewProj);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool hit = pickScreen(x, y, windowWidth, windowHeight, viewProj, pickedObject);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    char info[128];
+    if (!hit) {
+        std::snprintf(info, sizeof(info), "nothing");
+    } else if (pickedObject.kind == PICK_SEAT) {
+        const SeatPlacement& s = seatLayout()[pickedObject.seat];
+        SeatId id = makeSeatId(s.tier, s.sector, s.seatInRow);
+        int band = seatPriceBand(id);
+        std::snprintf(info, sizeof(info), "seat %d-%d-%d, %s, %s, view %.2f", s.tier, s.sector, s.seatInRow,
+                      band >= 0 ? PRICE_BAND_NAMES[band] : "no band", SEAT_STATE_NAMES[seatState(id)],
+                      seatViewQuality(s));
+        if (seatOccupancyActive()) {
+            size_t used = std::strlen(info);
+            std::snprintf(info + used, sizeof(info) - used, ", %s", occupancyStateName(seatOccupancy(pickedObject.seat)));
+        }
+    } else {
+        std::snprintf(info, sizeof(info), "%s", pickedObject.name);
     }
+    std::cout << "Pick: " << info << " (" << ms << " ms)" << std::endl;
+
+    std::string title = std::string("Astu Stadium - ") + info;
+    glutSetWindowTitle(title.c_str());
+    glutPostRedisplay();
+}
+
+void mouseHandler(int button, int state, int x, int y) {
+    if (button == GLUT_LEFT_BUTTON && state == GLUT_DOWN) pickUnderCursor(x, y);
+}
+
+// Yellow outline around the picked seat or box
+void drawPickHighlight() {
+    float m[16];
+    if (!pickedObjectMatrix(pickedObject, m)) return;
+    glDisable(GL_LIGHTING);
+    glColor3f(1.0f, 1.0f, 0.0f);
+    glLineWidth(3.0f);
+    glPushMatrix();
+    glMultMatrixf(m);
+    glScalef(1.15f, 1.15f, 1.15f);
+    glutWireCube(1.0);
+    glPopMatrix();
+    glLineWidth(1.0f);
+    glEnable(GL_LIGHTING);
+}
+
+// The context is still current here, unlike after glutMainLoop() returns
+void onWindowClose() {
+    captureEnd();   // window closed mid-capture: flush what is still queued
+    shutdownCity(); // join the tile workers
+    shutdownSeatOccupancy();
+    shutdownJobSystem(); // particle workers
+    stopSpectatorServer();
+    stopSpectatorDisplay();
+}
+
+// **********************************************
+// ************ COMMAND LINE ********************
+// **********************************************
+
+void printUsage(const char* exe) {
+    std::cout << "Usage: " << exe << " [options]\n"
+              << "  --play                     start the kick animation immediately\n"
+              << "  --size <w>x<h>             window size\n"
+              << "  --monitors                 start with the broadcast inset monitors shown\n"
+              << "  --stats                    print frame statistics once a second\n"
+              << "  --heap-check               report frames that allocate once running steadily\n"
+              << "  --no-occlusion             draw objects hidden behind the stands too\n"
+              << "  --trees <n>                trees and shrubs around the stadium (default 4000)\n"
+              << "  --city-budget <MB>         memory for streamed city tiles (default 16)\n"
+              << "  --geometry-cache <path>    seating geometry cache file (default stadium_geometry.cache)\n"
+              << "  --no-geometry-cache        always regenerate the seating geometry\n"
+              << "  --software <file.ppm>      render one frame on the CPU without a window and exit\n"
+              << "  --software-threads <n>     rasterizer threads (default: one per core)\n"
+              << "  --software-bench           also time the software renderer at 1, 2, 4 .. threads\n"
+              << "  --occupancy-feed <src>     colour seats live from a file or unix:<socket path>\n"
+              << "  --target-fps <fps>         lower the render resolution to hold this frame rate\n"
+              << "  --governor-detail          let --target-fps also thin nets, railings and trees\n"
+              << "  --particles <n>            rain / confetti / spark capacity (default 200000)\n"
+              << "  --particle-threads <n>     particle and crowd update threads, 0 = one per core (default 1)\n"
+              << "  --no-crowd                 leave the seats empty\n"
+              << "  --spectator-port <port>    broadcast the match to remote displays over UDP\n"
+              << "  --spectator-loopback <n>   simulate n remote displays without a window and exit\n"
+              << "  --spectator-loss <percent> packet loss each way for --spectator-loopback (default 2)\n"
+              << "  --spectator-connect <host>:<port> show the match from a --spectator-port server\n"
+              << "  --gl-trace <file>          record the GL calls of some frames for glTraceReplay\n"
+              << "  --gl-trace-frames <a>[-<b>] frames to record, 0 = start-up and the first (default 0)\n"
+              << "  --capture <path>           record frames offline (directory, or file / - for yuv)\n"
+              << "  --capture-format ppm|png|yuv\n"
+              << "  --capture-fps <fps>        output frame rate (default 30)\n"
+              << "  --capture-frames <n>       stop after n frames (default: until closed)\n"
+              << "  --capture-orbit <deg/s>    orbit the camera while recording\n";
+}
+
+// Returns false when the program should exit (bad option or --help).
+bool parseCommandLine(int argc, char** argv) {
+    CaptureSettings capture = { 0, CAPTURE_PPM, 30.0f, 0, 0.0f };
+    const char* traceOutputPath = 0;
+    int traceFirstFrame = 0, traceLastFrame = 0;
+    bool play = false;
+    bool monitors = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : 0;
+        bool takesValue = std::strncmp(arg, "--capture", 9) == 0 || std::strcmp(arg, "--size") == 0 ||
+                          std::strcmp(arg, "--trees") == 0 || std::strcmp(arg, "--city-budget") == 0 ||
+                          std::strcmp(arg, "--geometry-cache") == 0 || std::strcmp(arg, "--software") == 0 ||
+                          std::strcmp(arg, "--software-threads") == 0 || std::strcmp(arg, "--occupancy-feed") == 0 ||
+                          std::strcmp(arg, "--target-fps") == 0 || std::strcmp(arg, "--particles") == 0 ||
+                          std::strcmp(arg, "--particle-threads") == 0 || std::strncmp(arg, "--spectator", 11) == 0 ||
+                          std::strncmp(arg, "--gl-trace", 10) == 0;
+        if (takesValue && !value) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+
+        if (std::strcmp(arg, "--play") == 0) play = true;
+        else if (std::strcmp(arg, "--monitors") == 0) monitors = true;
+        else if (std::strcmp(arg, "--stats") == 0) statsEnable(true);
+        else if (std::strcmp(arg, "--heap-check") == 0) statsHeapCheck(true);
+        else if (std::strcmp(arg, "--no-occlusion") == 0) setOcclusionCulling(false);
+        else if (std::strcmp(arg, "--no-crowd") == 0) crowdEnabled = false;
+        else if (std::strcmp(arg, "--size") == 0) {
+            if (std::sscanf(value, "%dx%d", &windowWidth, &windowHeight) != 2) {
+                std::cerr << "Bad --size, expected e.g. 1280x720" << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--trees") == 0) vegetationCount = std::atoi(value);
+        else if (std::strcmp(arg, "--city-budget") == 0) cityBudgetMB = std::atoi(value);
+        else if (std::strcmp(arg, "--geometry-cache") == 0) geometryCachePath = value;
+        else if (std::strcmp(arg, "--no-geometry-cache") == 0) geometryCachePath = 0;
+        else if (std::strcmp(arg, "--software") == 0) softwareOutputPath = value;
+        else if (std::strcmp(arg, "--software-threads") == 0) softwareThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--software-bench") == 0) softwareBenchmark = true;
+        else if (std::strcmp(arg, "--occupancy-feed") == 0) occupancyFeed = value;
+        else if (std::strcmp(arg, "--target-fps") == 0) targetFps = (float)std::atof(value);
+        else if (std::strcmp(arg, "--governor-detail") == 0) governorDetail = true;
+        else if (std::strcmp(arg, "--particles") == 0) particleCapacity = std::atoi(value);
+        else if (std::strcmp(arg, "--particle-threads") == 0) particleThreads = std::atoi(value);
+        else if (std::strcmp(arg, "--spectator-port") == 0) spectatorPort = std::atoi(value);
+        else if (std::strcmp(arg, "--spectator-loopback") == 0) spectatorLoopbackClients = std::atoi(value);
+        else if (std::strcmp(arg, "--spectator-loss") == 0) spectatorLoss = (float)std::atof(value);
+        else if (std::strcmp(arg, "--spectator-connect") == 0) spectatorServerAddress = value;
+        else if (std::strcmp(arg, "--gl-trace") == 0) traceOutputPath = value;
+        else if (std::strcmp(arg, "--gl-trace-frames") == 0) {
+            int n = std::sscanf(value, "%d-%d", &traceFirstFrame, &traceLastFrame);
+            if (n < 1 || traceFirstFrame < 0) {
+                std::cerr << "Bad --gl-trace-frames, expected e.g. 100 or 100-119" << std::endl;
+                return false;
+            }
+            if (n == 1) traceLastFrame = traceFirstFrame;
+        }
+        else if (std::strcmp(arg, "--capture") == 0) capture.outputPath = value;
+        else if (std::strcmp(arg, "--capture-format") == 0) {
+            if (!parseCaptureFormat(value, capture.format)) {
+                std::cerr << "Unknown capture format " << value << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--capture-fps") == 0) capture.fps = (float)std::atof(value);
+        else if (std::strcmp(arg, "--capture-frames") == 0) capture.frameCount = std::atoi(value);
+        else if (std::strcmp(arg, "--capture-orbit") == 0) capture.orbitDegPerSec = (float)std::atof(value);
+        else {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (takesValue) ++i;
+    }
+
+    if (capture.outputPath) captureConfigure(capture);
+    if (traceOutputPath) glTraceConfigure(traceOutputPath, traceFirstFrame, traceLastFrame);
+    if (play) startKick();
+    if (monitors) cycleBroadcastLayout();
+    return true;
+}
+
+// Drives the match for --spectator-loopback: the kick on repeat and a
+// slow orbit, so the ball, players and camera all keep changing
+void advanceLoopbackMatch(float seconds) {
+    int ticks = (int)(seconds * SIM_TICK_RATE + 0.5f);
+    for (int i = 0; i < ticks; ++i) {
+        if (!isPlaying) startKick();
+        stepSimulation();
+    }
+    angleY += 6.0f * seconds;
+    computeCameraPosition();
 }
+
 // R
 int main(int argc, char** argv) {
+    launchTime = std::chrono::steady_clock::now();
+
+    // Headless: no display is needed, so GLUT is never initialised
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--software") != 0) continue;
+        if (!parseCommandLine(argc, argv)) return 1;
+        computeCameraPosition();
+        SoftRenderSettings software = { softwareOutputPath, windowWidth, windowHeight, softwareThreads, softwareBenchmark,
+                                        crowdEnabled };
+        return runSoftwareRender(software);
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--spectator-loopback") != 0) continue;
+        if (!parseCommandLine(argc, argv)) return 1;
+        computeCameraPosition();
+        return runSpectatorLoopback(spectatorLoopbackClients, SPECTATOR_LOOPBACK_SECONDS, spectatorLoss, advanceLoopbackMatch);
+    }
+
     // 1. Initialize GLUT (MUST BE FIRST)
     glutInit(&argc, argv);
+    if (!parseCommandLine(argc, argv)) return 1;
+    glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
     
     // 2. Configure Display Mode
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
@@ -1139,7 +849,30 @@ int main(int argc, char** argv) {
     glutCreateWindow("Astu Stadium");
 
     // 4. Initialize your settings (Lighting, Materials, etc.)
+    loadGLExtensions();
+    configureFrameGovernor(targetFps, governorDetail);
     init();
+    initSeatingMesh(geometryCachePath);
+    initSeatInventory(seatLayout());
+    std::vector<PickBox> pickBoxes;
+    collectStadiumBoxes(pickBoxes);
+    buildPickIndex(seatLayout(), pickBoxes);
+    if (occupancyFeed) initSeatOccupancy(seatLayout(), occupancyFeed);
+    initBroadcastViews();
+    initVegetation(vegetationCount);
+    initCity(cityBudgetMB);
+    initHeatMaps(SIM_TICK_RATE);
+    if (particleThreads != 1) initJobSystem(particleThreads);
+    initParticles(particleCapacity);
+    if (crowdEnabled) {
+        unsigned int crowdSectors[NUM_SEAT_SECTORS + 1];
+        for (int s = 0; s <= NUM_SEAT_SECTORS; ++s) crowdSectors[s] = sectorFirstSeat(s);
+        initCrowd(seatLayout(), crowdSectors);
+    }
+    if (spectatorPort) startSpectatorServer(spectatorPort);
+    if (spectatorServerAddress && !startSpectatorDisplay(spectatorServerAddress)) return 1;
+
+    initFrameArena(FRAME_ARENA_BYTES);
 
     // 5. Register Callbacks
     glutDisplayFunc(display);
@@ -1148,9 +881,11 @@ int main(int argc, char** argv) {
     glutSpecialUpFunc(releaseKey);
     glutIdleFunc(idle);            // Ensure 'idle' is defined (combines game+camera logic)
     glutKeyboardFunc(keyboardHandler);
+    glutMouseFunc(mouseHandler);
+    glutCloseFunc(onWindowClose);
 
     // 6. Enter Main Loop
     glutMainLoop();
-    
+
     return 0;
 }
@@ -0,0 +1,228 @@
+// **********************************************
+// ************ MATCH & CAMERA STATE ************
+// **********************************************
+
+// The kick animation and the director camera's orbit, kept apart from the
+// drawing code so they can be stepped without a window (STADIUMBENCH,
+// --spectator-loopback).
+
+#include "stadium.h"
+#include "particles.h"
+#include "crowd.h"
+#include <algorithm>
+
+// --- GAME ANIMATION VARIABLES ---
+bool isPlaying = false;
+int animStage = 0; // 0=Wait, 1=Run Up, 2=Ball Flying
+
+// Positions
+float ballX = 0.0f, ballZ = 0.0f, ballRot = 0.0f;
+float strikerX = -6.0f, strikerZ = 0.0f; // Start behind the ball
+float goalieZ = 0.0f;
+
+// Velocities
+float ballVelX = 0.0f, ballVelZ = 0.0f;
+const float STRIKER_RUN_SPEED = 0.15f; // per step
+const float KICK_BALL_SPEED = 0.8f;    // ballX per step off the boot
+const float GOALIE_REACT_X = 20.0f;    // the goalie moves once the ball is past this
+
+long animationTicks = 0; // steps since start-up, for the idle cycles
+
+bool goalCelebrated = false; // once per kick
+
+// --- CAMERA ---
+float angleY = 0.0f;
+float angleX = 20.0f;
+float camDist = 140.0f; 
+float cameraHeight = 25.0f;
+float lookAtHeight = 0.0f;
+
+float cameraX = 0.0f, cameraY = cameraHeight, cameraZ = camDist;
+float targetX = 0.0f, targetY = lookAtHeight, targetZ = 0.0f;
+
+float deltaAngleY = 0.0f, deltaAngleX = 0.0f, deltaMove = 0.0f;
+
+void computeCameraPosition() {
+    angleY += deltaAngleY;
+    angleX += deltaAngleX;
+    if (angleX > 89.0f) angleX = 89.0f;
+    if (angleX < 5.0f) angleX = 5.0f; 
+
+    camDist += deltaMove;
+    if (camDist < 20.0f) camDist = 20.0f;
+    if (camDist > 300.0f) camDist = 300.0f; 
+
+    float radY = angleY * M_PI / 180.0f;
+    float radX = angleX * M_PI / 180.0f;
+
+    cameraY = lookAtHeight + camDist * sin(radX);
+    float distXZ = camDist * cos(radX);
+    cameraX = distXZ * sin(radY);
+    cameraZ = distXZ * cos(radY);
+}
+
+void currentPlayerSpots(PlayerSpot spots[NUM_PLAYERS]) {
+    // --- RED TEAM (Left Side, Facing Right) ---
+    float rotRed = 90.0f;
+    PlayerSpot red[6] = {
+        { -38.0f, 0.0f, true, rotRed },   // Goalkeeper
+        { -25.0f, -10.0f, true, rotRed }, // Defender
+        { -25.0f, 10.0f, true, rotRed },  // Defender
+        { -10.0f, -5.0f, true, rotRed },  // Midfielder
+        { -5.0f, 15.0f, true, rotRed },   // Midfielder
+        { strikerX, strikerZ, true, rotRed } // The Striker uses dynamic variables
+    };
+
+    // --- BLUE TEAM (Right Side, Facing Left) ---
+    float rotBlue = -90.0f;
+    PlayerSpot blue[6] = {
+        { 38.0f, goalieZ, false, rotBlue }, // The Goalie moves Z to dive
+        { 25.0f, -8.0f, false, rotBlue },   // Defender
+        { 25.0f, 8.0f, false, rotBlue },    // Defender
+        { 15.0f, 0.0f, false, rotBlue },    // Midfielder
+        { 8.0f, -15.0f, false, rotBlue },   // Midfielder
+        { 5.0f, 5.0f, false, rotBlue }      // Striker
+    };
+    for (int i = 0; i < 6; ++i) {
+        spots[i] = red[i];
+        spots[6 + i] = blue[i];
+    }
+}
+// --- Player animation ---
+
+const float STRIKER_START_X = -6.0f;
+const float RUN_CYCLE_DISTANCE = 2.6f;  // run-up per run cycle, so the feet keep up with the ground
+const float DIVE_BALL_TRAVEL = 30.0f;   // how far the ball goes during the dive
+const float BLEND_STEPS_BETWEEN_CLIPS = 6.0f;
+const float SUBSTITUTE_SPACING = 1.4f;
+
+static void playClip(AnimFigure& f, int clip, float phase) {
+    f.clip = clip;
+    f.phase = phase;
+    f.fromClip = -1;
+    f.fromPhase = 0.0f;
+    f.fromWeight = 0.0f;
+}
+
+// Fading out of another clip for BLEND_STEPS_BETWEEN_CLIPS steps
+static void blendFrom(AnimFigure& f, int clip, float phase, float stepsSince) {
+    float weight = 1.0f - stepsSince / BLEND_STEPS_BETWEEN_CLIPS;
+    if (weight <= 0.0f) return;
+    f.fromClip = clip;
+    f.fromPhase = phase;
+    f.fromWeight = std::min(weight, 1.0f);
+}
+
+static float idlePhase(int figure) {
+    return animationTicks / (clipSeconds(CLIP_IDLE) * SIM_TICK_RATE) + figure * 0.37f; // out of step
+}
+
+// Run-up, then the kick (timed by how far the ball has gone), then idle
+static void animateStriker(AnimFigure& f, int figure) {
+    float runPhase = (strikerX - STRIKER_START_X) / RUN_CYCLE_DISTANCE;
+    if (animStage == 1) {
+        playClip(f, CLIP_RUN, runPhase);
+        blendFrom(f, CLIP_IDLE, idlePhase(figure), (strikerX - STRIKER_START_X) / STRIKER_RUN_SPEED);
+    } else if (animStage == 2) {
+        float steps = ballX / KICK_BALL_SPEED;
+        float kickSteps = clipSeconds(CLIP_KICK) * SIM_TICK_RATE;
+        if (steps < kickSteps) {
+            playClip(f, CLIP_KICK, steps / kickSteps);
+            blendFrom(f, CLIP_RUN, runPhase, steps);
+        } else {
+            blendFrom(f, CLIP_KICK, 1.0f, steps - kickSteps); // f is already idling
+        }
+    }
+}
+
+// Towards the side of the goal the ball is on, once the ball is close
+static void animateGoalie(AnimFigure& f, int figure) {
+    if (animStage != 2 || ballX <= GOALIE_REACT_X) return;
+    float travel = ballX - GOALIE_REACT_X;
+    // Facing -x, the goalie's left is +z
+    playClip(f, ballZ >= 0.0f ? CLIP_DIVE_LEFT : CLIP_DIVE_RIGHT, travel / DIVE_BALL_TRAVEL);
+    blendFrom(f, CLIP_IDLE, idlePhase(figure), travel / KICK_BALL_SPEED);
+}
+
+void currentMatchFigures(AnimFigure figures[NUM_MATCH_FIGURES], bool isTeamRed[NUM_MATCH_FIGURES]) {
+    PlayerSpot spots[NUM_PLAYERS];
+    currentPlayerSpots(spots);
+    for (int i = 0; i < NUM_MATCH_FIGURES; ++i) {
+        AnimFigure& f = figures[i];
+        if (i < NUM_PLAYERS) {
+            f.x = spots[i].x;
+            f.z = spots[i].z;
+            f.yawDeg = spots[i].rotation;
+            isTeamRed[i] = spots[i].isTeamRed;
+        } else {
+            int sub = i - NUM_PLAYERS, perTeam = NUM_SUBSTITUTES / 2;
+            isTeamRed[i] = sub < perTeam;
+            f.x = (isTeamRed[i] ? -TEAM_BENCH_X : TEAM_BENCH_X) + (sub % perTeam - (perTeam - 1) * 0.5f) * SUBSTITUTE_SPACING;
+            f.z = TEAM_BENCH_Z + 2.0f;
+            f.yawDeg = 0.0f;
+        }
+        f.y = 0.0f;
+        playClip(f, CLIP_IDLE, idlePhase(i));
+    }
+    const int striker = NUM_PLAYERS / 2 - 1, goalie = NUM_PLAYERS / 2; // see currentPlayerSpots()
+    animateStriker(figures[striker], striker);
+    animateGoalie(figures[goalie], goalie);
+}
+
+void updateGameLogic() {
+    ++animationTicks;
+    if (!isPlaying) return;
+
+    // STAGE 1: Striker Runs to Ball
+    if (animStage == 1) {
+        if (strikerX < -0.8f) {
+            strikerX += STRIKER_RUN_SPEED;
+        } else {
+            // Reached ball, KICK!
+            animStage = 2;
+            ballVelX = KICK_BALL_SPEED; // Fast shot X
+            ballVelZ = 0.25f; // Slight curve Z
+        }
+    }
+
+    // STAGE 2: Ball Flies & Goalie Dives
+    if (animStage == 2) {
+        // Move Ball
+        ballX += ballVelX;
+        ballZ += ballVelZ;
+        ballRot += 20.0f; // Spin
+
+        // Move Goalie (Simple AI: Move towards ball Z)
+        // Only if ball is getting close
+        if (ballX > GOALIE_REACT_X) {
+            if (goalieZ < ballZ) goalieZ += 0.15f;
+            if (goalieZ > ballZ) goalieZ -= 0.15f;
+        }
+
+        // The scripted shot is the goal: celebrate as it crosses the line
+        if (!goalCelebrated && ballX > FIELD_X_RADIUS) {
+            goalCelebrated = true;
+            startGoalCelebration();
+            startCrowdCheer(true); // the red striker always scores
+        }
+
+        // Friction / Stop condition
+        if (ballX > 45.0f) { // Ball passed goal line
+            ballVelX *= 0.95f; // Slow down
+            ballVelZ *= 0.95f;
+            if (ballVelX < 0.01f) isPlaying = false; // Stop
+        }
+    }
+}
+
+void startKick() {
+    isPlaying = true;
+    animStage = 1; // Start Running
+
+    // Reset Positions
+    ballX = 0.0f; ballZ = 0.0f; ballRot = 0.0f;
+    strikerX = STRIKER_START_X; strikerZ = 0.0f;
+    goalieZ = 0.0f;
+    ballVelX = 0.0f; ballVelZ = 0.0f;
+    goalCelebrated = false;
+}
@@ -0,0 +1,402 @@
+#include "multiView.h"
+#include "stadium.h"
+#include "glExtensions.h"
+#include "sceneObjects.h"
+#include "renderStats.h"
+#include "viewMath.h"
+#include "vegetation.h"
+#include "cityTiles.h"
+#include "heatMap.h"
+#include "frameGovernor.h"
+#include "particles.h"
+#include "crowd.h"
+#include "sceneGraph.h"
+#include "occlusionCulling.h"
+#include <algorithm>
+#include <iostream>
+#include "glTrace.h"
+
+struct BroadcastCamera {
+    const char* name;
+    float eye[3], target[3], up[3];
+    float fovY;
+};
+
+struct RenderTarget {
+    GLuint fbo, colorTex, depthBuffer;
+    int width, height;
+};
+
+struct BroadcastView {
+    const char* name;
+    int camera;
+    bool offscreen;
+    RenderTarget target;
+    float refreshHz;     // 0 = every frame
+    double lastRefresh;
+    bool rendered;       // offscreen texture holds a picture yet
+};
+
+enum ViewId {
+    VIEW_DIRECTOR,
+    VIEW_MONITOR_GOAL,
+    VIEW_MONITOR_TACTICAL,
+    VIEW_MONITOR_VIP,
+    VIEW_JUMBOTRON,
+    NUM_VIEWS
+};
+
+enum BroadcastLayout {
+    LAYOUT_DIRECTOR,  // main window only
+    LAYOUT_MONITORS,  // main window + inset monitors down the right edge
+    NUM_LAYOUTS
+};
+
+const float VIEW_NEAR = 1.0f;
+const float VIEW_FAR = VIEW_FAR_DISTANCE;
+
+static BroadcastCamera cameras[NUM_BROADCAST_CAMERAS];
+static BroadcastView views[NUM_VIEWS] = {
+    { "DIRECTOR",    CAM_DIRECTOR,    false, { 0, 0, 0, 0, 0 },     0.0f, 0.0, false },
+    { "BEHIND GOAL", CAM_BEHIND_GOAL, true,  { 0, 0, 0, 480, 270 }, 30.0f, 0.0, false },
+    { "TACTICAL",    CAM_TACTICAL,    true,  { 0, 0, 0, 480, 270 }, 15.0f, 0.0, false },
+    { "VIP STAND",   CAM_VIP_STAND,   true,  { 0, 0, 0, 480, 270 }, 15.0f, 0.0, false },
+    { "JUMBOTRON",   CAM_BEHIND_GOAL, true,  { 0, 0, 0, 320, 180 }, 10.0f, 0.0, false }
+};
+static int layout = LAYOUT_DIRECTOR;
+static GLuint dynamicList = 0;
+
+// The director view when the governor lowers its resolution. Sized to the
+// window and rendered into its lower-left part, so only a resize reallocates.
+static RenderTarget scaledTarget = { 0, 0, 0, 0, 0 };
+
+// Per-frame shared data
+static float projMatrix[NUM_VIEWS][16];
+static float viewMatrix[NUM_VIEWS][16];
+static Frustum viewFrustum[NUM_VIEWS];
+static unsigned int objectViewMask[MAX_SCENE_OBJECTS]; // bit v set = visible to view v
+
+static void setVec(float v[3], float x, float y, float z) {
+    v[0] = x; v[1] = y; v[2] = z;
+}
+
+static void updateCameras() {
+    BroadcastCamera& director = cameras[CAM_DIRECTOR];
+    director.name = "DIRECTOR";
+    setVec(director.eye, cameraX, cameraY, cameraZ);
+    setVec(director.target, targetX, targetY, targetZ);
+    setVec(director.up, 0.0f, 1.0f, 0.0f);
+    director.fovY = 60.0f;
+
+    // Rig in the +X stand, panning with the ball but never past the goal mouth
+    BroadcastCamera& goal = cameras[CAM_BEHIND_GOAL];
+    goal.name = "BEHIND GOAL";
+    float followX = ballX < FIELD_X_RADIUS ? ballX : FIELD_X_RADIUS;
+    setVec(goal.eye, TRACK_OUTER_X_RADIUS + 5.0f, 14.0f, 0.0f);
+    setVec(goal.target, followX, 0.5f, ballZ);
+    setVec(goal.up, 0.0f, 1.0f, 0.0f);
+    goal.fovY = 40.0f;
+
+    BroadcastCamera& tactical = cameras[CAM_TACTICAL];
+    tactical.name = "TACTICAL";
+    setVec(tactical.eye, 0.0f, 140.0f, 0.0f);
+    setVec(tactical.target, 0.0f, 0.0f, 0.0f);
+    setVec(tactical.up, 0.0f, 0.0f, -1.0f); // looking straight down, so "up" is along the pitch
+    tactical.fovY = 40.0f;
+
+    BroadcastCamera& vip = cameras[CAM_VIP_STAND];
+    vip.name = "VIP STAND";
+    setVec(vip.eye, 0.0f, STADIUM_TOTAL_HEIGHT + 4.5f, -MAX_SEATING_Z_RADIUS - 5.0f);
+    setVec(vip.target, ballX, 0.0f, ballZ);
+    setVec(vip.up, 0.0f, 1.0f, 0.0f);
+    vip.fovY = 45.0f;
+}
+
+static void destroyRenderTarget(RenderTarget& t) {
+    if (t.fbo) glExt.DeleteFramebuffers(1, &t.fbo);
+    if (t.depthBuffer) glExt.DeleteRenderbuffers(1, &t.depthBuffer);
+    if (t.colorTex) glDeleteTextures(1, &t.colorTex);
+    t.fbo = t.colorTex = t.depthBuffer = 0;
+}
+
+static bool createRenderTarget(RenderTarget& t) {
+    glGenTextures(1, &t.colorTex);
+    glBindTexture(GL_TEXTURE_2D, t.colorTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, t.width, t.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glExt.GenRenderbuffers(1, &t.depthBuffer);
+    glExt.BindRenderbuffer(GL_RENDERBUFFER, t.depthBuffer);
+    glExt.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, t.width, t.height);
+    glExt.BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glExt.GenFramebuffers(1, &t.fbo);
+    glExt.BindFramebuffer(GL_FRAMEBUFFER, t.fbo);
+    glExt.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, t.colorTex, 0);
+    glExt.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, t.depthBuffer);
+    bool ok = glExt.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!ok) destroyRenderTarget(t);
+    return ok;
+}
+
+void initBroadcastViews() {
+    dynamicList = glGenLists(1);
+    initOcclusionCulling(NUM_VIEWS);
+    if (!glExt.hasFramebuffers) {
+        std::cerr << "Broadcast: no framebuffer objects, monitors and jumbotron disabled" << std::endl;
+        return;
+    }
+    for (int v = 0; v < NUM_VIEWS; ++v) {
+        if (views[v].offscreen && !createRenderTarget(views[v].target))
+            std::cerr << "Broadcast: could not create target for " << views[v].name << std::endl;
+    }
+}
+
+void cycleBroadcastLayout() {
+    layout = (layout + 1) % NUM_LAYOUTS;
+    // Monitors show a fresh picture straight away instead of a stale one
+    for (int v = VIEW_MONITOR_GOAL; v <= VIEW_MONITOR_VIP; ++v) views[v].rendered = false;
+}
+
+void cycleJumbotronCamera() {
+    BroadcastView& j = views[VIEW_JUMBOTRON];
+    j.camera = (j.camera + 1) % NUM_BROADCAST_CAMERAS;
+    j.rendered = false;
+}
+
+static bool viewIsDue(const BroadcastView& v, int id, double now) {
+    if (!v.offscreen) return true;
+    if (!v.target.fbo) return false;
+    if (id != VIEW_JUMBOTRON && layout != LAYOUT_MONITORS) return false;
+    if (!v.rendered || v.refreshHz <= 0.0f) return true;
+    return now - v.lastRefresh >= 1.0 / v.refreshHz;
+}
+
+// The jumbotron's picture, on the inner face of its frame
+static void drawJumbotronScreen(int currentView) {
+    float x = JUMBOTRON_X - 0.19f;
+    float halfW = JUMBOTRON_WIDTH / 2.0f, halfH = JUMBOTRON_HEIGHT / 2.0f;
+    const BroadcastView& j = views[VIEW_JUMBOTRON];
+    // The jumbotron camera can't sample the texture it is rendering into
+    bool showPicture = j.rendered && currentView != VIEW_JUMBOTRON;
+
+    glDisable(GL_LIGHTING);
+    if (showPicture) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, j.target.colorTex);
+        glColor3f(1.0f, 1.0f, 1.0f);
+    } else {
+        glColor3f(0.05f, 0.05f, 0.08f);
+    }
+
+    // Seen from the pitch (looking down -X) screen-right is -Z
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex3f(x, JUMBOTRON_Y - halfH,  halfW);
+    glTexCoord2f(1.0f, 0.0f); glVertex3f(x, JUMBOTRON_Y - halfH, -halfW);
+    glTexCoord2f(1.0f, 1.0f); glVertex3f(x, JUMBOTRON_Y + halfH, -halfW);
+    glTexCoord2f(0.0f, 1.0f); glVertex3f(x, JUMBOTRON_Y + halfH,  halfW);
+    glEnd();
+
+    if (showPicture) {
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_TEXTURE_2D);
+    }
+    glEnable(GL_LIGHTING);
+}
+
+static void renderView(int v) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(projMatrix[v]);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadMatrixf(viewMatrix[v]);
+
+    applyAllFloodlights();
+
+    unsigned int bit = 1u << v;
+    int drawn = 0;
+    // Occluders first, so the occlusion queries have their depth to test against
+    for (int i = 0; i < sceneObjectCount(); ++i) {
+        if (!(objectViewMask[i] & bit) || !sceneObject(i).occluder) continue;
+        drawSceneObject(i);
+        ++drawn;
+    }
+    const float* eye = cameras[views[v].camera].eye;
+    occlusionTestView(v, eye, viewFrustum[v]);
+    for (int i = 0; i < sceneObjectCount(); ++i) {
+        if (!(objectViewMask[i] & bit) || sceneObject(i).occluder || occlusionObjectHidden(v, i)) continue;
+        drawSceneObject(i);
+        ++drawn;
+    }
+    drawCity(viewFrustum[v]);
+    drawVegetation(eye, viewFrustum[v], occlusionHiddenCells(v));
+    drawCrowd(viewFrustum[v]);
+    glCallList(dynamicList);
+    drawJumbotronScreen(v);
+    drawParticles(); // blended, so after everything solid
+
+    statsAdd(STAT_VIEWS_RENDERED, 1);
+    statsAdd(STAT_OBJECTS_DRAWN, drawn);
+}
+
+// Inset monitors stacked down the right-hand edge of the window
+static void composeMonitors() {
+    int margin = 10;
+    int w = windowWidth / 4;
+    int h = w * 9 / 16;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+
+    for (int v = VIEW_MONITOR_GOAL; v <= VIEW_MONITOR_VIP; ++v) {
+        const BroadcastView& view = views[v];
+        if (!view.rendered) continue;
+        int k = v - VIEW_MONITOR_GOAL;
+        float x0 = (float)(windowWidth - w - margin);
+        float y0 = (float)(windowHeight - (k + 1) * (h + margin));
+
+        // Border
+        glColor3f(0.0f, 0.0f, 0.0f);
+        glRectf(x0 - 2.0f, y0 - 2.0f, x0 + w + 2.0f, y0 + h + 2.0f);
+
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, view.target.colorTex);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        glBegin(GL_QUADS);
+        glTexCoord2f(0.0f, 0.0f); glVertex2f(x0, y0);
+        glTexCoord2f(1.0f, 0.0f); glVertex2f(x0 + w, y0);
+        glTexCoord2f(1.0f, 1.0f); glVertex2f(x0 + w, y0 + h);
+        glTexCoord2f(0.0f, 1.0f); glVertex2f(x0, y0 + h);
+        glEnd();
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_TEXTURE_2D);
+
+        glColor3f(1.0f, 1.0f, 0.0f);
+        glRasterPos2f(x0 + 6.0f, y0 + 6.0f);
+        glutBitmapString(GLUT_BITMAP_HELVETICA_12, (const unsigned char*)view.name);
+    }
+
+    glEnable(GL_LIGHTING);
+    glEnable(GL_DEPTH_TEST);
+}
+
+static bool prepareScaledTarget() {
+    if (!glExt.hasFramebuffers) return false;
+    if (scaledTarget.width == windowWidth && scaledTarget.height == windowHeight) return scaledTarget.fbo != 0;
+    destroyRenderTarget(scaledTarget);
+    scaledTarget.width = windowWidth;
+    scaledTarget.height = windowHeight;
+    if (createRenderTarget(scaledTarget)) return true;
+    std::cerr << "Broadcast: could not create the scaled director target" << std::endl;
+    return false; // not retried until the window size changes
+}
+
+// Stretches the w x h corner of the scaled target over the whole window
+static void presentScaledDirector(int w, int h) {
+    float u = (float)w / scaledTarget.width, v = (float)h / scaledTarget.height;
+
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0.0, windowWidth, 0.0, windowHeight, -1.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, scaledTarget.colorTex);
+    glColor3f(1.0f, 1.0f, 1.0f);
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 0.0f); glVertex2f(0.0f, 0.0f);
+    glTexCoord2f(u, 0.0f);    glVertex2f((float)windowWidth, 0.0f);
+    glTexCoord2f(u, v);       glVertex2f((float)windowWidth, (float)windowHeight);
+    glTexCoord2f(0.0f, v);    glVertex2f(0.0f, (float)windowHeight);
+    glEnd();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_TEXTURE_2D);
+
+    glEnable(GL_LIGHTING);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void renderBroadcastFrame(double now) {
+    buildSceneObjects();
+    updateCameras();
+    updateCity(cameras[CAM_DIRECTOR].eye);
+
+    // --- 1. Which views render this frame, and their matrices ---
+    unsigned int dueMask = 0;
+    for (int v = 0; v < NUM_VIEWS; ++v) {
+        BroadcastView& view = views[v];
+        if (!viewIsDue(view, v, now)) continue;
+        dueMask |= 1u << v;
+
+        const BroadcastCamera& cam = cameras[view.camera];
+        float aspect = view.offscreen ? (float)view.target.width / view.target.height
+                                      : (float)windowWidth / (windowHeight > 0 ? windowHeight : 1);
+        perspectiveMatrix(cam.fovY, aspect, VIEW_NEAR, VIEW_FAR, projMatrix[v]);
+        lookAtMatrix(cam.eye, cam.target, cam.up, viewMatrix[v]);
+        float viewProj[16];
+        multiplyMatrices(projMatrix[v], viewMatrix[v], viewProj);
+        extractFrustum(viewProj, viewFrustum[v]);
+    }
+
+    // --- 2. Union cull: one pass over the objects for every due view ---
+    int culled = 0;
+    for (int i = 0; i < sceneObjectCount(); ++i) {
+        const Bounds& b = sceneObject(i).bounds;
+        unsigned int mask = 0;
+        for (int v = 0; v < NUM_VIEWS; ++v) {
+            if ((dueMask & (1u << v)) && boundsInFrustum(b, viewFrustum[v])) mask |= 1u << v;
+        }
+        objectViewMask[i] = mask;
+        if (!mask) ++culled;
+    }
+    statsAdd(STAT_OBJECTS_CULLED, culled);
+
+    // --- 3. Animated objects: run their draw code once, replay per view ---
+    glNewList(dynamicList, GL_COMPILE);
+    drawHeatMapOverlay();
+    drawSceneGraph(); // players and ball
+    drawPickHighlight();
+    glEndList();
+
+    // --- 4. Offscreen views first, so the window can show this frame's pictures ---
+    for (int v = 0; v < NUM_VIEWS; ++v) {
+        BroadcastView& view = views[v];
+        if (!view.offscreen || !(dueMask & (1u << v))) continue;
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, view.target.fbo);
+        glViewport(0, 0, view.target.width, view.target.height);
+        renderView(v);
+        view.rendered = true;
+        view.lastRefresh = now;
+    }
+    if (glExt.hasFramebuffers) glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // --- 5. Main window, at the governor's resolution when it has lowered it ---
+    float scale = governorRenderScale();
+    if (scale < 1.0f && prepareScaledTarget()) {
+        int w = std::max(1, (int)(windowWidth * scale)), h = std::max(1, (int)(windowHeight * scale));
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, scaledTarget.fbo);
+        glViewport(0, 0, w, h);
+        renderView(VIEW_DIRECTOR);
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, windowWidth, windowHeight);
+        presentScaledDirector(w, h);
+    } else {
+        glViewport(0, 0, windowWidth, windowHeight);
+        renderView(VIEW_DIRECTOR);
+    }
+    if (layout == LAYOUT_MONITORS) composeMonitors();
+}
@@ -0,0 +1,31 @@
+#ifndef MULTI_VIEW_H
+#define MULTI_VIEW_H
+
+// **********************************************
+// ************ BROADCAST RENDERER **************
+// **********************************************
+
+// Renders several cameras from one shared frame: the static batches, the
+// animated players/ball and the culled object set are built once, then
+// replayed into the main window, the inset monitors and the jumbotron.
+// Offscreen views refresh at their own rate.
+
+enum BroadcastCameraId {
+    CAM_DIRECTOR,    // the angleY/angleX/camDist orbit
+    CAM_BEHIND_GOAL, // behind the +X goal, following the ball
+    CAM_TACTICAL,    // straight down over the centre spot
+    CAM_VIP_STAND,   // from the VIP seats under the roof
+    NUM_BROADCAST_CAMERAS
+};
+
+// Call once after loadGLExtensions().
+void initBroadcastViews();
+
+// Draws the whole frame into the back buffer. timeSeconds drives the
+// per-view refresh rates (wall clock, or output time while capturing).
+void renderBroadcastFrame(double timeSeconds);
+
+void cycleBroadcastLayout();  // director only / director + inset monitors
+void cycleJumbotronCamera();
+
+#endif
@@ -0,0 +1,164 @@
+#include "occlusionCulling.h"
+#include "glExtensions.h"
+#include "sceneObjects.h"
+#include "vegetation.h"
+#include "renderStats.h"
+#include <iostream>
+#include <vector>
+#include "glTrace.h"
+
+// Boxes are grown a little so a candidate resting on an occluder is not
+// hidden by its own contact face
+const float OCCLUSION_BOX_MARGIN = 0.25f;
+// Closer than this to a box and its near faces may be clipped away: always visible
+const float OCCLUSION_EYE_MARGIN = 2.0f;
+
+struct OcclusionTest {
+    GLuint query;
+    unsigned int issuedRender; // the view render that asked, 0 = no query in flight
+};
+
+// Scene objects first, then vegetation cells, in both arrays
+struct ViewOcclusion {
+    unsigned int render;
+    std::vector<OcclusionTest> tests;
+    std::vector<unsigned char> hidden;
+};
+
+static bool supported = false;
+static bool enabled = true;
+static std::vector<ViewOcclusion> viewState;
+
+void initOcclusionCulling(int views) {
+    supported = glExt.hasOcclusionQueries;
+    viewState.resize(views);
+    if (!supported) std::cerr << "Occlusion: no occlusion queries, hidden objects are drawn" << std::endl;
+}
+
+void setOcclusionCulling(bool on) {
+    enabled = on;
+    // Start again from "everything visible"; answers still in flight go stale
+    for (size_t v = 0; v < viewState.size(); ++v) {
+        ViewOcclusion& s = viewState[v];
+        s.hidden.assign(s.hidden.size(), 0);
+        ++s.render;
+    }
+}
+
+void toggleOcclusionCulling() {
+    setOcclusionCulling(!enabled);
+    std::cout << "Occlusion culling " << (enabled ? "on" : "off") << std::endl;
+}
+
+static bool isCandidate(const SceneObject& o) {
+    return o.kind != OBJECT_GROUND && !o.occluder; // the ground is under everything
+}
+
+static bool eyeNear(const Bounds& b, const float eye[3]) {
+    for (int a = 0; a < 3; ++a) {
+        if (eye[a] < b.min[a] - OCCLUSION_EYE_MARGIN || eye[a] > b.max[a] + OCCLUSION_EYE_MARGIN) return false;
+    }
+    return true;
+}
+
+static void drawQueryBox(const Bounds& b) {
+    float x0 = b.min[0] - OCCLUSION_BOX_MARGIN, x1 = b.max[0] + OCCLUSION_BOX_MARGIN;
+    float y0 = b.min[1] - OCCLUSION_BOX_MARGIN, y1 = b.max[1] + OCCLUSION_BOX_MARGIN;
+    float z0 = b.min[2] - OCCLUSION_BOX_MARGIN, z1 = b.max[2] + OCCLUSION_BOX_MARGIN;
+    glBegin(GL_QUADS);
+    glVertex3f(x0, y0, z0); glVertex3f(x1, y0, z0); glVertex3f(x1, y1, z0); glVertex3f(x0, y1, z0);
+    glVertex3f(x0, y0, z1); glVertex3f(x0, y1, z1); glVertex3f(x1, y1, z1); glVertex3f(x1, y0, z1);
+    glVertex3f(x0, y0, z0); glVertex3f(x0, y1, z0); glVertex3f(x0, y1, z1); glVertex3f(x0, y0, z1);
+    glVertex3f(x1, y0, z0); glVertex3f(x1, y0, z1); glVertex3f(x1, y1, z1); glVertex3f(x1, y1, z0);
+    glVertex3f(x0, y0, z0); glVertex3f(x0, y0, z1); glVertex3f(x1, y0, z1); glVertex3f(x1, y0, z0);
+    glVertex3f(x0, y1, z0); glVertex3f(x1, y1, z0); glVertex3f(x1, y1, z1); glVertex3f(x0, y1, z1);
+    glEnd();
+}
+
+// Reads whatever answers have arrived. Only one asked on the view's previous
+// render may hide something; an older one was asked from another viewpoint
+// and can only reveal.
+static void collectResults(ViewOcclusion& s) {
+    for (size_t i = 0; i < s.tests.size(); ++i) {
+        OcclusionTest& t = s.tests[i];
+        if (!t.issuedRender) continue;
+        GLuint available = 0;
+        glExt.GetQueryObjectuiv(t.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue; // still in flight: keep the previous answer
+        GLuint samples = 0;
+        glExt.GetQueryObjectuiv(t.query, GL_QUERY_RESULT, &samples);
+        if (t.issuedRender + 1 == s.render) s.hidden[i] = samples == 0;
+        else if (samples) s.hidden[i] = 0;
+        t.issuedRender = 0;
+    }
+}
+
+// Queries the box unless the answer from an earlier one is still pending.
+// Returns whether the candidate counts as hidden this render.
+static bool testCandidate(ViewOcclusion& s, size_t i, const Bounds& b, const float eye[3], const Frustum& frustum) {
+    if (!boundsInFrustum(b, frustum) || eyeNear(b, eye)) {
+        s.hidden[i] = 0; // drawn as soon as it is back in view, then asked about
+        return false;
+    }
+    OcclusionTest& t = s.tests[i];
+    if (!t.issuedRender) {
+        glExt.BeginQuery(GL_SAMPLES_PASSED, t.query);
+        drawQueryBox(b);
+        glExt.EndQuery(GL_SAMPLES_PASSED);
+        t.issuedRender = s.render;
+    }
+    return s.hidden[i] != 0;
+}
+
+void occlusionTestView(int view, const float eye[3], const Frustum& frustum) {
+    if (!supported || !enabled) return;
+    ViewOcclusion& s = viewState[view];
+    int objects = sceneObjectCount(), plantCells = vegetationCellCount();
+    if (s.tests.empty()) { // sized on first use, once the scene and the park exist
+        size_t count = objects + plantCells;
+        std::vector<GLuint> ids(count);
+        glExt.GenQueries((GLsizei)count, &ids[0]);
+        s.tests.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            s.tests[i].query = ids[i];
+            s.tests[i].issuedRender = 0;
+        }
+        s.hidden.assign(count, 0);
+    }
+    ++s.render;
+    collectResults(s);
+
+    // Invisible boxes: depth tested against the occluders, nothing written
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+
+    long hiddenObjects = 0, hiddenCells = 0;
+    for (int i = 0; i < objects; ++i) {
+        const SceneObject& o = sceneObject(i);
+        if (isCandidate(o) && testCandidate(s, i, o.bounds, eye, frustum)) ++hiddenObjects;
+    }
+    for (int c = 0; c < plantCells; ++c) {
+        if (testCandidate(s, objects + c, vegetationCellBounds(c), eye, frustum)) ++hiddenCells;
+    }
+
+    glPopAttrib();
+    statsAdd(STAT_OCCLUDED_OBJECTS, hiddenObjects);
+    statsAdd(STAT_OCCLUDED_CELLS, hiddenCells);
+}
+
+bool occlusionObjectHidden(int view, int object) {
+    if (!supported || !enabled) return false;
+    const ViewOcclusion& s = viewState[view];
+    return object < (int)s.hidden.size() && s.hidden[object];
+}
+
+const unsigned char* occlusionHiddenCells(int view) {
+    if (!supported || !enabled) return 0;
+    const ViewOcclusion& s = viewState[view];
+    return s.hidden.size() > (size_t)sceneObjectCount() ? &s.hidden[sceneObjectCount()] : 0;
+}
@@ -0,0 +1,31 @@
+#ifndef OCCLUSION_CULLING_H
+#define OCCLUSION_CULLING_H
+
+#include "viewMath.h"
+
+// **********************************************
+// ************ OCCLUSION CULLING ***************
+// **********************************************
+
+// Skips seat sectors, floodlight towers, stands and tree cells hidden behind
+// the big occluders: the stone facade, the grandstand and its roof. A view
+// draws the occluders first; then every other object and tree cell in its
+// frustum has its bounding box drawn, invisibly, inside an occlusion query
+// against that depth. The answers are collected on the view's next render
+// if the GPU has them ready and never waited for, so something coming into
+// sight shows up at most a frame late.
+
+// Call once after loadGLExtensions(). Without query support nothing is hidden.
+void initOcclusionCulling(int views);
+void setOcclusionCulling(bool enabled);
+void toggleOcclusionCulling();
+
+// Call between the occluders and everything else: picks up the view's last
+// answers, then asks this render's questions.
+void occlusionTestView(int view, const float eye[3], const Frustum& frustum);
+
+bool occlusionObjectHidden(int view, int object);
+// A byte per vegetation cell, non-zero when hidden; 0 when culling is off
+const unsigned char* occlusionHiddenCells(int view);
+
+#endif
@@ -0,0 +1,64 @@
+#include "particles.h"
+#include "glExtensions.h"
+#include "renderStats.h"
+#include <cstddef>
+#include "glTrace.h"
+
+// One streaming buffer per effect, grown only when a frame needs more room
+static GLuint buffers[NUM_PARTICLE_TYPES];
+static size_t bufferBytes[NUM_PARTICLE_TYPES];
+static int vertexCounts[NUM_PARTICLE_TYPES];
+
+void uploadParticles() {
+    buildParticleVertices();
+    long live = 0;
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        live += liveParticles((ParticleType)t);
+        const ParticleVertex* v = particleVertices((ParticleType)t, vertexCounts[t]);
+        if (!vertexCounts[t] || !glExt.hasVertexBuffers) continue;
+
+        size_t bytes = vertexCounts[t] * sizeof(ParticleVertex);
+        if (!buffers[t]) glExt.GenBuffers(1, &buffers[t]);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, buffers[t]);
+        if (bytes > bufferBytes[t]) bufferBytes[t] = bytes;
+        glExt.BufferData(GL_ARRAY_BUFFER, bufferBytes[t], 0, GL_STREAM_DRAW); // orphan last frame's copy
+        glExt.BufferSubData(GL_ARRAY_BUFFER, 0, bytes, v);
+    }
+    if (glExt.hasVertexBuffers) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    statsAdd(STAT_PARTICLES, live);
+}
+
+// Unlit, no depth writes: rain streaks and sparks blend, confetti is opaque
+void drawParticles() {
+    static const GLenum MODE[NUM_PARTICLE_TYPES] = { GL_LINES, GL_POINTS, GL_POINTS };
+    static const float POINT_SIZE[NUM_PARTICLE_TYPES] = { 1.0f, 3.0f, 4.0f };
+
+    glDisable(GL_LIGHTING);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        if (!vertexCounts[t]) continue;
+        const char* base = 0;
+        if (glExt.hasVertexBuffers) glExt.BindBuffer(GL_ARRAY_BUFFER, buffers[t]);
+        else base = (const char*)particleVertices((ParticleType)t, vertexCounts[t]);
+
+        if (t != PARTICLE_CONFETTI) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, t == PARTICLE_PYRO ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask(GL_FALSE);
+        }
+        glPointSize(POINT_SIZE[t]);
+        glVertexPointer(3, GL_FLOAT, sizeof(ParticleVertex), base + offsetof(ParticleVertex, pos));
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(ParticleVertex), base + offsetof(ParticleVertex, color));
+        glDrawArrays(MODE[t], 0, vertexCounts[t]);
+        if (t != PARTICLE_CONFETTI) {
+            glDepthMask(GL_TRUE);
+            glDisable(GL_BLEND);
+        }
+    }
+    if (glExt.hasVertexBuffers) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glPointSize(1.0f);
+    glEnable(GL_LIGHTING);
+}
@@ -0,0 +1,358 @@
+#include "particles.h"
+#include "jobSystem.h"
+#include "stadium.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Particles per chunk: the unit of work for a job and of compaction
+const int PARTICLE_CHUNK = 8192;
+
+// Share of the capacity each effect gets
+static const float TYPE_SHARE[NUM_PARTICLE_TYPES] = { 0.6f, 0.25f, 0.15f };
+
+// --- Rain: a box over the bowl, lit by the floodlights ---
+const float RAIN_HALF_X = 95.0f;
+const float RAIN_HALF_Z = 75.0f;
+const float RAIN_HEIGHT = 70.0f;
+const float RAIN_FALL_SPEED = 22.0f;
+const float RAIN_WIND = 1.5f;
+const float RAIN_FILL_SECONDS = 3.0f;   // from dry to a full pool
+const float RAIN_STREAK_SECONDS = 0.03f; // streak length as a time step of the fall
+
+// --- Goal celebration ---
+const float CELEBRATION_SECONDS = 6.0f;
+const float CONFETTI_LIFE = 14.0f;
+const float PYRO_LIFE = 1.6f;
+const float PYRO_FADE = 0.5f;            // sparks fade out over their last half second
+const int NUM_PYRO_FOUNTAINS = 6;
+static const float PYRO_FOUNTAIN_Z[NUM_PYRO_FOUNTAINS] = { -24.0f, -15.0f, -8.0f, 8.0f, 15.0f, 24.0f };
+
+const float GRAVITY = -9.8f;
+
+enum GroundRule {
+    GROUND_WRAP,  // back to the top of the box (rain while it is raining)
+    GROUND_REST,  // lies on the grass until its life runs out
+    GROUND_DIE
+};
+
+struct ParticlePool {
+    int capacity, chunkCount;
+    float drag;
+    int ground;
+    // SoA, PARTICLE_CHUNK slots per chunk; chunk c's live particles are packed
+    // at the front of its slots
+    std::vector<float> x, y, z, vx, vy, vz, life;
+    std::vector<unsigned int> color;
+    std::vector<int> chunkLive;
+    std::vector<unsigned int> chunkSeed;
+    std::vector<int> chunkFirstVertex;
+    std::vector<ParticleVertex> vertices;
+    int vertexCount;
+    float emitCarry;     // fractional particles owed to the next step
+    int emitThisStep;
+};
+
+static ParticlePool pools[NUM_PARTICLE_TYPES];
+static bool ready = false;
+static bool rainOn = false;
+static float celebrationLeft = 0.0f;
+
+// Per-step job context
+static float stepDt = 0.0f;
+
+// xorshift32 per chunk, so chunks emit in parallel and repeatably
+static unsigned int nextRandom(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+static float randomRange(unsigned int& state, float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+// RGBA bytes in memory order, as the vertices want them
+static unsigned int packColor(int r, int g, int b, int a) {
+    unsigned char bytes[4] = { (unsigned char)r, (unsigned char)g, (unsigned char)b, (unsigned char)a };
+    unsigned int c;
+    std::memcpy(&c, bytes, sizeof(c));
+    return c;
+}
+
+// **********************************************
+// ************ POOLS ***************************
+// **********************************************
+
+void initParticles(int capacity) {
+    static const float DRAG[NUM_PARTICLE_TYPES] = { 0.0f, 1.6f, 0.3f };
+    static const int GROUND[NUM_PARTICLE_TYPES] = { GROUND_WRAP, GROUND_REST, GROUND_DIE };
+    static const int VERTICES_PER[NUM_PARTICLE_TYPES] = { 2, 1, 1 };
+
+    size_t bytes = 0;
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        ParticlePool& p = pools[t];
+        p.chunkCount = std::max(1, (int)std::ceil(capacity * TYPE_SHARE[t] / PARTICLE_CHUNK));
+        p.capacity = p.chunkCount * PARTICLE_CHUNK;
+        p.drag = DRAG[t];
+        p.ground = GROUND[t];
+        std::vector<float>* arrays[] = { &p.x, &p.y, &p.z, &p.vx, &p.vy, &p.vz, &p.life };
+        for (int a = 0; a < 7; ++a) arrays[a]->assign(p.capacity, 0.0f);
+        p.color.assign(p.capacity, 0);
+        p.chunkLive.assign(p.chunkCount, 0);
+        p.chunkFirstVertex.assign(p.chunkCount, 0);
+        p.chunkSeed.resize(p.chunkCount);
+        for (int c = 0; c < p.chunkCount; ++c) p.chunkSeed[c] = 2463534242u + 977u * (t * 4096 + c + 1);
+        p.vertices.assign((size_t)p.capacity * VERTICES_PER[t], ParticleVertex());
+        p.vertexCount = 0;
+        p.emitCarry = 0.0f;
+        p.emitThisStep = 0;
+        bytes += (size_t)p.capacity * (8 * sizeof(float) + VERTICES_PER[t] * sizeof(ParticleVertex));
+    }
+    ready = true;
+    std::cout << "Particles: " << pools[PARTICLE_RAIN].capacity << " rain, " << pools[PARTICLE_CONFETTI].capacity
+              << " confetti, " << pools[PARTICLE_PYRO].capacity << " sparks, " << bytes / (1024 * 1024) << " MB" << std::endl;
+}
+
+int liveParticles(ParticleType type) {
+    const ParticlePool& p = pools[type];
+    int live = 0;
+    for (int c = 0; c < p.chunkCount; ++c) live += p.chunkLive[c];
+    return live;
+}
+
+void startGoalCelebration() {
+    celebrationLeft = CELEBRATION_SECONDS;
+}
+
+// **********************************************
+// ************ EMISSION ************************
+// **********************************************
+
+static void emitRain(ParticlePool& p, int i, unsigned int& seed) {
+    p.x[i] = randomRange(seed, -RAIN_HALF_X, RAIN_HALF_X);
+    p.y[i] = randomRange(seed, 0.0f, RAIN_HEIGHT); // through the whole column, not as one sheet
+    p.z[i] = randomRange(seed, -RAIN_HALF_Z, RAIN_HALF_Z);
+    p.vx[i] = RAIN_WIND;
+    p.vy[i] = -RAIN_FALL_SPEED * randomRange(seed, 0.85f, 1.15f);
+    p.vz[i] = 0.0f;
+    p.life[i] = 2.0f * RAIN_HEIGHT / RAIN_FALL_SPEED; // only counts down once the rain stops
+    p.color[i] = packColor(175, 185, 215, 90);
+}
+
+// Thrown from the top of the bowl towards the pitch
+static void emitConfetti(ParticlePool& p, int i, unsigned int& seed) {
+    static const unsigned int PALETTE[5] = {
+        packColor(230, 30, 30, 255), packColor(30, 60, 230, 255), packColor(250, 250, 250, 255),
+        packColor(250, 210, 20, 255), packColor(30, 190, 60, 255)
+    };
+    float angle = randomRange(seed, 0.0f, 2.0f * (float)M_PI);
+    float c = std::cos(angle), s = std::sin(angle);
+    float inward = randomRange(seed, 5.0f, 12.0f);
+    p.x[i] = MAX_SEATING_X_RADIUS * 0.95f * c;
+    p.y[i] = STADIUM_TOTAL_HEIGHT + randomRange(seed, 2.0f, 5.0f);
+    p.z[i] = MAX_SEATING_Z_RADIUS * 0.95f * s;
+    p.vx[i] = -inward * c + randomRange(seed, -1.5f, 1.5f);
+    p.vy[i] = randomRange(seed, 3.0f, 9.0f);
+    p.vz[i] = -inward * s + randomRange(seed, -1.5f, 1.5f);
+    p.life[i] = CONFETTI_LIFE * randomRange(seed, 0.7f, 1.0f);
+    p.color[i] = PALETTE[nextRandom(seed) % 5];
+}
+
+// Fountains of sparks along the back of the +X goal
+static void emitPyro(ParticlePool& p, int i, unsigned int& seed) {
+    int fountain = nextRandom(seed) % NUM_PYRO_FOUNTAINS;
+    p.x[i] = FIELD_X_RADIUS + 6.0f;
+    p.y[i] = 0.2f;
+    p.z[i] = PYRO_FOUNTAIN_Z[fountain];
+    p.vx[i] = randomRange(seed, -2.5f, 2.5f);
+    p.vy[i] = randomRange(seed, 16.0f, 24.0f);
+    p.vz[i] = randomRange(seed, -2.5f, 2.5f);
+    p.life[i] = PYRO_LIFE * randomRange(seed, 0.7f, 1.3f);
+    p.color[i] = nextRandom(seed) & 1 ? packColor(255, 190, 60, 255) : packColor(255, 120, 30, 255);
+}
+
+typedef void (*EmitFunction)(ParticlePool& p, int i, unsigned int& seed);
+static const EmitFunction EMITTERS[NUM_PARTICLE_TYPES] = { emitRain, emitConfetti, emitPyro };
+
+// How many particles each effect starts this step, shared out over the chunks
+static void planEmission(float dt) {
+    float rate[NUM_PARTICLE_TYPES] = { 0.0f, 0.0f, 0.0f };
+    if (rainOn) rate[PARTICLE_RAIN] = pools[PARTICLE_RAIN].capacity / RAIN_FILL_SECONDS;
+    if (celebrationLeft > 0.0f) {
+        rate[PARTICLE_CONFETTI] = pools[PARTICLE_CONFETTI].capacity / (CELEBRATION_SECONDS * 1.2f);
+        rate[PARTICLE_PYRO] = pools[PARTICLE_PYRO].capacity / (PYRO_LIFE * 1.3f);
+        celebrationLeft -= dt;
+    }
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        ParticlePool& p = pools[t];
+        float wanted = p.emitCarry + rate[t] * dt;
+        p.emitThisStep = (int)wanted;
+        p.emitCarry = rate[t] > 0.0f ? wanted - p.emitThisStep : 0.0f;
+    }
+}
+
+// **********************************************
+// ************ UPDATE **************************
+// **********************************************
+
+// Integrates [first, first + count); count is rounded up to four, which
+// stays inside the chunk because PARTICLE_CHUNK is a multiple of four.
+static void integrate(ParticlePool& p, int first, int count, float dt) {
+    float* x = &p.x[first]; float* y = &p.y[first]; float* z = &p.z[first];
+    float* vx = &p.vx[first]; float* vy = &p.vy[first]; float* vz = &p.vz[first];
+    float* life = &p.life[first];
+    float keep = 1.0f - p.drag * dt;
+    bool wrap = p.ground == GROUND_WRAP && rainOn;
+#ifdef __SSE2__
+    __m128 vDt = _mm_set1_ps(dt), vKeep = _mm_set1_ps(keep), vGravity = _mm_set1_ps(GRAVITY * dt);
+    __m128 zero = _mm_setzero_ps(), height = _mm_set1_ps(RAIN_HEIGHT);
+    __m128 edge = _mm_set1_ps(RAIN_HALF_X), width = _mm_set1_ps(2.0f * RAIN_HALF_X);
+    for (int i = 0; i < count; i += 4) {
+        __m128 u = _mm_mul_ps(_mm_loadu_ps(vx + i), vKeep);
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), vKeep), vGravity);
+        __m128 w = _mm_mul_ps(_mm_loadu_ps(vz + i), vKeep);
+        __m128 px = _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(u, vDt));
+        __m128 py = _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(v, vDt));
+        __m128 pz = _mm_add_ps(_mm_loadu_ps(z + i), _mm_mul_ps(w, vDt));
+        __m128 l = _mm_sub_ps(_mm_loadu_ps(life + i), vDt);
+        __m128 below = _mm_cmplt_ps(py, zero);
+
+        if (wrap) {
+            py = _mm_add_ps(py, _mm_and_ps(below, height));
+            px = _mm_sub_ps(px, _mm_and_ps(_mm_cmpgt_ps(px, edge), width));
+            l = _mm_add_ps(l, vDt); // rain lives until the rain stops
+        } else if (p.ground == GROUND_REST) {
+            py = _mm_max_ps(py, zero);
+            u = _mm_andnot_ps(below, u);
+            v = _mm_andnot_ps(below, v);
+            w = _mm_andnot_ps(below, w);
+        } else {
+            l = _mm_or_ps(_mm_and_ps(below, _mm_set1_ps(-1.0f)), _mm_andnot_ps(below, l));
+        }
+
+        _mm_storeu_ps(vx + i, u); _mm_storeu_ps(vy + i, v); _mm_storeu_ps(vz + i, w);
+        _mm_storeu_ps(x + i, px); _mm_storeu_ps(y + i, py); _mm_storeu_ps(z + i, pz);
+        _mm_storeu_ps(life + i, l);
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        vx[i] *= keep;
+        vy[i] = vy[i] * keep + GRAVITY * dt;
+        vz[i] *= keep;
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        z[i] += vz[i] * dt;
+        if (wrap) {
+            if (y[i] < 0.0f) y[i] += RAIN_HEIGHT;
+            if (x[i] > RAIN_HALF_X) x[i] -= 2.0f * RAIN_HALF_X;
+        } else {
+            life[i] -= dt;
+            if (y[i] < 0.0f) {
+                if (p.ground == GROUND_REST) {
+                    y[i] = 0.0f;
+                    vx[i] = vy[i] = vz[i] = 0.0f;
+                } else {
+                    life[i] = -1.0f;
+                }
+            }
+        }
+    }
+#endif
+}
+
+// Moves the last live particle into each dead slot; order does not matter
+static int compact(ParticlePool& p, int first, int live) {
+    for (int i = first; i < first + live;) {
+        if (p.life[i] > 0.0f) {
+            ++i;
+            continue;
+        }
+        int last = first + --live;
+        p.x[i] = p.x[last]; p.y[i] = p.y[last]; p.z[i] = p.z[last];
+        p.vx[i] = p.vx[last]; p.vy[i] = p.vy[last]; p.vz[i] = p.vz[last];
+        p.life[i] = p.life[last];
+        p.color[i] = p.color[last];
+    }
+    return live;
+}
+
+static void updateChunkJob(int job, int, void* context) {
+    ParticlePool& p = *(ParticlePool*)context;
+    int first = job * PARTICLE_CHUNK;
+    int live = p.chunkLive[job];
+    integrate(p, first, (live + 3) & ~3, stepDt);
+    live = compact(p, first, live);
+
+    // This chunk's share of the new particles, as far as it has room
+    int share = p.emitThisStep / p.chunkCount + (job < p.emitThisStep % p.chunkCount ? 1 : 0);
+    int count = std::min(share, PARTICLE_CHUNK - live);
+    EmitFunction emit = EMITTERS[&p - pools];
+    for (int i = 0; i < count; ++i) emit(p, first + live + i, p.chunkSeed[job]);
+    p.chunkLive[job] = live + count;
+}
+
+void updateParticles(float dt, bool raining) {
+    if (!ready) return;
+    rainOn = raining;
+    stepDt = dt;
+    planEmission(dt);
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        ParticlePool& p = pools[t];
+        bool idle = p.emitThisStep == 0;
+        for (int c = 0; c < p.chunkCount && idle; ++c) idle = p.chunkLive[c] == 0;
+        if (!idle) parallelFor(p.chunkCount, updateChunkJob, &p);
+    }
+}
+
+// **********************************************
+// ************ VERTICES ************************
+// **********************************************
+
+static void vertexChunkJob(int job, int, void* context) {
+    ParticlePool& p = *(ParticlePool*)context;
+    int type = (int)(&p - pools);
+    int first = job * PARTICLE_CHUNK, live = p.chunkLive[job];
+    ParticleVertex* out = &p.vertices[p.chunkFirstVertex[job]];
+
+    for (int i = first; i < first + live; ++i) {
+        out->pos[0] = p.x[i]; out->pos[1] = p.y[i]; out->pos[2] = p.z[i];
+        std::memcpy(out->color, &p.color[i], 4);
+        if (type == PARTICLE_PYRO && p.life[i] < PYRO_FADE) out->color[3] = (unsigned char)(255.0f * p.life[i] / PYRO_FADE);
+        ++out;
+        if (type == PARTICLE_RAIN) { // tail of the streak
+            out->pos[0] = p.x[i] - p.vx[i] * RAIN_STREAK_SECONDS;
+            out->pos[1] = p.y[i] - p.vy[i] * RAIN_STREAK_SECONDS;
+            out->pos[2] = p.z[i];
+            std::memcpy(out->color, out[-1].color, 4);
+            out->color[3] = 0;
+            ++out;
+        }
+    }
+}
+
+void buildParticleVertices() {
+    if (!ready) return;
+    for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) {
+        ParticlePool& p = pools[t];
+        int perParticle = t == PARTICLE_RAIN ? 2 : 1;
+        int total = 0;
+        for (int c = 0; c < p.chunkCount; ++c) {
+            p.chunkFirstVertex[c] = total;
+            total += p.chunkLive[c] * perParticle;
+        }
+        p.vertexCount = total;
+        if (total) parallelFor(p.chunkCount, vertexChunkJob, &p);
+    }
+}
+
+const ParticleVertex* particleVertices(ParticleType type, int& vertexCount) {
+    vertexCount = ready ? pools[type].vertexCount : 0;
+    return vertexCount ? &pools[type].vertices[0] : 0;
+}
@@ -0,0 +1,49 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+// **********************************************
+// ************ PARTICLE EFFECTS ****************
+// **********************************************
+
+// Rain at night, and confetti and pyrotechnics when a goal goes in. Each
+// effect owns a fixed pool allocated once by initParticles(): positions,
+// velocities, lifetimes and colours in separate arrays, cut into chunks
+// that are updated (SSE2, four particles at a time), compacted and refilled
+// independently, so the chunks can run on the job system. Once a frame the
+// live particles are packed into one vertex array per effect and drawn with
+// a single call each: rain as short streaks, confetti and sparks as points.
+// Nothing is allocated after initParticles().
+
+enum ParticleType {
+    PARTICLE_RAIN,
+    PARTICLE_CONFETTI,
+    PARTICLE_PYRO,
+    NUM_PARTICLE_TYPES
+};
+
+struct ParticleVertex {
+    float pos[3];
+    unsigned char color[4];
+};
+
+// capacity is the total over all effects. Uses the job system if started.
+void initParticles(int capacity);
+
+// One simulation step. raining starts or stops the rain.
+void updateParticles(float dt, bool raining);
+
+// Confetti from the stands and fountains of sparks behind the goal
+void startGoalCelebration();
+
+int liveParticles(ParticleType type);
+
+// Packs the live particles for drawing; once a frame, after the updates.
+// Rain has two vertices (a streak) per particle, the others one.
+void buildParticleVertices();
+const ParticleVertex* particleVertices(ParticleType type, int& vertexCount);
+
+// particleRender.cpp: uploads this frame's vertices, then one draw per effect
+void uploadParticles();
+void drawParticles();
+
+#endif
@@ -0,0 +1,108 @@
+#include "renderStats.h"
+#include "heapTracking.h"
+#include <chrono>
+#include <cstdio>
+
+static const char* STAT_NAMES[NUM_RENDER_STATS] = {
+    "views",
+    "drawn",
+    "culled",
+    "plants",
+    "impostors",
+    "tiles",
+    "uploads",
+    "cityKB",
+    "seatRanges",
+    "scale%",
+    "cpuUs",
+    "gpuUs",
+    "swapUs",
+    "particles",
+    "arenaKB",
+    "allocs",
+    "allocKB",
+    "nodes",
+    "occluded",
+    "occludedCells",
+    "figures",
+    "poseBlends",
+    "crowd"
+};
+
+// Frames of loading and first uploads before allocations count as leaks
+const int HEAP_CHECK_WARMUP_FRAMES = 300;
+
+typedef std::chrono::steady_clock StatsClock;
+
+static bool enabled = false;
+static long frameCounters[NUM_RENDER_STATS];
+static long windowCounters[NUM_RENDER_STATS];
+static int windowFrames = 0;
+static double windowFrameMs = 0.0, windowWorstMs = 0.0;
+static StatsClock::time_point frameStart, windowStart;
+
+static bool heapCheck = false;
+static long framesShown = 0;
+static HeapCounts lastHeap = { 0, 0 };
+static StatsClock::time_point lastHeapReport;
+
+void statsEnable(bool on) {
+    enabled = on;
+    windowStart = StatsClock::now();
+}
+
+bool statsEnabled() {
+    return enabled;
+}
+
+void statsAdd(RenderStat stat, long amount) {
+    frameCounters[stat] += amount;
+}
+
+void statsHeapCheck(bool on) {
+    heapCheck = on;
+}
+
+// Rate-limited: a leak in every frame should not flood the console
+static void reportFrameAllocations(long allocations, long bytes, StatsClock::time_point now) {
+    if (std::chrono::duration<double>(now - lastHeapReport).count() < 1.0) return;
+    lastHeapReport = now;
+    std::fprintf(stderr, "[heap] frame %ld made %ld allocations (%ld bytes)\n", framesShown, allocations, bytes);
+}
+
+void statsFrameBegin() {
+    for (int i = 0; i < NUM_RENDER_STATS; ++i) frameCounters[i] = 0;
+    frameStart = StatsClock::now();
+}
+
+void statsFrameEnd() {
+    StatsClock::time_point now = StatsClock::now();
+    HeapCounts heap = threadHeapCounts();
+    long allocations = heap.allocations - lastHeap.allocations, bytes = heap.bytes - lastHeap.bytes;
+    lastHeap = heap;
+    frameCounters[STAT_HEAP_ALLOCS] += allocations;
+    frameCounters[STAT_HEAP_KB] += bytes / 1024;
+    if (heapCheck && ++framesShown > HEAP_CHECK_WARMUP_FRAMES && allocations) {
+        reportFrameAllocations(allocations, bytes, now);
+    }
+    if (!enabled) return;
+    double ms = std::chrono::duration<double, std::milli>(now - frameStart).count();
+    windowFrameMs += ms;
+    if (ms > windowWorstMs) windowWorstMs = ms;
+    for (int i = 0; i < NUM_RENDER_STATS; ++i) windowCounters[i] += frameCounters[i];
+    ++windowFrames;
+
+    double elapsed = std::chrono::duration<double>(now - windowStart).count();
+    if (elapsed < 1.0) return;
+
+    std::fprintf(stderr, "[stats] %.1f fps, frame %.2f ms avg / %.2f worst",
+                 windowFrames / elapsed, windowFrameMs / windowFrames, windowWorstMs);
+    for (int i = 0; i < NUM_RENDER_STATS; ++i) {
+        std::fprintf(stderr, ", %s %.1f", STAT_NAMES[i], (double)windowCounters[i] / windowFrames);
+        windowCounters[i] = 0;
+    }
+    std::fprintf(stderr, "\n");
+    windowFrames = 0;
+    windowFrameMs = windowWorstMs = 0.0;
+    windowStart = now;
+}
@@ -0,0 +1,47 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// **********************************************
+// ************ RENDER STATISTICS ***************
+// **********************************************
+
+// Per-frame counters, averaged and printed to stderr once a second when
+// enabled with --stats. Modules bump them with statsAdd(). The heap
+// counters cover the whole main loop (idle and display), and with
+// --heap-check any frame after warm-up that allocates is reported.
+
+enum RenderStat {
+    STAT_VIEWS_RENDERED,   // cameras drawn this frame (screen + offscreen)
+    STAT_OBJECTS_DRAWN,    // static batches submitted, summed over views
+    STAT_OBJECTS_CULLED,   // static batches outside every camera this frame
+    STAT_PLANTS_MESH,      // trees and shrubs drawn as meshes, summed over views
+    STAT_PLANTS_IMPOSTOR,  // trees and shrubs drawn as billboards, summed over views
+    STAT_CITY_TILES,       // city tiles drawn, summed over views
+    STAT_CITY_UPLOADS,     // city tiles uploaded to the GPU this frame
+    STAT_CITY_KB,          // memory held by city tiles
+    STAT_SEAT_RANGES,      // seat colour ranges uploaded this frame
+    STAT_RENDER_SCALE,     // director view resolution, percent of the window
+    STAT_FRAME_CPU_US,     // governor: CPU time from the last swap up to this one
+    STAT_FRAME_GPU_US,     // governor: GPU time of a recent frame (timer queries)
+    STAT_SWAP_INTERVAL_US, // governor: time between swaps, vsync included
+    STAT_PARTICLES,        // live rain, confetti and spark particles
+    STAT_ARENA_KB,         // frame arena scratch handed out this frame
+    STAT_HEAP_ALLOCS,      // heap allocations by the main thread since the last frame
+    STAT_HEAP_KB,          // and their size
+    STAT_NODES_UPDATED,    // scene graph world matrices recomputed this frame
+    STAT_OCCLUDED_OBJECTS, // static batches in the frustum but hidden behind the stands, summed over views
+    STAT_OCCLUDED_CELLS,   // vegetation cells likewise
+    STAT_FIGURES_ANIMATED, // skeletal figures posed this frame
+    STAT_POSE_BLENDS,      // distinct blended poses built for them
+    STAT_CROWD_FANS,       // fans in the stands drawn, summed over views
+    NUM_RENDER_STATS
+};
+
+void statsEnable(bool enabled);
+bool statsEnabled();
+void statsAdd(RenderStat stat, long amount);
+void statsHeapCheck(bool enabled);
+void statsFrameBegin();
+void statsFrameEnd();
+
+#endif
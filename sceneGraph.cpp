@@ -0,0 +1,131 @@
+#include "sceneGraph.h"
+#include "renderStats.h"
+#include "viewMath.h"
+#include <GL/glut.h>
+#include <algorithm>
+#include <cstring>
+#include "glTrace.h"
+
+static float localMatrices[MAX_SCENE_NODES * 16];
+static float worldMatrices[MAX_SCENE_NODES * 16];
+static int parents[MAX_SCENE_NODES];
+static unsigned char dirty[MAX_SCENE_NODES];
+static SceneNodeLook looks[MAX_SCENE_NODES];
+static int nodeCount = 0;
+
+static int drawOrder[MAX_SCENE_NODES];
+static int drawCount = 0;
+static bool orderValid = false;
+
+void clearSceneGraph() {
+    nodeCount = 0;
+    drawCount = 0;
+    orderValid = false;
+}
+
+int addSceneNode(int parent, const float local[16]) {
+    if (nodeCount == MAX_SCENE_NODES || parent >= nodeCount) return -1;
+    int n = nodeCount++;
+    std::memcpy(localMatrices + 16 * n, local, 16 * sizeof(float));
+    parents[n] = parent;
+    dirty[n] = 1;
+    looks[n].shape = SHAPE_NONE;
+    looks[n].slices = 0;
+    looks[n].color[0] = looks[n].color[1] = looks[n].color[2] = 1.0f;
+    looks[n].lit = true;
+    orderValid = false;
+    return n;
+}
+
+void setSceneNodeLook(int node, int shape, int slices, float r, float g, float b, bool lit) {
+    SceneNodeLook& l = looks[node];
+    l.shape = shape;
+    l.slices = slices;
+    l.color[0] = r; l.color[1] = g; l.color[2] = b;
+    l.lit = lit;
+    orderValid = false;
+}
+
+void setSceneNodeLocal(int node, const float local[16]) {
+    float* m = localMatrices + 16 * node;
+    if (std::memcmp(m, local, 16 * sizeof(float)) == 0) return;
+    std::memcpy(m, local, 16 * sizeof(float));
+    dirty[node] = 1;
+}
+
+void updateSceneGraph() {
+    int updated = 0;
+    for (int n = 0; n < nodeCount; ++n) {
+        int p = parents[n];
+        if (p >= 0 && dirty[p]) dirty[n] = 1; // parents come first, so this is final
+        if (!dirty[n]) continue;
+        float* world = worldMatrices + 16 * n;
+        if (p < 0) std::memcpy(world, localMatrices + 16 * n, 16 * sizeof(float));
+        else multiplyMatrices(worldMatrices + 16 * p, localMatrices + 16 * n, world);
+        ++updated;
+    }
+    std::memset(dirty, 0, nodeCount);
+    statsAdd(STAT_NODES_UPDATED, updated);
+}
+
+int sceneNodeCount() {
+    return nodeCount;
+}
+
+const float* sceneWorldMatrices() {
+    return worldMatrices;
+}
+
+const SceneNodeLook& sceneNodeLook(int node) {
+    return looks[node];
+}
+
+static bool drawsBefore(int a, int b) {
+    const SceneNodeLook& x = looks[a];
+    const SceneNodeLook& y = looks[b];
+    if (x.lit != y.lit) return x.lit;
+    if (x.shape != y.shape) return x.shape < y.shape;
+    if (x.slices != y.slices) return x.slices < y.slices;
+    for (int k = 0; k < 3; ++k) {
+        if (x.color[k] != y.color[k]) return x.color[k] < y.color[k];
+    }
+    return a < b;
+}
+
+int sceneDrawOrder(const int*& nodes) {
+    if (!orderValid) {
+        drawCount = 0;
+        for (int n = 0; n < nodeCount; ++n) {
+            if (looks[n].shape != SHAPE_NONE) drawOrder[drawCount++] = n;
+        }
+        std::sort(drawOrder, drawOrder + drawCount, drawsBefore);
+        orderValid = true;
+    }
+    nodes = drawOrder;
+    return drawCount;
+}
+
+void drawSceneGraph() {
+    const int* order;
+    int count = sceneDrawOrder(order);
+    const SceneNodeLook* previous = 0;
+    for (int i = 0; i < count; ++i) {
+        int n = order[i];
+        const SceneNodeLook& l = looks[n];
+        if (!previous || l.lit != previous->lit) {
+            if (l.lit) glEnable(GL_LIGHTING);
+            else glDisable(GL_LIGHTING);
+        }
+        if (!previous || std::memcmp(l.color, previous->color, sizeof(l.color)) != 0) {
+            glColor3f(l.color[0], l.color[1], l.color[2]);
+        }
+        previous = &l;
+
+        glPushMatrix();
+        glMultMatrixf(worldMatrices + 16 * n);
+        if (l.shape == SHAPE_CUBE) glutSolidCube(1.0);
+        else glutSolidSphere(1.0, l.slices, l.slices);
+        glPopMatrix();
+    }
+    glEnable(GL_LIGHTING);
+}
@@ -0,0 +1,54 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+// **********************************************
+// ************ SCENE GRAPH *********************
+// **********************************************
+
+// The moving part of the match (players, ball, goalkeeper) as a tree of
+// nodes. Local and world matrices live in two flat arrays in node order,
+// and parents always come before their children, so one forward pass
+// brings every world matrix up to date. Setting a node's local matrix to
+// something new marks it dirty, the pass carries that down to its
+// children, and everything else keeps last frame's world matrix: a
+// standing player costs nothing. Drawing walks the shaped nodes in an
+// order grouped by shape and colour, straight from the world matrices.
+
+enum SceneShape {
+    SHAPE_NONE,   // a transform only
+    SHAPE_CUBE,   // glutSolidCube(1)
+    SHAPE_SPHERE  // glutSolidSphere(1, slices, slices)
+};
+
+struct SceneNodeLook {
+    int shape;
+    int slices;
+    float color[3];
+    bool lit;
+};
+
+const int MAX_SCENE_NODES = 256;
+
+void clearSceneGraph();
+
+// parent -1 for a root; the parent must already exist. Returns the node.
+int addSceneNode(int parent, const float local[16]);
+void setSceneNodeLook(int node, int shape, int slices, float r, float g, float b, bool lit);
+
+// Marks the branch dirty only if the matrix actually changed
+void setSceneNodeLocal(int node, const float local[16]);
+
+// Recomputes the world matrices of dirty branches
+void updateSceneGraph();
+
+int sceneNodeCount();
+const float* sceneWorldMatrices(); // 16 floats per node, column-major
+const SceneNodeLook& sceneNodeLook(int node);
+
+// Shaped nodes in batch order (by lighting, shape and colour)
+int sceneDrawOrder(const int*& nodes);
+
+// Immediate mode, for the frame's dynamic display list
+void drawSceneGraph();
+
+#endif
@@ -0,0 +1,142 @@
+#include "sceneObjects.h"
+#include "stadium.h"
+#include "seatingMesh.h"
+#include "stadiumScene.h"
+#include <iostream>
+#include "glTrace.h"
+
+static SceneObject objects[MAX_SCENE_OBJECTS];
+static int objectCount = 0;
+static bool registered = false;
+
+// --- Draw thunks: adapt the stadium's draw*() functions to one signature ---
+
+static void drawPart(int part) { drawStadiumPart(part); }
+static void drawGoals(int) { drawGoalposts(); }
+static void drawGates(int) { drawEntranceGates(); }
+static void drawSeatSector(int sector) { drawSeatingSector(sector); }
+static void drawRoof(int) { drawMainGrandstandRoof(); }
+static void drawName(int) { drawStadiumName(); }
+static void drawRailing(int) { drawSafetyRailing(); }
+
+static SceneObject& addObject(const char* name, int kind, void (*draw)(int), int param, const Bounds& b) {
+    SceneObject& o = objects[objectCount++];
+    o.name = name;
+    o.kind = kind;
+    o.bounds = b;
+    o.displayList = 0;
+    o.draw = draw;
+    o.param = param;
+    o.nightDependent = false;
+    o.detailDependent = false;
+    o.buffered = false;
+    o.occluder = false;
+    return o;
+}
+
+static Bounds box(float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+    Bounds b;
+    makeBounds(b, minX, minY, minZ, maxX, maxY, maxZ);
+    return b;
+}
+
+// Same order as the original display() so blending and overdraw look identical
+static void registerObjects() {
+    float topTierZ = MAX_SEATING_Z_RADIUS;
+    float H = STADIUM_TOTAL_HEIGHT;
+
+    addObject("ground", OBJECT_GROUND, drawPart, STADIUM_GROUND,
+              box(-TRACK_OUTER_X_RADIUS, 0.0f, -TRACK_OUTER_Z_RADIUS, TRACK_OUTER_X_RADIUS, 0.1f, TRACK_OUTER_Z_RADIUS));
+    addObject("goals", OBJECT_STRUCTURE, drawGoals, 0,
+              box(-FIELD_X_RADIUS - 2.5f, 0.0f, -4.0f, FIELD_X_RADIUS + 2.5f, 2.6f, 4.0f)).detailDependent = true;
+    addObject("benches", OBJECT_STRUCTURE, drawPart, STADIUM_BENCHES,
+              box(-20.0f, 0.0f, -FIELD_Z_RADIUS - 9.0f, 20.0f, 2.3f, -FIELD_Z_RADIUS - 7.0f));
+    addObject("gates", OBJECT_STRUCTURE, drawGates, 0,
+              box(-MAX_SEATING_X_RADIUS - 20.0f, 0.0f, -10.0f, MAX_SEATING_X_RADIUS + 20.0f, 16.0f, 10.0f));
+
+    for (int i = 0; i < NUM_FLOODLIGHT_TOWERS; ++i) {
+        const FloodlightTower& t = FLOODLIGHT_TOWERS[i];
+        addObject("floodlight", OBJECT_TOWER, drawPart, STADIUM_FIRST_TOWER + i,
+                  box(t.x - 9.0f, 0.0f, t.z - 9.0f, t.x + 9.0f, 72.0f, t.z + 9.0f)).nightDependent = true;
+    }
+
+    float sectorWidth = 360.0f / NUM_SEAT_SECTORS;
+    for (int s = 0; s < NUM_SEAT_SECTORS; ++s) {
+        Bounds b = ellipseArcBounds(MAX_SEATING_X_RADIUS + 1.0f, MAX_SEATING_Z_RADIUS + 1.0f,
+                                    s * sectorWidth, (s + 1) * sectorWidth, -0.5f, H + 0.5f);
+        Bounds inner = ellipseArcBounds(SEATING_BASE_X_RADIUS - 1.0f, SEATING_BASE_Z_RADIUS - 1.0f,
+                                        s * sectorWidth, (s + 1) * sectorWidth, -0.5f, H + 0.5f);
+        growBounds(b, inner.min[0], inner.min[1], inner.min[2]);
+        growBounds(b, inner.max[0], inner.max[1], inner.max[2]);
+        addObject("seats", OBJECT_SEATS, drawSeatSector, s, b).buffered = seatingMeshBuffered();
+    }
+
+    addObject("roof", OBJECT_STRUCTURE, drawRoof, 0,
+              box(-MAIN_GRANDSTAND_WIDTH / 2.0f, H + 7.5f, -topTierZ - 47.5f, MAIN_GRANDSTAND_WIDTH / 2.0f, H + 11.0f, -topTierZ + 17.5f))
+        .occluder = true;
+    addObject("columns", OBJECT_STRUCTURE, drawPart, STADIUM_COLUMNS,
+              box(-MAIN_GRANDSTAND_WIDTH / 2.0f, 0.0f, -topTierZ - 16.0f, MAIN_GRANDSTAND_WIDTH / 2.0f, H + 10.0f, -topTierZ - 14.0f));
+    addObject("grandstand", OBJECT_STRUCTURE, drawPart, STADIUM_GRANDSTAND_FACADE,
+              box(-MAIN_GRANDSTAND_WIDTH / 2.0f, 0.0f, -topTierZ - 12.5f, MAIN_GRANDSTAND_WIDTH / 2.0f, H, -topTierZ - 11.5f))
+        .occluder = true;
+    addObject("vip", OBJECT_STRUCTURE, drawPart, STADIUM_VIP,
+              box(-MAIN_GRANDSTAND_WIDTH * 0.3f, H + 1.5f, -topTierZ - 10.0f, MAIN_GRANDSTAND_WIDTH * 0.3f, H + 4.0f, -topTierZ));
+    addObject("name", OBJECT_STRUCTURE, drawName, 0,
+              box(-16.0f, H + 7.0f, -topTierZ - 15.0f, 16.0f, H + 12.0f, -topTierZ - 13.0f));
+    addObject("stone facade", OBJECT_STRUCTURE, drawPart, STADIUM_STONE_FACADE,
+              box(-MAX_SEATING_X_RADIUS, -5.0f, -MAX_SEATING_Z_RADIUS, MAX_SEATING_X_RADIUS, H, MAX_SEATING_Z_RADIUS))
+        .occluder = true;
+    addObject("railing", OBJECT_STRUCTURE, drawRailing, 0,
+              box(-MAX_SEATING_X_RADIUS - 0.5f, H + 1.5f, -MAX_SEATING_Z_RADIUS - 0.5f, MAX_SEATING_X_RADIUS + 0.5f, H + 2.5f, MAX_SEATING_Z_RADIUS + 0.5f))
+        .detailDependent = true;
+    addObject("jumbotron", OBJECT_STRUCTURE, drawPart, STADIUM_JUMBOTRON,
+              box(JUMBOTRON_X - 2.0f, 0.0f, -JUMBOTRON_WIDTH / 2.0f - 1.0f,
+                  JUMBOTRON_X + 2.0f, JUMBOTRON_Y + JUMBOTRON_HEIGHT / 2.0f + 1.0f, JUMBOTRON_WIDTH / 2.0f + 1.0f));
+}
+
+void buildSceneObjects() {
+    if (!registered) {
+        registerObjects();
+        registered = true;
+        std::cout << "Scene: " << objectCount << " static batches" << std::endl;
+    }
+    for (int i = 0; i < objectCount; ++i) {
+        SceneObject& o = objects[i];
+        if (o.displayList || o.buffered) continue;
+        o.displayList = glGenLists(1);
+        glNewList(o.displayList, GL_COMPILE);
+        o.draw(o.param);
+        glEndList();
+    }
+}
+
+static void invalidateObjects(bool SceneObject::*flag) {
+    for (int i = 0; i < objectCount; ++i) {
+        if (objects[i].*flag && objects[i].displayList) {
+            glDeleteLists(objects[i].displayList, 1);
+            objects[i].displayList = 0;
+        }
+    }
+}
+
+void invalidateNightDependentObjects() {
+    invalidateObjects(&SceneObject::nightDependent);
+}
+
+void invalidateDetailDependentObjects() {
+    invalidateObjects(&SceneObject::detailDependent);
+}
+
+int sceneObjectCount() {
+    return objectCount;
+}
+
+const SceneObject& sceneObject(int index) {
+    return objects[index];
+}
+
+void drawSceneObject(int index) {
+    const SceneObject& o = objects[index];
+    if (o.buffered) o.draw(o.param);
+    else glCallList(o.displayList);
+}
@@ -0,0 +1,47 @@
+#ifndef SCENE_OBJECTS_H
+#define SCENE_OBJECTS_H
+
+#include <GL/glut.h>
+#include "viewMath.h"
+
+// **********************************************
+// ************ STATIC SCENE BATCHES ************
+// **********************************************
+
+// The static stadium is split into objects with world-space bounds. Each one
+// is compiled once into a display list from the regular draw*() functions,
+// so any number of cameras can replay and cull it without re-running them.
+// Seat sectors already live in vertex buffers and are drawn from those.
+
+enum SceneObjectKind {
+    OBJECT_GROUND,     // grass, track, pitch lines
+    OBJECT_SEATS,      // one angular sector of the seating bowl
+    OBJECT_STRUCTURE,  // grandstand, facade, gates, benches, goals
+    OBJECT_TOWER       // floodlight tower
+};
+
+struct SceneObject {
+    const char* name;
+    int kind;
+    Bounds bounds;
+    GLuint displayList;
+    void (*draw)(int param); // immediate-mode draw compiled into the list
+    int param;
+    bool nightDependent;     // recompiled when night mode changes
+    bool detailDependent;    // recompiled when the governor's detail level changes
+    bool buffered;           // draws from vertex buffers itself, no display list
+    bool occluder;           // big and solid: drawn first, the occlusion queries test against it
+};
+
+const int MAX_SCENE_OBJECTS = 64;
+
+// Compiles every batch that is missing or out of date. Cheap when nothing changed.
+void buildSceneObjects();
+void invalidateNightDependentObjects();
+void invalidateDetailDependentObjects();
+
+int sceneObjectCount();
+const SceneObject& sceneObject(int index);
+void drawSceneObject(int index);
+
+#endif
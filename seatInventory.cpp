@@ -0,0 +1,309 @@
+#include "seatInventory.h"
+#include <algorithm>
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef unsigned long long Word;
+const int WORD_BITS = 64;
+const int ROW_ALIGN_WORDS = 2; // rows start and end on 128-bit boundaries
+
+// Price bands by angle from the halfway line (90 and 270 degrees)
+const float SIDELINE_BAND_DEGREES = 30.0f;
+const float CORNER_BAND_DEGREES = 60.0f;
+
+// One tier of the bowl. Seat i of the row is bit firstWord * 64 + i in every
+// bitset; gate gaps are simply bits that are never set in existsBits.
+struct InventoryRow {
+    int firstWord;
+    int wordCount;
+    int seatCount;   // seatInRow range, gaps included
+    int nearest[2];  // seat closest to the halfway line on each side of the pitch
+};
+
+static std::vector<InventoryRow> rows; // by tier
+static std::vector<Word> existsBits, heldBits, soldBits;
+static std::vector<Word> bandBits[NUM_PRICE_BANDS];
+static std::vector<float> slotX;                 // seat x, for distance to the halfway line
+static std::vector<unsigned char> slotSector;
+static int seatTotal = 0;
+
+// Query scratch, sized to the longest row so queries never allocate
+static std::vector<Word> scratch;
+
+static inline int popcount64(Word v) {
+#ifdef __GNUC__
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((v * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+static inline int lowestBit(Word v) {
+#ifdef __GNUC__
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    while (!(v & 1)) { v >>= 1; ++n; }
+    return n;
+#endif
+}
+
+static inline int highestBit(Word v) {
+#ifdef __GNUC__
+    return 63 - __builtin_clzll(v);
+#else
+    int n = 63;
+    while (!(v >> 63)) { v <<= 1; --n; }
+    return n;
+#endif
+}
+
+static inline bool testBit(const std::vector<Word>& bits, int slot) {
+    return (bits[slot / WORD_BITS] >> (slot % WORD_BITS)) & 1;
+}
+static inline void setBit(std::vector<Word>& bits, int slot) {
+    bits[slot / WORD_BITS] |= 1ULL << (slot % WORD_BITS);
+}
+static inline void clearBit(std::vector<Word>& bits, int slot) {
+    bits[slot / WORD_BITS] &= ~(1ULL << (slot % WORD_BITS));
+}
+
+// **********************************************
+// ************ BUILDING ************************
+// **********************************************
+
+static int bandFor(const SeatPlacement& s, int tierCount) {
+    float fromHalfway = std::min(std::fabs(s.angleDeg - 90.0f), std::fabs(s.angleDeg - 270.0f));
+    if (fromHalfway < SIDELINE_BAND_DEGREES) return s.tier < (tierCount + 1) / 2 ? PRICE_PREMIUM : PRICE_SIDELINE;
+    if (fromHalfway < CORNER_BAND_DEGREES) return PRICE_CORNER;
+    return PRICE_END;
+}
+
+void initSeatInventory(const std::vector<SeatPlacement>& seats) {
+    int tierCount = 0;
+    for (size_t i = 0; i < seats.size(); ++i) tierCount = std::max(tierCount, (int)seats[i].tier + 1);
+
+    // Lay the rows out one after another
+    rows.assign(tierCount, InventoryRow());
+    for (size_t i = 0; i < seats.size(); ++i) {
+        InventoryRow& row = rows[seats[i].tier];
+        row.seatCount = std::max(row.seatCount, seats[i].seatInRow + 1);
+    }
+    int words = 0, longest = 0;
+    for (int t = 0; t < tierCount; ++t) {
+        InventoryRow& row = rows[t];
+        int rowWords = (row.seatCount + WORD_BITS - 1) / WORD_BITS;
+        row.wordCount = (rowWords + ROW_ALIGN_WORDS - 1) / ROW_ALIGN_WORDS * ROW_ALIGN_WORDS;
+        row.firstWord = words;
+        row.nearest[0] = row.nearest[1] = 0;
+        words += row.wordCount;
+        longest = std::max(longest, row.wordCount);
+    }
+
+    existsBits.assign(words, 0);
+    heldBits.assign(words, 0);
+    soldBits.assign(words, 0);
+    for (int b = 0; b < NUM_PRICE_BANDS; ++b) bandBits[b].assign(words, 0);
+    slotX.assign((size_t)words * WORD_BITS, 0.0f);
+    slotSector.assign((size_t)words * WORD_BITS, 0);
+    scratch.assign(longest, 0);
+
+    std::vector<float> nearestX(tierCount * 2, 1e30f);
+    for (size_t i = 0; i < seats.size(); ++i) {
+        const SeatPlacement& s = seats[i];
+        InventoryRow& row = rows[s.tier];
+        int slot = row.firstWord * WORD_BITS + s.seatInRow;
+        setBit(existsBits, slot);
+        setBit(bandBits[bandFor(s, tierCount)], slot);
+        slotX[slot] = s.x;
+        slotSector[slot] = (unsigned char)s.sector;
+
+        int side = s.angleDeg < 180.0f ? 0 : 1;
+        if (std::fabs(s.x) < nearestX[s.tier * 2 + side]) {
+            nearestX[s.tier * 2 + side] = std::fabs(s.x);
+            row.nearest[side] = s.seatInRow;
+        }
+    }
+    seatTotal = (int)seats.size();
+}
+
+void resetSeatInventory() {
+    std::fill(heldBits.begin(), heldBits.end(), 0);
+    std::fill(soldBits.begin(), soldBits.end(), 0);
+}
+
+int inventorySeatCount() {
+    return seatTotal;
+}
+
+// Slot of a seat in the bitsets, or -1 when the ID names no seat
+static int slotOf(SeatId id) {
+    int tier = seatIdTier(id), seat = seatIdSeat(id);
+    if (tier >= (int)rows.size() || seat >= rows[tier].seatCount) return -1;
+    int slot = rows[tier].firstWord * WORD_BITS + seat;
+    if (!testBit(existsBits, slot) || slotSector[slot] != seatIdSector(id)) return -1;
+    return slot;
+}
+
+// **********************************************
+// ************ STATE CHANGES *******************
+// **********************************************
+
+SeatState seatState(SeatId id) {
+    int slot = slotOf(id);
+    if (slot < 0) return SEAT_UNKNOWN;
+    if (testBit(soldBits, slot)) return SEAT_SOLD;
+    if (testBit(heldBits, slot)) return SEAT_HELD;
+    return SEAT_FREE;
+}
+
+int seatPriceBand(SeatId id) {
+    int slot = slotOf(id);
+    if (slot < 0) return -1;
+    for (int b = 0; b < NUM_PRICE_BANDS; ++b)
+        if (testBit(bandBits[b], slot)) return b;
+    return -1;
+}
+
+bool holdSeats(const SeatId* ids, int count) {
+    for (int i = 0; i < count; ++i)
+        if (seatState(ids[i]) != SEAT_FREE) return false;
+    for (int i = 0; i < count; ++i) setBit(heldBits, slotOf(ids[i]));
+    return true;
+}
+
+bool sellSeats(const SeatId* ids, int count) {
+    for (int i = 0; i < count; ++i) {
+        SeatState state = seatState(ids[i]);
+        if (state != SEAT_FREE && state != SEAT_HELD) return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        int slot = slotOf(ids[i]);
+        clearBit(heldBits, slot);
+        setBit(soldBits, slot);
+    }
+    return true;
+}
+
+void releaseSeats(const SeatId* ids, int count) {
+    for (int i = 0; i < count; ++i) {
+        int slot = slotOf(ids[i]);
+        if (slot < 0) continue;
+        clearBit(heldBits, slot);
+        clearBit(soldBits, slot);
+    }
+}
+
+// **********************************************
+// ************ QUERIES *************************
+// **********************************************
+
+// out = (band or exists) & ~(held | sold) for one row, 128 bits at a time.
+// Returns the number of free seats.
+static int freeSeatsInRow(const InventoryRow& row, int band, Word* out) {
+    const Word* candidates = band < 0 ? &existsBits[row.firstWord] : &bandBits[band][row.firstWord];
+    const Word* held = &heldBits[row.firstWord];
+    const Word* sold = &soldBits[row.firstWord];
+    int total = 0;
+#ifdef __SSE2__
+    for (int w = 0; w < row.wordCount; w += 2) {
+        __m128i taken = _mm_or_si128(_mm_loadu_si128((const __m128i*)(held + w)),
+                                     _mm_loadu_si128((const __m128i*)(sold + w)));
+        __m128i free = _mm_andnot_si128(taken, _mm_loadu_si128((const __m128i*)(candidates + w)));
+        _mm_storeu_si128((__m128i*)(out + w), free);
+        total += popcount64(out[w]) + popcount64(out[w + 1]);
+    }
+#else
+    for (int w = 0; w < row.wordCount; ++w) {
+        out[w] = candidates[w] & ~(held[w] | sold[w]);
+        total += popcount64(out[w]);
+    }
+#endif
+    return total;
+}
+
+// Keeps bit i only where bits i .. i + length - 1 are all set, doubling the
+// run length covered on each pass.
+static void keepRunStarts(Word* bits, int words, int length) {
+    for (int have = 1; have < length; ) {
+        int shift = std::min(have, length - have);
+        for (int w = 0; w < words; ++w) {
+            Word next = w + 1 < words ? bits[w + 1] << (WORD_BITS - shift) : 0;
+            bits[w] &= (bits[w] >> shift) | next;
+        }
+        have += shift;
+    }
+}
+
+static int nextSetBit(const Word* bits, int words, int from) {
+    int w = from / WORD_BITS;
+    if (w >= words) return -1;
+    Word v = bits[w] & (~0ULL << (from % WORD_BITS));
+    while (!v) {
+        if (++w == words) return -1;
+        v = bits[w];
+    }
+    return w * WORD_BITS + lowestBit(v);
+}
+
+static int previousSetBit(const Word* bits, int from) {
+    if (from < 0) return -1;
+    int w = from / WORD_BITS;
+    int keep = from % WORD_BITS;
+    Word v = bits[w] & (keep == WORD_BITS - 1 ? ~0ULL : (2ULL << keep) - 1);
+    while (!v) {
+        if (--w < 0) return -1;
+        v = bits[w];
+    }
+    return w * WORD_BITS + highestBit(v);
+}
+
+int countFreeSeats(int band) {
+    if (band >= NUM_PRICE_BANDS) return 0;
+    int total = 0;
+    for (size_t t = 0; t < rows.size(); ++t) total += freeSeatsInRow(rows[t], band, &scratch[0]);
+    return total;
+}
+
+bool findAdjacentSeats(int count, int band, SeatId* ids) {
+    if (count < 1 || count > MAX_ADJACENT_SEATS || band >= NUM_PRICE_BANDS) return false;
+
+    float bestScore = 1e30f;
+    int bestTier = -1, bestStart = 0;
+    int centre = (count - 1) / 2;
+    for (int t = 0; t < (int)rows.size(); ++t) {
+        const InventoryRow& row = rows[t];
+        if (row.seatCount < count) continue;
+        Word* bits = &scratch[0];
+        if (freeSeatsInRow(row, band, bits) < count) continue;
+        keepRunStarts(bits, row.wordCount, count);
+
+        // |x| grows away from the seat nearest the halfway line on each side,
+        // so the nearest run start either way of it is the best on that stretch
+        const float* x = &slotX[(size_t)row.firstWord * WORD_BITS];
+        for (int side = 0; side < 2; ++side) {
+            int target = std::min(std::max(row.nearest[side] - centre, 0), row.seatCount - 1);
+            int starts[2] = { nextSetBit(bits, row.wordCount, target), previousSetBit(bits, target) };
+            for (int k = 0; k < 2; ++k) {
+                if (starts[k] < 0) continue;
+                float score = std::fabs(x[starts[k]] + x[starts[k] + count - 1]) * 0.5f;
+                if (score < bestScore) {
+                    bestScore = score;
+                    bestTier = t;
+                    bestStart = starts[k];
+                }
+            }
+        }
+    }
+    if (bestTier < 0) return false;
+
+    int slot = rows[bestTier].firstWord * WORD_BITS + bestStart;
+    for (int i = 0; i < count; ++i) ids[i] = makeSeatId(bestTier, slotSector[slot + i], bestStart + i);
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef SEAT_INVENTORY_H
+#define SEAT_INVENTORY_H
+
+#include "stadiumGeometry.h"
+#include <vector>
+
+// **********************************************
+// ************ SEAT INVENTORY ******************
+// **********************************************
+
+// The ticketing view of the bowl. Every seat has a stable ID built from the
+// geometry (tier, sector, position in its row), and availability, holds,
+// sales and price bands are bitsets with one bit per seat, rows padded to
+// 128 bits. Queries combine the sets 128 bits at a time and find runs of
+// adjacent free seats with shift-and passes. Not thread-safe.
+
+// tier << 24 | sector << 16 | seatInRow. Stable while the bowl constants are.
+typedef unsigned int SeatId;
+
+const SeatId INVALID_SEAT_ID = 0xFFFFFFFFu;
+
+inline SeatId makeSeatId(int tier, int sector, int seatInRow) {
+    return ((SeatId)tier << 24) | ((SeatId)sector << 16) | (SeatId)seatInRow;
+}
+inline int seatIdTier(SeatId id) { return (int)(id >> 24); }
+inline int seatIdSector(SeatId id) { return (int)((id >> 16) & 0xFF); }
+inline int seatIdSeat(SeatId id) { return (int)(id & 0xFFFF); }
+
+enum PriceBand {
+    PRICE_PREMIUM,   // lower half of the tiers along the halfway line
+    PRICE_SIDELINE,  // upper tiers along the halfway line
+    PRICE_CORNER,
+    PRICE_END,       // behind the goals
+    NUM_PRICE_BANDS
+};
+const int ANY_PRICE_BAND = -1;
+
+enum SeatState {
+    SEAT_FREE,
+    SEAT_HELD,       // reserved while a purchase is in progress
+    SEAT_SOLD,
+    SEAT_UNKNOWN     // no such seat (gate gap, bad ID)
+};
+
+// Longest run findAdjacentSeats() will search for
+const int MAX_ADJACENT_SEATS = 64;
+
+// Builds the inventory from a seat layout (any order); every seat starts free.
+void initSeatInventory(const std::vector<SeatPlacement>& seats);
+void resetSeatInventory(); // everything free again
+
+int inventorySeatCount();
+int countFreeSeats(int band); // band or ANY_PRICE_BAND
+
+SeatState seatState(SeatId id);
+int seatPriceBand(SeatId id); // -1 for an unknown seat
+
+// All-or-nothing: returns false and changes nothing unless every seat is
+// free (hold) or free/held (sell).
+bool holdSeats(const SeatId* ids, int count);
+bool sellSeats(const SeatId* ids, int count);
+void releaseSeats(const SeatId* ids, int count); // held or sold back to free
+
+// Best block of count adjacent free seats in one row (band or
+// ANY_PRICE_BAND), nearest the halfway line, lower tiers winning ties.
+// Fills ids and returns true, or returns false when no row has room.
+bool findAdjacentSeats(int count, int band, SeatId* ids);
+
+#endif
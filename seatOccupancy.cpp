@@ -0,0 +1,312 @@
+#include "seatOccupancy.h"
+#include "glExtensions.h"
+#include "renderStats.h"
+#include "seatingMesh.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "glTrace.h"
+
+// Feed bytes parsed per frame; anything beyond waits for the next frame
+const int FEED_BYTES_PER_FRAME = 64 * 1024;
+
+// Colour bytes uploaded per frame, and how many clean seats a range may
+// bridge rather than start another glBufferSubData call
+const int OCCUPANCY_UPLOAD_BUDGET = 256 * 1024;
+const int MERGE_GAP_SEATS = 4;
+
+static const unsigned char STATE_COLORS[NUM_OCCUPANCY_STATES][4] = {
+    {  26,  26, 230, 255 }, // empty: the bowl's usual blue
+    { 230, 140,  26, 255 }, // sold
+    {  26, 204,  51, 255 }, // scanned in
+    {  64,  64,  64, 255 }  // blocked
+};
+static const char* STATE_NAMES[NUM_OCCUPANCY_STATES] = { "empty", "sold", "scanned", "blocked" };
+
+static bool active = false;
+static std::vector<unsigned char> states;        // per seat
+static std::vector<unsigned int> vertexColors;   // SEAT_VERTICES per seat, RGBA8
+static std::vector<unsigned long long> dirty;    // one bit per seat
+static GLuint colorBuffer = 0;
+
+// (tier, seatInRow) -> layout index, -1 in the gate gaps
+static std::vector<int> rowBase;
+static std::vector<int> rowLength;
+static std::vector<int> seatIndex;
+static std::vector<unsigned char> seatSector;
+
+// Feed source
+static FILE* feedFile = 0;
+static int feedSocket = -1;
+static std::string feedSocketPath;
+static std::string pendingLine;
+static long updatesApplied = 0, updatesRejected = 0;
+
+static unsigned int packedColor(OccupancyState s) {
+    unsigned int c;
+    std::memcpy(&c, STATE_COLORS[s], sizeof(c));
+    return c;
+}
+
+// **********************************************
+// ************ FEED ****************************
+// **********************************************
+
+static bool openFeed(const char* feed) {
+    if (std::strncmp(feed, "unix:", 5) == 0) {
+#ifdef _WIN32
+        std::cerr << "Occupancy: unix sockets are not supported on Windows, use a file feed" << std::endl;
+        return false;
+#else
+        feedSocketPath = feed + 5;
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (feedSocketPath.size() >= sizeof(address.sun_path)) return false;
+        std::strcpy(address.sun_path, feedSocketPath.c_str());
+
+        feedSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (feedSocket < 0) return false;
+        unlink(address.sun_path); // left over from an earlier run
+        if (bind(feedSocket, (sockaddr*)&address, sizeof(address)) != 0) {
+            close(feedSocket);
+            feedSocket = -1;
+            return false;
+        }
+        fcntl(feedSocket, F_SETFL, fcntl(feedSocket, F_GETFL, 0) | O_NONBLOCK);
+        return true;
+#endif
+    }
+    feedFile = std::fopen(feed, "rb");
+    return feedFile != 0;
+}
+
+static void applyLine(const char* line) {
+    int tier, sector, seat;
+    char name[16];
+    if (line[0] == '#' || line[0] == '\0') return;
+    if (std::sscanf(line, "%d-%d-%d %15s", &tier, &sector, &seat, name) != 4) {
+        ++updatesRejected;
+        return;
+    }
+    for (int s = 0; s < NUM_OCCUPANCY_STATES; ++s) {
+        if (std::strcmp(name, STATE_NAMES[s]) == 0) {
+            if (setSeatOccupancy(tier, sector, seat, (OccupancyState)s)) ++updatesApplied;
+            else ++updatesRejected;
+            return;
+        }
+    }
+    ++updatesRejected;
+}
+
+static void consume(const char* data, size_t size) {
+    size_t start = 0;
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != '\n') continue;
+        pendingLine.append(data + start, i - start);
+        if (!pendingLine.empty() && pendingLine[pendingLine.size() - 1] == '\r') pendingLine.resize(pendingLine.size() - 1);
+        applyLine(pendingLine.c_str());
+        pendingLine.clear();
+        start = i + 1;
+    }
+    pendingLine.append(data + start, size - start);
+}
+
+static void pollFeed() {
+    static char buffer[4096];
+    int budget = FEED_BYTES_PER_FRAME;
+    if (feedFile) {
+        while (budget > 0) {
+            size_t got = std::fread(buffer, 1, sizeof(buffer), feedFile);
+            if (got == 0) {
+                std::clearerr(feedFile); // at the end for now; the file may still grow
+                break;
+            }
+            consume(buffer, got);
+            budget -= (int)got;
+        }
+    }
+#ifndef _WIN32
+    while (feedSocket >= 0 && budget > 0) {
+        ssize_t got = recv(feedSocket, buffer, sizeof(buffer), 0);
+        if (got <= 0) break;
+        consume(buffer, (size_t)got);
+        if (buffer[got - 1] != '\n') consume("\n", 1); // a datagram is always whole lines
+        budget -= (int)got;
+    }
+#endif
+}
+
+// **********************************************
+// ************ STATE & UPLOAD ******************
+// **********************************************
+
+bool initSeatOccupancy(const std::vector<SeatPlacement>& seats, const char* feed) {
+    if (!glExt.hasVertexBuffers || !seatingMeshBuffered() || seats.empty()) {
+        std::cerr << "Occupancy: needs the buffered seating mesh, live seat colours disabled" << std::endl;
+        return false;
+    }
+    if (!openFeed(feed)) {
+        std::cerr << "Occupancy: could not open feed " << feed << std::endl;
+        return false;
+    }
+
+    int tiers = 0;
+    for (size_t i = 0; i < seats.size(); ++i) tiers = std::max(tiers, (int)seats[i].tier + 1);
+    rowLength.assign(tiers, 0);
+    for (size_t i = 0; i < seats.size(); ++i)
+        rowLength[seats[i].tier] = std::max(rowLength[seats[i].tier], seats[i].seatInRow + 1);
+    rowBase.assign(tiers, 0);
+    int slots = 0;
+    for (int t = 0; t < tiers; ++t) {
+        rowBase[t] = slots;
+        slots += rowLength[t];
+    }
+    seatIndex.assign(slots, -1);
+    seatSector.assign(slots, 0);
+    for (size_t i = 0; i < seats.size(); ++i) {
+        int slot = rowBase[seats[i].tier] + seats[i].seatInRow;
+        seatIndex[slot] = (int)i;
+        seatSector[slot] = (unsigned char)seats[i].sector;
+    }
+
+    updatesApplied = updatesRejected = 0;
+    pendingLine.clear();
+    states.assign(seats.size(), OCCUPANCY_EMPTY);
+    vertexColors.assign(seats.size() * SEAT_VERTICES, packedColor(OCCUPANCY_EMPTY));
+    dirty.assign((seats.size() + 63) / 64, 0);
+
+    glExt.GenBuffers(1, &colorBuffer);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+    glExt.BufferData(GL_ARRAY_BUFFER, vertexColors.size() * sizeof(unsigned int), &vertexColors[0], GL_DYNAMIC_DRAW);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    active = true;
+    std::cout << "Occupancy: following " << feed << " for " << seats.size() << " seats" << std::endl;
+    return true;
+}
+
+void shutdownSeatOccupancy() {
+    if (!active) return;
+    if (feedFile) std::fclose(feedFile);
+    feedFile = 0;
+#ifndef _WIN32
+    if (feedSocket >= 0) {
+        close(feedSocket);
+        unlink(feedSocketPath.c_str());
+    }
+    feedSocket = -1;
+#endif
+    std::cout << "Occupancy: " << updatesApplied << " updates applied, " << updatesRejected << " rejected" << std::endl;
+    active = false;
+}
+
+bool seatOccupancyActive() {
+    return active;
+}
+
+bool setSeatOccupancy(int tier, int sector, int seatInRow, OccupancyState state) {
+    if (tier < 0 || tier >= (int)rowBase.size() || seatInRow < 0 || seatInRow >= rowLength[tier]) return false;
+    int slot = rowBase[tier] + seatInRow;
+    int seat = seatIndex[slot];
+    if (seat < 0 || seatSector[slot] != sector) return false;
+    if (states[seat] == state) return true;
+
+    states[seat] = (unsigned char)state;
+    unsigned int color = packedColor(state);
+    for (int v = 0; v < SEAT_VERTICES; ++v) vertexColors[(size_t)seat * SEAT_VERTICES + v] = color;
+    dirty[seat / 64] |= 1ULL << (seat % 64);
+    return true;
+}
+
+OccupancyState seatOccupancy(int seat) {
+    if (seat < 0 || seat >= (int)states.size()) return OCCUPANCY_EMPTY;
+    return (OccupancyState)states[seat];
+}
+
+const char* occupancyStateName(OccupancyState state) {
+    return STATE_NAMES[state];
+}
+
+static void clearDirty(int first, int last) {
+    for (int s = first; s <= last; ++s) dirty[s / 64] &= ~(1ULL << (s % 64));
+}
+
+// Walks the dirty bits in order, merging seats less than MERGE_GAP_SEATS
+// apart, and uploads ranges until the budget is spent.
+static void uploadDirtyRanges() {
+    const size_t seatBytes = SEAT_VERTICES * sizeof(unsigned int);
+    size_t budget = OCCUPANCY_UPLOAD_BUDGET;
+    int rangeFirst = -1, rangeLast = -1, ranges = 0;
+    bool bound = false;
+
+    for (size_t w = 0; w <= dirty.size(); ++w) {
+        unsigned long long bits = w < dirty.size() ? dirty[w] : 0;
+        bool flushAll = w == dirty.size();
+        while (bits || (flushAll && rangeFirst >= 0)) {
+            int seat = -1;
+            if (bits) {
+                int bit = 0;
+                while (!((bits >> bit) & 1)) ++bit;
+                bits &= bits - 1;
+                seat = (int)(w * 64) + bit;
+                if (rangeFirst >= 0 && seat - rangeLast <= MERGE_GAP_SEATS) {
+                    rangeLast = seat;
+                    continue;
+                }
+            }
+            if (rangeFirst >= 0) {
+                // Over budget: send the front of the range, the rest stays dirty
+                int fits = (int)(budget / seatBytes);
+                bool lastRange = rangeLast - rangeFirst + 1 > fits;
+                if (lastRange) rangeLast = rangeFirst + std::max(fits, 1) - 1;
+                size_t bytes = (size_t)(rangeLast - rangeFirst + 1) * seatBytes;
+                if (!bound) {
+                    glExt.BindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+                    bound = true;
+                }
+                glExt.BufferSubData(GL_ARRAY_BUFFER, (GLintptr)((size_t)rangeFirst * seatBytes), (GLsizeiptr)bytes,
+                                    &vertexColors[(size_t)rangeFirst * SEAT_VERTICES]);
+                clearDirty(rangeFirst, rangeLast);
+                ++ranges;
+                if (lastRange) {
+                    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+                    statsAdd(STAT_SEAT_RANGES, ranges);
+                    return;
+                }
+                budget -= bytes;
+            }
+            rangeFirst = rangeLast = seat;
+            if (seat < 0) break;
+        }
+    }
+    if (bound) glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    statsAdd(STAT_SEAT_RANGES, ranges);
+}
+
+void updateSeatOccupancy() {
+    if (!active) return;
+    pollFeed();
+    uploadDirtyRanges();
+}
+
+void bindSeatColors() {
+    if (!active) return;
+    glExt.BindBuffer(GL_ARRAY_BUFFER, colorBuffer);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, 0, 0);
+}
+
+void unbindSeatColors() {
+    if (!active) return;
+    glDisableClientState(GL_COLOR_ARRAY);
+}
@@ -0,0 +1,46 @@
+#ifndef SEAT_OCCUPANCY_H
+#define SEAT_OCCUPANCY_H
+
+#include "stadiumGeometry.h"
+#include <vector>
+
+// **********************************************
+// ************ LIVE SEAT OCCUPANCY *************
+// **********************************************
+
+// Colours every seat by its live state from a feed. Each line of the feed is
+// "<tier>-<sector>-<seat> <state>", state one of empty, sold, scanned or
+// blocked. Changes only mark seats dirty; once a frame the dirty seats are
+// merged into ranges and just those ranges of the colour buffer are
+// uploaded, under a byte budget, so bursts never cause a rebuild or a spike.
+
+enum OccupancyState {
+    OCCUPANCY_EMPTY,
+    OCCUPANCY_SOLD,
+    OCCUPANCY_SCANNED,  // ticket scanned at the gate, fan is in the seat
+    OCCUPANCY_BLOCKED,  // not for sale (camera positions, segregation)
+    NUM_OCCUPANCY_STATES
+};
+
+// feed is a file path (read from the start, then followed as it grows) or,
+// except on Windows, "unix:<path>" for a datagram socket created at path.
+// Needs vertex buffers and the seating mesh; returns false if either is
+// missing or the feed cannot be opened.
+bool initSeatOccupancy(const std::vector<SeatPlacement>& seats, const char* feed);
+void shutdownSeatOccupancy();
+bool seatOccupancyActive();
+
+// Reads what the feed has ready and uploads dirty ranges. Once per frame.
+void updateSeatOccupancy();
+
+// Returns false for a seat that is not in the layout.
+bool setSeatOccupancy(int tier, int sector, int seatInRow, OccupancyState state);
+// seatIndex is a position in seatLayout()
+OccupancyState seatOccupancy(int seatIndex);
+const char* occupancyStateName(OccupancyState state);
+
+// Around drawing the seating mesh: per-vertex colours from the buffer.
+void bindSeatColors();
+void unbindSeatColors();
+
+#endif
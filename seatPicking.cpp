@@ -0,0 +1,308 @@
+#include "seatPicking.h"
+#include "stadium.h"
+#include "viewMath.h"
+#include <algorithm>
+#include <cmath>
+
+const int BVH_LEAF_SIZE = 4;
+const int BVH_STACK_DEPTH = 64;
+
+// A seat or stadium box as an oriented unit cube: world to cube space is an
+// affine transform, so ray distances carry over unchanged.
+struct PickPrimitive {
+    float toLocal[12]; // rows 0-2 of the inverse matrix
+    int id;            // >= 0: seat index, < 0: -(box index + 1)
+};
+
+// count > 0: leaf over primitives [first, first + count)
+// count == 0: children at first and first + 1
+struct BvhNode {
+    float min[3], max[3];
+    int first, count;
+};
+
+static const std::vector<SeatPlacement>* pickSeats = 0;
+static std::vector<PickBox> pickBoxes;
+static std::vector<PickPrimitive> primitives;
+static std::vector<BvhNode> nodes;
+
+// Build-time only
+static std::vector<Bounds> primitiveBounds;
+static std::vector<float> centroids;
+
+static void seatMatrix(const SeatPlacement& s, float m[16]) {
+    // Same as buildSeatMesh(): glTranslatef(seat) glRotatef(90 - angle, 0, 1, 0) glScalef(size)
+    float turn = (90.0f - s.angleDeg) * (float)M_PI / 180.0f;
+    float c = std::cos(turn), sn = std::sin(turn);
+    float matrix[16] = { c * SEAT_WIDTH, 0, -sn * SEAT_WIDTH, 0,
+                         0, SEAT_HEIGHT, 0, 0,
+                         sn * SEAT_DEPTH, 0, c * SEAT_DEPTH, 0,
+                         s.x, s.y, s.z, 1 };
+    for (int i = 0; i < 16; ++i) m[i] = matrix[i];
+}
+
+static void addPrimitive(const float world[16], int id) {
+    PickPrimitive p;
+    float inv[16];
+    if (!invertMatrix(world, inv)) return;
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 4; ++c) p.toLocal[r * 4 + c] = inv[c * 4 + r];
+    p.id = id;
+    primitives.push_back(p);
+
+    Bounds b;
+    for (int corner = 0; corner < 8; ++corner) {
+        float l[3] = { (corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f };
+        float w[3];
+        for (int r = 0; r < 3; ++r) w[r] = world[r] * l[0] + world[4 + r] * l[1] + world[8 + r] * l[2] + world[12 + r];
+        if (corner == 0) makeBounds(b, w[0], w[1], w[2], w[0], w[1], w[2]);
+        else growBounds(b, w[0], w[1], w[2]);
+    }
+    primitiveBounds.push_back(b);
+    for (int k = 0; k < 3; ++k) centroids.push_back((b.min[k] + b.max[k]) * 0.5f);
+}
+
+// Sorts primitive indices by centroid along an axis
+struct CentroidLess {
+    int axis;
+    bool operator()(int a, int b) const { return centroids[a * 3 + axis] < centroids[b * 3 + axis]; }
+};
+
+// Median split on the longest axis of the centroid bounds
+static void buildNode(int nodeIndex, std::vector<int>& order, int first, int count) {
+    BvhNode& node = nodes[nodeIndex];
+    Bounds b = primitiveBounds[order[first]];
+    float cmin[3], cmax[3];
+    for (int k = 0; k < 3; ++k) cmin[k] = cmax[k] = centroids[order[first] * 3 + k];
+    for (int i = first + 1; i < first + count; ++i) {
+        const Bounds& pb = primitiveBounds[order[i]];
+        growBounds(b, pb.min[0], pb.min[1], pb.min[2]);
+        growBounds(b, pb.max[0], pb.max[1], pb.max[2]);
+        for (int k = 0; k < 3; ++k) {
+            cmin[k] = std::min(cmin[k], centroids[order[i] * 3 + k]);
+            cmax[k] = std::max(cmax[k], centroids[order[i] * 3 + k]);
+        }
+    }
+    for (int k = 0; k < 3; ++k) { node.min[k] = b.min[k]; node.max[k] = b.max[k]; }
+
+    if (count <= BVH_LEAF_SIZE) {
+        node.first = first;
+        node.count = count;
+        return;
+    }
+    CentroidLess less;
+    less.axis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (cmax[k] - cmin[k] > cmax[less.axis] - cmin[less.axis]) less.axis = k;
+    int half = count / 2;
+    std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count, less);
+
+    int children = (int)nodes.size();
+    nodes.resize(nodes.size() + 2); // invalidates node
+    nodes[nodeIndex].first = children;
+    nodes[nodeIndex].count = 0;
+    buildNode(children, order, first, half);
+    buildNode(children + 1, order, first + half, count - half);
+}
+
+void buildPickIndex(const std::vector<SeatPlacement>& seats, const std::vector<PickBox>& boxes) {
+    pickSeats = &seats;
+    pickBoxes = boxes;
+    primitives.clear();
+    primitiveBounds.clear();
+    centroids.clear();
+    nodes.clear();
+
+    float m[16];
+    for (size_t i = 0; i < seats.size(); ++i) {
+        seatMatrix(seats[i], m);
+        addPrimitive(m, (int)i);
+    }
+    for (size_t i = 0; i < boxes.size(); ++i) addPrimitive(boxes[i].matrix, -(int)i - 1);
+    if (primitives.empty()) return;
+
+    std::vector<int> order(primitives.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = (int)i;
+    nodes.reserve(primitives.size() / BVH_LEAF_SIZE * 2 + 1);
+    nodes.resize(1);
+    buildNode(0, order, 0, (int)order.size());
+
+    // Store the primitives in leaf order so leaves are contiguous
+    std::vector<PickPrimitive> sorted(primitives.size());
+    for (size_t i = 0; i < order.size(); ++i) sorted[i] = primitives[order[i]];
+    primitives.swap(sorted);
+    std::vector<Bounds>().swap(primitiveBounds);
+    std::vector<float>().swap(centroids);
+}
+
+// **********************************************
+// ************ RAY QUERIES *********************
+// **********************************************
+
+// Slab test; returns the entry distance or -1
+static float rayBox(const float origin[3], const float invDir[3], const float* bmin, const float* bmax, float tMax) {
+    float t0 = 0.0f, t1 = tMax;
+    for (int k = 0; k < 3; ++k) {
+        float a = (bmin[k] - origin[k]) * invDir[k];
+        float b = (bmax[k] - origin[k]) * invDir[k];
+        if (a > b) std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+        if (t0 > t1) return -1.0f;
+    }
+    return t0;
+}
+
+static float rayPrimitive(const PickPrimitive& p, const float origin[3], const float dir[3], float tMax) {
+    const float* m = p.toLocal;
+    float o[3], d[3], inv[3];
+    for (int r = 0; r < 3; ++r) {
+        o[r] = m[r * 4] * origin[0] + m[r * 4 + 1] * origin[1] + m[r * 4 + 2] * origin[2] + m[r * 4 + 3];
+        d[r] = m[r * 4] * dir[0] + m[r * 4 + 1] * dir[1] + m[r * 4 + 2] * dir[2];
+        inv[r] = 1.0f / d[r];
+    }
+    static const float lo[3] = { -0.5f, -0.5f, -0.5f }, hi[3] = { 0.5f, 0.5f, 0.5f };
+    return rayBox(o, inv, lo, hi, tMax);
+}
+
+// Both walls of the facade ellipse between y = -5 and the top of the bowl,
+// except across the gate gaps
+static float rayFacade(const float o[3], const float d[3], float tMax) {
+    float ax = 1.0f / (MAX_SEATING_X_RADIUS * MAX_SEATING_X_RADIUS);
+    float az = 1.0f / (MAX_SEATING_Z_RADIUS * MAX_SEATING_Z_RADIUS);
+    float a = d[0] * d[0] * ax + d[2] * d[2] * az;
+    float b = 2.0f * (o[0] * d[0] * ax + o[2] * d[2] * az);
+    float c = o[0] * o[0] * ax + o[2] * o[2] * az - 1.0f;
+    float disc = b * b - 4.0f * a * c;
+    if (a <= 0.0f || disc < 0.0f) return -1.0f;
+    float root = std::sqrt(disc);
+    float roots[2] = { (-b - root) / (2.0f * a), (-b + root) / (2.0f * a) };
+    for (int i = 0; i < 2; ++i) {
+        float t = roots[i];
+        if (t <= 0.0f || t >= tMax) continue;
+        float y = o[1] + d[1] * t;
+        if (y < -5.0f || y > STADIUM_TOTAL_HEIGHT) continue;
+        float angleDeg = std::atan2((o[2] + d[2] * t) / MAX_SEATING_Z_RADIUS, (o[0] + d[0] * t) / MAX_SEATING_X_RADIUS) *
+                         180.0f / (float)M_PI;
+        if (angleDeg < 0.0f) angleDeg += 360.0f;
+        if (inGateClearance(angleDeg, GATE_GAP_DEGREES)) continue;
+        return t;
+    }
+    return -1.0f;
+}
+
+static const char* groundName(float x, float z) {
+    if (std::fabs(x) <= FIELD_X_RADIUS && std::fabs(z) <= FIELD_Z_RADIUS) return "pitch";
+    float inner = (x * x) / (TRACK_INNER_X_RADIUS * TRACK_INNER_X_RADIUS) + (z * z) / (TRACK_INNER_Z_RADIUS * TRACK_INNER_Z_RADIUS);
+    if (inner <= 1.0f) return "grass";
+    float outer = (x * x) / (TRACK_OUTER_X_RADIUS * TRACK_OUTER_X_RADIUS) + (z * z) / (TRACK_OUTER_Z_RADIUS * TRACK_OUTER_Z_RADIUS);
+    if (outer <= 1.0f) return "track";
+    if (std::fabs(x) <= PARK_HALF_EXTENT && std::fabs(z) <= PARK_HALF_EXTENT) return "park";
+    return "city";
+}
+
+bool pickRay(const float origin[3], const float direction[3], PickResult& hit) {
+    hit.kind = PICK_NOTHING;
+    hit.distance = 1e30f;
+    hit.seat = hit.box = -1;
+    hit.name = 0;
+
+    // --- Seats and boxes through the hierarchy, nearest child first ---
+    float invDir[3] = { 1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2] };
+    int best = -1;
+    if (!nodes.empty()) {
+        int stack[BVH_STACK_DEPTH];
+        int top = 0;
+        if (rayBox(origin, invDir, nodes[0].min, nodes[0].max, hit.distance) >= 0.0f) stack[top++] = 0;
+        while (top > 0) {
+            const BvhNode& node = nodes[stack[--top]];
+            if (node.count > 0) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    float t = rayPrimitive(primitives[i], origin, direction, hit.distance);
+                    if (t >= 0.0f && t < hit.distance) {
+                        hit.distance = t;
+                        best = i;
+                    }
+                }
+                continue;
+            }
+            const BvhNode& a = nodes[node.first];
+            const BvhNode& b = nodes[node.first + 1];
+            float ta = rayBox(origin, invDir, a.min, a.max, hit.distance);
+            float tb = rayBox(origin, invDir, b.min, b.max, hit.distance);
+            // Push the farther child first so the nearer one is searched first
+            if (ta >= 0.0f && tb >= 0.0f) {
+                bool aFirst = ta <= tb;
+                stack[top++] = aFirst ? node.first + 1 : node.first;
+                stack[top++] = aFirst ? node.first : node.first + 1;
+            } else if (ta >= 0.0f) {
+                stack[top++] = node.first;
+            } else if (tb >= 0.0f) {
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+    if (best >= 0) {
+        int id = primitives[best].id;
+        if (id >= 0) {
+            hit.kind = PICK_SEAT;
+            hit.seat = id;
+            hit.name = "seat";
+        } else {
+            hit.kind = PICK_STRUCTURE;
+            hit.box = -id - 1;
+            hit.name = pickBoxes[hit.box].name;
+        }
+    }
+
+    // --- Analytic surfaces ---
+    float t = rayFacade(origin, direction, hit.distance);
+    if (t > 0.0f) {
+        hit.kind = PICK_STRUCTURE;
+        hit.distance = t;
+        hit.seat = hit.box = -1;
+        hit.name = "stone facade";
+    }
+    if (direction[1] < 0.0f) {
+        t = -origin[1] / direction[1];
+        if (t > 0.0f && t < hit.distance) {
+            hit.kind = PICK_GROUND;
+            hit.distance = t;
+            hit.seat = hit.box = -1;
+            hit.name = groundName(origin[0] + direction[0] * t, origin[2] + direction[2] * t);
+        }
+    }
+
+    if (hit.kind == PICK_NOTHING) return false;
+    for (int k = 0; k < 3; ++k) hit.point[k] = origin[k] + direction[k] * hit.distance;
+    return true;
+}
+
+bool pickScreen(int x, int y, int width, int height, const float viewProj[16], PickResult& hit) {
+    float inv[16];
+    if (width <= 0 || height <= 0 || !invertMatrix(viewProj, inv)) return false;
+
+    float ndcX = 2.0f * (x + 0.5f) / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * (y + 0.5f) / height;
+    float ends[2][3];
+    for (int e = 0; e < 2; ++e) {
+        float ndcZ = e == 0 ? -1.0f : 1.0f;
+        float p[4];
+        for (int r = 0; r < 4; ++r) p[r] = inv[r] * ndcX + inv[4 + r] * ndcY + inv[8 + r] * ndcZ + inv[12 + r];
+        for (int k = 0; k < 3; ++k) ends[e][k] = p[k] / p[3];
+    }
+    float dir[3] = { ends[1][0] - ends[0][0], ends[1][1] - ends[0][1], ends[1][2] - ends[0][2] };
+    return pickRay(ends[0], dir, hit);
+}
+
+bool pickedObjectMatrix(const PickResult& hit, float matrix[16]) {
+    if (hit.kind == PICK_SEAT && pickSeats) {
+        seatMatrix((*pickSeats)[hit.seat], matrix);
+        return true;
+    }
+    if (hit.box >= 0) {
+        for (int i = 0; i < 16; ++i) matrix[i] = pickBoxes[hit.box].matrix[i];
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef SEAT_PICKING_H
+#define SEAT_PICKING_H
+
+#include "stadiumGeometry.h"
+#include <vector>
+
+// **********************************************
+// ************ MOUSE PICKING *******************
+// **********************************************
+
+// Ray casts against a bounding volume hierarchy of every seat and solid box
+// in the stadium, plus the curved stone facade and the ground, entirely on
+// the CPU: no picking render pass and no GPU readback.
+
+// A solid box in the stadium: the matrix takes the unit cube (glutSolidCube(1))
+// to world space. name says which draw function it belongs to.
+struct PickBox {
+    float matrix[16];
+    const char* name;
+};
+
+enum PickKind {
+    PICK_NOTHING,
+    PICK_SEAT,
+    PICK_STRUCTURE, // a box, or the stone facade
+    PICK_GROUND
+};
+
+struct PickResult {
+    PickKind kind;
+    float distance;     // along the ray, in units of its direction's length
+    float point[3];
+    int seat;           // index into the layout, for PICK_SEAT
+    int box;            // index into the boxes, -1 unless a box was hit
+    const char* name;
+};
+
+// Keeps a pointer to seats, which must outlive the index.
+void buildPickIndex(const std::vector<SeatPlacement>& seats, const std::vector<PickBox>& boxes);
+
+bool pickRay(const float origin[3], const float direction[3], PickResult& hit);
+
+// Window coordinates (origin top left, like glutMouseFunc) through the
+// camera's projection * view matrix.
+bool pickScreen(int x, int y, int width, int height, const float viewProj[16], PickResult& hit);
+
+// Unit cube to world for a picked seat or box, for drawing a highlight.
+// False for the facade and the ground.
+bool pickedObjectMatrix(const PickResult& hit, float matrix[16]);
+
+#endif
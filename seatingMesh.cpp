@@ -0,0 +1,111 @@
+#include "seatingMesh.h"
+#include "geometryCache.h"
+#include "stadium.h"
+#include "glExtensions.h"
+#include "seatOccupancy.h"
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include "glTrace.h"
+
+static std::vector<SeatPlacement> seats;
+static unsigned int sectorFirst[NUM_SEAT_SECTORS + 1];
+
+// Client-side copies, kept only when there are no vertex buffers
+static std::vector<SeatVertex> vertices;
+static std::vector<unsigned int> indices;
+static GLuint vertexBuffer = 0, indexBuffer = 0;
+
+static void uploadMesh(const SeatVertex* v, const unsigned int* idx, size_t seatCount) {
+    if (!glExt.hasVertexBuffers || seatCount == 0) {
+        vertices.assign(v, v + seatCount * SEAT_VERTICES);
+        indices.assign(idx, idx + seatCount * SEAT_INDICES);
+        return;
+    }
+    glExt.GenBuffers(1, &vertexBuffer);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glExt.BufferData(GL_ARRAY_BUFFER, seatCount * SEAT_VERTICES * sizeof(SeatVertex), v, GL_STATIC_DRAW);
+    glExt.GenBuffers(1, &indexBuffer);
+    glExt.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glExt.BufferData(GL_ELEMENT_ARRAY_BUFFER, seatCount * SEAT_INDICES * sizeof(unsigned int), idx, GL_STATIC_DRAW);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    glExt.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void initSeatingMesh(const char* cachePath) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    unsigned long long hash = stadiumParamsHash();
+
+    // --- Fast path: map the cache straight into the buffers ---
+    GeometryCacheView view;
+    if (cachePath && openGeometryCache(cachePath, hash, view)) {
+        seats.assign(view.seats, view.seats + view.seatCount);
+        for (int s = 0; s <= NUM_SEAT_SECTORS; ++s) sectorFirst[s] = view.sectorFirstSeat[s];
+        uploadMesh(view.vertices, view.indices, view.seatCount);
+        closeGeometryCache(view);
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Seating: " << seats.size() << " seats mapped from " << cachePath << " in " << ms << " ms" << std::endl;
+        return;
+    }
+
+    // --- Slow path: generate, upload, and leave a cache for next time ---
+    generateSeatLayout(seats, sectorFirst);
+    std::vector<SeatVertex> builtVertices(seats.size() * SEAT_VERTICES);
+    std::vector<unsigned int> builtIndices(seats.size() * SEAT_INDICES);
+    if (!seats.empty()) buildSeatMesh(&seats[0], (int)seats.size(), &builtVertices[0], &builtIndices[0]);
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    bool written = cachePath && !seats.empty() &&
+                   writeGeometryCache(cachePath, hash, sectorFirst, &seats[0], &builtVertices[0],
+                                      &builtIndices[0], (unsigned int)seats.size());
+    uploadMesh(builtVertices.empty() ? 0 : &builtVertices[0], builtIndices.empty() ? 0 : &builtIndices[0], seats.size());
+
+    std::cout << "Seating: " << seats.size() << " seats generated in " << buildMs << " ms";
+    if (cachePath) std::cout << (written ? ", cache written to " : ", could not write cache ") << cachePath;
+    std::cout << std::endl;
+}
+
+bool seatingMeshBuffered() {
+    return vertexBuffer != 0;
+}
+
+void drawSeatingSector(int sector) {
+    unsigned int first = sectorFirst[sector], count = sectorFirst[sector + 1] - first;
+    if (!count) return;
+
+    const char* vertexBase = 0;
+    const char* indexBase = 0;
+    if (vertexBuffer) {
+        glExt.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glExt.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    } else {
+        vertexBase = (const char*)&vertices[0];
+        indexBase = (const char*)&indices[0];
+    }
+
+    glColor3f(0.1f, 0.1f, 0.9f);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(SeatVertex), vertexBase + offsetof(SeatVertex, pos));
+    glNormalPointer(GL_FLOAT, sizeof(SeatVertex), vertexBase + offsetof(SeatVertex, normal));
+    bindSeatColors(); // live occupancy colours, when a feed is attached
+    glDrawElements(GL_TRIANGLES, count * SEAT_INDICES, GL_UNSIGNED_INT,
+                   indexBase + (size_t)first * SEAT_INDICES * sizeof(unsigned int));
+    unbindSeatColors();
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+
+    if (vertexBuffer) {
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+        glExt.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+const std::vector<SeatPlacement>& seatLayout() {
+    return seats;
+}
+
+unsigned int sectorFirstSeat(int sector) {
+    return sectorFirst[sector];
+}
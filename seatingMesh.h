@@ -0,0 +1,27 @@
+#ifndef SEATING_MESH_H
+#define SEATING_MESH_H
+
+#include "stadiumGeometry.h"
+#include <vector>
+
+// **********************************************
+// ************ SEATING BOWL MESH ***************
+// **********************************************
+
+// Every seat in one vertex/index buffer pair, drawn per sector. The mesh is
+// mapped from the geometry cache when it matches the stadium parameters and
+// regenerated (and the cache rewritten) when it does not.
+
+// Call once after loadGLExtensions(). cachePath 0 always regenerates.
+void initSeatingMesh(const char* cachePath);
+
+// True when sectors draw straight from GPU buffers, so they need no display list.
+bool seatingMeshBuffered();
+
+void drawSeatingSector(int sector);
+
+// Every seat in sector/tier/seat order, with per-sector ranges.
+const std::vector<SeatPlacement>& seatLayout();
+unsigned int sectorFirstSeat(int sector);
+
+#endif
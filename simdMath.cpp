@@ -0,0 +1,363 @@
+#include "simdMath.h"
+#include <cmath>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+const int ANGLE_CHUNK = 256; // angles built on the stack per batch call
+
+// --- Angles ---
+
+// Cody-Waite split of pi/2: the first parts have few mantissa bits, so
+// q * part is exact for the q the reduction sees
+const float TWO_OVER_PI = 0.63661977236758134f;
+const float PIO2_1 = 1.5703125f;
+const float PIO2_2 = 4.837512969970703125e-4f;
+const float PIO2_3 = 7.54978995489188216e-8f;
+
+// Minimax polynomials on [-pi/4, pi/4] (Cephes sinf/cosf)
+const float SIN_1 = -1.6666654611e-1f, SIN_2 = 8.3321608736e-3f, SIN_3 = -1.9515295891e-4f;
+const float COS_1 = 4.166664568298827e-2f, COS_2 = -1.388731625493765e-3f, COS_3 = 2.443315711809948e-5f;
+
+// r is the angle less q quarter turns. Quarter turn q mod 4 maps (sin, cos)
+// of r to (s, c), (c, -s), (-s, -c), (-c, s).
+static inline void sinCosQuadrant(float r, int q, float& sine, float& cosine) {
+    float z = r * r;
+    float s = r + r * z * (SIN_1 + z * (SIN_2 + z * SIN_3));
+    float c = 1.0f - 0.5f * z + z * z * (COS_1 + z * (COS_2 + z * COS_3));
+    if (q & 1) {
+        float t = s;
+        s = c;
+        c = t;
+    }
+    sine = (q & 2) ? -s : s;
+    cosine = ((q + 1) & 2) ? -c : c;
+}
+
+static inline void sinCosRadians(float x, float& sine, float& cosine) {
+    int q = (int)std::lrint(x * TWO_OVER_PI);
+    float fq = (float)q;
+    sinCosQuadrant(((x - fq * PIO2_1) - fq * PIO2_2) - fq * PIO2_3, q, sine, cosine);
+}
+
+// Quarter turns come off exactly in degrees
+static inline void sinCosDegrees(float d, float& sine, float& cosine) {
+    int q = (int)std::lrint(d * (1.0f / 90.0f));
+    sinCosQuadrant((d - (float)q * 90.0f) * DEG_TO_RAD, q, sine, cosine);
+}
+
+#if defined(__AVX__)
+// Quadrant as a float: AVX has no 8-wide integer ops
+static inline void sinCosQuadrant8(__m256 r, __m256 q, __m256& sine, __m256& cosine) {
+    __m256 z = _mm256_mul_ps(r, r);
+    __m256 s = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(SIN_3)), _mm256_set1_ps(SIN_2));
+    s = _mm256_add_ps(_mm256_mul_ps(z, s), _mm256_set1_ps(SIN_1));
+    s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), s));
+    __m256 c = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(COS_3)), _mm256_set1_ps(COS_2));
+    c = _mm256_add_ps(_mm256_mul_ps(z, c), _mm256_set1_ps(COS_1));
+    c = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(z, z), c),
+                      _mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(z, _mm256_set1_ps(0.5f))));
+
+    __m256 m = _mm256_sub_ps(q, _mm256_mul_ps(_mm256_floor_ps(_mm256_mul_ps(q, _mm256_set1_ps(0.25f))),
+                                              _mm256_set1_ps(4.0f))); // 0..3
+    __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), negZero = _mm256_set1_ps(-0.0f);
+    __m256 swap = _mm256_or_ps(_mm256_cmp_ps(m, one, _CMP_EQ_OQ), _mm256_cmp_ps(m, _mm256_set1_ps(3.0f), _CMP_EQ_OQ));
+    __m256 sinNegative = _mm256_cmp_ps(m, two, _CMP_GE_OQ);
+    __m256 cosNegative = _mm256_and_ps(_mm256_cmp_ps(m, one, _CMP_GE_OQ), _mm256_cmp_ps(m, two, _CMP_LE_OQ));
+    sine = _mm256_xor_ps(_mm256_blendv_ps(s, c, swap), _mm256_and_ps(sinNegative, negZero));
+    cosine = _mm256_xor_ps(_mm256_blendv_ps(c, s, swap), _mm256_and_ps(cosNegative, negZero));
+}
+#elif defined(__SSE2__)
+static inline void sinCosQuadrant4(__m128 r, __m128i q, __m128& sine, __m128& cosine) {
+    __m128 z = _mm_mul_ps(r, r);
+    __m128 s = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(SIN_3)), _mm_set1_ps(SIN_2));
+    s = _mm_add_ps(_mm_mul_ps(z, s), _mm_set1_ps(SIN_1));
+    s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), s));
+    __m128 c = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(COS_3)), _mm_set1_ps(COS_2));
+    c = _mm_add_ps(_mm_mul_ps(z, c), _mm_set1_ps(COS_1));
+    c = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(z, z), c), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(z, _mm_set1_ps(0.5f))));
+
+    __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+    __m128 swappedSine = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+    __m128 swappedCosine = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+    sine = _mm_xor_ps(swappedSine, sinSign);
+    cosine = _mm_xor_ps(swappedCosine, cosSign);
+}
+#endif
+
+void sinCosBatch(const float* radians, int count, float* sines, float* cosines) {
+    int i = 0;
+#if defined(__AVX__)
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(radians + i);
+        __m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_1)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_2)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(q, _mm256_set1_ps(PIO2_3)));
+        __m256 s, c;
+        sinCosQuadrant8(r, q, s, c);
+        _mm256_storeu_ps(sines + i, s);
+        _mm256_storeu_ps(cosines + i, c);
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(radians + i);
+        __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)));
+        __m128 fq = _mm_cvtepi32_ps(q);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(fq, _mm_set1_ps(PIO2_1)));
+        r = _mm_sub_ps(r, _mm_mul_ps(fq, _mm_set1_ps(PIO2_2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(fq, _mm_set1_ps(PIO2_3)));
+        __m128 s, c;
+        sinCosQuadrant4(r, q, s, c);
+        _mm_storeu_ps(sines + i, s);
+        _mm_storeu_ps(cosines + i, c);
+    }
+#endif
+    for (; i < count; ++i) sinCosRadians(radians[i], sines[i], cosines[i]);
+}
+
+void sinCosDegreesBatch(const float* degrees, int count, float* sines, float* cosines) {
+    int i = 0;
+#if defined(__AVX__)
+    for (; i + 8 <= count; i += 8) {
+        __m256 d = _mm256_loadu_ps(degrees + i);
+        __m256 q = _mm256_round_ps(_mm256_mul_ps(d, _mm256_set1_ps(1.0f / 90.0f)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_mul_ps(_mm256_sub_ps(d, _mm256_mul_ps(q, _mm256_set1_ps(90.0f))),
+                                 _mm256_set1_ps(DEG_TO_RAD));
+        __m256 s, c;
+        sinCosQuadrant8(r, q, s, c);
+        _mm256_storeu_ps(sines + i, s);
+        _mm256_storeu_ps(cosines + i, c);
+    }
+#elif defined(__SSE2__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 d = _mm_loadu_ps(degrees + i);
+        __m128i q = _mm_cvtps_epi32(_mm_mul_ps(d, _mm_set1_ps(1.0f / 90.0f)));
+        __m128 r = _mm_mul_ps(_mm_sub_ps(d, _mm_mul_ps(_mm_cvtepi32_ps(q), _mm_set1_ps(90.0f))),
+                              _mm_set1_ps(DEG_TO_RAD));
+        __m128 s, c;
+        sinCosQuadrant4(r, q, s, c);
+        _mm_storeu_ps(sines + i, s);
+        _mm_storeu_ps(cosines + i, c);
+    }
+#endif
+    for (; i < count; ++i) sinCosDegrees(degrees[i], sines[i], cosines[i]);
+}
+
+void sinCosDegreeSteps(float startDeg, float stepDeg, int count, float* sines, float* cosines) {
+    float angles[ANGLE_CHUNK];
+    for (int first = 0; first < count; first += ANGLE_CHUNK) {
+        int n = count - first < ANGLE_CHUNK ? count - first : ANGLE_CHUNK;
+        for (int k = 0; k < n; ++k) angles[k] = startDeg + (first + k) * stepDeg;
+        sinCosDegreesBatch(angles, n, sines + first, cosines + first);
+    }
+}
+
+// --- Matrices ---
+
+void multiplyMatrixBatch(const float a[16], const float* b, int count, float* out) {
+#ifdef __SSE2__
+    // Column j of a * b is a's columns weighted by b's column j. All four
+    // columns are done before any store, so out may be a or b.
+    __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (int i = 0; i < count; ++i) {
+        const float* m = b + i * 16;
+        __m128 col[4];
+        for (int j = 0; j < 4; ++j) {
+            __m128 r = _mm_mul_ps(a0, _mm_set1_ps(m[j * 4]));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(m[j * 4 + 1])));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(m[j * 4 + 2])));
+            col[j] = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(m[j * 4 + 3])));
+        }
+        float* o = out + i * 16;
+        _mm_storeu_ps(o, col[0]);
+        _mm_storeu_ps(o + 4, col[1]);
+        _mm_storeu_ps(o + 8, col[2]);
+        _mm_storeu_ps(o + 12, col[3]);
+    }
+#else
+    float left[16];
+    for (int k = 0; k < 16; ++k) left[k] = a[k];
+    for (int i = 0; i < count; ++i) {
+        const float* m = b + i * 16;
+        float r[16];
+        for (int col = 0; col < 4; ++col) {
+            for (int row = 0; row < 4; ++row) {
+                r[col * 4 + row] = left[row] * m[col * 4] + left[4 + row] * m[col * 4 + 1] +
+                                   left[8 + row] * m[col * 4 + 2] + left[12 + row] * m[col * 4 + 3];
+            }
+        }
+        for (int k = 0; k < 16; ++k) out[i * 16 + k] = r[k];
+    }
+#endif
+}
+
+static inline void writeTransform(const float position[3], const Quat& q, const float scale[3], float* m) {
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    m[0] = (1.0f - 2.0f * (yy + zz)) * scale[0];
+    m[1] = 2.0f * (xy + wz) * scale[0];
+    m[2] = 2.0f * (xz - wy) * scale[0];
+    m[3] = 0.0f;
+    m[4] = 2.0f * (xy - wz) * scale[1];
+    m[5] = (1.0f - 2.0f * (xx + zz)) * scale[1];
+    m[6] = 2.0f * (yz + wx) * scale[1];
+    m[7] = 0.0f;
+    m[8] = 2.0f * (xz + wy) * scale[2];
+    m[9] = 2.0f * (yz - wx) * scale[2];
+    m[10] = (1.0f - 2.0f * (xx + yy)) * scale[2];
+    m[11] = 0.0f;
+    m[12] = position[0];
+    m[13] = position[1];
+    m[14] = position[2];
+    m[15] = 1.0f;
+}
+
+void composeTransforms(const ModelTransform* transforms, int count, float* matrices) {
+    for (int i = 0; i < count; ++i) {
+        const ModelTransform& t = transforms[i];
+        writeTransform(t.position, t.rotation, t.scale, matrices + i * 16);
+    }
+}
+
+void composeYawTransforms(const float* x, const float* y, const float* z, const float* yawDeg,
+                          const float* scale, int count, float* matrices) {
+    float sines[ANGLE_CHUNK], cosines[ANGLE_CHUNK];
+    for (int first = 0; first < count; first += ANGLE_CHUNK) {
+        int n = count - first < ANGLE_CHUNK ? count - first : ANGLE_CHUNK;
+        sinCosDegreesBatch(yawDeg + first, n, sines, cosines);
+        for (int k = 0; k < n; ++k) {
+            int i = first + k;
+            float sc = scale ? scale[i] : 1.0f, c = cosines[k] * sc, s = sines[k] * sc;
+            float* m = matrices + i * 16;
+            m[0] = c;    m[1] = 0.0f; m[2] = -s;   m[3] = 0.0f;
+            m[4] = 0.0f; m[5] = sc;   m[6] = 0.0f; m[7] = 0.0f;
+            m[8] = s;    m[9] = 0.0f; m[10] = c;   m[11] = 0.0f;
+            m[12] = x[i]; m[13] = y ? y[i] : 0.0f; m[14] = z[i]; m[15] = 1.0f;
+        }
+    }
+}
+
+#ifdef __SSE2__
+// Three lanes out, so the store never reaches the next element
+static inline void storeXyz(float* p, __m128 v) {
+    _mm_storel_pi((__m64*)p, v);
+    _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+#endif
+
+void transformPoints(const float m[16], const float* points, int count, float* out) {
+#ifdef __SSE2__
+    __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+    for (int i = 0; i < count; ++i) {
+        const float* p = points + i * 3;
+        __m128 r = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), _mm_mul_ps(c1, _mm_set1_ps(p[1])));
+        r = _mm_add_ps(r, _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p[2])), c3));
+        storeXyz(out + i * 3, r);
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        float px = points[i * 3], py = points[i * 3 + 1], pz = points[i * 3 + 2];
+        for (int a = 0; a < 3; ++a) out[i * 3 + a] = m[a] * px + m[4 + a] * py + m[8 + a] * pz + m[12 + a];
+    }
+#endif
+}
+
+// Arvo: the new centre is the transformed centre, the new half size the
+// absolute matrix times the old one
+void transformBoundsBatch(const float* matrices, int count, const Bounds& local, Bounds* out) {
+    float center[3], extent[3];
+    for (int a = 0; a < 3; ++a) {
+        center[a] = 0.5f * (local.min[a] + local.max[a]);
+        extent[a] = 0.5f * (local.max[a] - local.min[a]);
+    }
+#ifdef __SSE2__
+    __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (int i = 0; i < count; ++i) {
+        const float* m = matrices + i * 16;
+        __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4), c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+        __m128 mid = _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(center[0])), _mm_mul_ps(c1, _mm_set1_ps(center[1])));
+        mid = _mm_add_ps(mid, _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(center[2])), c3));
+        __m128 half = _mm_add_ps(_mm_mul_ps(_mm_and_ps(c0, absMask), _mm_set1_ps(extent[0])),
+                                 _mm_mul_ps(_mm_and_ps(c1, absMask), _mm_set1_ps(extent[1])));
+        half = _mm_add_ps(half, _mm_mul_ps(_mm_and_ps(c2, absMask), _mm_set1_ps(extent[2])));
+        storeXyz(out[i].min, _mm_sub_ps(mid, half));
+        storeXyz(out[i].max, _mm_add_ps(mid, half));
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        const float* m = matrices + i * 16;
+        for (int a = 0; a < 3; ++a) {
+            float mid = m[a] * center[0] + m[4 + a] * center[1] + m[8 + a] * center[2] + m[12 + a];
+            float half = std::fabs(m[a]) * extent[0] + std::fabs(m[4 + a]) * extent[1] + std::fabs(m[8 + a]) * extent[2];
+            out[i].min[a] = mid - half;
+            out[i].max[a] = mid + half;
+        }
+    }
+#endif
+}
+
+// --- Quaternions ---
+
+Quat quatFromAxisAngle(float deg, float ax, float ay, float az) {
+    float s, c;
+    sinCosDegrees(0.5f * deg, s, c);
+    Quat q = { ax * s, ay * s, az * s, c };
+    return q;
+}
+
+Quat quatMultiply(const Quat& a, const Quat& b) {
+    Quat q = { a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+               a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+               a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+               a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z };
+    return q;
+}
+
+void quatToMatrix(const Quat& q, float m[16]) {
+    const float origin[3] = { 0.0f, 0.0f, 0.0f }, unit[3] = { 1.0f, 1.0f, 1.0f };
+    writeTransform(origin, q, unit, m);
+}
+
+#ifdef __SSE2__
+static inline __m128 dot4(__m128 a, __m128 b) {
+    __m128 m = _mm_mul_ps(a, b);
+    m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2))); // in every lane
+}
+#endif
+
+void nlerpQuats(const Quat* a, const Quat* b, float t, int count, Quat* out) {
+#ifdef __SSE2__
+    __m128 weight = _mm_set1_ps(t), negZero = _mm_set1_ps(-0.0f);
+    for (int i = 0; i < count; ++i) {
+        __m128 from = _mm_loadu_ps(&a[i].x), to = _mm_loadu_ps(&b[i].x);
+        // q and -q are the same rotation: take the one on from's side
+        to = _mm_xor_ps(to, _mm_and_ps(_mm_cmplt_ps(dot4(from, to), _mm_setzero_ps()), negZero));
+        __m128 q = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), weight));
+        _mm_storeu_ps(&out[i].x, _mm_div_ps(q, _mm_sqrt_ps(dot4(q, q))));
+    }
+#else
+    for (int i = 0; i < count; ++i) {
+        const Quat& from = a[i];
+        Quat to = b[i];
+        if (from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w < 0.0f) {
+            to.x = -to.x; to.y = -to.y; to.z = -to.z; to.w = -to.w;
+        }
+        Quat q = { from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t,
+                   from.z + (to.z - from.z) * t, from.w + (to.w - from.w) * t };
+        float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        out[i].x = q.x / len; out[i].y = q.y / len; out[i].z = q.z / len; out[i].w = q.w / len;
+    }
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef SIMD_MATH_H
+#define SIMD_MATH_H
+
+#include "viewMath.h"
+
+// **********************************************
+// ************ SIMD MATH ***********************
+// **********************************************
+
+// Batched vector, matrix and quaternion kernels for the CPU-side transform
+// work: seat and ellipse generation, model matrices for props and players,
+// world bounds for culling. Each kernel has an SSE2 body and a plain C++ one
+// for other targets, picked at compile time; sines and cosines go eight wide
+// when the build targets AVX. Matrices are column-major float[16] as in
+// viewMath, packed back to back in arrays. Unaligned data is fine.
+
+const float DEG_TO_RAD = 0.017453292519943296f;
+
+// x, y, z, w; a rotation when unit length
+struct Quat {
+    float x, y, z, w;
+};
+
+// What glTranslatef(position) <rotation> glScalef(scale) builds
+struct ModelTransform {
+    float position[3];
+    Quat rotation;
+    float scale[3];
+};
+
+// --- Angles ---
+// Polynomials after a quarter-turn range reduction: within 2e-7 of the
+// exact values for |angle| up to 8000 radians (or degrees, any size)
+void sinCosBatch(const float* radians, int count, float* sines, float* cosines);
+void sinCosDegreesBatch(const float* degrees, int count, float* sines, float* cosines);
+// sin and cos of startDeg + i * stepDeg, i = 0 .. count-1
+void sinCosDegreeSteps(float startDeg, float stepDeg, int count, float* sines, float* cosines);
+
+// --- Matrices ---
+void multiplyMatrixBatch(const float a[16], const float* b, int count, float* out); // out[i] = a * b[i]
+void composeTransforms(const ModelTransform* transforms, int count, float* matrices);
+// translate(x, y, z) rotate(yawDeg about +y) uniform scale; y and scale may
+// be null for all 0 and all 1
+void composeYawTransforms(const float* x, const float* y, const float* z, const float* yawDeg,
+                          const float* scale, int count, float* matrices);
+
+// Affine only: xyz triples in and out, in place allowed
+void transformPoints(const float m[16], const float* points, int count, float* out);
+// The box around the transformed box, one per matrix
+void transformBoundsBatch(const float* matrices, int count, const Bounds& local, Bounds* out);
+
+// --- Quaternions ---
+Quat quatFromAxisAngle(float deg, float ax, float ay, float az); // unit axis
+Quat quatMultiply(const Quat& a, const Quat& b);                 // rotate by b, then by a
+void quatToMatrix(const Quat& q, float m[16]);
+// Normalized lerp from a[i] towards b[i] along the shorter arc
+void nlerpQuats(const Quat* a, const Quat* b, float t, int count, Quat* out);
+
+#endif
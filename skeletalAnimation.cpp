@@ -0,0 +1,340 @@
+#include "skeletalAnimation.h"
+#include "jobSystem.h"
+#include "renderStats.h"
+#include "simdMath.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+const int BLEND_STEPS = 16;          // blend weights are rounded to sixteenths
+const int BLEND_TABLE_SIZE = 4096;   // a power of two
+const int MAX_BLENDS = BLEND_TABLE_SIZE / 2; // per call; beyond that the nearer clip is used
+const int FIGURES_PER_JOB = 512;
+
+enum Bone {
+    BONE_PELVIS,
+    BONE_TORSO,
+    BONE_HEAD,
+    BONE_RIGHT_ARM,
+    BONE_LEFT_ARM,
+    BONE_RIGHT_THIGH,
+    BONE_RIGHT_SHIN,
+    BONE_LEFT_THIGH,
+    BONE_LEFT_SHIN,
+    NUM_BONES
+};
+
+// Part p hangs off bone p + 1; the pelvis carries none. Parents come first.
+struct BoneRig {
+    int parent;
+    float joint[3];      // from the parent's joint in the bind pose
+    float partCenter[3]; // from the joint
+    float partSize[3];   // box edges, or the head's radius
+};
+
+// The bind pose is the old rigid player: 0.9 legs split at the knee, a
+// 0.6 x 0.7 torso, 0.5 arms from the shoulders and a 0.25 head. Facing +z,
+// the figure's right is -x.
+static const BoneRig RIG[NUM_BONES] = {
+    { -1,               {  0.0f,  0.9f,  0.0f }, { 0.0f,  0.0f,   0.0f }, { 0.0f,  0.0f,  0.0f } },
+    { BONE_PELVIS,      {  0.0f,  0.0f,  0.0f }, { 0.0f,  0.35f,  0.0f }, { 0.6f,  0.7f,  0.3f } },
+    { BONE_TORSO,       {  0.0f,  0.7f,  0.0f }, { 0.0f,  0.25f,  0.0f }, { 0.25f, 0.25f, 0.25f } },
+    { BONE_TORSO,       { -0.4f,  0.75f, 0.0f }, { 0.0f, -0.25f,  0.0f }, { 0.15f, 0.5f,  0.15f } },
+    { BONE_TORSO,       {  0.4f,  0.75f, 0.0f }, { 0.0f, -0.25f,  0.0f }, { 0.15f, 0.5f,  0.15f } },
+    { BONE_PELVIS,      { -0.15f, 0.0f,  0.0f }, { 0.0f, -0.225f, 0.0f }, { 0.2f,  0.45f, 0.2f } },
+    { BONE_RIGHT_THIGH, {  0.0f, -0.45f, 0.0f }, { 0.0f, -0.225f, 0.0f }, { 0.2f,  0.45f, 0.2f } },
+    { BONE_PELVIS,      {  0.15f, 0.0f,  0.0f }, { 0.0f, -0.225f, 0.0f }, { 0.2f,  0.45f, 0.2f } },
+    { BONE_LEFT_THIGH,  {  0.0f, -0.45f, 0.0f }, { 0.0f, -0.225f, 0.0f }, { 0.2f,  0.45f, 0.2f } }
+};
+
+// Degrees about the bone's x axis, then its z axis. Pitch swings a hanging
+// limb forward when negative, bends a knee when positive and leans the
+// torso forward when positive; roll turns a hanging limb towards +x.
+struct ClipKey {
+    float pelvisShift[2]; // x, y from the bind pose
+    float angles[NUM_BONES][2];
+};
+
+// --- Clips: bones in enum order, pelvis, torso, head, arms R/L, right leg, left leg ---
+
+static const ClipKey IDLE_KEYS[] = {
+    { { 0.0f,  0.0f  }, { {0,0}, {0, 0}, { 0,0}, { 0,-4}, { 0,4}, { 0,0}, {0,0}, { 0,0}, {0,0} } },
+    { { 0.0f, -0.01f }, { {0,0}, {2, 1}, {-3,0}, { 3,-6}, { 3,6}, {-2,0}, {4,0}, {-2,0}, {4,0} } },
+    { { 0.0f,  0.0f  }, { {0,0}, {0, 0}, { 0,0}, { 0,-4}, { 0,4}, { 0,0}, {0,0}, { 0,0}, {0,0} } },
+    { { 0.0f, -0.01f }, { {0,0}, {2,-1}, {-3,2}, {-2,-6}, {-2,6}, {-2,0}, {4,0}, {-2,0}, {4,0} } }
+};
+
+// Right foot down, passing, left foot down, passing
+static const ClipKey RUN_KEYS[] = {
+    { { 0.0f, -0.04f }, { {0,0}, {10,0}, {-6,0}, { 35, 0}, {-35,0}, {-35,0}, {15,0}, { 25,0}, {60,0} } },
+    { { 0.0f,  0.06f }, { {0,0}, {10,0}, {-6,0}, {  0,-4}, {  0,4}, {  0,0}, {10,0}, {-15,0}, {95,0} } },
+    { { 0.0f, -0.04f }, { {0,0}, {10,0}, {-6,0}, {-35, 0}, { 35,0}, { 25,0}, {60,0}, {-35,0}, {15,0} } },
+    { { 0.0f,  0.06f }, { {0,0}, {10,0}, {-6,0}, {  0,-4}, {  0,4}, {-15,0}, {95,0}, {  0,0}, {10,0} } }
+};
+
+// Last stride, wind-up, strike, follow-through, recover
+static const ClipKey KICK_KEYS[] = {
+    { { 0.0f, -0.03f }, { {0,0}, {  8,0}, {-5,0}, { 20,-10}, {-20,10}, { 25,0}, { 70,0}, {-20,0}, {15,0} } },
+    { { 0.0f, -0.05f }, { {0,0}, { -2,0}, { 0,0}, {-30,-25}, { 20,35}, { 45,0}, {100,0}, { -5,0}, {20,0} } },
+    { { 0.0f, -0.02f }, { {0,0}, { -8,0}, { 5,0}, { 30,-35}, {-30,40}, {-45,0}, { 20,0}, {  0,0}, {10,0} } },
+    { { 0.0f,  0.02f }, { {0,0}, {-15,0}, { 8,0}, { 40,-30}, {-40,30}, {-85,0}, {  5,0}, {  5,0}, { 5,0} } },
+    { { 0.0f,  0.0f  }, { {0,0}, {  0,0}, { 0,0}, {  0, -6}, {  0, 6}, {-10,0}, { 20,0}, {  0,0}, { 5,0} } }
+};
+
+// Set, push off, flight, on the ground: the body rolls onto its left side
+// with both arms stretched past the head
+static const ClipKey DIVE_LEFT_KEYS[] = {
+    { { 0.0f, -0.15f }, { {0,  0}, {12,  0}, {-8, 0}, {-30, -20}, {-30, 20}, {-25, -8}, {50,0}, {-25, 8}, {50,0} } },
+    { { 0.2f, -0.1f  }, { {0,-35}, { 5,-10}, { 0,-5}, {  0,-120}, {  0,130}, {-10, -5}, {20,0}, {-30,20}, {60,0} } },
+    { { 0.5f, -0.35f }, { {0,-75}, { 0, -8}, { 0,-5}, {  0,-170}, {  0,165}, {  0,-10}, {15,0}, {-10,15}, {25,0} } },
+    { { 0.7f, -0.55f }, { {0,-88}, { 0, -2}, { 0,-5}, {  0,-172}, {  0,170}, {  0, -5}, {10,0}, {  0,10}, {15,0} } }
+};
+
+const int DIVE_KEY_COUNT = sizeof(DIVE_LEFT_KEYS) / sizeof(DIVE_LEFT_KEYS[0]);
+static ClipKey diveRightKeys[DIVE_KEY_COUNT]; // mirrored at init
+
+struct ClipDef {
+    const ClipKey* keys;
+    int keyCount;
+    float seconds;
+    bool loops;
+};
+
+static const ClipDef CLIPS[NUM_ANIM_CLIPS] = {
+    { IDLE_KEYS, sizeof(IDLE_KEYS) / sizeof(IDLE_KEYS[0]), 2.4f, true },
+    { RUN_KEYS, sizeof(RUN_KEYS) / sizeof(RUN_KEYS[0]), 0.6f, true },
+    { KICK_KEYS, sizeof(KICK_KEYS) / sizeof(KICK_KEYS[0]), 0.5f, false },
+    { DIVE_LEFT_KEYS, DIVE_KEY_COUNT, 0.8f, false },
+    { diveRightKeys, DIVE_KEY_COUNT, 0.8f, false }
+};
+
+// A pose before the hierarchy: what blends are made from
+struct SampledPose {
+    Quat rotation[NUM_BONES];
+    float pelvisShift[2];
+};
+
+static bool ready = false;
+static float partLocal[NUM_BONES][16]; // translate(partCenter) scale(partSize)
+static SampledPose samples[NUM_ANIM_CLIPS * POSE_SAMPLES];
+static float cachedPoses[NUM_ANIM_CLIPS * POSE_SAMPLES * POSE_FLOATS];
+
+// Blends made by the current resolveFigurePoses() call, found by key in a
+// table whose slots count as empty unless stamped with this call
+static unsigned int blendKeys[BLEND_TABLE_SIZE];
+static unsigned int blendStamps[BLEND_TABLE_SIZE];
+static int blendIndices[BLEND_TABLE_SIZE];
+static unsigned int currentStamp = 0;
+static std::vector<float> blendPoses;
+static std::vector<int> poseRefs; // >= 0 a cached sample, < 0 blend -1 - ref
+
+static void mirrorClip(const ClipKey* from, int count, ClipKey* to) {
+    static const int MIRROR[NUM_BONES] = { BONE_PELVIS, BONE_TORSO, BONE_HEAD, BONE_LEFT_ARM, BONE_RIGHT_ARM,
+                                           BONE_LEFT_THIGH, BONE_LEFT_SHIN, BONE_RIGHT_THIGH, BONE_RIGHT_SHIN };
+    for (int k = 0; k < count; ++k) {
+        to[k].pelvisShift[0] = -from[k].pelvisShift[0];
+        to[k].pelvisShift[1] = from[k].pelvisShift[1];
+        for (int b = 0; b < NUM_BONES; ++b) {
+            to[k].angles[b][0] = from[k].angles[MIRROR[b]][0];
+            to[k].angles[b][1] = -from[k].angles[MIRROR[b]][1];
+        }
+    }
+}
+
+// Linear between the two keys around the phase
+static void sampleKeys(int clip, float phase, SampledPose& out) {
+    const ClipDef& c = CLIPS[clip];
+    int k0;
+    float f;
+    if (c.loops) {
+        float t = (phase - std::floor(phase)) * c.keyCount;
+        k0 = (int)t;
+        f = t - k0;
+        k0 %= c.keyCount;
+    } else {
+        float t = std::min(std::max(phase, 0.0f), 1.0f) * (c.keyCount - 1);
+        k0 = std::min((int)t, c.keyCount - 2);
+        f = t - k0;
+    }
+    const ClipKey& a = c.keys[k0];
+    const ClipKey& b = c.keys[(k0 + 1) % c.keyCount];
+    for (int i = 0; i < 2; ++i) out.pelvisShift[i] = a.pelvisShift[i] + (b.pelvisShift[i] - a.pelvisShift[i]) * f;
+    for (int bone = 0; bone < NUM_BONES; ++bone) {
+        float pitch = a.angles[bone][0] + (b.angles[bone][0] - a.angles[bone][0]) * f;
+        float roll = a.angles[bone][1] + (b.angles[bone][1] - a.angles[bone][1]) * f;
+        out.rotation[bone] = quatMultiply(quatFromAxisAngle(roll, 0.0f, 0.0f, 1.0f),
+                                          quatFromAxisAngle(pitch, 1.0f, 0.0f, 0.0f));
+    }
+}
+
+// Down the hierarchy to a matrix per part
+static void buildPose(const SampledPose& s, float* pose) {
+    ModelTransform local[NUM_BONES];
+    for (int b = 0; b < NUM_BONES; ++b) {
+        ModelTransform& t = local[b];
+        for (int a = 0; a < 3; ++a) {
+            t.position[a] = RIG[b].joint[a];
+            t.scale[a] = 1.0f;
+        }
+        t.rotation = s.rotation[b];
+    }
+    local[BONE_PELVIS].position[0] += s.pelvisShift[0];
+    local[BONE_PELVIS].position[1] += s.pelvisShift[1];
+
+    float bones[NUM_BONES * 16];
+    composeTransforms(local, NUM_BONES, bones);
+    for (int b = 1; b < NUM_BONES; ++b) {
+        multiplyMatrices(bones + 16 * RIG[b].parent, bones + 16 * b, bones + 16 * b);
+        multiplyMatrices(bones + 16 * b, partLocal[b], pose + 16 * (b - 1));
+    }
+}
+
+void initSkeletalAnimation() {
+    if (ready) return;
+    mirrorClip(DIVE_LEFT_KEYS, DIVE_KEY_COUNT, diveRightKeys);
+    for (int b = 0; b < NUM_BONES; ++b) {
+        ModelTransform t;
+        for (int a = 0; a < 3; ++a) {
+            t.position[a] = RIG[b].partCenter[a];
+            t.scale[a] = RIG[b].partSize[a];
+        }
+        t.rotation.x = t.rotation.y = t.rotation.z = 0.0f;
+        t.rotation.w = 1.0f;
+        composeTransforms(&t, 1, partLocal[b]);
+    }
+    for (int clip = 0; clip < NUM_ANIM_CLIPS; ++clip) {
+        for (int s = 0; s < POSE_SAMPLES; ++s) {
+            int at = clip * POSE_SAMPLES + s;
+            float phase = CLIPS[clip].loops ? (float)s / POSE_SAMPLES : (float)s / (POSE_SAMPLES - 1);
+            sampleKeys(clip, phase, samples[at]);
+            buildPose(samples[at], cachedPoses + at * POSE_FLOATS);
+        }
+    }
+    blendPoses.reserve(64 * POSE_FLOATS);
+    ready = true;
+}
+
+float clipSeconds(int clip) {
+    return CLIPS[clip].seconds;
+}
+
+bool clipLoops(int clip) {
+    return CLIPS[clip].loops;
+}
+
+void sampleFigurePose(int clip, float phase, float pose[POSE_FLOATS]) {
+    initSkeletalAnimation();
+    SampledPose s;
+    sampleKeys(clip, phase, s);
+    buildPose(s, pose);
+}
+
+// The nearest cached phase
+static int sampleIndex(int clip, float phase) {
+    if (CLIPS[clip].loops) {
+        int s = (int)((phase - std::floor(phase)) * POSE_SAMPLES + 0.5f);
+        return clip * POSE_SAMPLES + s % POSE_SAMPLES;
+    }
+    float p = std::min(std::max(phase, 0.0f), 1.0f);
+    return clip * POSE_SAMPLES + (int)(p * (POSE_SAMPLES - 1) + 0.5f);
+}
+
+// Index of the blend in blendPoses, made on first use this call; -1 when the table is full
+static int findBlend(int from, int to, int step, int& blendCount) {
+    unsigned int key = ((unsigned int)from * (NUM_ANIM_CLIPS * POSE_SAMPLES) + to) * BLEND_STEPS + step;
+    unsigned int slot = (key * 2654435761u) >> 20; // 12 bits: BLEND_TABLE_SIZE
+    while (blendStamps[slot] == currentStamp) {
+        if (blendKeys[slot] == key) return blendIndices[slot];
+        slot = (slot + 1) & (BLEND_TABLE_SIZE - 1);
+    }
+    if (blendCount == MAX_BLENDS) return -1;
+
+    int index = blendCount++;
+    blendStamps[slot] = currentStamp;
+    blendKeys[slot] = key;
+    blendIndices[slot] = index;
+    if (blendPoses.size() < (size_t)(index + 1) * POSE_FLOATS) blendPoses.resize((index + 1) * POSE_FLOATS);
+
+    const SampledPose& a = samples[from];
+    const SampledPose& b = samples[to];
+    float t = 1.0f - (float)step / BLEND_STEPS;
+    SampledPose mixed;
+    nlerpQuats(a.rotation, b.rotation, t, NUM_BONES, mixed.rotation);
+    for (int i = 0; i < 2; ++i) mixed.pelvisShift[i] = a.pelvisShift[i] + (b.pelvisShift[i] - a.pelvisShift[i]) * t;
+    buildPose(mixed, &blendPoses[index * POSE_FLOATS]);
+    return index;
+}
+
+void resolveFigurePoses(const AnimFigure* figures, int count, const float** poses) {
+    initSkeletalAnimation();
+    if (++currentStamp == 0) { // wrapped: old stamps could match again
+        std::fill(blendStamps, blendStamps + BLEND_TABLE_SIZE, 0u);
+        currentStamp = 1;
+    }
+    if ((int)poseRefs.size() < count) poseRefs.resize(count);
+
+    int blendCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const AnimFigure& f = figures[i];
+        int to = sampleIndex(f.clip, f.phase);
+        int step = f.fromClip < 0 ? 0 : (int)(f.fromWeight * BLEND_STEPS + 0.5f);
+        if (step <= 0) {
+            poseRefs[i] = to;
+            continue;
+        }
+        int from = sampleIndex(f.fromClip, f.fromPhase);
+        int blend = step < BLEND_STEPS && from != to ? findBlend(from, to, step, blendCount) : -1;
+        if (blend >= 0) poseRefs[i] = -1 - blend;
+        else poseRefs[i] = 2 * step > BLEND_STEPS ? from : to;
+    }
+    // Only now: blendPoses may have moved while growing
+    for (int i = 0; i < count; ++i) {
+        int ref = poseRefs[i];
+        poses[i] = ref >= 0 ? cachedPoses + ref * POSE_FLOATS : &blendPoses[(-1 - ref) * POSE_FLOATS];
+    }
+    statsAdd(STAT_FIGURES_ANIMATED, count);
+    statsAdd(STAT_POSE_BLENDS, blendCount);
+}
+
+// --- World matrices, a job per FIGURES_PER_JOB figures ---
+
+struct AnimateJob {
+    const AnimFigure* figures;
+    const float* const* poses;
+    int count;
+    float* out;
+};
+
+static void animateJob(int job, int, void* context) {
+    const AnimateJob& a = *(const AnimateJob*)context;
+    int first = job * FIGURES_PER_JOB;
+    int n = std::min(a.count - first, FIGURES_PER_JOB);
+    if (n <= 0) return;
+    float x[FIGURES_PER_JOB], y[FIGURES_PER_JOB], z[FIGURES_PER_JOB], yaw[FIGURES_PER_JOB];
+    for (int i = 0; i < n; ++i) {
+        const AnimFigure& f = a.figures[first + i];
+        x[i] = f.x;
+        y[i] = f.y;
+        z[i] = f.z;
+        yaw[i] = f.yawDeg;
+    }
+    float roots[FIGURES_PER_JOB * 16];
+    composeYawTransforms(x, y, z, yaw, 0, n, roots);
+    for (int i = 0; i < n; ++i)
+        multiplyMatrixBatch(roots + 16 * i, a.poses[first + i], NUM_FIGURE_PARTS, a.out + (first + i) * POSE_FLOATS);
+}
+
+static std::vector<const float*> posePointers;
+
+void animateFigures(const AnimFigure* figures, int count, float* partMatrices) {
+    if (count <= 0) return;
+    if ((int)posePointers.size() < count) posePointers.resize(count);
+    resolveFigurePoses(figures, count, &posePointers[0]);
+
+    AnimateJob a;
+    a.figures = figures;
+    a.poses = &posePointers[0];
+    a.count = count;
+    a.out = partMatrices;
+    parallelFor((count + FIGURES_PER_JOB - 1) / FIGURES_PER_JOB, animateJob, &a);
+}
@@ -0,0 +1,69 @@
+#ifndef SKELETAL_ANIMATION_H
+#define SKELETAL_ANIMATION_H
+
+// **********************************************
+// ************ SKELETAL ANIMATION **************
+// **********************************************
+
+// Keyframed clips for a nine-bone figure whose body parts are rigid boxes
+// and a sphere for the head, the way the players have always been drawn.
+// Every clip is sampled ahead of time into a pose cache: for each of
+// POSE_SAMPLES phases, the matrix of every part relative to the figure's
+// feet. Figures in the same clip and phase share one cached pose, and a
+// blend between two clips is built once per distinct pair and weight, so
+// a figure costs a root matrix and one batch of products whatever it is
+// doing. No OpenGL: the results are plain matrices for the scene graph,
+// instancing or the benchmarks, and work for crowd figures as well.
+
+enum AnimClip {
+    CLIP_IDLE,
+    CLIP_RUN,
+    CLIP_KICK,       // right foot
+    CLIP_DIVE_LEFT,  // towards the figure's left (+x before its yaw)
+    CLIP_DIVE_RIGHT,
+    NUM_ANIM_CLIPS
+};
+
+// In the order of the pose matrices
+enum FigurePart {
+    PART_TORSO,
+    PART_HEAD,       // a unit sphere; the rest are unit cubes
+    PART_RIGHT_ARM,
+    PART_LEFT_ARM,
+    PART_RIGHT_THIGH,
+    PART_RIGHT_SHIN,
+    PART_LEFT_THIGH,
+    PART_LEFT_SHIN,
+    NUM_FIGURE_PARTS
+};
+
+const int POSE_SAMPLES = 64; // cached phases per clip
+const int POSE_FLOATS = NUM_FIGURE_PARTS * 16;
+
+struct AnimFigure {
+    float x, y, z, yawDeg;  // feet; faces +z at yaw 0
+    int clip;
+    float phase;            // 0-1 through the clip, wrapped if it loops
+    int fromClip;           // the clip being blended out of, -1 for none
+    float fromPhase;
+    float fromWeight;       // 1 = all fromClip, 0 = all clip
+};
+
+// Samples every clip into the pose cache; later calls do nothing
+void initSkeletalAnimation();
+
+float clipSeconds(int clip);
+bool clipLoops(int clip);
+
+// The pose straight from the keyframes, bypassing the cache
+void sampleFigurePose(int clip, float phase, float pose[POSE_FLOATS]);
+
+// Parts relative to each figure's root, one pointer per figure, valid
+// until the next call. Main thread only.
+void resolveFigurePoses(const AnimFigure* figures, int count, const float** poses);
+
+// World matrices of every part, NUM_FIGURE_PARTS per figure in figure
+// order. Large batches are split over the job system.
+void animateFigures(const AnimFigure* figures, int count, float* partMatrices);
+
+#endif
@@ -0,0 +1,444 @@
+#include "softRaster.h"
+#include "jobSystem.h"
+#include "viewMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+const int SOFT_TILE_SIZE = 64;        // pixels per tile side, a multiple of 4
+const int SOFT_TRIANGLES_PER_JOB = 1024;
+
+// A screen-space triangle ready to rasterize: edge functions, depth and
+// colour as planes in x and y, pre-divided by the area so the edge values
+// are the barycentric weights.
+struct SetupTriangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depth[3];                 // plane: A, B, C
+    float red[3], green[3], blue[3];
+    unsigned int flatColor;
+    bool flat;
+    int minX, minY, maxX, maxY;     // inclusive pixel bounds
+};
+
+struct DrawBatch {
+    const SoftVertex* vertices;
+    int triangleCount;
+    SoftShading shading;
+    int firstTriangle;
+};
+
+struct BinEntry {
+    int tile;
+    int triangle; // index into the job's setups
+};
+
+struct JobOutput {
+    std::vector<SetupTriangle> setups;
+    std::vector<BinEntry> bins;
+};
+
+// Clip-space vertex with its lit colour (0-255), used while clipping
+struct ClipVertex {
+    float pos[4];
+    float color[3];
+};
+
+static int width = 0, height = 0, stride = 0;
+static int tilesX = 0, tilesY = 0;
+static std::vector<unsigned int> colorBuffer;
+static std::vector<float> depthBuffer;
+static std::vector<unsigned char> output;
+static unsigned int clearValue = 0;
+
+static float viewMatrix[16], viewProjMatrix[16];
+static SoftLight lights[SOFT_MAX_LIGHTS];
+static int lightCount = 0;
+static float ambientLight[3] = { 0.2f, 0.2f, 0.2f };
+
+static std::vector<DrawBatch> batches;
+static int totalTriangles = 0;
+static std::vector<JobOutput> jobOutputs;
+static std::vector<int> tileStart;                 // tilesX * tilesY + 1 offsets into tileTriangles
+static std::vector<const SetupTriangle*> tileTriangles;
+static int trianglesRasterized = 0;
+
+static unsigned int packColor(float r, float g, float b) {
+    unsigned int ir = (unsigned int)std::min(std::max(r, 0.0f), 255.0f);
+    unsigned int ig = (unsigned int)std::min(std::max(g, 0.0f), 255.0f);
+    unsigned int ib = (unsigned int)std::min(std::max(b, 0.0f), 255.0f);
+    return ir | (ig << 8) | (ib << 16) | 0xFF000000u;
+}
+
+// **********************************************
+// ************ FRAME SETUP *********************
+// **********************************************
+
+void softBeginFrame(int w, int h, const float clearColor[3]) {
+    width = w;
+    height = h;
+    tilesX = (w + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    tilesY = (h + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+    stride = tilesX * SOFT_TILE_SIZE;
+    size_t pixels = (size_t)stride * tilesY * SOFT_TILE_SIZE;
+    if (colorBuffer.size() != pixels) {
+        colorBuffer.resize(pixels);
+        depthBuffer.resize(pixels);
+    }
+    clearValue = packColor(clearColor[0] * 255.0f, clearColor[1] * 255.0f, clearColor[2] * 255.0f);
+    batches.clear();
+    totalTriangles = 0;
+}
+
+void softSetMatrices(const float projection[16], const float view[16]) {
+    std::memcpy(viewMatrix, view, sizeof(viewMatrix));
+    multiplyMatrices(projection, view, viewProjMatrix);
+}
+
+void softSetLights(const SoftLight* l, int count, const float globalAmbient[3]) {
+    lightCount = std::min(count, SOFT_MAX_LIGHTS);
+    for (int i = 0; i < lightCount; ++i) lights[i] = l[i];
+    for (int k = 0; k < 3; ++k) ambientLight[k] = globalAmbient[k];
+}
+
+void softDrawTriangles(const SoftVertex* vertices, int vertexCount, SoftShading shading) {
+    DrawBatch b;
+    b.vertices = vertices;
+    b.triangleCount = vertexCount / 3;
+    b.shading = shading;
+    b.firstTriangle = totalTriangles;
+    if (b.triangleCount <= 0) return;
+    batches.push_back(b);
+    totalTriangles += b.triangleCount;
+}
+
+// **********************************************
+// ************ VERTEX STAGE ********************
+// **********************************************
+
+// Fixed-function lighting with GL_COLOR_MATERIAL (ambient and diffuse
+// follow the vertex colour, no specular since the material has none).
+static void lightVertex(const SoftVertex& v, float out[3]) {
+    const float* m = viewMatrix;
+    float eye[3], n[3];
+    for (int r = 0; r < 3; ++r) {
+        eye[r] = m[r] * v.pos[0] + m[4 + r] * v.pos[1] + m[8 + r] * v.pos[2] + m[12 + r];
+        n[r] = m[r] * v.normal[0] + m[4 + r] * v.normal[1] + m[8 + r] * v.normal[2];
+    }
+    float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (len > 0.0f) { n[0] /= len; n[1] /= len; n[2] /= len; }
+
+    float c[3] = { v.color[0] / 255.0f, v.color[1] / 255.0f, v.color[2] / 255.0f };
+    float sum[3] = { c[0] * ambientLight[0], c[1] * ambientLight[1], c[2] * ambientLight[2] };
+    for (int i = 0; i < lightCount; ++i) {
+        const SoftLight& l = lights[i];
+        float L[3] = { l.position[0] - eye[0], l.position[1] - eye[1], l.position[2] - eye[2] };
+        float d = std::sqrt(L[0] * L[0] + L[1] * L[1] + L[2] * L[2]);
+        float ndotl = d > 0.0f ? std::max((n[0] * L[0] + n[1] * L[1] + n[2] * L[2]) / d, 0.0f) : 0.0f;
+        float att = 1.0f / (l.constantAttenuation + l.linearAttenuation * d);
+        for (int k = 0; k < 3; ++k) sum[k] += att * c[k] * (l.ambient[k] + l.diffuse[k] * ndotl);
+    }
+    for (int k = 0; k < 3; ++k) out[k] = std::min(sum[k], 1.0f) * 255.0f;
+}
+
+static void toClip(const SoftVertex& v, ClipVertex& out) {
+    const float* m = viewProjMatrix;
+    for (int r = 0; r < 4; ++r)
+        out.pos[r] = m[r] * v.pos[0] + m[4 + r] * v.pos[1] + m[8 + r] * v.pos[2] + m[12 + r];
+}
+
+static void lerpClip(const ClipVertex& a, const ClipVertex& b, float t, ClipVertex& out) {
+    for (int k = 0; k < 4; ++k) out.pos[k] = a.pos[k] + (b.pos[k] - a.pos[k]) * t;
+    for (int k = 0; k < 3; ++k) out.color[k] = a.color[k] + (b.color[k] - a.color[k]) * t;
+}
+
+static void setupTriangle(const ClipVertex* v0, const ClipVertex* v1, const ClipVertex* v2, bool flat,
+                          JobOutput& out) {
+    float sx[3], sy[3], sz[3];
+    const ClipVertex* v[3] = { v0, v1, v2 };
+    for (int i = 0; i < 3; ++i) {
+        float invW = 1.0f / v[i]->pos[3];
+        sx[i] = (v[i]->pos[0] * invW * 0.5f + 0.5f) * width;
+        sy[i] = (v[i]->pos[1] * invW * 0.5f + 0.5f) * height;
+        sz[i] = v[i]->pos[2] * invW * 0.5f + 0.5f;
+    }
+    float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+    if (std::fabs(area) < 1e-6f) return;
+    if (area < 0.0f) { // no face culling in this scene: flip to counter-clockwise
+        std::swap(sx[1], sx[2]); std::swap(sy[1], sy[2]); std::swap(sz[1], sz[2]);
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+
+    SetupTriangle t;
+    float minXf = std::min(sx[0], std::min(sx[1], sx[2])), maxXf = std::max(sx[0], std::max(sx[1], sx[2]));
+    float minYf = std::min(sy[0], std::min(sy[1], sy[2])), maxYf = std::max(sy[0], std::max(sy[1], sy[2]));
+    t.minX = std::max((int)std::floor(minXf), 0);
+    t.minY = std::max((int)std::floor(minYf), 0);
+    t.maxX = std::min((int)std::ceil(maxXf), width - 1);
+    t.maxY = std::min((int)std::ceil(maxYf), height - 1);
+    if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+    float inv = 1.0f / area;
+    for (int i = 0; i < 3; ++i) {
+        int a = (i + 1) % 3, b = (i + 2) % 3; // edge opposite vertex i
+        t.edgeA[i] = (sy[a] - sy[b]) * inv;
+        t.edgeB[i] = (sx[b] - sx[a]) * inv;
+        t.edgeC[i] = -(t.edgeA[i] * sx[a] + t.edgeB[i] * sy[a]);
+    }
+    // Any per-vertex value as a plane: sum of value_i * barycentric_i
+    float* planes[4] = { t.depth, t.red, t.green, t.blue };
+    for (int p = 0; p < 4; ++p) {
+        float value[3];
+        for (int i = 0; i < 3; ++i) value[i] = p == 0 ? sz[i] : v[i]->color[p - 1];
+        planes[p][0] = value[0] * t.edgeA[0] + value[1] * t.edgeA[1] + value[2] * t.edgeA[2];
+        planes[p][1] = value[0] * t.edgeB[0] + value[1] * t.edgeB[1] + value[2] * t.edgeB[2];
+        planes[p][2] = value[0] * t.edgeC[0] + value[1] * t.edgeC[1] + value[2] * t.edgeC[2];
+    }
+    t.flat = flat;
+    t.flatColor = packColor(v0->color[0], v0->color[1], v0->color[2]);
+
+    // Bin into every tile the bounds touch, skipping tiles wholly outside an edge
+    int index = (int)out.setups.size();
+    out.setups.push_back(t);
+    for (int ty = t.minY / SOFT_TILE_SIZE; ty <= t.maxY / SOFT_TILE_SIZE; ++ty) {
+        for (int tx = t.minX / SOFT_TILE_SIZE; tx <= t.maxX / SOFT_TILE_SIZE; ++tx) {
+            float x0 = (float)(tx * SOFT_TILE_SIZE), y0 = (float)(ty * SOFT_TILE_SIZE);
+            float x1 = x0 + SOFT_TILE_SIZE, y1 = y0 + SOFT_TILE_SIZE;
+            bool outside = false;
+            for (int e = 0; e < 3 && !outside; ++e) {
+                float bx = t.edgeA[e] > 0.0f ? x1 : x0, by = t.edgeB[e] > 0.0f ? y1 : y0;
+                outside = t.edgeA[e] * bx + t.edgeB[e] * by + t.edgeC[e] < 0.0f;
+            }
+            if (outside) continue;
+            BinEntry entry = { ty * tilesX + tx, index };
+            out.bins.push_back(entry);
+        }
+    }
+}
+
+// Clips against the near plane (z >= -w) and passes on one or two triangles
+static void clipAndSetup(ClipVertex* v, bool flat, JobOutput& out) {
+    float d[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i) {
+        d[i] = v[i].pos[2] + v[i].pos[3];
+        if (d[i] >= 0.0f) ++inside;
+    }
+    if (inside == 0) return;
+
+    // Trivial reject against the side planes
+    for (int axis = 0; axis < 2; ++axis) {
+        if (v[0].pos[axis] > v[0].pos[3] && v[1].pos[axis] > v[1].pos[3] && v[2].pos[axis] > v[2].pos[3]) return;
+        if (v[0].pos[axis] < -v[0].pos[3] && v[1].pos[axis] < -v[1].pos[3] && v[2].pos[axis] < -v[2].pos[3]) return;
+    }
+    if (inside == 3) {
+        setupTriangle(&v[0], &v[1], &v[2], flat, out);
+        return;
+    }
+
+    ClipVertex poly[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i) {
+        int j = (i + 1) % 3;
+        if (d[i] >= 0.0f) poly[count++] = v[i];
+        if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) lerpClip(v[i], v[j], d[i] / (d[i] - d[j]), poly[count++]);
+    }
+    if (flat) for (int i = 0; i < count; ++i) std::memcpy(poly[i].color, v[0].color, sizeof(v[0].color));
+    for (int i = 1; i + 1 < count; ++i) setupTriangle(&poly[0], &poly[i], &poly[i + 1], flat, out);
+}
+
+static void vertexJob(int job, int, void*) {
+    JobOutput& out = jobOutputs[job];
+    out.setups.clear();
+    out.bins.clear();
+
+    int first = job * SOFT_TRIANGLES_PER_JOB;
+    int last = std::min(first + SOFT_TRIANGLES_PER_JOB, totalTriangles);
+    size_t b = 0;
+    while (b + 1 < batches.size() && batches[b + 1].firstTriangle <= first) ++b;
+
+    for (int tri = first; tri < last; ++tri) {
+        while (tri >= batches[b].firstTriangle + batches[b].triangleCount) ++b;
+        const DrawBatch& batch = batches[b];
+        const SoftVertex* src = batch.vertices + (tri - batch.firstTriangle) * 3;
+
+        ClipVertex v[3];
+        for (int i = 0; i < 3; ++i) toClip(src[i], v[i]);
+        if (batch.shading == SOFT_UNLIT) {
+            for (int i = 0; i < 3; ++i)
+                for (int k = 0; k < 3; ++k) v[i].color[k] = src[i].color[k];
+        } else if (batch.shading == SOFT_FLAT) {
+            lightVertex(src[0], v[0].color);
+            std::memcpy(v[1].color, v[0].color, sizeof(v[0].color));
+            std::memcpy(v[2].color, v[0].color, sizeof(v[0].color));
+        } else {
+            for (int i = 0; i < 3; ++i) lightVertex(src[i], v[i].color);
+        }
+        clipAndSetup(v, batch.shading != SOFT_GOURAUD, out);
+    }
+}
+
+// Counting sort of every job's bin entries into per-tile lists, keeping
+// submission order within a tile so equal depths resolve like GL would.
+static void buildTileLists(int jobCount) {
+    int tileCount = tilesX * tilesY;
+    tileStart.assign(tileCount + 1, 0);
+    int total = 0;
+    for (int j = 0; j < jobCount; ++j) {
+        const std::vector<BinEntry>& bins = jobOutputs[j].bins;
+        for (size_t i = 0; i < bins.size(); ++i) ++tileStart[bins[i].tile + 1];
+        total += (int)jobOutputs[j].setups.size();
+    }
+    for (int t = 0; t < tileCount; ++t) tileStart[t + 1] += tileStart[t];
+    tileTriangles.resize(tileStart[tileCount]);
+
+    static std::vector<int> cursor;
+    cursor.assign(tileStart.begin(), tileStart.end() - 1);
+    for (int j = 0; j < jobCount; ++j) {
+        const JobOutput& out = jobOutputs[j];
+        for (size_t i = 0; i < out.bins.size(); ++i)
+            tileTriangles[cursor[out.bins[i].tile]++] = &out.setups[out.bins[i].triangle];
+    }
+    trianglesRasterized = total;
+}
+
+// **********************************************
+// ************ RASTER STAGE ********************
+// **********************************************
+
+#ifdef __SSE2__
+
+static void rasterSpan4(const SetupTriangle& t, int tileX0, int tileX1, int y) {
+    const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    float py = y + 0.5f;
+    int xStart = std::max(t.minX, tileX0) & ~3;
+    int xEnd = std::min(t.maxX, tileX1 - 1);
+
+    __m128 px = _mm_add_ps(_mm_set1_ps((float)xStart), offsets);
+    __m128 step = _mm_set1_ps(4.0f);
+    __m128 e[3], eStep[3];
+    for (int i = 0; i < 3; ++i) {
+        e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.edgeA[i]), px), _mm_set1_ps(t.edgeB[i] * py + t.edgeC[i]));
+        eStep[i] = _mm_mul_ps(_mm_set1_ps(t.edgeA[i]), step);
+    }
+    __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.depth[0]), px), _mm_set1_ps(t.depth[1] * py + t.depth[2]));
+    __m128 zStep = _mm_mul_ps(_mm_set1_ps(t.depth[0]), step);
+
+    __m128 r = zero, g = zero, b = zero, rStep = zero, gStep = zero, bStep = zero;
+    if (!t.flat) {
+        r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.red[0]), px), _mm_set1_ps(t.red[1] * py + t.red[2]));
+        g = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.green[0]), px), _mm_set1_ps(t.green[1] * py + t.green[2]));
+        b = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.blue[0]), px), _mm_set1_ps(t.blue[1] * py + t.blue[2]));
+        rStep = _mm_mul_ps(_mm_set1_ps(t.red[0]), step);
+        gStep = _mm_mul_ps(_mm_set1_ps(t.green[0]), step);
+        bStep = _mm_mul_ps(_mm_set1_ps(t.blue[0]), step);
+    }
+    const __m128 maxChannel = _mm_set1_ps(255.0f);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+    const __m128i flatColor = _mm_set1_epi32((int)t.flatColor);
+
+    float* depthRow = &depthBuffer[(size_t)y * stride];
+    unsigned int* colorRow = &colorBuffer[(size_t)y * stride];
+    for (int x = xStart; x <= xEnd; x += 4) {
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e[0], zero), _mm_cmpge_ps(e[1], zero)),
+                                   _mm_cmpge_ps(e[2], zero));
+        if (_mm_movemask_ps(inside)) {
+            __m128 oldZ = _mm_loadu_ps(depthRow + x);
+            __m128 pass = _mm_and_ps(inside, _mm_cmplt_ps(z, oldZ));
+            if (_mm_movemask_ps(pass)) {
+                _mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, oldZ)));
+                __m128i color = flatColor;
+                if (!t.flat) {
+                    __m128i ir = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(r, zero), maxChannel));
+                    __m128i ig = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(g, zero), maxChannel));
+                    __m128i ib = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(b, zero), maxChannel));
+                    color = _mm_or_si128(_mm_or_si128(ir, _mm_slli_epi32(ig, 8)),
+                                         _mm_or_si128(_mm_slli_epi32(ib, 16), alpha));
+                }
+                __m128i mask = _mm_castps_si128(pass);
+                __m128i oldColor = _mm_loadu_si128((const __m128i*)(colorRow + x));
+                _mm_storeu_si128((__m128i*)(colorRow + x),
+                                 _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, oldColor)));
+            }
+        }
+        for (int i = 0; i < 3; ++i) e[i] = _mm_add_ps(e[i], eStep[i]);
+        z = _mm_add_ps(z, zStep);
+        if (!t.flat) {
+            r = _mm_add_ps(r, rStep);
+            g = _mm_add_ps(g, gStep);
+            b = _mm_add_ps(b, bStep);
+        }
+    }
+}
+
+#else
+
+// Portable fallback: the same four-pixel steps without SIMD
+static void rasterSpan4(const SetupTriangle& t, int tileX0, int tileX1, int y) {
+    float py = y + 0.5f;
+    int xStart = std::max(t.minX, tileX0) & ~3;
+    int xEnd = std::min(t.maxX, tileX1 - 1);
+    float* depthRow = &depthBuffer[(size_t)y * stride];
+    unsigned int* colorRow = &colorBuffer[(size_t)y * stride];
+    for (int x = xStart; x <= xEnd; ++x) {
+        float px = x + 0.5f;
+        if (t.edgeA[0] * px + t.edgeB[0] * py + t.edgeC[0] < 0.0f) continue;
+        if (t.edgeA[1] * px + t.edgeB[1] * py + t.edgeC[1] < 0.0f) continue;
+        if (t.edgeA[2] * px + t.edgeB[2] * py + t.edgeC[2] < 0.0f) continue;
+        float z = t.depth[0] * px + t.depth[1] * py + t.depth[2];
+        if (z >= depthRow[x]) continue;
+        depthRow[x] = z;
+        colorRow[x] = t.flat ? t.flatColor
+                             : packColor(t.red[0] * px + t.red[1] * py + t.red[2],
+                                         t.green[0] * px + t.green[1] * py + t.green[2],
+                                         t.blue[0] * px + t.blue[1] * py + t.blue[2]);
+    }
+}
+
+#endif
+
+static void rasterTileJob(int tile, int, void*) {
+    int tx = tile % tilesX, ty = tile / tilesX;
+    int x0 = tx * SOFT_TILE_SIZE, y0 = ty * SOFT_TILE_SIZE;
+    int x1 = x0 + SOFT_TILE_SIZE, y1 = y0 + SOFT_TILE_SIZE;
+
+    for (int y = y0; y < y1; ++y) {
+        std::fill(&colorBuffer[(size_t)y * stride + x0], &colorBuffer[(size_t)y * stride + x1], clearValue);
+        std::fill(&depthBuffer[(size_t)y * stride + x0], &depthBuffer[(size_t)y * stride + x1], 1.0f);
+    }
+    for (int i = tileStart[tile]; i < tileStart[tile + 1]; ++i) {
+        const SetupTriangle& t = *tileTriangles[i];
+        int rowStart = std::max(t.minY, y0), rowEnd = std::min(t.maxY, y1 - 1);
+        for (int y = rowStart; y <= rowEnd; ++y) rasterSpan4(t, x0, x1, y);
+    }
+}
+
+static void resolveRowsJob(int row, int, void*) {
+    std::memcpy(&output[(size_t)row * width * 4], &colorBuffer[(size_t)row * stride], (size_t)width * 4);
+}
+
+void softEndFrame() {
+    int jobCount = (totalTriangles + SOFT_TRIANGLES_PER_JOB - 1) / SOFT_TRIANGLES_PER_JOB;
+    if ((int)jobOutputs.size() < jobCount) jobOutputs.resize(jobCount);
+
+    parallelFor(jobCount, vertexJob, 0);
+    buildTileLists(jobCount);
+    parallelFor(tilesX * tilesY, rasterTileJob, 0);
+
+    output.resize((size_t)width * height * 4);
+    parallelFor(height, resolveRowsJob, 0);
+}
+
+const unsigned char* softColorBuffer() {
+    return output.empty() ? 0 : &output[0];
+}
+
+int softTrianglesRasterized() {
+    return trianglesRasterized;
+}
@@ -0,0 +1,49 @@
+#ifndef SOFT_RASTER_H
+#define SOFT_RASTER_H
+
+// **********************************************
+// ************ CPU RASTERIZER ******************
+// **********************************************
+
+// A software back end for machines without a GPU. Triangles are transformed
+// and lit like the fixed-function pipeline (GL_COLOR_MATERIAL, per-vertex
+// lighting), binned into screen tiles, and the tiles are rasterized in
+// parallel on the job system with SSE2 edge functions and depth tests.
+
+struct SoftVertex {
+    float pos[3];           // world space
+    float normal[3];
+    unsigned char color[4];
+};
+
+enum SoftShading {
+    SOFT_FLAT,     // one lit colour per triangle (boxes: same as smooth, a third of the work)
+    SOFT_GOURAUD,  // lit per vertex and interpolated, like GL_SMOOTH
+    SOFT_UNLIT     // colour as given, like drawing with GL_LIGHTING disabled
+};
+
+// Same meaning as the glLight parameters; position is in eye space, w = 1.
+struct SoftLight {
+    float position[3];
+    float ambient[3];
+    float diffuse[3];
+    float constantAttenuation, linearAttenuation;
+};
+
+const int SOFT_MAX_LIGHTS = 8;
+
+void softBeginFrame(int width, int height, const float clearColor[3]);
+void softSetMatrices(const float projection[16], const float view[16]);
+void softSetLights(const SoftLight* lights, int count, const float globalAmbient[3]);
+
+// Queues a triangle list. The vertices must stay valid until softEndFrame().
+void softDrawTriangles(const SoftVertex* vertices, int vertexCount, SoftShading shading);
+
+// Runs the vertex, binning and raster stages for everything queued.
+void softEndFrame();
+
+// RGBA8 rows, bottom row first like glReadPixels.
+const unsigned char* softColorBuffer();
+int softTrianglesRasterized();
+
+#endif
@@ -0,0 +1,341 @@
+#include "softScene.h"
+#include "softRaster.h"
+#include "sceneGraph.h"
+#include "stadiumScene.h"
+#include "jobSystem.h"
+#include "crowd.h"
+#include "stadium.h"
+#include "stadiumGeometry.h"
+#include "viewMath.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Triangle lists by shading mode; the static stadium is built once, the
+// players, ball and crowd every frame
+static std::vector<SoftVertex> staticFlat, staticSmooth, staticUnlit;
+static std::vector<SoftVertex> dynamicFlat, dynamicSmooth, dynamicUnlit;
+static bool crowdWanted = false;
+static std::vector<CrowdVertex> crowdVertices;
+
+// **********************************************
+// ************ TRIANGLE OUTPUT *****************
+// **********************************************
+
+// Shapes go out through the current matrix and colour, into the list for
+// their shading mode.
+
+static float current[16];
+static unsigned char currentColor[4] = { 255, 255, 255, 255 };
+static std::vector<SoftVertex>* flatOut = &staticFlat;
+static std::vector<SoftVertex>* smoothOut = &staticSmooth;
+static std::vector<SoftVertex>* unlitOut = &staticUnlit;
+static bool lightingOn = true;
+
+static void loadIdentity() {
+    std::memset(current, 0, sizeof(current));
+    current[0] = current[5] = current[10] = current[15] = 1.0f;
+}
+
+static void color3f(float r, float g, float b) {
+    currentColor[0] = (unsigned char)(r * 255.0f + 0.5f);
+    currentColor[1] = (unsigned char)(g * 255.0f + 0.5f);
+    currentColor[2] = (unsigned char)(b * 255.0f + 0.5f);
+}
+
+static void emitVertex(std::vector<SoftVertex>& out, float x, float y, float z, float nx, float ny, float nz) {
+    const float* m = current;
+    SoftVertex v;
+    // Normals go through the linear part only: the scene has no shear, and
+    // lighting renormalises them like GL_NORMALIZE
+    for (int r = 0; r < 3; ++r) {
+        v.pos[r] = m[r] * x + m[4 + r] * y + m[8 + r] * z + m[12 + r];
+        v.normal[r] = m[r] * nx + m[4 + r] * ny + m[8 + r] * nz;
+    }
+    std::memcpy(v.color, currentColor, sizeof(v.color));
+    out.push_back(v);
+}
+
+static void emitQuad(std::vector<SoftVertex>& out, const float* a, const float* b, const float* c, const float* d,
+                     const float* n) {
+    const float* corners[6] = { a, b, c, a, c, d };
+    for (int i = 0; i < 6; ++i) emitVertex(out, corners[i][0], corners[i][1], corners[i][2], n[0], n[1], n[2]);
+}
+
+static void solidCube(float size) {
+    static const float faces[6][4][3] = {
+        { { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 }, { 1, -1, 1 } },
+        { { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, -1 } },
+        { { -1, 1, -1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 } },
+        { { -1, -1, 1 }, { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 } },
+        { { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 } },
+        { { 1, -1, -1 }, { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 } }
+    };
+    static const float normals[6][3] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    float h = size * 0.5f;
+    std::vector<SoftVertex>& out = lightingOn ? *flatOut : *unlitOut;
+    for (int f = 0; f < 6; ++f) {
+        float p[4][3];
+        for (int i = 0; i < 4; ++i)
+            for (int k = 0; k < 3; ++k) p[i][k] = faces[f][i][k] * h;
+        emitQuad(out, p[0], p[1], p[2], p[3], normals[f]);
+    }
+}
+
+static void solidSphere(float radius, int slices, int stacks) {
+    std::vector<SoftVertex>& out = lightingOn ? *smoothOut : *unlitOut;
+    for (int j = 0; j < stacks; ++j) {
+        float t0 = (float)M_PI * j / stacks, t1 = (float)M_PI * (j + 1) / stacks;
+        for (int i = 0; i < slices; ++i) {
+            float p0 = 2.0f * (float)M_PI * i / slices, p1 = 2.0f * (float)M_PI * (i + 1) / slices;
+            float n[4][3] = {
+                { std::sin(t0) * std::cos(p0), std::cos(t0), std::sin(t0) * std::sin(p0) },
+                { std::sin(t1) * std::cos(p0), std::cos(t1), std::sin(t1) * std::sin(p0) },
+                { std::sin(t1) * std::cos(p1), std::cos(t1), std::sin(t1) * std::sin(p1) },
+                { std::sin(t0) * std::cos(p1), std::cos(t0), std::sin(t0) * std::sin(p1) }
+            };
+            static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+            for (int k = 0; k < 6; ++k) {
+                const float* v = n[order[k]];
+                emitVertex(out, v[0] * radius, v[1] * radius, v[2] * radius, v[0], v[1], v[2]);
+            }
+        }
+    }
+}
+
+// A flat band on the ground, standing in for GL_LINES (which the rasterizer
+// does not draw)
+static void groundBand(const StadiumVertex* points, int count, bool loop, float width) {
+    static const float up[3] = { 0.0f, 1.0f, 0.0f };
+    float halfWidth = width * 0.5f;
+    int segments = loop ? count : count - 1;
+    for (int i = 0; i < segments; ++i) {
+        const float* a = points[i].pos;
+        const float* b = points[(i + 1) % count].pos;
+        float dx = b[0] - a[0], dz = b[2] - a[2];
+        float len = std::sqrt(dx * dx + dz * dz);
+        if (len <= 0.0f) continue;
+        float ox = -dz / len * halfWidth, oz = dx / len * halfWidth;
+        float q[4][3] = { { a[0] - ox, a[1], a[2] - oz }, { a[0] + ox, a[1], a[2] + oz },
+                          { b[0] + ox, b[1], b[2] + oz }, { b[0] - ox, b[1], b[2] - oz } };
+        emitQuad(*flatOut, q[0], q[1], q[2], q[3], up);
+    }
+}
+
+// **********************************************
+// ************ STADIUM AS TRIANGLES ************
+// **********************************************
+
+static void buildSeating() {
+    std::vector<SeatPlacement> seats;
+    unsigned int sectorFirst[NUM_SEAT_SECTORS + 1];
+    generateSeatLayout(seats, sectorFirst);
+    if (seats.empty()) return;
+    std::vector<SeatVertex> vertices(seats.size() * SEAT_VERTICES);
+    std::vector<unsigned int> indices(seats.size() * SEAT_INDICES);
+    buildSeatMesh(&seats[0], (int)seats.size(), &vertices[0], &indices[0]);
+
+    color3f(0.1f, 0.1f, 0.9f); // drawSeatingSector
+    for (size_t i = 0; i < indices.size(); ++i) {
+        const SeatVertex& v = vertices[indices[i]];
+        emitVertex(*flatOut, v.pos[0], v.pos[1], v.pos[2], v.normal[0], v.normal[1], v.normal[2]);
+    }
+    if (crowdWanted) initCrowd(seats, sectorFirst);
+}
+
+// Every shape of the scene description (stadiumScene.h)
+static void buildStructures() {
+    const StadiumVertex* v = stadiumVertices();
+    int count = stadiumPartFirstShape(NUM_STADIUM_PARTS);
+    for (int i = 0; i < count; ++i) {
+        const StadiumShape& s = stadiumShape(i);
+        float rgb[3];
+        lightingOn = stadiumShapeLook(s, nightMode, rgb);
+        color3f(rgb[0], rgb[1], rgb[2]);
+        if (s.kind == STADIUM_BOX) {
+            std::memcpy(current, s.matrix, sizeof(current));
+            solidCube(1.0f);
+            continue;
+        }
+        loadIdentity();
+        if (s.kind == STADIUM_LINES) {
+            groundBand(v + s.first, s.count, s.loop, s.bandWidth);
+            continue;
+        }
+        for (int k = s.first; k < s.first + s.count; ++k)
+            emitVertex(*flatOut, v[k].pos[0], v[k].pos[1], v[k].pos[2], v[k].normal[0], v[k].normal[1], v[k].normal[2]);
+    }
+    lightingOn = true;
+    loadIdentity();
+}
+
+static void buildStaticScene() {
+    staticFlat.clear();
+    staticSmooth.clear();
+    staticUnlit.clear();
+    flatOut = &staticFlat;
+    smoothOut = &staticSmooth;
+    unlitOut = &staticUnlit;
+    loadIdentity();
+
+    buildSeating();
+    buildStructures();
+}
+
+// --- Players and ball, rebuilt every frame from the scene graph ---
+
+static void buildDynamicScene() {
+    dynamicFlat.clear();
+    dynamicSmooth.clear();
+    dynamicUnlit.clear();
+    flatOut = &dynamicFlat;
+    smoothOut = &dynamicSmooth;
+    unlitOut = &dynamicUnlit;
+
+    updateMatchSceneGraph();
+    const float* world = sceneWorldMatrices();
+    const int* order;
+    int count = sceneDrawOrder(order);
+    for (int i = 0; i < count; ++i) {
+        const SceneNodeLook& look = sceneNodeLook(order[i]);
+        std::memcpy(current, world + 16 * order[i], sizeof(current));
+        color3f(look.color[0], look.color[1], look.color[2]);
+        lightingOn = look.lit;
+        if (look.shape == SHAPE_CUBE) solidCube(1.0f);
+        else solidSphere(1.0f, look.slices, look.slices);
+    }
+    lightingOn = true;
+
+    // The crowd, unlit as drawCrowd() draws it
+    int fans = crowdFanCount();
+    if (!crowdReady() || !fans) return;
+    crowdVertices.resize((size_t)fans * CROWD_FAN_VERTICES);
+    buildCrowdVertices(0, fans, nightMode ? 0.7f : 1.0f, &crowdVertices[0]);
+    for (size_t i = 0; i < crowdVertices.size(); ++i) {
+        SoftVertex v;
+        std::memcpy(v.pos, crowdVertices[i].pos, sizeof(v.pos));
+        v.normal[0] = v.normal[2] = 0.0f;
+        v.normal[1] = 1.0f;
+        std::memcpy(v.color, crowdVertices[i].color, sizeof(v.color));
+        dynamicUnlit.push_back(v);
+    }
+}
+
+// **********************************************
+// ************ FRAME & DRIVER ******************
+// **********************************************
+
+// The sun (GL_LIGHT0, fixed to the eye in init()) and, at night, the four
+// floodlights placed exactly as applyFloodlight() places them.
+static int buildLights(const float view[16], SoftLight* lights) {
+    SoftLight& sun = lights[0];
+    sun.position[0] = 100.0f; sun.position[1] = 200.0f; sun.position[2] = 100.0f;
+    for (int k = 0; k < 3; ++k) { sun.ambient[k] = 0.4f; sun.diffuse[k] = 1.0f; }
+    sun.constantAttenuation = 1.0f;
+    sun.linearAttenuation = 0.0f;
+    if (!nightMode) return 1;
+
+    for (int i = 0; i < NUM_FLOODLIGHT_TOWERS; ++i) {
+        const FloodlightTower& t = FLOODLIGHT_TOWERS[i];
+        // glTranslatef(x, 0, z); glRotatef(angle, 0, 1, 0); GL_POSITION (x, 65, z)
+        float r = t.angleRotation * (float)M_PI / 180.0f;
+        float world[3] = { t.x + t.x * std::cos(r) + t.z * std::sin(r), 65.0f,
+                           t.z - t.x * std::sin(r) + t.z * std::cos(r) };
+        SoftLight& l = lights[1 + i];
+        for (int k = 0; k < 3; ++k) {
+            l.position[k] = view[k] * world[0] + view[4 + k] * world[1] + view[8 + k] * world[2] + view[12 + k];
+            l.ambient[k] = 0.0f;
+            l.diffuse[k] = 0.6f;
+        }
+        l.constantAttenuation = 0.5f;
+        l.linearAttenuation = 0.005f;
+    }
+    return 1 + NUM_FLOODLIGHT_TOWERS;
+}
+
+static void renderFrame(int width, int height) {
+    static const float daySky[3] = { 0.6f, 0.8f, 1.0f }, nightSky[3] = { 0.1f, 0.1f, 0.2f };
+    static const float globalAmbient[3] = { 0.2f, 0.2f, 0.2f };
+
+    float eye[3] = { cameraX, cameraY, cameraZ }, target[3] = { targetX, targetY, targetZ }, up[3] = { 0, 1, 0 };
+    float projection[16], view[16];
+    perspectiveMatrix(60.0f, (float)width / (float)height, 1.0f, VIEW_FAR_DISTANCE, projection);
+    lookAtMatrix(eye, target, up, view);
+
+    SoftLight lights[SOFT_MAX_LIGHTS];
+    int lightCount = buildLights(view, lights);
+    buildDynamicScene();
+
+    softBeginFrame(width, height, nightMode ? nightSky : daySky);
+    softSetMatrices(projection, view);
+    softSetLights(lights, lightCount, globalAmbient);
+    softDrawTriangles(staticFlat.empty() ? 0 : &staticFlat[0], (int)staticFlat.size(), SOFT_FLAT);
+    softDrawTriangles(staticSmooth.empty() ? 0 : &staticSmooth[0], (int)staticSmooth.size(), SOFT_GOURAUD);
+    softDrawTriangles(staticUnlit.empty() ? 0 : &staticUnlit[0], (int)staticUnlit.size(), SOFT_UNLIT);
+    softDrawTriangles(dynamicFlat.empty() ? 0 : &dynamicFlat[0], (int)dynamicFlat.size(), SOFT_FLAT);
+    softDrawTriangles(dynamicSmooth.empty() ? 0 : &dynamicSmooth[0], (int)dynamicSmooth.size(), SOFT_GOURAUD);
+    softDrawTriangles(dynamicUnlit.empty() ? 0 : &dynamicUnlit[0], (int)dynamicUnlit.size(), SOFT_UNLIT);
+    softEndFrame();
+}
+
+static bool writeImage(const char* path, int width, int height) {
+    FILE* out = std::fopen(path, "wb");
+    if (!out) return false;
+    std::fprintf(out, "P6\n%d %d\n255\n", width, height);
+    const unsigned char* pixels = softColorBuffer();
+    std::vector<unsigned char> row(width * 3);
+    for (int y = height - 1; y >= 0; --y) { // buffer is bottom-up
+        const unsigned char* src = pixels + (size_t)y * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3] = src[x * 4];
+            row[x * 3 + 1] = src[x * 4 + 1];
+            row[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(&row[0], 1, row.size(), out);
+    }
+    return std::fclose(out) == 0;
+}
+
+static double timeFrames(int width, int height, int frames) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) renderFrame(width, height);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+int runSoftwareRender(const SoftRenderSettings& settings) {
+    crowdWanted = settings.crowd;
+    buildStaticScene();
+    std::cout << "Software: " << (staticFlat.size() + staticSmooth.size() + staticUnlit.size()) / 3
+              << " static triangles" << std::endl;
+
+    if (settings.benchmark) {
+        int cores = (int)std::thread::hardware_concurrency();
+        if (cores < 1) cores = 1;
+        double single = 0.0;
+        for (int threads = 1; ; threads = std::min(threads * 2, cores)) {
+            initJobSystem(threads);
+            renderFrame(settings.width, settings.height); // warm up the buffers
+            double ms = timeFrames(settings.width, settings.height, 10);
+            if (threads == 1) single = ms;
+            std::printf("Software: %2d threads  %8.2f ms/frame  %5.2fx\n", threads, ms, single / ms);
+            shutdownJobSystem();
+            if (threads >= cores) break;
+        }
+    }
+
+    initJobSystem(settings.threads);
+    double ms = timeFrames(settings.width, settings.height, 1);
+    std::cout << "Software: " << settings.width << "x" << settings.height << " on " << jobWorkerCount()
+              << " threads, " << softTrianglesRasterized() << " triangles rasterized in " << ms << " ms" << std::endl;
+    bool written = !settings.outputPath || writeImage(settings.outputPath, settings.width, settings.height);
+    shutdownJobSystem();
+    if (!written) {
+        std::cerr << "Could not write " << settings.outputPath << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef SOFT_SCENE_H
+#define SOFT_SCENE_H
+
+// **********************************************
+// ************ HEADLESS SOFTWARE RENDER ********
+// **********************************************
+
+// Renders the director camera on the CPU rasterizer, with no window or GL
+// context, for render farms and machines without a GPU. The stadium comes
+// from the scene description the GL path draws (stadiumScene.h), lines as
+// flat bands; text, goal nets, the railing, vegetation and the city are
+// left out.
+
+struct SoftRenderSettings {
+    const char* outputPath; // P6 image
+    int width, height;
+    int threads;            // <= 0: one per core
+    bool benchmark;         // also time frames at 1, 2, 4 .. threads
+    bool crowd;             // a fan in every seat
+};
+
+// Uses the current camera, night mode and animation state. Returns the
+// process exit code.
+int runSoftwareRender(const SoftRenderSettings& settings);
+
+#endif
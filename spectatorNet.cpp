@@ -0,0 +1,191 @@
+#include "spectatorNet.h"
+#include <cmath>
+#include <cstring>
+
+const float POSITION_SCALE = 64.0f; // steps per unit
+const float ANGLE_SCALE = 8.0f;     // steps per degree
+
+// Field layout
+const int SNAP_BALL = 0;            // x, z, rotation
+const int SNAP_PLAYERS = 3;         // x, z per player
+const int SNAP_EYE = SNAP_PLAYERS + 2 * NUM_PLAYERS;
+const int SNAP_TARGET = SNAP_EYE + 3;
+const int SNAP_NIGHT = SNAP_TARGET + 3;
+const int SNAP_STAGE = SNAP_NIGHT + 1;
+
+const int MASK_BYTES = (SNAPSHOT_FIELDS + 7) / 8;
+
+// Smoothing of the client's estimate of the server clock
+const double CLOCK_SMOOTHING = 0.05;
+
+static int quantize(float value, float scale) {
+    return (int)std::floor(value * scale + 0.5f);
+}
+
+void quantizeMatchState(const MatchState& s, unsigned int sequence, MatchSnapshot& out) {
+    out.sequence = sequence;
+    out.field[SNAP_BALL] = quantize(s.ballX, POSITION_SCALE);
+    out.field[SNAP_BALL + 1] = quantize(s.ballZ, POSITION_SCALE);
+    out.field[SNAP_BALL + 2] = quantize(std::fmod(s.ballRot, 360.0f), ANGLE_SCALE); // spins forever otherwise
+    for (int p = 0; p < NUM_PLAYERS; ++p) {
+        out.field[SNAP_PLAYERS + 2 * p] = quantize(s.playerX[p], POSITION_SCALE);
+        out.field[SNAP_PLAYERS + 2 * p + 1] = quantize(s.playerZ[p], POSITION_SCALE);
+    }
+    for (int i = 0; i < 3; ++i) {
+        out.field[SNAP_EYE + i] = quantize(s.eye[i], POSITION_SCALE);
+        out.field[SNAP_TARGET + i] = quantize(s.target[i], POSITION_SCALE);
+    }
+    out.field[SNAP_NIGHT] = s.night ? 1 : 0;
+    out.field[SNAP_STAGE] = s.animStage;
+}
+
+void dequantizeMatchState(const MatchSnapshot& q, MatchState& out) {
+    out.ballX = q.field[SNAP_BALL] / POSITION_SCALE;
+    out.ballZ = q.field[SNAP_BALL + 1] / POSITION_SCALE;
+    out.ballRot = q.field[SNAP_BALL + 2] / ANGLE_SCALE;
+    for (int p = 0; p < NUM_PLAYERS; ++p) {
+        out.playerX[p] = q.field[SNAP_PLAYERS + 2 * p] / POSITION_SCALE;
+        out.playerZ[p] = q.field[SNAP_PLAYERS + 2 * p + 1] / POSITION_SCALE;
+    }
+    for (int i = 0; i < 3; ++i) {
+        out.eye[i] = q.field[SNAP_EYE + i] / POSITION_SCALE;
+        out.target[i] = q.field[SNAP_TARGET + i] / POSITION_SCALE;
+    }
+    out.night = q.field[SNAP_NIGHT] != 0;
+    out.animStage = q.field[SNAP_STAGE];
+}
+
+// **********************************************
+// ************ WIRE FORMAT *********************
+// **********************************************
+
+static void putU32(unsigned char* out, unsigned int v) {
+    for (int i = 0; i < 4; ++i) out[i] = (unsigned char)(v >> (8 * i));
+}
+
+static unsigned int getU32(const unsigned char* in) {
+    return in[0] | in[1] << 8 | in[2] << 16 | (unsigned int)in[3] << 24;
+}
+
+int encodeSnapshot(const MatchSnapshot& current, const MatchSnapshot* base, unsigned char* out) {
+    putU32(out, current.sequence);
+    putU32(out + 4, base ? base->sequence : 0);
+    unsigned char* mask = out + 8;
+    std::memset(mask, 0, MASK_BYTES);
+    unsigned char* p = mask + MASK_BYTES;
+
+    for (int f = 0; f < SNAPSHOT_FIELDS; ++f) {
+        int delta = current.field[f] - (base ? base->field[f] : 0);
+        if (!delta) continue;
+        mask[f / 8] |= (unsigned char)(1 << (f % 8));
+        unsigned int zigzag = ((unsigned int)delta << 1) ^ (unsigned int)(delta >> 31);
+        while (zigzag >= 0x80) {
+            *p++ = (unsigned char)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *p++ = (unsigned char)zigzag;
+    }
+    return (int)(p - out);
+}
+
+static MatchSnapshot* findSnapshot(SpectatorClient& c, unsigned int sequence) {
+    MatchSnapshot& s = c.history[sequence % SPECTATOR_HISTORY];
+    return sequence && s.sequence == sequence ? &s : 0;
+}
+
+// **********************************************
+// ************ CLIENT **************************
+// **********************************************
+
+void initSpectatorClient(SpectatorClient& client, float tickHz) {
+    std::memset(&client, 0, sizeof(client));
+    client.tickHz = tickHz;
+}
+
+bool spectatorClientReceive(SpectatorClient& c, const unsigned char* data, int size, double now, unsigned int& ack) {
+    ack = c.newest;
+    if (size < 8 + MASK_BYTES) return false;
+    unsigned int sequence = getU32(data), baseSequence = getU32(data + 4);
+    if (sequence == 0 || findSnapshot(c, sequence)) return false; // duplicate
+    if (sequence + SPECTATOR_HISTORY <= c.newest) return false;   // too late to be of use
+    const MatchSnapshot* base = 0;
+    if (baseSequence && !(base = findSnapshot(c, baseSequence))) return false;
+
+    MatchSnapshot decoded;
+    decoded.sequence = sequence;
+    const unsigned char* mask = data + 8;
+    const unsigned char* p = mask + MASK_BYTES;
+    const unsigned char* end = data + size;
+    for (int f = 0; f < SNAPSHOT_FIELDS; ++f) {
+        int value = base ? base->field[f] : 0;
+        if (mask[f / 8] & (1 << (f % 8))) {
+            unsigned int zigzag = 0;
+            for (int shift = 0;; shift += 7) {
+                if (p == end || shift > 28) return false;
+                unsigned char byte = *p++;
+                zigzag |= (unsigned int)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            value += (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+        }
+        decoded.field[f] = value;
+    }
+    c.history[sequence % SPECTATOR_HISTORY] = decoded;
+
+    // Server time is sequence / tickHz; track how far ahead of our clock it runs
+    double offset = sequence / c.tickHz - now;
+    if (!c.synced) c.clockOffset = offset;
+    else c.clockOffset += CLOCK_SMOOTHING * (offset - c.clockOffset);
+    c.synced = true;
+
+    if (sequence > c.newest) c.newest = sequence;
+    ack = c.newest;
+    return true;
+}
+
+static float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+bool spectatorClientSample(const SpectatorClient& c, double now, MatchState& out) {
+    if (!c.synced) return false;
+    double tick = (now + c.clockOffset - SPECTATOR_INTERP_DELAY) * c.tickHz;
+
+    // The snapshots either side of the render time; a lost one is bridged
+    const MatchSnapshot* before = 0;
+    const MatchSnapshot* after = 0;
+    for (int i = 0; i < SPECTATOR_HISTORY; ++i) {
+        const MatchSnapshot& s = c.history[i];
+        if (!s.sequence) continue;
+        if (s.sequence <= tick && (!before || s.sequence > before->sequence)) before = &s;
+        if (s.sequence > tick && (!after || s.sequence < after->sequence)) after = &s;
+    }
+    if (!before) before = after; // started late: hold the oldest
+    if (!after) after = before;  // starved: hold the newest
+    if (!before) return false;
+
+    MatchState a, b;
+    dequantizeMatchState(*before, a);
+    dequantizeMatchState(*after, b);
+    float t = after->sequence > before->sequence
+                  ? (float)((tick - before->sequence) / (after->sequence - before->sequence)) : 0.0f;
+    if (t < 0.0f) t = 0.0f;
+    if (t > 1.0f) t = 1.0f;
+
+    out = a;
+    out.ballX = lerp(a.ballX, b.ballX, t);
+    out.ballZ = lerp(a.ballZ, b.ballZ, t);
+    float spin = b.ballRot - a.ballRot; // the short way round
+    if (spin > 180.0f) spin -= 360.0f;
+    if (spin < -180.0f) spin += 360.0f;
+    out.ballRot = a.ballRot + spin * t;
+    for (int p = 0; p < NUM_PLAYERS; ++p) {
+        out.playerX[p] = lerp(a.playerX[p], b.playerX[p], t);
+        out.playerZ[p] = lerp(a.playerZ[p], b.playerZ[p], t);
+    }
+    for (int i = 0; i < 3; ++i) {
+        out.eye[i] = lerp(a.eye[i], b.eye[i], t);
+        out.target[i] = lerp(a.target[i], b.target[i], t);
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef SPECTATOR_NET_H
+#define SPECTATOR_NET_H
+
+#include "stadium.h"
+
+// **********************************************
+// ************ SPECTATOR PROTOCOL **************
+// **********************************************
+
+// The match as remote displays see it: ball, players, director camera and
+// night mode, quantized to integers (positions to 1/64 unit, angles to
+// 1/8 degree). A snapshot goes out as the fields that differ from a base
+// the client has acknowledged, each as a zigzag varint of the difference,
+// so a still frame costs a dozen bytes. Clients keep a short history and
+// render slightly in the past, interpolating between snapshots.
+//
+// Server -> client: u32 sequence, u32 base sequence (0 = none), changed-field
+// bitmask, varints. Client -> server: u32 newest decoded sequence (0 = join).
+
+struct MatchState {
+    float ballX, ballZ, ballRot;
+    float playerX[NUM_PLAYERS], playerZ[NUM_PLAYERS];
+    float eye[3], target[3];
+    bool night;
+    int animStage;
+};
+
+const int SNAPSHOT_FIELDS = 3 + 2 * NUM_PLAYERS + 6 + 2;
+const int SNAPSHOT_MAX_BYTES = 8 + (SNAPSHOT_FIELDS + 7) / 8 + 5 * SNAPSHOT_FIELDS;
+
+struct MatchSnapshot {
+    unsigned int sequence; // 0 = empty slot
+    int field[SNAPSHOT_FIELDS];
+};
+
+void quantizeMatchState(const MatchState& state, unsigned int sequence, MatchSnapshot& out);
+void dequantizeMatchState(const MatchSnapshot& snapshot, MatchState& out);
+
+// base 0 sends every field. Returns the packet size.
+int encodeSnapshot(const MatchSnapshot& current, const MatchSnapshot* base, unsigned char* out);
+
+// --- Client side ---
+
+const int SPECTATOR_HISTORY = 32;       // snapshots kept for bases and interpolation
+const float SPECTATOR_INTERP_DELAY = 0.15f; // seconds behind the newest snapshot
+
+struct SpectatorClient {
+    float tickHz;
+    MatchSnapshot history[SPECTATOR_HISTORY];
+    unsigned int newest;      // newest decoded sequence
+    double clockOffset;       // server time minus local time, smoothed
+    bool synced;
+};
+
+void initSpectatorClient(SpectatorClient& client, float tickHz);
+
+// Decodes one packet; false if it is malformed or its base is gone. ack is
+// what to send back (the newest sequence decoded so far).
+bool spectatorClientReceive(SpectatorClient& client, const unsigned char* data, int size, double now, unsigned int& ack);
+
+// The match SPECTATOR_INTERP_DELAY behind the server, interpolated.
+bool spectatorClientSample(const SpectatorClient& client, double now, MatchState& out);
+
+#endif
@@ -0,0 +1,504 @@
+// Sockets first: winsock2.h must come before the windows.h that GLUT pulls in
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "spectatorServer.h"
+#include "spectatorNet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Displays further behind than the client's history get a full snapshot
+const unsigned int SERVER_HISTORY = SPECTATOR_HISTORY;
+
+const int MAX_SPECTATORS = 1024;
+const double SPECTATOR_TIMEOUT = 10.0; // seconds without an ack
+const double REPORT_SECONDS = 10.0;
+
+typedef std::chrono::steady_clock SpectatorClock;
+
+static MatchSnapshot snapshotRing[SERVER_HISTORY];
+
+// The parts of the match a display needs, straight from the globals
+static void captureMatchState(MatchState& s) {
+    s.ballX = ballX;
+    s.ballZ = ballZ;
+    s.ballRot = ballRot;
+    PlayerSpot spots[NUM_PLAYERS];
+    currentPlayerSpots(spots);
+    for (int p = 0; p < NUM_PLAYERS; ++p) {
+        s.playerX[p] = spots[p].x;
+        s.playerZ[p] = spots[p].z;
+    }
+    s.eye[0] = cameraX; s.eye[1] = cameraY; s.eye[2] = cameraZ;
+    s.target[0] = targetX; s.target[1] = targetY; s.target[2] = targetZ;
+    s.night = nightMode;
+    s.animStage = animStage;
+}
+
+static const MatchSnapshot& publishSnapshot(unsigned int sequence, MatchState& state) {
+    captureMatchState(state);
+    MatchSnapshot& slot = snapshotRing[sequence % SERVER_HISTORY];
+    quantizeMatchState(state, sequence, slot);
+    return slot;
+}
+
+// Delta against what the display last acknowledged, if we still have it
+static int packetFor(const MatchSnapshot& current, unsigned int lastAck, unsigned char* out, bool& full) {
+    const MatchSnapshot* base = 0;
+    if (lastAck && current.sequence - lastAck < SERVER_HISTORY) {
+        const MatchSnapshot& s = snapshotRing[lastAck % SERVER_HISTORY];
+        if (s.sequence == lastAck) base = &s;
+    }
+    full = !base;
+    return encodeSnapshot(current, base, out);
+}
+
+// **********************************************
+// ************ UDP SERVER **********************
+// **********************************************
+
+#ifdef _WIN32
+typedef SOCKET SocketHandle;
+const SocketHandle NO_SOCKET = INVALID_SOCKET;
+static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+typedef int SocketHandle;
+const SocketHandle NO_SOCKET = -1;
+static void closeSocket(SocketHandle s) { close(s); }
+#endif
+
+static void setNonBlocking(SocketHandle s) {
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(s, FIONBIO, &nonBlocking);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+struct SpectatorPeer {
+    sockaddr_in address;
+    unsigned int lastAck; // 0 until the first snapshot is acknowledged
+    double lastHeard;
+};
+
+static SocketHandle serverSocket = NO_SOCKET;
+static std::vector<SpectatorPeer> peers;
+static SpectatorClock::time_point serverStart;
+static unsigned int serverSequence = 0;
+
+// Since the last report
+static double reportStart = 0.0;
+static long reportBytes = 0;
+static long reportPeerTicks = 0;
+static double reportCpuSeconds = 0.0;
+
+bool startSpectatorServer(int port) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "Spectators: WSAStartup failed" << std::endl;
+        return false;
+    }
+#endif
+    serverSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (serverSocket == NO_SOCKET) {
+        std::cerr << "Spectators: cannot create a UDP socket" << std::endl;
+        return false;
+    }
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((unsigned short)port);
+    if (bind(serverSocket, (sockaddr*)&address, sizeof(address)) != 0) {
+        std::cerr << "Spectators: cannot bind UDP port " << port << std::endl;
+        stopSpectatorServer();
+        return false;
+    }
+    setNonBlocking(serverSocket);
+
+    serverStart = SpectatorClock::now();
+    serverSequence = 0;
+    peers.clear();
+    std::memset(snapshotRing, 0, sizeof(snapshotRing));
+    std::cout << "Spectators: broadcasting on UDP port " << port << " at " << SPECTATOR_TICK_HZ << " Hz" << std::endl;
+    return true;
+}
+
+static bool sameAddress(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+static void receiveAcks(double now) {
+    for (;;) {
+        unsigned char buffer[16];
+        sockaddr_in from;
+#ifdef _WIN32
+        int fromSize = sizeof(from);
+        int size = recvfrom(serverSocket, (char*)buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromSize);
+#else
+        socklen_t fromSize = sizeof(from);
+        int size = (int)recvfrom(serverSocket, buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromSize);
+#endif
+        if (size < 0) break; // nothing more waiting
+        if (size != 4) continue;
+        unsigned int ack = buffer[0] | buffer[1] << 8 | buffer[2] << 16 | (unsigned int)buffer[3] << 24;
+
+        SpectatorPeer* peer = 0;
+        for (size_t i = 0; i < peers.size(); ++i) {
+            if (sameAddress(peers[i].address, from)) peer = &peers[i];
+        }
+        if (!peer) {
+            if ((int)peers.size() >= MAX_SPECTATORS) continue;
+            SpectatorPeer joined = { from, 0, now };
+            peers.push_back(joined);
+            peer = &peers.back();
+            std::cout << "Spectators: " << inet_ntoa(from.sin_addr) << ":" << ntohs(from.sin_port) << " joined ("
+                      << peers.size() << " watching)" << std::endl;
+        }
+        // A zero ack is a display that restarted; anything else only moves forward
+        if (ack == 0 || ack > peer->lastAck) peer->lastAck = ack;
+        peer->lastHeard = now;
+    }
+}
+
+void updateSpectatorServer() {
+    if (serverSocket == NO_SOCKET) return;
+    double now = std::chrono::duration<double>(SpectatorClock::now() - serverStart).count();
+    receiveAcks(now);
+
+    size_t kept = 0;
+    for (size_t i = 0; i < peers.size(); ++i) {
+        if (now - peers[i].lastHeard < SPECTATOR_TIMEOUT) peers[kept++] = peers[i];
+    }
+    peers.resize(kept);
+
+    // Ticks missed during a long frame are skipped, not sent in a burst
+    unsigned int due = (unsigned int)(now * SPECTATOR_TICK_HZ) + 1;
+    if (due <= serverSequence) return;
+    serverSequence = due;
+
+    SpectatorClock::time_point begin = SpectatorClock::now();
+    MatchState state;
+    const MatchSnapshot& current = publishSnapshot(serverSequence, state);
+    for (size_t i = 0; i < peers.size(); ++i) {
+        unsigned char packet[SNAPSHOT_MAX_BYTES];
+        bool full;
+        int size = packetFor(current, peers[i].lastAck, packet, full);
+        sendto(serverSocket, (const char*)packet, size, 0, (const sockaddr*)&peers[i].address, sizeof(sockaddr_in));
+        reportBytes += size;
+    }
+    reportCpuSeconds += std::chrono::duration<double>(SpectatorClock::now() - begin).count();
+    reportPeerTicks += (long)peers.size();
+
+    if (now - reportStart >= REPORT_SECONDS) {
+        if (reportPeerTicks) {
+            double clientSeconds = (double)reportPeerTicks / SPECTATOR_TICK_HZ;
+            std::cout << "Spectators: " << peers.size() << " watching, " << (long)(reportBytes / clientSeconds)
+                      << " B/client/s, " << reportCpuSeconds * 1e6 / reportPeerTicks << " us/client/tick" << std::endl;
+        }
+        reportStart = now;
+        reportBytes = reportPeerTicks = 0;
+        reportCpuSeconds = 0.0;
+    }
+}
+
+void stopSpectatorServer() {
+    if (serverSocket == NO_SOCKET) return;
+    closeSocket(serverSocket);
+    serverSocket = NO_SOCKET;
+    peers.clear();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// **********************************************
+// ************ UDP DISPLAY *********************
+// **********************************************
+
+const double DISPLAY_REJOIN_SECONDS = 1.0;
+
+static SocketHandle displaySocket = NO_SOCKET;
+static sockaddr_in displayServer;
+static SpectatorClient displayClient;
+static SpectatorClock::time_point displayStart;
+static double displayLastHeard = 0.0, displayLastJoin = 0.0;
+static bool displayReceiving = false;
+
+static void sendAck(unsigned int ack) {
+    unsigned char packet[4] = { (unsigned char)ack, (unsigned char)(ack >> 8), (unsigned char)(ack >> 16),
+                                (unsigned char)(ack >> 24) };
+    sendto(displaySocket, (const char*)packet, sizeof(packet), 0, (const sockaddr*)&displayServer, sizeof(displayServer));
+}
+
+// A fresh history, then a zero ack, which the server takes as a join
+static void joinServer(double now) {
+    initSpectatorClient(displayClient, SPECTATOR_TICK_HZ);
+    sendAck(0);
+    displayLastJoin = now;
+    displayReceiving = false;
+}
+
+bool startSpectatorDisplay(const char* hostPort) {
+    const char* colon = std::strrchr(hostPort, ':');
+    int port = colon ? std::atoi(colon + 1) : 0;
+    if (!colon || port <= 0 || port > 65535) {
+        std::cerr << "Spectator display: expected <host>:<port>, got " << hostPort << std::endl;
+        return false;
+    }
+    std::string host(hostPort, colon);
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        std::cerr << "Spectator display: WSAStartup failed" << std::endl;
+        return false;
+    }
+#endif
+    displaySocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (displaySocket == NO_SOCKET) {
+        std::cerr << "Spectator display: cannot create a UDP socket" << std::endl;
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return false;
+    }
+    hostent* found = gethostbyname(host.c_str());
+    if (!found || found->h_addrtype != AF_INET) {
+        std::cerr << "Spectator display: cannot resolve " << host << std::endl;
+        stopSpectatorDisplay();
+        return false;
+    }
+    std::memset(&displayServer, 0, sizeof(displayServer));
+    displayServer.sin_family = AF_INET;
+    std::memcpy(&displayServer.sin_addr, found->h_addr_list[0], sizeof(displayServer.sin_addr));
+    displayServer.sin_port = htons((unsigned short)port);
+    setNonBlocking(displaySocket);
+
+    displayStart = SpectatorClock::now();
+    joinServer(0.0);
+    std::cout << "Spectator display: joining " << inet_ntoa(displayServer.sin_addr) << ":" << port << std::endl;
+    return true;
+}
+
+bool updateSpectatorDisplay(MatchState& out) {
+    if (displaySocket == NO_SOCKET) return false;
+    double now = std::chrono::duration<double>(SpectatorClock::now() - displayStart).count();
+    for (;;) {
+        unsigned char buffer[SNAPSHOT_MAX_BYTES];
+        sockaddr_in from;
+#ifdef _WIN32
+        int fromSize = sizeof(from);
+        int size = recvfrom(displaySocket, (char*)buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromSize);
+#else
+        socklen_t fromSize = sizeof(from);
+        int size = (int)recvfrom(displaySocket, buffer, sizeof(buffer), 0, (sockaddr*)&from, &fromSize);
+#endif
+        if (size < 0) break; // nothing more waiting
+        if (!sameAddress(from, displayServer)) continue;
+        unsigned int ack;
+        bool decoded = spectatorClientReceive(displayClient, buffer, size, now, ack);
+        sendAck(ack); // a packet without its base still tells the server where we are
+        if (!decoded) continue;
+        if (!displayReceiving) std::cout << "Spectator display: receiving the match" << std::endl;
+        displayReceiving = true;
+        displayLastHeard = now;
+    }
+
+    // The server is not up yet, restarted or has dropped us
+    double quiet = now - std::max(displayLastHeard, displayLastJoin);
+    if (quiet >= DISPLAY_REJOIN_SECONDS) joinServer(now);
+    return spectatorClientSample(displayClient, now, out);
+}
+
+void stopSpectatorDisplay() {
+    if (displaySocket == NO_SOCKET) return;
+    closeSocket(displaySocket);
+    displaySocket = NO_SOCKET;
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+// **********************************************
+// ************ LOOPBACK STAND-IN ***************
+// **********************************************
+
+const double LOOPBACK_FRAME = 1.0 / 60.0; // client render rate
+const double LOOPBACK_MIN_LATENCY = 0.020, LOOPBACK_MAX_LATENCY = 0.150;
+const double LOOPBACK_JITTER = 0.010;     // either way, so packets reorder
+const double LOOPBACK_WARMUP = 1.0;       // seconds before errors are measured
+
+struct LoopPacket {
+    double arrival;
+    int size;
+    unsigned char data[SNAPSHOT_MAX_BYTES];
+};
+
+struct LoopAck {
+    double arrival;
+    unsigned int ack;
+};
+
+struct LoopClient {
+    SpectatorClient client;
+    double latency;
+    std::vector<LoopPacket> toClient;
+    std::vector<LoopAck> toServer;
+    unsigned int lastAck; // as the server knows it
+};
+
+static unsigned int loopRandomState = 12345u;
+
+static double loopRandom() {
+    loopRandomState ^= loopRandomState << 13;
+    loopRandomState ^= loopRandomState >> 17;
+    loopRandomState ^= loopRandomState << 5;
+    return (loopRandomState & 0xFFFFFF) / 16777216.0;
+}
+
+static double loopDelay(const LoopClient& c) {
+    return c.latency + (loopRandom() * 2.0 - 1.0) * LOOPBACK_JITTER;
+}
+
+int runSpectatorLoopback(int clientCount, float seconds, float lossPercent, MatchAdvanceFunction advance) {
+    if (clientCount < 1 || seconds <= 0.0f) {
+        std::cerr << "Spectator loopback: need at least one client and some time" << std::endl;
+        return 1;
+    }
+    double loss = lossPercent / 100.0;
+    std::cout << "Spectator loopback: " << clientCount << " clients for " << seconds << " s at " << SPECTATOR_TICK_HZ
+              << " Hz, " << lossPercent << "% loss each way" << std::endl;
+
+    std::vector<LoopClient> clients(clientCount);
+    for (int i = 0; i < clientCount; ++i) {
+        initSpectatorClient(clients[i].client, SPECTATOR_TICK_HZ);
+        clients[i].latency = LOOPBACK_MIN_LATENCY + loopRandom() * (LOOPBACK_MAX_LATENCY - LOOPBACK_MIN_LATENCY);
+        clients[i].lastAck = 0;
+    }
+    std::memset(snapshotRing, 0, sizeof(snapshotRing));
+
+    // The unquantized ball, by sequence, to judge what the clients show
+    std::vector<float> trueBallX(1, 0.0f), trueBallZ(1, 0.0f);
+
+    unsigned int sequence = 0;
+    long bytes = 0, packets = 0, fullPackets = 0, rejected = 0, mismatched = 0;
+    double encodeSeconds = 0.0;
+    std::vector<float> errors; // the kick restarting teleports the ball, so quote percentiles
+    long emptySamples = 0;
+
+    int frames = (int)(seconds / LOOPBACK_FRAME);
+    for (int frame = 0; frame <= frames; ++frame) {
+        double now = frame * LOOPBACK_FRAME;
+
+        // Server ticks due by now
+        while (sequence / SPECTATOR_TICK_HZ <= now) {
+            if (sequence) advance(1.0f / SPECTATOR_TICK_HZ);
+            ++sequence;
+            MatchState state;
+            const MatchSnapshot& current = publishSnapshot(sequence, state);
+            trueBallX.push_back(state.ballX);
+            trueBallZ.push_back(state.ballZ);
+
+            SpectatorClock::time_point begin = SpectatorClock::now();
+            for (int i = 0; i < clientCount; ++i) {
+                LoopClient& c = clients[i];
+                LoopPacket packet;
+                bool full;
+                packet.size = packetFor(current, c.lastAck, packet.data, full);
+                bytes += packet.size;
+                ++packets;
+                fullPackets += full;
+                if (loopRandom() < loss) continue;
+                packet.arrival = now + loopDelay(c);
+                c.toClient.push_back(packet);
+            }
+            encodeSeconds += std::chrono::duration<double>(SpectatorClock::now() - begin).count();
+        }
+
+        for (int i = 0; i < clientCount; ++i) {
+            LoopClient& c = clients[i];
+
+            // Acks reaching the server
+            size_t kept = 0;
+            for (size_t k = 0; k < c.toServer.size(); ++k) {
+                const LoopAck& a = c.toServer[k];
+                if (a.arrival > now) c.toServer[kept++] = a;
+                else if (a.ack > c.lastAck) c.lastAck = a.ack;
+            }
+            c.toServer.resize(kept);
+
+            // Snapshots reaching the client, each answered with an ack
+            kept = 0;
+            for (size_t k = 0; k < c.toClient.size(); ++k) {
+                const LoopPacket& p = c.toClient[k];
+                if (p.arrival > now) {
+                    c.toClient[kept++] = p;
+                    continue;
+                }
+                unsigned int ack;
+                if (spectatorClientReceive(c.client, p.data, p.size, now, ack)) {
+                    unsigned int got = p.data[0] | p.data[1] << 8 | p.data[2] << 16 | (unsigned int)p.data[3] << 24;
+                    const MatchSnapshot& sent = snapshotRing[got % SERVER_HISTORY];
+                    const MatchSnapshot& decoded = c.client.history[got % SPECTATOR_HISTORY];
+                    if (sent.sequence == got && std::memcmp(sent.field, decoded.field, sizeof(sent.field)) != 0) {
+                        ++mismatched;
+                    }
+                } else {
+                    ++rejected;
+                }
+                if (loopRandom() < loss) continue;
+                LoopAck a = { now + loopDelay(c), ack };
+                c.toServer.push_back(a);
+            }
+            c.toClient.resize(kept);
+
+            // What this display shows now, against where the ball really was then
+            if (now < LOOPBACK_WARMUP) continue;
+            MatchState shown;
+            if (!spectatorClientSample(c.client, now, shown)) {
+                ++emptySamples;
+                continue;
+            }
+            double tick = (now + c.client.clockOffset - SPECTATOR_INTERP_DELAY) * SPECTATOR_TICK_HZ;
+            tick = std::max(1.0, std::min(tick, (double)sequence));
+            int s = (int)tick;
+            int n = std::min(s + 1, (int)sequence);
+            float t = (float)(tick - s);
+            float x = trueBallX[s] + (trueBallX[n] - trueBallX[s]) * t;
+            float z = trueBallZ[s] + (trueBallZ[n] - trueBallZ[s]) * t;
+            errors.push_back(std::sqrt((shown.ballX - x) * (shown.ballX - x) + (shown.ballZ - z) * (shown.ballZ - z)));
+        }
+    }
+
+    double clientSeconds = (double)packets / SPECTATOR_TICK_HZ;
+    std::cout << "Spectator loopback: " << (long)(bytes / clientSeconds) << " B/client/s, "
+              << (double)bytes / packets << " B per snapshot, " << 100.0 * fullPackets / packets << "% sent in full"
+              << std::endl;
+    std::cout << "Spectator loopback: server " << encodeSeconds * 1e6 / packets << " us/client/tick, "
+              << encodeSeconds * 1e6 / sequence << " us/tick for all " << clientCount << std::endl;
+    float median = 0.0f, p99 = 0.0f;
+    if (!errors.empty()) {
+        std::nth_element(errors.begin(), errors.begin() + errors.size() / 2, errors.end());
+        median = errors[errors.size() / 2];
+        std::nth_element(errors.begin(), errors.begin() + errors.size() * 99 / 100, errors.end());
+        p99 = errors[errors.size() * 99 / 100];
+    }
+    std::cout << "Spectator loopback: ball error median " << median << ", 99th percentile " << p99 << " units; " << emptySamples << " empty samples, " << rejected
+              << " packets too late or without base, " << mismatched << " decoded wrongly" << std::endl;
+    return mismatched ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+#ifndef SPECTATOR_SERVER_H
+#define SPECTATOR_SERVER_H
+
+// **********************************************
+// ************ SPECTATOR BROADCAST *************
+// **********************************************
+
+// Publishes the match to remote displays over UDP at a fixed tick, whatever
+// the local frame rate. A display joins by sending a zero ack and stays
+// subscribed while it keeps acknowledging; each tick it is sent the
+// snapshot as a delta against the newest one it acknowledged (a full
+// snapshot when that is too old), so a lost packet costs nothing but a
+// slightly bigger next one. Displays that go quiet are dropped.
+
+const float SPECTATOR_TICK_HZ = 20.0f;
+
+struct MatchState;
+
+bool startSpectatorServer(int port);
+// Every frame: reads acks and joins, sends a snapshot when a tick is due
+void updateSpectatorServer();
+void stopSpectatorServer();
+
+// The display end (--spectator-connect <host>:<port>): joins the server,
+// acks every snapshot it decodes and joins again, from scratch, after a
+// second without one. Each frame it gives the match as the server had it
+// SPECTATOR_INTERP_DELAY ago; false until the first snapshot arrives.
+bool startSpectatorDisplay(const char* hostPort);
+bool updateSpectatorDisplay(MatchState& out);
+void stopSpectatorDisplay();
+
+// Headless stand-in for a room full of displays: `clients` simulated
+// clients behind an in-process link with per-client latency, jitter and
+// `lossPercent` loss each way, decoding and interpolating at 60 Hz while
+// `advance` moves the match on for `seconds` of simulated time. Prints
+// bytes per client per second, server CPU per client and how far the
+// clients' interpolated ball strays from the true one. Returns the exit code.
+typedef void (*MatchAdvanceFunction)(float seconds);
+int runSpectatorLoopback(int clients, float seconds, float lossPercent, MatchAdvanceFunction advance);
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef STADIUM_H
+#define STADIUM_H
+
+#include <GL/glut.h>
+#include <GL/freeglut.h>
+#include <GL/glu.h>
+#include <cmath>
+#include "skeletalAnimation.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Shared between mainSTADIUMHERMES.cpp and the renderer modules.
+
+// **********************************************
+// ************ DIMENSIONS (FIXED) **************
+// **********************************************
+
+// 1. INCREASE TRACK SIZE to accommodate the field corners
+const float TRACK_INNER_X_RADIUS = 55.0f;
+const float TRACK_INNER_Z_RADIUS = 38.0f; // Made wider to prevent corner overlap
+
+const float TRACK_WIDTH = 10.0f;
+const float TRACK_OUTER_X_RADIUS = TRACK_INNER_X_RADIUS + TRACK_WIDTH;
+const float TRACK_OUTER_Z_RADIUS = TRACK_INNER_Z_RADIUS + TRACK_WIDTH;
+
+// 2. SHRINK FIELD SIZE to ensure corners don't touch the track
+// The field is now significantly smaller than the track inner radius
+const float FIELD_X_RADIUS = 40.0f; // Leaves ~15 units of "D" area length
+const float FIELD_Z_RADIUS = 24.0f; // Leaves ~14 units of side area width
+
+// Team benches (dugouts) either side of the halfway line, facing the pitch
+const float TEAM_BENCH_X = 15.0f;
+const float TEAM_BENCH_Z = -FIELD_Z_RADIUS - 8.0f;
+
+// Corner Check: (40/55)^2 + (24/38)^2 = 0.53 + 0.40 = 0.93 < 1.0 (Safe inside)
+
+const float SEATING_BASE_X_RADIUS = TRACK_OUTER_X_RADIUS;
+const float SEATING_BASE_Z_RADIUS = TRACK_OUTER_Z_RADIUS;
+
+const int NUM_TIERS = 8;
+const float TIER_HEIGHT = 1.2f;
+const float TIER_DEPTH_INCREASE_X = 1.2f;
+const float TIER_DEPTH_INCREASE_Z = 1.2f;
+
+// Seats per unit of row circumference
+const float SEAT_DENSITY = 1.1f;
+
+// The bowl is built, cached and culled in this many angular sectors
+const int NUM_SEAT_SECTORS = 12;
+
+const float MAX_SEATING_X_RADIUS = SEATING_BASE_X_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_X;
+const float MAX_SEATING_Z_RADIUS = SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
+
+const float STADIUM_TOTAL_HEIGHT = (NUM_TIERS - 1) * TIER_HEIGHT;
+const float MAIN_GRANDSTAND_WIDTH = 120.0f;
+
+// Gap left in the seating bowl and stone facade for each gate, in degrees
+const float GATE_GAP_DEGREES = 14.0f;
+
+// Nothing is planted within this angle of either gate, so the approaches stay clear
+const float TREE_GATE_CLEARANCE_DEGREES = 15.0f;
+
+// Square park around the stadium; the streamed city starts at its edge
+const float PARK_HALF_EXTENT = 240.0f;
+
+// Far clipping distance for every camera, and how far out city tiles are kept loaded
+const float VIEW_FAR_DISTANCE = 1500.0f;
+
+// Jumbotron above Gate B, screen facing the pitch (+X)
+const float JUMBOTRON_X = -(MAX_SEATING_X_RADIUS + 6.0f);
+const float JUMBOTRON_Y = STADIUM_TOTAL_HEIGHT + 18.0f; // screen centre
+const float JUMBOTRON_WIDTH = 32.0f;
+const float JUMBOTRON_HEIGHT = 18.0f;
+
+// **********************************************
+// ************ SHARED STATE ********************
+// **********************************************
+
+extern int windowWidth;
+extern int windowHeight;
+extern bool nightMode;
+void toggleNightMode(); // also sets the sky colour
+
+extern bool isPlaying;
+extern int animStage;
+extern float ballX, ballZ, ballRot;
+extern float strikerX, strikerZ;
+extern float goalieZ;
+
+extern float angleY, angleX, camDist;
+extern float lookAtHeight;
+extern float cameraX, cameraY, cameraZ;
+extern float targetX, targetY, targetZ;
+extern float deltaAngleY, deltaAngleX, deltaMove; // per step while a key is held
+
+// updateGameLogic() steps per simulated second. Interactive mode steps once per
+// idle call; offline capture steps this many times per second of output video.
+const float SIM_TICK_RATE = 60.0f;
+
+// matchState.cpp: no OpenGL, so the benchmarks and headless modes can use them
+void computeCameraPosition();
+void updateGameLogic(); // one step of the kick animation
+void startKick();
+
+bool inGateClearance(float angleDeg, float gapDeg);
+
+// Where every player stands this frame: five fixed per team plus the
+// animated striker (red) and goalkeeper (blue)
+struct PlayerSpot {
+    float x, z;
+    bool isTeamRed;
+    float rotation;
+};
+const int NUM_PLAYERS = 12;
+void currentPlayerSpots(PlayerSpot spots[NUM_PLAYERS]);
+
+// Everyone animated at the pitch: the players in currentPlayerSpots() order,
+// then the substitutes in front of the benches, red first. Clips and blends
+// follow from the match globals alone, so spectator displays agree.
+const int NUM_SUBSTITUTES = 10;
+const int NUM_MATCH_FIGURES = NUM_PLAYERS + NUM_SUBSTITUTES;
+void currentMatchFigures(AnimFigure figures[NUM_MATCH_FIGURES], bool isTeamRed[NUM_MATCH_FIGURES]);
+
+// Players and ball as scene graph nodes (sceneGraph.h), built on first use;
+// moves the nodes that changed since last frame
+void updateMatchSceneGraph();
+
+// **********************************************
+// ************ DRAWING FUNCTIONS ***************
+// **********************************************
+
+// A StadiumPart of the scene description (stadiumScene.h); the functions
+// after it add what is drawn only in GL
+void drawStadiumPart(int part);
+void drawMainGrandstandRoof();
+void drawStadiumName();
+void drawSafetyRailing();
+void drawGoalposts();
+void drawEntranceGates();
+void applyAllFloodlights();
+bool surroundingTreePosition(int i, float& x, float& z);
+void drawPickHighlight();
+
+// Floodlight tower placement, shared by the tower geometry and the GL lights
+struct FloodlightTower {
+    float x, z, angleRotation;
+    int lightIndex;
+};
+const int NUM_FLOODLIGHT_TOWERS = 4;
+extern const FloodlightTower FLOODLIGHT_TOWERS[NUM_FLOODLIGHT_TOWERS];
+
+const int NUM_SURROUNDING_TREES = 10;
+
+#endif
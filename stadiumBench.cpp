@@ -0,0 +1,815 @@
+// **********************************************
+// ************ STANDALONE BENCHMARKS ***********
+// **********************************************
+
+// Windowless timings of the CPU-side subsystems, built from STADIUMBENCH.dev.
+// No OpenGL context is created, so it runs on build and ticketing servers.
+// Every result is also kept as name/size/ns-per-op: --csv writes them out
+// and --baseline compares a run against an earlier file, failing when any
+// kernel got slower by more than --threshold percent.
+
+#include "crowd.h"
+#include "frameArena.h"
+#include "heapTracking.h"
+#include "jobSystem.h"
+#include "particles.h"
+#include "seatInventory.h"
+#include "seatPicking.h"
+#include "simdMath.h"
+#include "skeletalAnimation.h"
+#include "stadiumGeometry.h"
+#include "stadium.h"
+#include "viewMath.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include <vector>
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double elapsedNs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+}
+
+// --- Results: printed as they come, kept for --csv and --baseline ---
+
+struct BenchResult {
+    char name[48];
+    int size; // the scaling parameter (tiers, segments ...), 0 if none
+    double nsPerOp;
+};
+
+static std::vector<BenchResult> results;
+
+static void reportSized(const char* name, int size, double totalNs, long ops) {
+    double perOp = totalNs / ops;
+    char label[64];
+    if (size) std::snprintf(label, sizeof(label), "%s/%d", name, size);
+    else std::snprintf(label, sizeof(label), "%s", name);
+    std::printf("%-28s %10.1f ns/op %12.0f ops/s\n", label, perOp, 1e9 / perOp);
+    BenchResult r;
+    std::snprintf(r.name, sizeof(r.name), "%s", name);
+    r.size = size;
+    r.nsPerOp = perOp;
+    results.push_back(r);
+}
+
+static void report(const char* name, double totalNs, int ops) {
+    reportSized(name, 0, totalNs, ops);
+}
+
+// Small kernels: repeated until a run lasts long enough to time, and the
+// best of several runs kept, since noise only ever adds time
+typedef long (*BenchKernel)(void* context); // one call; returns the operations done
+
+const int KERNEL_RUNS = 7;
+const double KERNEL_MIN_RUN_NS = 20e6;
+
+static void timeKernel(const char* name, int size, BenchKernel kernel, void* context) {
+    long calls = 1;
+    for (;;) {
+        BenchClock::time_point start = BenchClock::now();
+        for (long c = 0; c < calls; ++c) kernel(context);
+        if (elapsedNs(start) >= KERNEL_MIN_RUN_NS / 4 || calls > (1L << 30)) break;
+        calls *= 2;
+    }
+    calls *= 4;
+
+    double bestNs = 0.0;
+    long ops = 0;
+    for (int run = 0; run < KERNEL_RUNS; ++run) {
+        long runOps = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (long c = 0; c < calls; ++c) runOps += kernel(context);
+        double ns = elapsedNs(start);
+        if (run == 0 || ns / runOps < bestNs / ops) {
+            bestNs = ns;
+            ops = runOps;
+        }
+    }
+    reportSized(name, size, bestNs, ops);
+}
+
+// xorshift32, so runs are repeatable
+static unsigned int benchRandom() {
+    static unsigned int state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// **********************************************
+// ************ SEAT INVENTORY ******************
+// **********************************************
+
+const float BENCH_SEAT_DENSITY = 3.0f;
+
+// The real bowl's geometry with enough tiers for targetSeats
+static void buildLargeBowl(int targetSeats, std::vector<SeatPlacement>& seats, unsigned int* sectorFirst = 0) {
+    float keptFraction = 1.0f - 4.0f * GATE_GAP_DEGREES / 360.0f;
+    int tiers = 1;
+    float estimate = 0.0f;
+    while (tiers < 255 && estimate < targetSeats) estimate += seatsInRow(tiers++ - 1, BENCH_SEAT_DENSITY) * keptFraction;
+    unsigned int sectors[NUM_SEAT_SECTORS + 1];
+    generateSeatLayout(seats, sectorFirst ? sectorFirst : sectors, tiers, BENCH_SEAT_DENSITY);
+}
+
+static void benchSeatInventory(int targetSeats, int queries) {
+    std::vector<SeatPlacement> layout;
+    BenchClock::time_point start = BenchClock::now();
+    buildLargeBowl(targetSeats, layout);
+    initSeatInventory(layout);
+    std::printf("Seat inventory: %d seats, built in %.1f ms\n", inventorySeatCount(), elapsedNs(start) / 1e6);
+
+    // Sell a random 60% so the searches have gaps to work around
+    std::vector<SeatId> ids(layout.size());
+    for (size_t i = 0; i < layout.size(); ++i) ids[i] = makeSeatId(layout[i].tier, layout[i].sector, layout[i].seatInRow);
+    for (size_t i = 0; i < ids.size(); ++i)
+        if (benchRandom() % 10 < 6) sellSeats(&ids[i], 1);
+
+    start = BenchClock::now();
+    int sink = 0;
+    for (int i = 0; i < queries; ++i) sink += countFreeSeats(i % (NUM_PRICE_BANDS + 1) - 1);
+    report("countFreeSeats", elapsedNs(start), queries);
+
+    SeatId block[MAX_ADJACENT_SEATS];
+    start = BenchClock::now();
+    for (int i = 0; i < queries; ++i) {
+        int band = (int)(benchRandom() % (NUM_PRICE_BANDS + 1)) - 1;
+        sink += findAdjacentSeats(1 + benchRandom() % 8, band, block) ? 1 : 0;
+    }
+    report("findAdjacentSeats", elapsedNs(start), queries);
+
+    start = BenchClock::now();
+    for (int i = 0; i < queries; ++i) {
+        SeatId id = ids[benchRandom() % ids.size()];
+        if (holdSeats(&id, 1)) releaseSeats(&id, 1);
+    }
+    report("holdSeats + releaseSeats", elapsedNs(start), queries);
+
+    // Full booking flow from an empty bowl: find, hold, then confirm
+    resetSeatInventory();
+    int booked = 0;
+    start = BenchClock::now();
+    for (int i = 0; i < queries; ++i) {
+        int n = 1 + benchRandom() % 6;
+        if (!findAdjacentSeats(n, ANY_PRICE_BAND, block)) {
+            resetSeatInventory(); // sold out: start the next event
+            continue;
+        }
+        if (holdSeats(block, n) && sellSeats(block, n)) booked += n;
+    }
+    report("find + hold + sell", elapsedNs(start), queries);
+    std::printf("  %d seats booked (checksum %d)\n", booked, sink);
+}
+
+// **********************************************
+// ************ SEAT PICKING ********************
+// **********************************************
+
+static void benchSeatPicking(int targetSeats, int picks) {
+    std::vector<SeatPlacement> layout;
+    buildLargeBowl(targetSeats, layout);
+    BenchClock::time_point start = BenchClock::now();
+    buildPickIndex(layout, std::vector<PickBox>());
+    std::printf("Seat picking: %d seats, index built in %.1f ms\n", (int)layout.size(), elapsedNs(start) / 1e6);
+
+    // Rays from around the director camera's orbit at random seats
+    int seatHits = 0;
+    double worstNs = 0.0;
+    start = BenchClock::now();
+    for (int i = 0; i < picks; ++i) {
+        const SeatPlacement& s = layout[benchRandom() % layout.size()];
+        float origin[3] = { (float)(benchRandom() % 200) - 100.0f, 30.0f + benchRandom() % 60, (float)(benchRandom() % 200) - 100.0f };
+        float dir[3] = { s.x - origin[0], s.y - origin[1], s.z - origin[2] };
+        BenchClock::time_point pickStart = BenchClock::now();
+        PickResult hit;
+        if (pickRay(origin, dir, hit) && hit.kind == PICK_SEAT) ++seatHits;
+        worstNs = std::max(worstNs, elapsedNs(pickStart));
+    }
+    report("pickRay", elapsedNs(start), picks);
+    std::printf("  %d of %d rays hit a seat, slowest %.1f us\n", seatHits, picks, worstNs / 1e3);
+}
+
+// **********************************************
+// ************ PARTICLES ***********************
+// **********************************************
+
+const float BENCH_TICK = 1.0f / 60.0f;
+
+// Rain and a goal celebration at once, the worst case in the app
+static void benchParticles(int capacity, int threads) {
+    initJobSystem(threads);
+    initParticles(capacity);
+
+    // Warm up: fill the rain and get the celebration going
+    startGoalCelebration();
+    for (int i = 0; i < 240; ++i) updateParticles(BENCH_TICK, true);
+    buildParticleVertices();
+
+    const int frames = 120;
+    long allocationsBefore = processHeapCounts().allocations;
+    double updateNs = 0.0, vertexNs = 0.0;
+    long liveSum = 0;
+    for (int f = 0; f < frames; ++f) {
+        if (f % 60 == 0) startGoalCelebration(); // keep confetti and sparks coming
+        BenchClock::time_point start = BenchClock::now();
+        updateParticles(BENCH_TICK, true);
+        updateNs += elapsedNs(start);
+        start = BenchClock::now();
+        buildParticleVertices();
+        vertexNs += elapsedNs(start);
+        for (int t = 0; t < NUM_PARTICLE_TYPES; ++t) liveSum += liveParticles((ParticleType)t);
+    }
+
+    std::printf("Particles: %d workers, %ld live on average\n", jobWorkerCount(), liveSum / frames);
+    report("updateParticles / particle", updateNs, (int)liveSum);
+    report("buildParticleVertices / p.", vertexNs, (int)liveSum);
+    std::printf("  %.2f ms update + %.2f ms vertices per frame, %ld heap allocations after warm-up\n",
+                updateNs / frames / 1e6, vertexNs / frames / 1e6,
+                processHeapCounts().allocations - allocationsBefore);
+    shutdownJobSystem();
+}
+
+// Transient render data, the frame arena against the heap: a frame's worth
+// of small and medium scratch arrays, then all released together
+static void benchFrameArena() {
+    const int frames = 2000, perFrame = 64;
+    size_t sizes[perFrame];
+    for (int i = 0; i < perFrame; ++i) sizes[i] = 16 + benchRandom() % 4096;
+    initFrameArena(256 * 1024);
+
+    volatile char sink = 0;
+    long allocationsBefore = processHeapCounts().allocations;
+    BenchClock::time_point start = BenchClock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < perFrame; ++i) {
+            char* p = frameAllocArray<char>(sizes[i]);
+            p[0] = (char)i;
+            sink += p[0];
+        }
+        frameArenaReset();
+    }
+    double arenaNs = elapsedNs(start);
+    long arenaAllocations = processHeapCounts().allocations - allocationsBefore;
+
+    char* blocks[perFrame];
+    start = BenchClock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < perFrame; ++i) {
+            blocks[i] = new char[sizes[i]];
+            blocks[i][0] = (char)i;
+            sink += blocks[i][0];
+        }
+        for (int i = 0; i < perFrame; ++i) delete[] blocks[i];
+    }
+    double heapNs = elapsedNs(start);
+
+    std::printf("Frame arena: %d scratch arrays per frame\n", perFrame);
+    report("frameAlloc + reset", arenaNs, frames * perFrame);
+    report("new[] + delete[]", heapNs, frames * perFrame);
+    std::printf("  %ld heap allocations from the arena over %d frames\n", arenaAllocations, frames);
+}
+
+// **********************************************
+// ************ GEOMETRY & MATCH KERNELS ********
+// **********************************************
+
+// Tier counts and ring resolutions for the scaling curves
+static const int LAYOUT_TIERS[] = { 5, 10, 20, 40, 80 };
+static const int RING_SEGMENTS[] = { 30, 120, 480, 1920 };
+const int CAMERA_STEPS = 1000;
+
+struct LayoutContext {
+    int tiers;
+    std::vector<SeatPlacement> seats;
+    unsigned int sectorFirst[NUM_SEAT_SECTORS + 1];
+    std::vector<SeatVertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static long layoutKernel(void* context) {
+    LayoutContext& c = *(LayoutContext*)context;
+    generateSeatLayout(c.seats, c.sectorFirst, c.tiers, SEAT_DENSITY);
+    return (long)c.seats.size();
+}
+
+static long seatMeshKernel(void* context) {
+    LayoutContext& c = *(LayoutContext*)context;
+    buildSeatMesh(&c.seats[0], (int)c.seats.size(), &c.vertices[0], &c.indices[0]);
+    return (long)c.seats.size();
+}
+
+struct RingContext {
+    int segments;
+    std::vector<float> points;
+};
+
+static long ringKernel(void* context) {
+    RingContext& c = *(RingContext*)context;
+    ellipseArcPoints(TRACK_OUTER_X_RADIUS, TRACK_OUTER_Z_RADIUS, 0.0f, 360.0f, c.segments, &c.points[0]);
+    return c.segments + 1;
+}
+
+// One whole kick, from the run-up until the ball stops
+static long gameLogicKernel(void*) {
+    startKick();
+    long steps = 0;
+    while (isPlaying) {
+        updateGameLogic();
+        ++steps;
+    }
+    return steps;
+}
+
+// Orbiting and zooming like a held arrow key, clamps included
+static long cameraKernel(void*) {
+    deltaAngleY = 1.0f;
+    deltaAngleX = 0.5f;
+    deltaMove = 0.5f;
+    for (int i = 0; i < CAMERA_STEPS; ++i) {
+        if (i % 200 == 0) deltaAngleX = -deltaAngleX; // back and forth through the angle limits
+        computeCameraPosition();
+    }
+    deltaAngleY = deltaAngleX = deltaMove = 0.0f;
+    return CAMERA_STEPS;
+}
+
+// What reshape()'s gluPerspective and the camera imply for culling: the
+// projection, view and combined matrices, then the six frustum planes
+static long frustumKernel(void* context) {
+    Frustum& f = *(Frustum*)context;
+    float target[3] = { 0.0f, 0.0f, 0.0f }, up[3] = { 0.0f, 1.0f, 0.0f };
+    for (int i = 0; i < CAMERA_STEPS; ++i) {
+        float a = i * 0.01f;
+        float eye[3] = { 140.0f * std::sin(a), 40.0f, 140.0f * std::cos(a) };
+        float proj[16], view[16], viewProj[16];
+        perspectiveMatrix(60.0f, 1.5f, 1.0f, VIEW_FAR_DISTANCE, proj);
+        lookAtMatrix(eye, target, up, view);
+        multiplyMatrices(proj, view, viewProj);
+        extractFrustum(viewProj, f);
+    }
+    return CAMERA_STEPS;
+}
+
+static void benchKernels() {
+    std::printf("Kernels: best of %d runs, ns per seat / point / step / call\n", KERNEL_RUNS);
+    for (size_t t = 0; t < sizeof(LAYOUT_TIERS) / sizeof(LAYOUT_TIERS[0]); ++t) {
+        LayoutContext c;
+        c.tiers = LAYOUT_TIERS[t];
+        layoutKernel(&c);
+        c.vertices.resize(c.seats.size() * SEAT_VERTICES);
+        c.indices.resize(c.seats.size() * SEAT_INDICES);
+        timeKernel("generateSeatLayout", c.tiers, layoutKernel, &c);
+        timeKernel("buildSeatMesh", c.tiers, seatMeshKernel, &c);
+    }
+    for (size_t s = 0; s < sizeof(RING_SEGMENTS) / sizeof(RING_SEGMENTS[0]); ++s) {
+        RingContext c;
+        c.segments = RING_SEGMENTS[s];
+        c.points.resize(2 * (c.segments + 1));
+        timeKernel("ellipseArcPoints", c.segments, ringKernel, &c);
+    }
+    timeKernel("updateGameLogic", 0, gameLogicKernel, 0);
+    timeKernel("computeCameraPosition", 0, cameraKernel, 0);
+    Frustum frustum;
+    timeKernel("frustum from camera", 0, frustumKernel, &frustum);
+}
+
+// **********************************************
+// ************ SIMD MATH ***********************
+// **********************************************
+
+// Each batch kernel against the per-call path it replaces, on the same data
+const int MATH_BATCH = 4096;
+
+struct MathContext {
+    std::vector<float> angles, sines, cosines;
+    std::vector<float> x, y, z, scale;
+    std::vector<ModelTransform> transforms;
+    std::vector<float> matrices, products, points, transformed;
+    std::vector<Bounds> bounds;
+};
+
+static long libmSinCosKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        c.sines[i] = std::sin(c.angles[i]);
+        c.cosines[i] = std::cos(c.angles[i]);
+    }
+    return MATH_BATCH;
+}
+
+static long batchSinCosKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    sinCosBatch(&c.angles[0], MATH_BATCH, &c.sines[0], &c.cosines[0]);
+    return MATH_BATCH;
+}
+
+// glTranslatef, glRotatef, glScalef: three matrices and two products each
+static long perCallYawKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        float t[16], r[16], sc[16], tr[16];
+        translationMatrix(c.x[i], c.y[i], c.z[i], t);
+        rotationMatrix(c.angles[i], 0.0f, 1.0f, 0.0f, r);
+        scalingMatrix(c.scale[i], c.scale[i], c.scale[i], sc);
+        multiplyMatrices(t, r, tr);
+        multiplyMatrices(tr, sc, &c.matrices[i * 16]);
+    }
+    return MATH_BATCH;
+}
+
+static long batchYawKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    composeYawTransforms(&c.x[0], &c.y[0], &c.z[0], &c.angles[0], &c.scale[0], MATH_BATCH, &c.matrices[0]);
+    return MATH_BATCH;
+}
+
+static long perCallTrsKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        const ModelTransform& m = c.transforms[i];
+        float t[16], r[16], sc[16], tr[16];
+        translationMatrix(m.position[0], m.position[1], m.position[2], t);
+        rotationMatrix(c.angles[i], 0.6f, 0.8f, 0.0f, r);
+        scalingMatrix(m.scale[0], m.scale[1], m.scale[2], sc);
+        multiplyMatrices(t, r, tr);
+        multiplyMatrices(tr, sc, &c.matrices[i * 16]);
+    }
+    return MATH_BATCH;
+}
+
+static long batchTrsKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    composeTransforms(&c.transforms[0], MATH_BATCH, &c.matrices[0]);
+    return MATH_BATCH;
+}
+
+// The scalar product multiplyMatrices() used before it went through SSE
+static void scalarMultiply(const float a[16], const float b[16], float out[16]) {
+    float r[16];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            r[col * 4 + row] = a[row] * b[col * 4] + a[4 + row] * b[col * 4 + 1] +
+                               a[8 + row] * b[col * 4 + 2] + a[12 + row] * b[col * 4 + 3];
+        }
+    }
+    for (int i = 0; i < 16; ++i) out[i] = r[i];
+}
+
+static long scalarMultiplyKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    const float* m = &c.matrices[0];
+    for (int i = 0; i < MATH_BATCH; ++i) scalarMultiply(m, m + i * 16, &c.products[i * 16]);
+    return MATH_BATCH;
+}
+
+static long batchMultiplyKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    multiplyMatrixBatch(&c.matrices[0], &c.matrices[0], MATH_BATCH, &c.products[0]);
+    return MATH_BATCH;
+}
+
+static long perPointKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    const float* m = &c.matrices[0];
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        const float* p = &c.points[i * 3];
+        for (int a = 0; a < 3; ++a) c.transformed[i * 3 + a] = m[a] * p[0] + m[4 + a] * p[1] + m[8 + a] * p[2] + m[12 + a];
+    }
+    return MATH_BATCH;
+}
+
+static long batchPointsKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    transformPoints(&c.matrices[0], &c.points[0], MATH_BATCH, &c.transformed[0]);
+    return MATH_BATCH;
+}
+
+// World bounds the way a caller without the batch would: all eight corners
+static long cornerBoundsKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        const float* m = &c.matrices[i * 16];
+        Bounds& b = c.bounds[i];
+        for (int k = 0; k < 8; ++k) {
+            float px = (k & 1) ? 1.0f : -1.0f, py = (k & 2) ? 2.0f : 0.0f, pz = (k & 4) ? 1.0f : -1.0f;
+            float w[3];
+            for (int a = 0; a < 3; ++a) w[a] = m[a] * px + m[4 + a] * py + m[8 + a] * pz + m[12 + a];
+            if (k == 0) makeBounds(b, w[0], w[1], w[2], w[0], w[1], w[2]);
+            else growBounds(b, w[0], w[1], w[2]);
+        }
+    }
+    return MATH_BATCH;
+}
+
+static long batchBoundsKernel(void* context) {
+    MathContext& c = *(MathContext*)context;
+    Bounds local;
+    makeBounds(local, -1.0f, 0.0f, -1.0f, 1.0f, 2.0f, 1.0f);
+    transformBoundsBatch(&c.matrices[0], MATH_BATCH, local, &c.bounds[0]);
+    return MATH_BATCH;
+}
+
+static void printSpeedup() {
+    const BenchResult& perCall = results[results.size() - 2];
+    const BenchResult& batch = results[results.size() - 1];
+    std::printf("  %.1fx faster in batches\n", perCall.nsPerOp / batch.nsPerOp);
+}
+
+static void benchSimdMath() {
+#if defined(__AVX__)
+    const char* path = "AVX";
+#elif defined(__SSE2__)
+    const char* path = "SSE2";
+#else
+    const char* path = "scalar";
+#endif
+    std::printf("SIMD math (%s): %d angles / matrices / points per batch, ns each\n", path, MATH_BATCH);
+    MathContext c;
+    c.angles.resize(MATH_BATCH);
+    c.sines.resize(MATH_BATCH);
+    c.cosines.resize(MATH_BATCH);
+    c.x.resize(MATH_BATCH);
+    c.y.resize(MATH_BATCH);
+    c.z.resize(MATH_BATCH);
+    c.scale.resize(MATH_BATCH);
+    c.transforms.resize(MATH_BATCH);
+    c.matrices.resize(MATH_BATCH * 16);
+    c.products.resize(MATH_BATCH * 16);
+    c.points.resize(MATH_BATCH * 3);
+    c.transformed.resize(MATH_BATCH * 3);
+    c.bounds.resize(MATH_BATCH);
+    for (int i = 0; i < MATH_BATCH; ++i) {
+        c.angles[i] = (benchRandom() % 72000) * 0.01f - 360.0f;
+        c.x[i] = (benchRandom() % 2000) * 0.1f - 100.0f;
+        c.y[i] = (benchRandom() % 100) * 0.1f;
+        c.z[i] = (benchRandom() % 2000) * 0.1f - 100.0f;
+        c.scale[i] = 0.6f + (benchRandom() % 100) * 0.008f;
+        ModelTransform& t = c.transforms[i];
+        t.position[0] = c.x[i]; t.position[1] = c.y[i]; t.position[2] = c.z[i];
+        t.rotation = quatFromAxisAngle(c.angles[i], 0.6f, 0.8f, 0.0f);
+        t.scale[0] = t.scale[1] = t.scale[2] = c.scale[i];
+        for (int a = 0; a < 3; ++a) c.points[i * 3 + a] = (benchRandom() % 200) * 0.01f - 1.0f;
+    }
+
+    // Accuracy first: the batch against libm on the same angles
+    libmSinCosKernel(&c);
+    std::vector<float> libmSines(c.sines), libmCosines(c.cosines);
+    batchSinCosKernel(&c);
+    float worst = 0.0f;
+    for (int i = 0; i < MATH_BATCH; ++i)
+        worst = std::max(worst, std::max(std::fabs(c.sines[i] - libmSines[i]), std::fabs(c.cosines[i] - libmCosines[i])));
+    std::printf("  sinCosBatch within %.1e of libm\n", worst);
+
+    timeKernel("sin + cos (libm)", 0, libmSinCosKernel, &c);
+    timeKernel("sinCosBatch", 0, batchSinCosKernel, &c);
+    printSpeedup();
+    timeKernel("translate rotateY scale", 0, perCallYawKernel, &c);
+    timeKernel("composeYawTransforms", 0, batchYawKernel, &c);
+    printSpeedup();
+    timeKernel("translate rotate scale", 0, perCallTrsKernel, &c);
+    timeKernel("composeTransforms", 0, batchTrsKernel, &c);
+    printSpeedup();
+    timeKernel("scalar matrix product", 0, scalarMultiplyKernel, &c);
+    timeKernel("multiplyMatrixBatch", 0, batchMultiplyKernel, &c);
+    printSpeedup();
+    timeKernel("per-point transform", 0, perPointKernel, &c);
+    timeKernel("transformPoints", 0, batchPointsKernel, &c);
+    printSpeedup();
+    timeKernel("bounds from 8 corners", 0, cornerBoundsKernel, &c);
+    timeKernel("transformBoundsBatch", 0, batchBoundsKernel, &c);
+    printSpeedup();
+}
+
+// **********************************************
+// ************ SKELETAL ANIMATION **************
+// **********************************************
+
+// The match's figures, then crowd sizes
+static const int FIGURE_COUNTS[] = { NUM_MATCH_FIGURES, 1000, 10000, 100000 };
+
+struct AnimationContext {
+    int count;
+    std::vector<AnimFigure> figures;
+    std::vector<float> matrices;
+};
+
+// Mostly idle, some running, a few kicking or diving, one in eight blending
+static void makeFigures(AnimationContext& c) {
+    c.figures.resize(c.count);
+    c.matrices.resize((size_t)c.count * POSE_FLOATS);
+    for (int i = 0; i < c.count; ++i) {
+        AnimFigure& f = c.figures[i];
+        unsigned int r = benchRandom();
+        f.x = (r % 1000) * 0.1f - 50.0f;
+        f.y = 0.0f;
+        f.z = ((r >> 10) % 1000) * 0.1f - 50.0f;
+        f.yawDeg = (float)((r >> 20) % 360);
+        int pick = benchRandom() % 16;
+        f.clip = pick < 10 ? CLIP_IDLE : pick < 14 ? CLIP_RUN : pick == 14 ? CLIP_KICK : CLIP_DIVE_LEFT;
+        f.phase = (benchRandom() % 1000) * 0.001f;
+        f.fromClip = -1;
+        f.fromPhase = 0.0f;
+        f.fromWeight = 0.0f;
+        if (benchRandom() % 8 == 0) {
+            f.fromClip = CLIP_IDLE;
+            f.fromPhase = (benchRandom() % 1000) * 0.001f;
+            f.fromWeight = (benchRandom() % 100) * 0.01f;
+        }
+    }
+}
+
+static long cachedAnimationKernel(void* context) {
+    AnimationContext& c = *(AnimationContext*)context;
+    animateFigures(&c.figures[0], c.count, &c.matrices[0]);
+    return c.count;
+}
+
+// The same figures without the cache: every one samples its keyframes and
+// walks its bones (blends left out, so this is the cheaper side)
+static long sampledAnimationKernel(void* context) {
+    AnimationContext& c = *(AnimationContext*)context;
+    for (int i = 0; i < c.count; ++i) {
+        const AnimFigure& f = c.figures[i];
+        float pose[POSE_FLOATS], t[16], r[16], root[16];
+        sampleFigurePose(f.clip, f.phase, pose);
+        translationMatrix(f.x, f.y, f.z, t);
+        rotationMatrix(f.yawDeg, 0.0f, 1.0f, 0.0f, r);
+        multiplyMatrices(t, r, root);
+        multiplyMatrixBatch(root, pose, NUM_FIGURE_PARTS, &c.matrices[(size_t)i * POSE_FLOATS]);
+    }
+    return c.count;
+}
+
+static void benchAnimation(int threads) {
+    initJobSystem(threads);
+    initSkeletalAnimation();
+    std::printf("Skeletal animation: %d parts per figure, %d worker threads, ns per figure\n", NUM_FIGURE_PARTS,
+                jobWorkerCount());
+    for (size_t n = 0; n < sizeof(FIGURE_COUNTS) / sizeof(FIGURE_COUNTS[0]); ++n) {
+        AnimationContext c;
+        c.count = FIGURE_COUNTS[n];
+        makeFigures(c);
+        timeKernel("sampled per figure", c.count, sampledAnimationKernel, &c);
+        timeKernel("animateFigures", c.count, cachedAnimationKernel, &c);
+        printSpeedup();
+        if (c.count == NUM_MATCH_FIGURES)
+            std::printf("  the match's %d figures: %.1f us per frame\n", c.count, results.back().nsPerOp * c.count / 1000.0);
+    }
+    shutdownJobSystem();
+}
+
+// **********************************************
+// ************ CROWD ***************************
+// **********************************************
+
+// A fan in each of targetSeats seats: the wave running all the time and a
+// cheer every two seconds, so every fan is moving
+static void benchCrowd(int targetSeats, int threads) {
+    std::vector<SeatPlacement> layout;
+    unsigned int sectorFirst[NUM_SEAT_SECTORS + 1];
+    buildLargeBowl(targetSeats, layout, sectorFirst);
+    initJobSystem(threads);
+    initCrowd(layout, sectorFirst);
+    int fans = crowdFanCount();
+    std::vector<CrowdVertex> vertices((size_t)fans * CROWD_FAN_VERTICES);
+    for (int i = 0; i < 60; ++i) updateCrowd(BENCH_TICK);
+
+    const int frames = 120;
+    long allocationsBefore = processHeapCounts().allocations;
+    double updateNs = 0.0, vertexNs = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        if (f % 120 == 0) startCrowdCheer(f % 240 == 0);
+        BenchClock::time_point start = BenchClock::now();
+        updateCrowd(BENCH_TICK);
+        updateNs += elapsedNs(start);
+        start = BenchClock::now();
+        buildCrowdVertices(0, fans, 1.0f, &vertices[0]);
+        vertexNs += elapsedNs(start);
+    }
+
+    std::printf("Crowd: %d workers, %d fans\n", jobWorkerCount(), fans);
+    report("updateCrowd / fan", updateNs, fans * frames);
+    report("buildCrowdVertices / fan", vertexNs, fans * frames);
+    std::printf("  %.2f ms update per frame, uploading %d KB instanced or %d KB of vertices without; "
+                "%ld heap allocations after warm-up\n",
+                updateNs / frames / 1e6, fans / 1024, (int)(vertices.size() * sizeof(CrowdVertex) / 1024),
+                processHeapCounts().allocations - allocationsBefore);
+    shutdownJobSystem();
+}
+
+// **********************************************
+// ************ CSV & BASELINE ******************
+// **********************************************
+
+static bool writeResults(const char* path) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) return false;
+    std::fprintf(f, "name,size,ns_per_op\n");
+    for (size_t i = 0; i < results.size(); ++i)
+        std::fprintf(f, "%s,%d,%.3f\n", results[i].name, results[i].size, results[i].nsPerOp);
+    std::fclose(f);
+    return true;
+}
+
+static bool readResults(const char* path, std::vector<BenchResult>& out) {
+    FILE* f = std::fopen(path, "r");
+    if (!f) return false;
+    char line[256];
+    while (std::fgets(line, sizeof(line), f)) {
+        char* sizeField = std::strchr(line, ',');
+        if (!sizeField) continue;
+        *sizeField++ = 0;
+        BenchResult r;
+        std::snprintf(r.name, sizeof(r.name), "%.47s", line);
+        if (std::sscanf(sizeField, "%d,%lf", &r.size, &r.nsPerOp) == 2) out.push_back(r);
+    }
+    std::fclose(f);
+    return true;
+}
+
+// Returns the number of results slower than the baseline by more than thresholdPercent
+static int compareWithBaseline(const std::vector<BenchResult>& baseline, float thresholdPercent) {
+    std::printf("\nAgainst the baseline (regression above +%.0f%%):\n", thresholdPercent);
+    int regressions = 0, compared = 0;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& now = results[i];
+        for (size_t j = 0; j < baseline.size(); ++j) {
+            const BenchResult& base = baseline[j];
+            if (std::strcmp(base.name, now.name) != 0 || base.size != now.size || base.nsPerOp <= 0.0) continue;
+            double change = 100.0 * (now.nsPerOp / base.nsPerOp - 1.0);
+            bool regressed = change > thresholdPercent;
+            char label[64];
+            if (now.size) std::snprintf(label, sizeof(label), "%s/%d", now.name, now.size);
+            else std::snprintf(label, sizeof(label), "%s", now.name);
+            std::printf("%-28s %10.1f -> %10.1f ns/op %+7.1f%%%s\n", label, base.nsPerOp, now.nsPerOp, change,
+                        regressed ? "  REGRESSION" : "");
+            regressions += regressed;
+            ++compared;
+            break;
+        }
+    }
+    std::printf("%d compared, %d regressed\n", compared, regressions);
+    return regressions;
+}
+
+// **********************************************
+// ************ MAIN ****************************
+// **********************************************
+
+int main(int argc, char** argv) {
+    int seats = 100000;
+    int queries = 20000;
+    int particles = 1000000;
+    int threads = 0;
+    const char* only = 0;
+    const char* csvPath = 0;
+    const char* baselinePath = 0;
+    float threshold = 10.0f;
+    for (int i = 1; i < argc; ++i) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : 0;
+        if (std::strcmp(argv[i], "--seats") == 0 && value) { seats = std::atoi(value); ++i; }
+        else if (std::strcmp(argv[i], "--queries") == 0 && value) { queries = std::atoi(value); ++i; }
+        else if (std::strcmp(argv[i], "--particles") == 0 && value) { particles = std::atoi(value); ++i; }
+        else if (std::strcmp(argv[i], "--threads") == 0 && value) { threads = std::atoi(value); ++i; }
+        else if (std::strcmp(argv[i], "--only") == 0 && value) { only = value; ++i; }
+        else if (std::strcmp(argv[i], "--csv") == 0 && value) { csvPath = value; ++i; }
+        else if (std::strcmp(argv[i], "--baseline") == 0 && value) { baselinePath = value; ++i; }
+        else if (std::strcmp(argv[i], "--threshold") == 0 && value) { threshold = (float)std::atof(value); ++i; }
+        else {
+            std::printf("Usage: %s [--seats <n>] [--queries <n>] [--particles <n>] [--threads <n>]\n"
+                        "       [--only kernels|inventory|picking|particles|arena|math|animation|crowd] [--csv <file>]\n"
+                        "       [--baseline <file>] [--threshold <percent, default 10>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> baseline;
+    if (baselinePath && !readResults(baselinePath, baseline)) {
+        std::printf("Cannot read baseline %s\n", baselinePath);
+        return 1;
+    }
+    results.reserve(64); // so reporting never allocates inside a heap-counted section
+
+    if (!only || std::strcmp(only, "kernels") == 0) benchKernels();
+    if (!only || std::strcmp(only, "inventory") == 0) benchSeatInventory(seats, queries);
+    if (!only || std::strcmp(only, "picking") == 0) benchSeatPicking(seats, queries);
+    if (!only || std::strcmp(only, "particles") == 0) benchParticles(particles, threads);
+    if (!only || std::strcmp(only, "arena") == 0) benchFrameArena();
+    if (!only || std::strcmp(only, "math") == 0) benchSimdMath();
+    if (!only || std::strcmp(only, "animation") == 0) benchAnimation(threads);
+    if (!only || std::strcmp(only, "crowd") == 0) benchCrowd(seats, threads);
+
+    if (csvPath && !writeResults(csvPath)) {
+        std::printf("Cannot write %s\n", csvPath);
+        return 1;
+    }
+    if (baselinePath && compareWithBaseline(baseline, threshold) > 0) return 2;
+    return 0;
+}
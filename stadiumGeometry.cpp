@@ -0,0 +1,185 @@
+#include "stadiumGeometry.h"
+#include "stadium.h"
+#include "simdMath.h"
+#include <algorithm>
+#include <cmath>
+
+// Bump when the layout or mesh code changes in a way the constants don't show
+const unsigned int SEAT_GEOMETRY_REVISION = 2;
+const int ANGLE_CHUNK = 256; // angles per batch of sines and cosines
+
+// True when angleDeg (0-360) lies within gapDeg of Gate A (0/360) or Gate B (180)
+bool inGateClearance(float angleDeg, float gapDeg) {
+    if (angleDeg < gapDeg || angleDeg > 360.0f - gapDeg) return true;
+    if (angleDeg > 180.0f - gapDeg && angleDeg < 180.0f + gapDeg) return true;
+    return false;
+}
+
+int seatsInRow(int tier) {
+    return seatsInRow(tier, SEAT_DENSITY);
+}
+
+int seatsInRow(int tier, float seatDensity) {
+    float radiusX = SEATING_BASE_X_RADIUS + tier * TIER_DEPTH_INCREASE_X;
+    float radiusZ = SEATING_BASE_Z_RADIUS + tier * TIER_DEPTH_INCREASE_Z;
+
+    // Ramanujan's approximation of the ellipse circumference
+    float h = pow(radiusX - radiusZ, 2) / pow(radiusX + radiusZ, 2);
+    float circumference = M_PI * (radiusX + radiusZ) * (1 + (3 * h) / (10 + sqrt(4 - 3 * h)));
+    return (int)(circumference * seatDensity);
+}
+
+static bool bySectorTierSeat(const SeatPlacement& a, const SeatPlacement& b) {
+    if (a.sector != b.sector) return a.sector < b.sector;
+    if (a.tier != b.tier) return a.tier < b.tier;
+    return a.seatInRow < b.seatInRow;
+}
+
+void generateSeatLayout(std::vector<SeatPlacement>& seats, unsigned int* sectorFirstSeat) {
+    generateSeatLayout(seats, sectorFirstSeat, NUM_TIERS, SEAT_DENSITY);
+}
+
+void generateSeatLayout(std::vector<SeatPlacement>& seats, unsigned int* sectorFirstSeat, int tierCount,
+                        float seatDensity) {
+    seats.clear();
+    float sectorWidth = 360.0f / NUM_SEAT_SECTORS;
+    std::vector<float> rowSines, rowCosines;
+
+    for (int tier = 0; tier < tierCount; ++tier) {
+        float radiusX = SEATING_BASE_X_RADIUS + tier * TIER_DEPTH_INCREASE_X;
+        float radiusZ = SEATING_BASE_Z_RADIUS + tier * TIER_DEPTH_INCREASE_Z;
+        float y = tier * TIER_HEIGHT;
+        float stagger = (tier % 2 == 0) ? 0.0f : 0.5f; // alternate rows offset by half a degree
+
+        int numSeats = seatsInRow(tier, seatDensity);
+        float angleStep = 360.0f / (float)numSeats;
+        rowSines.resize(numSeats);
+        rowCosines.resize(numSeats);
+        sinCosDegreeSteps(stagger, angleStep, numSeats, rowSines.data(), rowCosines.data());
+        for (int i = 0; i < numSeats; ++i) {
+            float angleDeg = stagger + i * angleStep;
+            while (angleDeg >= 360.0f) angleDeg -= 360.0f;
+            if (inGateClearance(angleDeg, GATE_GAP_DEGREES)) continue;
+
+            SeatPlacement s;
+            s.x = radiusX * rowCosines[i];
+            s.y = y;
+            s.z = radiusZ * rowSines[i];
+            s.angleDeg = angleDeg;
+            s.tier = (unsigned short)tier;
+            s.sector = (unsigned short)std::min((int)(angleDeg / sectorWidth), NUM_SEAT_SECTORS - 1);
+            s.seatInRow = i;
+            seats.push_back(s);
+        }
+    }
+    std::sort(seats.begin(), seats.end(), bySectorTierSeat);
+
+    int seat = 0;
+    for (int s = 0; s <= NUM_SEAT_SECTORS; ++s) {
+        while (seat < (int)seats.size() && seats[seat].sector < s) ++seat;
+        sectorFirstSeat[s] = (unsigned int)seat;
+    }
+}
+
+void ellipseArcPoints(float radiusX, float radiusZ, float startDeg, float endDeg, int segments, float* xz) {
+    float step = (endDeg - startDeg) / segments;
+    float angles[ANGLE_CHUNK], sines[ANGLE_CHUNK], cosines[ANGLE_CHUNK];
+    for (int first = 0; first <= segments; first += ANGLE_CHUNK) {
+        int n = std::min(segments + 1 - first, ANGLE_CHUNK);
+        for (int k = 0; k < n; ++k) angles[k] = startDeg + (first + k) * step;
+        sinCosDegreesBatch(angles, n, sines, cosines);
+        for (int k = 0; k < n; ++k) {
+            xz[2 * (first + k)] = radiusX * cosines[k];
+            xz[2 * (first + k) + 1] = radiusZ * sines[k];
+        }
+    }
+}
+
+// Unit box faces: outward normal and four corners, counter-clockwise from outside
+static const float BOX_FACES[6][5][3] = {
+    { { 1, 0, 0}, { 1,-1, 1}, { 1,-1,-1}, { 1, 1,-1}, { 1, 1, 1} },
+    { {-1, 0, 0}, {-1,-1,-1}, {-1,-1, 1}, {-1, 1, 1}, {-1, 1,-1} },
+    { { 0, 1, 0}, {-1, 1,-1}, {-1, 1, 1}, { 1, 1, 1}, { 1, 1,-1} },
+    { { 0,-1, 0}, {-1,-1,-1}, { 1,-1,-1}, { 1,-1, 1}, {-1,-1, 1} },
+    { { 0, 0, 1}, {-1,-1, 1}, { 1,-1, 1}, { 1, 1, 1}, {-1, 1, 1} },
+    { { 0, 0,-1}, { 1,-1,-1}, {-1,-1,-1}, {-1, 1,-1}, { 1, 1,-1} }
+};
+
+void buildSeatMesh(const SeatPlacement* seats, int seatCount, SeatVertex* vertices, unsigned int* indices) {
+    float half[3] = { SEAT_WIDTH / 2.0f, SEAT_HEIGHT / 2.0f, SEAT_DEPTH / 2.0f };
+    float turns[ANGLE_CHUNK], sines[ANGLE_CHUNK], cosines[ANGLE_CHUNK];
+    for (int i = 0; i < seatCount; ++i) {
+        const SeatPlacement& s = seats[i];
+        int k = i % ANGLE_CHUNK;
+        if (k == 0) {
+            // Same as glRotatef(90 - angleDeg, 0, 1, 0): seats face the pitch
+            int n = std::min(seatCount - i, ANGLE_CHUNK);
+            for (int j = 0; j < n; ++j) turns[j] = 90.0f - seats[i + j].angleDeg;
+            sinCosDegreesBatch(turns, n, sines, cosines);
+        }
+        float c = cosines[k], sn = sines[k];
+
+        SeatVertex* v = vertices + i * SEAT_VERTICES;
+        unsigned int* idx = indices + i * SEAT_INDICES;
+        unsigned int base = (unsigned int)(i * SEAT_VERTICES);
+        for (int f = 0; f < 6; ++f) {
+            const float* n = BOX_FACES[f][0];
+            for (int k = 0; k < 4; ++k) {
+                const float* corner = BOX_FACES[f][k + 1];
+                float px = corner[0] * half[0], py = corner[1] * half[1], pz = corner[2] * half[2];
+                SeatVertex& out = v[f * 4 + k];
+                out.pos[0] = s.x + c * px + sn * pz;
+                out.pos[1] = s.y + py;
+                out.pos[2] = s.z - sn * px + c * pz;
+                out.normal[0] = c * n[0] + sn * n[2];
+                out.normal[1] = n[1];
+                out.normal[2] = -sn * n[0] + c * n[2];
+            }
+            unsigned int q = base + f * 4;
+            idx[f * 6 + 0] = q;     idx[f * 6 + 1] = q + 1; idx[f * 6 + 2] = q + 2;
+            idx[f * 6 + 3] = q;     idx[f * 6 + 4] = q + 2; idx[f * 6 + 5] = q + 3;
+        }
+    }
+}
+
+// FNV-1a over every input of the generator, plus the struct sizes so a cache
+// written by a different build layout is never mapped.
+static void hashBytes(unsigned long long& h, const void* data, size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+unsigned long long stadiumParamsHash() {
+    unsigned long long h = 14695981039346656037ULL;
+    const float floats[] = {
+        SEATING_BASE_X_RADIUS, SEATING_BASE_Z_RADIUS, TIER_HEIGHT, TIER_DEPTH_INCREASE_X,
+        TIER_DEPTH_INCREASE_Z, SEAT_DENSITY, GATE_GAP_DEGREES, SEAT_WIDTH, SEAT_HEIGHT, SEAT_DEPTH
+    };
+    const unsigned int ints[] = {
+        (unsigned int)NUM_TIERS, (unsigned int)NUM_SEAT_SECTORS, SEAT_GEOMETRY_REVISION,
+        (unsigned int)sizeof(SeatPlacement), (unsigned int)sizeof(SeatVertex)
+    };
+    hashBytes(h, floats, sizeof(floats));
+    hashBytes(h, ints, sizeof(ints));
+    return h;
+}
+
+float seatViewQuality(const SeatPlacement& s) {
+    // Distance to the nearest point of the pitch rectangle
+    float dx = std::max(std::fabs(s.x) - FIELD_X_RADIUS, 0.0f);
+    float dz = std::max(std::fabs(s.z) - FIELD_Z_RADIUS, 0.0f);
+    float distance = std::sqrt(dx * dx + dz * dz);
+    float closeness = std::max(1.0f - distance / 60.0f, 0.0f);
+
+    // Looking down over the players helps, up to about 25 degrees
+    float elevationDeg = std::atan2(s.y + 1.2f, distance + 1.0f) * 180.0f / M_PI;
+    float elevation = std::min(elevationDeg / 25.0f, 1.0f);
+
+    // Side-on to the halfway line sees both goals equally
+    float side = 1.0f - std::fabs(std::cos(s.angleDeg * M_PI / 180.0f));
+
+    return 0.5f * closeness + 0.2f * elevation + 0.3f * side;
+}
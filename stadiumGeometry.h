@@ -0,0 +1,61 @@
+#ifndef STADIUM_GEOMETRY_H
+#define STADIUM_GEOMETRY_H
+
+#include <vector>
+
+// **********************************************
+// ************ SEATING LAYOUT & MESH ***********
+// **********************************************
+
+// Where every seat goes and the triangles that draw it, computed without
+// touching OpenGL so the result can be cached, benchmarked or queried.
+
+struct SeatPlacement {
+    float x, y, z;         // centre of the seat
+    float angleDeg;        // position around the bowl, 0 = Gate A, 180 = Gate B
+    unsigned short tier;   // 0 = front row
+    unsigned short sector; // NUM_SEAT_SECTORS equal slices of the bowl
+    int seatInRow;         // index around the tier's ellipse; gate gaps leave holes
+};
+
+struct SeatVertex {
+    float pos[3];
+    float normal[3];
+};
+
+// Seat block size (was the glScalef() in drawSeat())
+const float SEAT_WIDTH = 0.8f;
+const float SEAT_HEIGHT = 0.4f;
+const float SEAT_DEPTH = 0.6f;
+
+const int SEAT_VERTICES = 24; // a box with flat-shaded faces
+const int SEAT_INDICES = 36;
+
+// Seats in one tier's ellipse before the gate gaps are cut out.
+int seatsInRow(int tier);
+int seatsInRow(int tier, float seatDensity);
+
+// Every seat, ordered by sector, then tier, then seatInRow. sectorFirstSeat
+// gets NUM_SEAT_SECTORS + 1 entries: sector s is seats [first[s], first[s + 1]).
+void generateSeatLayout(std::vector<SeatPlacement>& seats, unsigned int* sectorFirstSeat);
+
+// The same bowl with a different tier count and density, for sizing tests
+// and benchmarks. The stadium itself always uses NUM_TIERS and SEAT_DENSITY.
+void generateSeatLayout(std::vector<SeatPlacement>& seats, unsigned int* sectorFirstSeat, int tierCount,
+                        float seatDensity);
+
+// segments + 1 points, as x, z pairs, evenly spaced from startDeg to endDeg
+// round an ellipse centred on the pitch: the track, facade and railing outlines
+void ellipseArcPoints(float radiusX, float radiusZ, float startDeg, float endDeg, int segments, float* xz);
+
+// Fills SEAT_VERTICES vertices and SEAT_INDICES indices per seat.
+void buildSeatMesh(const SeatPlacement* seats, int seatCount, SeatVertex* vertices, unsigned int* indices);
+
+// 0 (poor) .. 1 (best): closeness to the pitch, height above it and how
+// square-on the seat is to the halfway line.
+float seatViewQuality(const SeatPlacement& seat);
+
+// Changes whenever anything that affects the layout or mesh changes.
+unsigned long long stadiumParamsHash();
+
+#endif
@@ -0,0 +1,415 @@
+#include "stadiumScene.h"
+#include "stadiumGeometry.h"
+#include "viewMath.h"
+#include <cstring>
+
+static std::vector<StadiumShape> shapes;
+static std::vector<StadiumVertex> vertices;
+static int partFirst[NUM_STADIUM_PARTS + 1];
+static bool built = false;
+
+// **********************************************
+// ************ BUILDER *************************
+// **********************************************
+
+// A glPushMatrix/glTranslatef/glColor3f-like state, so each part below
+// reads like the draw function it replaced.
+
+static float current[16];
+static std::vector<float> matrixStack;
+static float currentColor[3] = { 1.0f, 1.0f, 1.0f };
+static const char* currentName = "";
+static bool currentBulb = false;
+
+static void pushMatrix() { matrixStack.insert(matrixStack.end(), current, current + 16); }
+
+static void popMatrix() {
+    std::memcpy(current, &matrixStack[matrixStack.size() - 16], sizeof(current));
+    matrixStack.resize(matrixStack.size() - 16);
+}
+
+static void multMatrix(const float m[16]) {
+    float out[16];
+    multiplyMatrices(current, m, out);
+    std::memcpy(current, out, sizeof(current));
+}
+
+static void translate(float x, float y, float z) {
+    float m[16];
+    translationMatrix(x, y, z, m);
+    multMatrix(m);
+}
+
+static void rotate(float deg, float ax, float ay, float az) {
+    float m[16];
+    rotationMatrix(deg, ax, ay, az, m);
+    multMatrix(m);
+}
+
+static void scale(float x, float y, float z) {
+    float m[16];
+    scalingMatrix(x, y, z, m);
+    multMatrix(m);
+}
+
+static void color3f(float r, float g, float b) {
+    currentColor[0] = r;
+    currentColor[1] = g;
+    currentColor[2] = b;
+}
+
+static StadiumShape& addShape(int kind) {
+    shapes.push_back(StadiumShape());
+    StadiumShape& s = shapes.back();
+    std::memset(&s, 0, sizeof(s));
+    s.kind = kind;
+    s.name = currentName;
+    std::memcpy(s.color, currentColor, sizeof(s.color));
+    s.bulb = currentBulb;
+    s.first = (int)vertices.size();
+    return s;
+}
+
+static void solidCube() {
+    StadiumShape& s = addShape(STADIUM_BOX);
+    std::memcpy(s.matrix, current, sizeof(s.matrix));
+}
+
+static void box(float tx, float ty, float tz, float sx, float sy, float sz) {
+    pushMatrix();
+    translate(tx, ty, tz);
+    scale(sx, sy, sz);
+    solidCube();
+    popMatrix();
+}
+
+static void addVertex(float x, float y, float z, const float* normal) {
+    StadiumVertex v = { { x, y, z }, { normal[0], normal[1], normal[2] } };
+    vertices.push_back(v);
+}
+
+// Two triangles, a b c and a c d
+static void addQuad(const float* a, const float* b, const float* c, const float* d, const float* normal) {
+    const float* corners[6] = { a, b, c, a, c, d };
+    for (int i = 0; i < 6; ++i) addVertex(corners[i][0], corners[i][1], corners[i][2], normal);
+}
+
+static void endShape(StadiumShape& s) {
+    s.count = (int)vertices.size() - s.first;
+}
+
+// (x, z) points on the ground at height y
+static void groundLines(const float* xz, int count, bool loop, float y, float lineWidth, float bandWidth) {
+    static const float up[3] = { 0.0f, 1.0f, 0.0f };
+    StadiumShape& s = addShape(STADIUM_LINES);
+    s.loop = loop;
+    s.lineWidth = lineWidth;
+    s.bandWidth = bandWidth;
+    for (int i = 0; i < count; ++i) addVertex(xz[2 * i], y, xz[2 * i + 1], up);
+    endShape(s);
+}
+
+// **********************************************
+// ************ THE STADIUM *********************
+// **********************************************
+
+static float topTierZ() {
+    return SEATING_BASE_Z_RADIUS + (NUM_TIERS - 1) * TIER_DEPTH_INCREASE_Z;
+}
+
+// Grass filling the track, the track and its lanes, the pitch markings
+static void buildGround() {
+    static const float up[3] = { 0.0f, 1.0f, 0.0f };
+
+    const int grassSegments = 100;
+    float ring[2 * (grassSegments + 1)];
+    ellipseArcPoints(TRACK_INNER_X_RADIUS, TRACK_INNER_Z_RADIUS, 0.0f, 360.0f, grassSegments, ring);
+    color3f(0.0f, 0.5f, 0.0f);
+    StadiumShape& grass = addShape(STADIUM_TRIANGLES);
+    for (int i = 0; i < grassSegments; ++i) {
+        addVertex(0.0f, 0.01f, 0.0f, up);
+        addVertex(ring[2 * (i + 1)], 0.01f, ring[2 * (i + 1) + 1], up);
+        addVertex(ring[2 * i], 0.01f, ring[2 * i + 1], up);
+    }
+    endShape(grass);
+
+    const int trackSegments = 120;
+    float outer[2 * (trackSegments + 1)], inner[2 * (trackSegments + 1)];
+    ellipseArcPoints(TRACK_OUTER_X_RADIUS, TRACK_OUTER_Z_RADIUS, 0.0f, 360.0f, trackSegments, outer);
+    ellipseArcPoints(TRACK_INNER_X_RADIUS, TRACK_INNER_Z_RADIUS, 0.0f, 360.0f, trackSegments, inner);
+    color3f(0.8f, 0.2f, 0.1f); // burnt orange
+    StadiumShape& track = addShape(STADIUM_TRIANGLES);
+    for (int i = 0; i < trackSegments; ++i) {
+        float q[4][3] = { { outer[2 * i], 0.02f, outer[2 * i + 1] }, { inner[2 * i], 0.02f, inner[2 * i + 1] },
+                          { inner[2 * i + 2], 0.02f, inner[2 * i + 3] }, { outer[2 * i + 2], 0.02f, outer[2 * i + 3] } };
+        addQuad(q[0], q[1], q[2], q[3], up);
+    }
+    endShape(track);
+
+    color3f(1.0f, 1.0f, 1.0f);
+    for (int lane = 1; lane < 4; ++lane) {
+        float r = lane * (TRACK_WIDTH / 4.0f);
+        ellipseArcPoints(TRACK_INNER_X_RADIUS + r, TRACK_INNER_Z_RADIUS + r, 0.0f, 360.0f, trackSegments, outer);
+        groundLines(outer, trackSegments, true, 0.07f, 1.0f, 0.16f);
+    }
+
+    const float pitchY = 0.04f, pitchLine = 2.0f, pitchBand = 0.24f;
+    float boundary[8] = { -FIELD_X_RADIUS, -FIELD_Z_RADIUS, FIELD_X_RADIUS, -FIELD_Z_RADIUS,
+                          FIELD_X_RADIUS, FIELD_Z_RADIUS, -FIELD_X_RADIUS, FIELD_Z_RADIUS };
+    groundLines(boundary, 4, true, pitchY, pitchLine, pitchBand);
+    float halfway[4] = { 0.0f, FIELD_Z_RADIUS, 0.0f, -FIELD_Z_RADIUS };
+    groundLines(halfway, 2, false, pitchY, pitchLine, pitchBand);
+    ellipseArcPoints(9.0f, 9.0f, 0.0f, 360.0f, 50, ring); // centre circle
+    groundLines(ring, 50, true, pitchY, pitchLine, pitchBand);
+    float boxDepth = 16.0f, boxWidth = 30.0f; // penalty areas
+    for (int side = 1; side >= -1; side -= 2) {
+        float x = side * FIELD_X_RADIUS, inner = x - side * boxDepth;
+        float area[8] = { x, -boxWidth / 2, inner, -boxWidth / 2, inner, boxWidth / 2, x, boxWidth / 2 };
+        groundLines(area, 4, true, pitchY, pitchLine, pitchBand);
+    }
+}
+
+// Two walls round the outside of the bowl, open at the gates
+static void buildStoneFacade() {
+    color3f(0.5f, 0.5f, 0.55f);
+    const int segments = 60;
+    float arc[2 * (segments + 1)];
+    float arcs[2][2] = { { GATE_GAP_DEGREES, 180.0f - GATE_GAP_DEGREES },
+                         { 180.0f + GATE_GAP_DEGREES, 360.0f - GATE_GAP_DEGREES } };
+    for (int a = 0; a < 2; ++a) {
+        ellipseArcPoints(MAX_SEATING_X_RADIUS, MAX_SEATING_Z_RADIUS, arcs[a][0], arcs[a][1], segments, arc);
+        StadiumShape& wall = addShape(STADIUM_TRIANGLES);
+        for (int i = 0; i < segments; ++i) {
+            const float* p0 = arc + 2 * i;
+            const float* p1 = arc + 2 * i + 2;
+            float q[4][3] = { { p0[0], STADIUM_TOTAL_HEIGHT, p0[1] }, { p0[0], -5.0f, p0[1] },
+                              { p1[0], -5.0f, p1[1] }, { p1[0], STADIUM_TOTAL_HEIGHT, p1[1] } };
+            // The ellipse's outward normal at the middle of the quad
+            float mx = (p0[0] + p1[0]) * 0.5f, mz = (p0[1] + p1[1]) * 0.5f;
+            float n[3] = { mx / (MAX_SEATING_X_RADIUS * MAX_SEATING_X_RADIUS), 0.0f,
+                           mz / (MAX_SEATING_Z_RADIUS * MAX_SEATING_Z_RADIUS) };
+            addQuad(q[0], q[1], q[2], q[3], n);
+        }
+        endShape(wall);
+    }
+}
+
+static void buildRoof() {
+    currentName = "grandstand roof";
+    color3f(0.8f, 0.8f, 0.9f);
+    box(0.0f, STADIUM_TOTAL_HEIGHT + 10.0f, -topTierZ() - 15.0f, MAIN_GRANDSTAND_WIDTH, 2.0f, 65.0f);
+}
+
+static void buildColumns() {
+    currentName = "grandstand column";
+    color3f(0.6f, 0.6f, 0.65f);
+    float roofHeight = STADIUM_TOTAL_HEIGHT + 10.0f;
+    int numColumns = 8;
+    float spacing = (MAIN_GRANDSTAND_WIDTH - 10.0f) / (numColumns - 1);
+    float startX = -(MAIN_GRANDSTAND_WIDTH - 10.0f) / 2.0f;
+    for (int i = 0; i < numColumns; ++i)
+        box(startX + i * spacing, roofHeight / 2.0f, -topTierZ() - 15.0f, 2.0f, roofHeight, 2.0f);
+}
+
+static void buildGrandstandFacade() {
+    currentName = "grandstand facade";
+    color3f(0.7f, 0.7f, 0.7f);
+    box(0.0f, STADIUM_TOTAL_HEIGHT / 2.0f, -topTierZ() - 12.0f, MAIN_GRANDSTAND_WIDTH, STADIUM_TOTAL_HEIGHT, 1.0f);
+}
+
+// A dark platform with a row of red seats
+static void buildVIP() {
+    currentName = "VIP seating";
+    pushMatrix();
+    translate(0.0f, STADIUM_TOTAL_HEIGHT + 2.0f, -topTierZ() - 5.0f);
+    color3f(0.2f, 0.2f, 0.2f);
+    box(0.0f, 0.0f, 0.0f, MAIN_GRANDSTAND_WIDTH * 0.6f, 1.0f, 10.0f);
+    color3f(0.8f, 0.1f, 0.1f);
+    for (float x = -MAIN_GRANDSTAND_WIDTH * 0.25f; x < MAIN_GRANDSTAND_WIDTH * 0.25f; x += 2.0f)
+        box(x, 1.0f, -2.0f, 1.0f, 1.0f, 1.0f);
+    popMatrix();
+}
+
+void stadiumGoalFrame(int goal, float m[16]) {
+    float side = goal == 0 ? 1.0f : -1.0f;
+    float t[16], r[16];
+    translationMatrix(side * FIELD_X_RADIUS, 0.0f, 0.0f, t);
+    rotationMatrix(-side * 90.0f, 0.0f, 1.0f, 0.0f, r);
+    multiplyMatrices(t, r, m);
+}
+
+static void buildGoals() {
+    currentName = "goalpost";
+    color3f(1.0f, 1.0f, 1.0f);
+    for (int goal = 0; goal < 2; ++goal) {
+        float frame[16];
+        stadiumGoalFrame(goal, frame);
+        pushMatrix();
+        multMatrix(frame);
+        box(-GOAL_WIDTH / 2, GOAL_HEIGHT / 2, 0.0f, GOAL_POST_SIZE, GOAL_HEIGHT, GOAL_POST_SIZE);
+        box(GOAL_WIDTH / 2, GOAL_HEIGHT / 2, 0.0f, GOAL_POST_SIZE, GOAL_HEIGHT, GOAL_POST_SIZE);
+        box(0.0f, GOAL_HEIGHT, 0.0f, GOAL_WIDTH, GOAL_POST_SIZE, GOAL_POST_SIZE);
+        popMatrix();
+    }
+}
+
+// Dugouts either side of the halfway line, open towards the pitch
+static void buildBenches() {
+    currentName = "team bench";
+    float width = 8.0f, height = 2.2f, depth = 1.5f;
+    float positions[2] = { -TEAM_BENCH_X, TEAM_BENCH_X };
+    float colors[2][3] = { { 0.9f, 0.2f, 0.2f }, { 0.2f, 0.2f, 0.9f } };
+    for (int i = 0; i < 2; ++i) {
+        pushMatrix();
+        translate(positions[i], 0.0f, TEAM_BENCH_Z);
+        color3f(0.3f, 0.3f, 0.35f); // roof and walls
+        box(0.0f, height, 0.0f, width, 0.1f, depth);
+        box(0.0f, height / 2.0f, -depth / 2.0f, width, height, 0.1f);
+        box(-width / 2.0f, height / 2.0f, 0.0f, 0.1f, height, depth);
+        box(width / 2.0f, height / 2.0f, 0.0f, 0.1f, height, depth);
+
+        color3f(colors[i][0], colors[i][1], colors[i][2]); // seats in the team colour
+        int numSeats = 6;
+        float seatSpacing = (width - 0.5f) / numSeats;
+        float startX = -(width / 2.0f) + (seatSpacing / 2.0f) + 0.25f;
+        for (int s = 0; s < numSeats; ++s) {
+            box(startX + s * seatSpacing, 0.4f, 0.0f, 0.8f, 0.1f, 0.8f);
+            box(startX + s * seatSpacing, 0.7f, -0.35f, 0.8f, 0.6f, 0.1f);
+        }
+        popMatrix();
+    }
+}
+
+// Gate centre with the opening along x, just inside the outer seating
+// radius in the gaps left in the bowl; 0 = Gate A, 1 = Gate B
+static void gateFrame(int gate, float m[16]) {
+    float angle = gate == 0 ? 0.0f : 180.0f;
+    float angleRad = angle * (float)M_PI / 180.0f;
+    float t[16], r[16];
+    translationMatrix((MAX_SEATING_X_RADIUS - 2.0f) * std::cos(angleRad), 0.0f,
+                      (MAX_SEATING_Z_RADIUS - 2.0f) * std::sin(angleRad), t);
+    rotationMatrix(angle + 90.0f, 0.0f, 1.0f, 0.0f, r);
+    multiplyMatrices(t, r, m);
+}
+
+// Pillars, beam, sign board and the walkway through to the track
+static void buildGates() {
+    static const char* const names[2] = { "gate A", "gate B" };
+    float gateWidth = 16.0f, gateHeight = 12.0f, gateDepth = 4.0f;
+    for (int gate = 0; gate < 2; ++gate) {
+        currentName = names[gate];
+        float frame[16];
+        gateFrame(gate, frame);
+        pushMatrix();
+        multMatrix(frame);
+        color3f(0.5f, 0.5f, 0.55f);
+        box(-gateWidth / 2 + 1.5f, gateHeight / 2, 0.0f, 3.0f, gateHeight, gateDepth);
+        box(gateWidth / 2 - 1.5f, gateHeight / 2, 0.0f, 3.0f, gateHeight, gateDepth);
+        box(0.0f, gateHeight - 1.5f, 0.0f, gateWidth, 3.0f, gateDepth);
+        color3f(0.1f, 0.1f, 0.4f);
+        box(0.0f, gateHeight + 2.0f, 0.0f, gateWidth * 0.8f, 3.0f, 0.5f);
+        color3f(0.55f, 0.55f, 0.6f);
+        box(0.0f, 0.05f, 5.0f, gateWidth - 4.0f, 0.1f, 30.0f);
+        popMatrix();
+    }
+}
+
+// Mast, then the light head tilted down towards the pitch with its bulbs
+static void buildTower(const FloodlightTower& tower) {
+    currentName = "floodlight tower";
+    float poleHeight = 65.0f, headWidth = 14.0f, headHeight = 8.0f;
+    pushMatrix();
+    translate(tower.x, 0.0f, tower.z);
+    rotate(tower.angleRotation, 0.0f, 1.0f, 0.0f);
+    color3f(0.6f, 0.65f, 0.7f); // steel grey
+    box(0.0f, poleHeight / 2.0f, 0.0f, 2.5f, poleHeight, 2.5f);
+
+    translate(0.0f, poleHeight, 0.0f);
+    rotate(25.0f, 1.0f, 0.0f, 0.0f);
+    color3f(0.2f, 0.2f, 0.25f);
+    box(0.0f, 0.0f, 0.0f, headWidth, headHeight, 2.0f);
+
+    currentBulb = true;
+    color3f(0.9f, 0.9f, 0.9f);
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 3; ++j)
+            box(-headWidth / 2.0f + 1.5f + i * 3.5f, -headHeight / 2.0f + 1.5f + j * 2.5f, 1.1f, 2.5f, 1.5f, 0.5f);
+    currentBulb = false;
+    popMatrix();
+}
+
+// The big screen's frame and legs; the picture is drawn by the broadcast renderer
+static void buildJumbotron() {
+    currentName = "jumbotron";
+    float bottom = JUMBOTRON_Y - JUMBOTRON_HEIGHT / 2.0f;
+    color3f(0.15f, 0.15f, 0.18f);
+    box(JUMBOTRON_X - 0.8f, JUMBOTRON_Y, 0.0f, 1.2f, JUMBOTRON_HEIGHT + 1.5f, JUMBOTRON_WIDTH + 1.5f);
+    color3f(0.6f, 0.65f, 0.7f);
+    for (int side = -1; side <= 1; side += 2)
+        box(JUMBOTRON_X - 1.0f, bottom / 2.0f, side * JUMBOTRON_WIDTH * 0.35f, 1.2f, bottom, 1.2f);
+}
+
+static void buildStadiumScene() {
+    built = true;
+    scalingMatrix(1.0f, 1.0f, 1.0f, current);
+    for (int part = 0; part < NUM_STADIUM_PARTS; ++part) {
+        partFirst[part] = (int)shapes.size();
+        currentName = "";
+        switch (part) {
+        case STADIUM_GROUND: buildGround(); break;
+        case STADIUM_STONE_FACADE: buildStoneFacade(); break;
+        case STADIUM_ROOF: buildRoof(); break;
+        case STADIUM_COLUMNS: buildColumns(); break;
+        case STADIUM_GRANDSTAND_FACADE: buildGrandstandFacade(); break;
+        case STADIUM_VIP: buildVIP(); break;
+        case STADIUM_GOALS: buildGoals(); break;
+        case STADIUM_BENCHES: buildBenches(); break;
+        case STADIUM_GATES: buildGates(); break;
+        case STADIUM_JUMBOTRON: buildJumbotron(); break;
+        default: buildTower(FLOODLIGHT_TOWERS[part - STADIUM_FIRST_TOWER]);
+        }
+    }
+    partFirst[NUM_STADIUM_PARTS] = (int)shapes.size();
+}
+
+// **********************************************
+// ************ QUERIES *************************
+// **********************************************
+
+int stadiumPartFirstShape(int part) {
+    if (!built) buildStadiumScene();
+    return partFirst[part];
+}
+
+const StadiumShape& stadiumShape(int index) {
+    if (!built) buildStadiumScene();
+    return shapes[index];
+}
+
+const StadiumVertex* stadiumVertices() {
+    if (!built) buildStadiumScene();
+    return &vertices[0];
+}
+
+bool stadiumShapeLook(const StadiumShape& shape, bool night, float rgb[3]) {
+    if (shape.bulb && night) {
+        rgb[0] = 1.0f;
+        rgb[1] = 1.0f;
+        rgb[2] = 0.2f;
+        return false;
+    }
+    std::memcpy(rgb, shape.color, 3 * sizeof(float));
+    return true;
+}
+
+void collectStadiumBoxes(std::vector<PickBox>& boxes) {
+    int count = stadiumPartFirstShape(NUM_STADIUM_PARTS);
+    for (int i = 0; i < count; ++i) {
+        const StadiumShape& s = shapes[i];
+        if (s.kind != STADIUM_BOX) continue;
+        PickBox b;
+        std::memcpy(b.matrix, s.matrix, sizeof(b.matrix));
+        b.name = s.name;
+        boxes.push_back(b);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef STADIUM_SCENE_H
+#define STADIUM_SCENE_H
+
+#include "seatPicking.h"
+#include "stadium.h"
+#include <vector>
+
+// **********************************************
+// ************ STADIUM SCENE DESCRIPTION *******
+// **********************************************
+
+// The static structures as data, built once without touching OpenGL: the
+// solid boxes (grandstand, goals, benches, gates, floodlight towers,
+// jumbotron), the ground and stone facade as triangles and the pitch and
+// lane markings as lines. The GL draw code, the software renderer and
+// mouse picking all read this one list. What only the GL path draws (the
+// name, goal nets, the railing, the roof's wireframe underside) stays in its
+// draw function; the goal nets are placed with stadiumGoalFrame().
+
+enum StadiumPart {
+    STADIUM_GROUND,
+    STADIUM_STONE_FACADE,
+    STADIUM_ROOF,
+    STADIUM_COLUMNS,
+    STADIUM_GRANDSTAND_FACADE,
+    STADIUM_VIP,
+    STADIUM_GOALS,
+    STADIUM_BENCHES,
+    STADIUM_GATES,
+    STADIUM_FIRST_TOWER, // one part per FLOODLIGHT_TOWERS entry
+    STADIUM_JUMBOTRON = STADIUM_FIRST_TOWER + NUM_FLOODLIGHT_TOWERS,
+    NUM_STADIUM_PARTS
+};
+
+enum StadiumShapeKind {
+    STADIUM_BOX,       // the unit cube (glutSolidCube(1.0)) through matrix
+    STADIUM_TRIANGLES, // vertices [first, first + count), flat shaded
+    STADIUM_LINES      // points [first, first + count), a strip or a loop
+};
+
+struct StadiumVertex {
+    float pos[3];
+    float normal[3];
+};
+
+struct StadiumShape {
+    int kind;
+    const char* name;  // what picking calls a box
+    float color[3];
+    bool bulb;         // a floodlight bulb: white by day, glowing yellow and unlit at night
+    float matrix[16];  // STADIUM_BOX
+    int first, count;  // STADIUM_TRIANGLES, STADIUM_LINES
+    bool loop;         // STADIUM_LINES
+    float lineWidth;   // STADIUM_LINES in GL, pixels
+    float bandWidth;   // STADIUM_LINES as flat bands on the ground, units
+};
+
+// Part p is shapes [stadiumPartFirstShape(p), stadiumPartFirstShape(p + 1))
+int stadiumPartFirstShape(int part);
+const StadiumShape& stadiumShape(int index);
+const StadiumVertex* stadiumVertices();
+
+// The colour to draw a shape in; false if it is drawn without lighting
+bool stadiumShapeLook(const StadiumShape& shape, bool night, float rgb[3]);
+
+// Goal-line centre with the posts along x, for the nets drawn outside this list
+const float GOAL_WIDTH = 7.32f;
+const float GOAL_HEIGHT = 2.44f;
+const float GOAL_POST_SIZE = 0.15f;
+void stadiumGoalFrame(int goal, float m[16]); // 0 = +x, 1 = -x
+
+// Every box, named after the part it belongs to, for mouse picking
+void collectStadiumBoxes(std::vector<PickBox>& boxes);
+
+#endif
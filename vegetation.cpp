@@ -0,0 +1,719 @@
+#include "vegetation.h"
+#include "stadium.h"
+#include "glExtensions.h"
+#include "renderStats.h"
+#include "frameArena.h"
+#include "frameGovernor.h"
+#include "simdMath.h"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+#include "glTrace.h"
+
+// --- Layout ---
+const float VEG_EXTENT = PARK_HALF_EXTENT; // plants within +/- this many units of the centre
+const int VEG_MAP_SIZE = 128;              // density map texels per side
+const float VEG_CELL_SIZE = 20.0f;         // culling / LOD cell
+const int VEG_CELLS = (int)(2.0f * VEG_EXTENT / VEG_CELL_SIZE);
+const float VEG_IMPOSTOR_DISTANCE = 110.0f; // cells further than this use impostors
+static const float IMPOSTOR_DISTANCE_SCALE[3] = { 1.0f, 0.6f, 0.35f }; // per governor detail level
+const float VEG_SHRUB_SHARE = 0.3f;
+
+// --- Impostor atlas: one row per species, one column per view direction ---
+const int IMPOSTOR_VIEWS = 8;
+const int IMPOSTOR_TILE = 128;
+
+struct VegVertex {
+    float pos[3];
+    float normal[3];
+    unsigned char color[4];
+};
+
+struct VegCell {
+    Bounds bounds;
+    int first[NUM_SPECIES];  // into the sorted instance array
+    int count[NUM_SPECIES];
+};
+
+// Species footprint: half width and height before the per-instance scale
+static const float SPECIES_HALF_WIDTH[NUM_SPECIES] = { 5.0f, 2.4f };
+static const float SPECIES_HEIGHT[NUM_SPECIES] = { 14.0f, 2.8f };
+
+static std::vector<VegetationInstance> instances;
+static std::vector<VegCell> cells;           // non-empty cells only
+static std::vector<VegVertex> meshVerts;
+static int meshFirst[NUM_SPECIES], meshCount[NUM_SPECIES];
+static int quadFirst = 0;
+
+static bool ready = false;
+static GLuint meshBuffer = 0, instanceBuffer = 0;
+static GLuint meshProgram = 0, impostorProgram = 0;
+static GLuint atlasTexture = 0;
+static GLuint fallbackLists[NUM_SPECIES];
+static GLint impostorEyeLoc = -1, impostorSizeLoc = -1, impostorRowLoc = -1;
+
+// **********************************************
+// ************ MESHES **************************
+// **********************************************
+
+static void pushVertex(float x, float y, float z, float nx, float ny, float nz, const float color[3]) {
+    VegVertex v;
+    v.pos[0] = x; v.pos[1] = y; v.pos[2] = z;
+    v.normal[0] = nx; v.normal[1] = ny; v.normal[2] = nz;
+    for (int i = 0; i < 3; ++i) v.color[i] = (unsigned char)(color[i] * 255.0f);
+    v.color[3] = 255;
+    meshVerts.push_back(v);
+}
+
+static void addBox(float cx, float cy, float cz, float sx, float sy, float sz, const float color[3]) {
+    static const float faces[6][3] = { {1,0,0}, {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1} };
+    for (int f = 0; f < 6; ++f) {
+        const float* n = faces[f];
+        // Two in-plane axes for this face
+        float u[3] = { n[1], n[2], n[0] };
+        float v[3] = { n[1] * u[2] - n[2] * u[1], n[2] * u[0] - n[0] * u[2], n[0] * u[1] - n[1] * u[0] };
+        float corners[4][2] = { {-1,-1}, {1,-1}, {1,1}, {-1,1} };
+        float p[4][3];
+        for (int c = 0; c < 4; ++c) {
+            for (int k = 0; k < 3; ++k) {
+                float half[3] = { sx / 2.0f, sy / 2.0f, sz / 2.0f };
+                p[c][k] = (n[k] + u[k] * corners[c][0] + v[k] * corners[c][1]) * half[k];
+            }
+        }
+        int order[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i = 0; i < 6; ++i) {
+            const float* q = p[order[i]];
+            pushVertex(cx + q[0], cy + q[1], cz + q[2], n[0], n[1], n[2], color);
+        }
+    }
+}
+
+// Upright cone like glutSolidCone after glRotatef(-90, 1, 0, 0)
+static void addCone(float baseY, float radius, float height, int slices, const float color[3]) {
+    float slope = radius / height;
+    for (int i = 0; i < slices; ++i) {
+        float a0 = 2.0f * (float)M_PI * i / slices;
+        float a1 = 2.0f * (float)M_PI * (i + 1) / slices;
+        float am = 0.5f * (a0 + a1);
+        float c0 = std::cos(a0), s0 = std::sin(a0), c1 = std::cos(a1), s1 = std::sin(a1);
+        float len = std::sqrt(1.0f + slope * slope);
+        pushVertex(radius * c0, baseY, radius * s0, c0 / len, slope / len, s0 / len, color);
+        pushVertex(0.0f, baseY + height, 0.0f, std::cos(am) / len, slope / len, std::sin(am) / len, color);
+        pushVertex(radius * c1, baseY, radius * s1, c1 / len, slope / len, s1 / len, color);
+        // Base
+        pushVertex(0.0f, baseY, 0.0f, 0.0f, -1.0f, 0.0f, color);
+        pushVertex(radius * c0, baseY, radius * s0, 0.0f, -1.0f, 0.0f, color);
+        pushVertex(radius * c1, baseY, radius * s1, 0.0f, -1.0f, 0.0f, color);
+    }
+}
+
+// Half ellipsoid sitting on the ground
+static void addDome(float radius, float height, int slices, int stacks, const float color[3]) {
+    for (int j = 0; j < stacks; ++j) {
+        float b0 = 0.5f * (float)M_PI * j / stacks, b1 = 0.5f * (float)M_PI * (j + 1) / stacks;
+        for (int i = 0; i < slices; ++i) {
+            float a0 = 2.0f * (float)M_PI * i / slices, a1 = 2.0f * (float)M_PI * (i + 1) / slices;
+            float quad[4][2] = { {a0, b0}, {a1, b0}, {a1, b1}, {a0, b1} };
+            float p[4][6];
+            for (int k = 0; k < 4; ++k) {
+                float ca = std::cos(quad[k][0]), sa = std::sin(quad[k][0]);
+                float cb = std::cos(quad[k][1]), sb = std::sin(quad[k][1]);
+                p[k][0] = radius * cb * ca; p[k][1] = height * sb; p[k][2] = radius * cb * sa;
+                p[k][3] = cb * ca / radius; p[k][4] = sb / height; p[k][5] = cb * sa / radius;
+                float len = std::sqrt(p[k][3] * p[k][3] + p[k][4] * p[k][4] + p[k][5] * p[k][5]);
+                p[k][3] /= len; p[k][4] /= len; p[k][5] /= len;
+            }
+            int order[6] = { 0, 2, 1, 0, 3, 2 };
+            for (int t = 0; t < 6; ++t) {
+                const float* q = p[order[t]];
+                pushVertex(q[0], q[1], q[2], q[3], q[4], q[5], color);
+            }
+        }
+    }
+}
+
+static void buildMeshes() {
+    meshVerts.clear();
+
+    // Conifer: same proportions as the original drawTree()
+    static const float wood[3] = { 0.4f, 0.26f, 0.13f };
+    static const float needles[3] = { 0.05f, 0.4f, 0.05f };
+    meshFirst[SPECIES_CONIFER] = (int)meshVerts.size();
+    addBox(0.0f, 2.0f, 0.0f, 1.5f, 4.0f, 1.5f, wood);
+    addCone(4.0f, 5.0f, 6.0f, 10, needles);
+    addCone(6.5f, 4.0f, 5.5f, 10, needles);
+    addCone(9.0f, 2.5f, 5.0f, 10, needles);
+    meshCount[SPECIES_CONIFER] = (int)meshVerts.size() - meshFirst[SPECIES_CONIFER];
+
+    static const float leaves[3] = { 0.16f, 0.46f, 0.1f };
+    meshFirst[SPECIES_SHRUB] = (int)meshVerts.size();
+    addDome(2.4f, 2.8f, 10, 3, leaves);
+    meshCount[SPECIES_SHRUB] = (int)meshVerts.size() - meshFirst[SPECIES_SHRUB];
+
+    // Unit billboard corners for the impostor pass, as a triangle strip
+    static const float none[3] = { 0.0f, 0.0f, 0.0f };
+    quadFirst = (int)meshVerts.size();
+    pushVertex(-1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, none);
+    pushVertex( 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, none);
+    pushVertex(-1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, none);
+    pushVertex( 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, none);
+}
+
+static void drawMeshImmediate(int species) {
+    glBegin(GL_TRIANGLES);
+    for (int i = meshFirst[species]; i < meshFirst[species] + meshCount[species]; ++i) {
+        const VegVertex& v = meshVerts[i];
+        glColor3ub(v.color[0], v.color[1], v.color[2]);
+        glNormal3fv(v.normal);
+        glVertex3fv(v.pos);
+    }
+    glEnd();
+}
+
+// **********************************************
+// ************ SCATTERING **********************
+// **********************************************
+
+static unsigned int rngState = 0x9E3779B9u;
+
+static unsigned int nextRandom() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+static float randomUnit() {
+    return (nextRandom() & 0xFFFFFF) / (float)0x1000000;
+}
+
+static float latticeValue(int x, int z, unsigned int seed) {
+    unsigned int h = (unsigned int)x * 374761393u + (unsigned int)z * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return ((h ^ (h >> 16)) & 0xFFFF) / 65535.0f;
+}
+
+static float valueNoise(float x, float z, unsigned int seed) {
+    int ix = (int)std::floor(x), iz = (int)std::floor(z);
+    float fx = x - ix, fz = z - iz;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fz = fz * fz * (3.0f - 2.0f * fz);
+    float a = latticeValue(ix, iz, seed), b = latticeValue(ix + 1, iz, seed);
+    float c = latticeValue(ix, iz + 1, seed), d = latticeValue(ix + 1, iz + 1, seed);
+    return (a + (b - a) * fx) + ((c + (d - c) * fx) - (a + (b - a) * fx)) * fz;
+}
+
+static float smoothStep(float e0, float e1, float x) {
+    float t = (x - e0) / (e1 - e0);
+    t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// 0 where nothing may grow: the bowl and its apron, the gate approaches,
+// the grandstand behind the bowl and the floodlight tower bases.
+static float plantableMask(float x, float z) {
+    float ex = x / (MAX_SEATING_X_RADIUS + 22.0f), ez = z / (MAX_SEATING_Z_RADIUS + 22.0f);
+    float e = ex * ex + ez * ez;
+    if (e < 1.0f) return 0.0f;
+
+    float angleDeg = std::atan2(z, x) * 180.0f / (float)M_PI;
+    if (angleDeg < 0.0f) angleDeg += 360.0f;
+    if (inGateClearance(angleDeg, TREE_GATE_CLEARANCE_DEGREES)) return 0.0f;
+
+    if (std::fabs(x) < MAIN_GRANDSTAND_WIDTH / 2.0f + 6.0f && z < 0.0f && z > -MAX_SEATING_Z_RADIUS - 52.0f)
+        return 0.0f;
+
+    for (int i = 0; i < NUM_FLOODLIGHT_TOWERS; ++i) {
+        float dx = x - FLOODLIGHT_TOWERS[i].x, dz = z - FLOODLIGHT_TOWERS[i].z;
+        if (dx * dx + dz * dz < 12.0f * 12.0f) return 0.0f;
+    }
+
+    float edge = 1.0f - smoothStep(VEG_EXTENT - 30.0f, VEG_EXTENT, std::max(std::fabs(x), std::fabs(z)));
+    return smoothStep(1.0f, 1.5f, e) * edge;
+}
+
+// Density map per species: clumpy woods for conifers, scattered shrubs at their margins
+static void buildDensityMap(int species, std::vector<unsigned char>& map) {
+    map.resize(VEG_MAP_SIZE * VEG_MAP_SIZE);
+    for (int j = 0; j < VEG_MAP_SIZE; ++j) {
+        for (int i = 0; i < VEG_MAP_SIZE; ++i) {
+            float x = ((i + 0.5f) / VEG_MAP_SIZE * 2.0f - 1.0f) * VEG_EXTENT;
+            float z = ((j + 0.5f) / VEG_MAP_SIZE * 2.0f - 1.0f) * VEG_EXTENT;
+            float n = 0.55f * valueNoise(x / 60.0f, z / 60.0f, 1) +
+                      0.3f * valueNoise(x / 25.0f, z / 25.0f, 2) +
+                      0.15f * valueNoise(x / 10.0f, z / 10.0f, 3);
+            float d = (species == SPECIES_CONIFER) ? smoothStep(0.4f, 0.7f, n)
+                                                   : smoothStep(0.25f, 0.45f, n) * (1.0f - smoothStep(0.6f, 0.75f, n));
+            map[j * VEG_MAP_SIZE + i] = (unsigned char)(255.0f * d * plantableMask(x, z));
+        }
+    }
+}
+
+static float sampleDensity(const std::vector<unsigned char>& map, float x, float z) {
+    int i = (int)((x / VEG_EXTENT + 1.0f) * 0.5f * VEG_MAP_SIZE);
+    int j = (int)((z / VEG_EXTENT + 1.0f) * 0.5f * VEG_MAP_SIZE);
+    if (i < 0 || j < 0 || i >= VEG_MAP_SIZE || j >= VEG_MAP_SIZE) return 0.0f;
+    return map[j * VEG_MAP_SIZE + i] / 255.0f;
+}
+
+static VegetationInstance makeInstance(float x, float z, int species) {
+    VegetationInstance v;
+    v.x = (short)(x / VEG_POSITION_STEP);
+    v.z = (short)(z / VEG_POSITION_STEP);
+    v.scale = (unsigned char)(nextRandom() & 0xFF);
+    v.rotation = (unsigned char)(nextRandom() & 0xFF);
+    v.species = (unsigned char)species;
+    v.tint = (unsigned char)(nextRandom() & 0xFF);
+    return v;
+}
+
+// Jittered grid a little denser than the target needs, then a random subset
+// is kept so the count matches without favouring one side of the map.
+static void scatterSpecies(int species, int target) {
+    std::vector<unsigned char> map;
+    buildDensityMap(species, map);
+
+    double mean = 0.0;
+    for (size_t i = 0; i < map.size(); ++i) mean += map[i] / 255.0;
+    mean /= map.size();
+    if (mean <= 0.0 || target <= 0) return;
+
+    float area = 4.0f * VEG_EXTENT * VEG_EXTENT;
+    float spacing = 0.9f * std::sqrt(area * (float)mean / target);
+    int steps = (int)(2.0f * VEG_EXTENT / spacing);
+    std::vector<VegetationInstance> candidates;
+    for (int j = 0; j < steps; ++j) {
+        for (int i = 0; i < steps; ++i) {
+            float x = -VEG_EXTENT + (i + randomUnit()) * spacing;
+            float z = -VEG_EXTENT + (j + randomUnit()) * spacing;
+            if (randomUnit() >= sampleDensity(map, x, z)) continue;
+            if (plantableMask(x, z) <= 0.0f) continue; // exact edge, the map is coarse
+            candidates.push_back(makeInstance(x, z, species));
+        }
+    }
+
+    int keep = std::min(target, (int)candidates.size());
+    for (int i = 0; i < keep; ++i) {
+        int pick = i + (int)(nextRandom() % (unsigned int)(candidates.size() - i));
+        std::swap(candidates[i], candidates[pick]);
+        instances.push_back(candidates[i]);
+    }
+}
+
+static int cellIndexOf(const VegetationInstance& v) {
+    int cx = (int)((v.x * VEG_POSITION_STEP + VEG_EXTENT) / VEG_CELL_SIZE);
+    int cz = (int)((v.z * VEG_POSITION_STEP + VEG_EXTENT) / VEG_CELL_SIZE);
+    cx = cx < 0 ? 0 : (cx >= VEG_CELLS ? VEG_CELLS - 1 : cx);
+    cz = cz < 0 ? 0 : (cz >= VEG_CELLS ? VEG_CELLS - 1 : cz);
+    return cz * VEG_CELLS + cx;
+}
+
+static bool byCellThenSpecies(const VegetationInstance& a, const VegetationInstance& b) {
+    int ca = cellIndexOf(a), cb = cellIndexOf(b);
+    if (ca != cb) return ca < cb;
+    return a.species < b.species;
+}
+
+// Sorts the instances so each cell's plants of one species are contiguous
+static void buildCells() {
+    std::sort(instances.begin(), instances.end(), byCellThenSpecies);
+    cells.clear();
+    int lastCell = -1;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const VegetationInstance& v = instances[i];
+        int c = cellIndexOf(v);
+        if (c != lastCell) {
+            VegCell cell;
+            for (int s = 0; s < NUM_SPECIES; ++s) { cell.first[s] = (int)i; cell.count[s] = 0; }
+            float x0 = (c % VEG_CELLS) * VEG_CELL_SIZE - VEG_EXTENT;
+            float z0 = (c / VEG_CELLS) * VEG_CELL_SIZE - VEG_EXTENT;
+            // Canopies may hang over the cell edge
+            makeBounds(cell.bounds, x0 - 7.0f, 0.0f, z0 - 7.0f,
+                       x0 + VEG_CELL_SIZE + 7.0f, SPECIES_HEIGHT[SPECIES_CONIFER] * 1.4f, z0 + VEG_CELL_SIZE + 7.0f);
+            cells.push_back(cell);
+            lastCell = c;
+        }
+        VegCell& cell = cells.back();
+        if (cell.count[v.species] == 0) cell.first[v.species] = (int)i;
+        ++cell.count[v.species];
+    }
+}
+
+// **********************************************
+// ************ SHADERS *************************
+// **********************************************
+
+static const char* const VEG_ATTRIBUTES[] = { "aPosition", "aNormal", "aColor", "aInstance", "aParams", 0 };
+
+// Rotation and scale per instance, then the same single-light model the
+// fixed-function path uses with GL_COLOR_MATERIAL.
+static const char* MESH_VS =
+    "#version 120\n"
+    "attribute vec3 aPosition;\n"
+    "attribute vec3 aNormal;\n"
+    "attribute vec4 aColor;\n"
+    "attribute vec2 aInstance;\n"
+    "attribute vec4 aParams;\n"
+    "uniform float uPositionStep;\n"
+    "uniform float uRotationStep;\n" // radians per rotation byte
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "    float scale = 0.6 + aParams.x * 0.8;\n"
+    "    float angle = aParams.y * 255.0 * uRotationStep;\n"
+    "    float c = cos(angle), s = sin(angle);\n"
+    "    vec3 p = aPosition * scale;\n"
+    "    vec3 world = vec3(c * p.x + s * p.z, p.y, -s * p.x + c * p.z) +\n"
+    "                 vec3(aInstance.x * uPositionStep, 0.0, aInstance.y * uPositionStep);\n"
+    "    vec3 n = vec3(c * aNormal.x + s * aNormal.z, aNormal.y, -s * aNormal.x + c * aNormal.z);\n"
+    "    vec4 eyePos = gl_ModelViewMatrix * vec4(world, 1.0);\n"
+    "    gl_Position = gl_ProjectionMatrix * eyePos;\n"
+    "    vec3 N = normalize(gl_NormalMatrix * n);\n"
+    "    vec3 L = normalize(gl_LightSource[0].position.xyz - eyePos.xyz);\n"
+    "    vec3 base = aColor.rgb * (0.75 + aParams.w * 0.5);\n"
+    "    vec3 lit = base * (gl_LightModel.ambient.rgb + gl_LightSource[0].ambient.rgb) +\n"
+    "               base * gl_LightSource[0].diffuse.rgb * max(dot(N, L), 0.0);\n"
+    "    vColor = vec4(lit, 1.0);\n"
+    "}\n";
+
+static const char* MESH_FS =
+    "#version 120\n"
+    "varying vec4 vColor;\n"
+    "void main() { gl_FragColor = vColor; }\n";
+
+// Cylindrical billboard; the atlas column is the view direction in the
+// plant's own frame, so rotated instances still show the right side.
+static const char* IMPOSTOR_VS =
+    "#version 120\n"
+    "attribute vec3 aPosition;\n"
+    "attribute vec2 aInstance;\n"
+    "attribute vec4 aParams;\n"
+    "uniform float uPositionStep;\n"
+    "uniform float uRotationStep;\n"
+    "uniform vec3 uEye;\n"
+    "uniform vec2 uSize;\n"   // half width, height
+    "uniform float uRow;\n"
+    "uniform vec2 uAtlasGrid;\n" // views, species
+    "varying vec2 vUV;\n"
+    "varying float vTint;\n"
+    "void main() {\n"
+    "    float scale = 0.6 + aParams.x * 0.8;\n"
+    "    vec3 centre = vec3(aInstance.x * uPositionStep, 0.0, aInstance.y * uPositionStep);\n"
+    "    vec2 d = uEye.xz - centre.xz;\n"
+    "    d = d / max(length(d), 0.001);\n"
+    "    vec3 right = vec3(d.y, 0.0, -d.x);\n"
+    "    vec3 world = centre + right * (aPosition.x * uSize.x * scale) + vec3(0.0, aPosition.y * uSize.y * scale, 0.0);\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(world, 1.0);\n"
+    "    float localAngle = atan(d.y, d.x) + aParams.y * 255.0 * uRotationStep;\n"
+    "    float column = mod(floor(localAngle / 6.2831853 * uAtlasGrid.x + 0.5), uAtlasGrid.x);\n"
+    "    vUV = vec2((column + aPosition.x * 0.5 + 0.5) / uAtlasGrid.x, (uRow + aPosition.y) / uAtlasGrid.y);\n"
+    "    vTint = 0.75 + aParams.w * 0.5;\n"
+    "}\n";
+
+static const char* IMPOSTOR_FS =
+    "#version 120\n"
+    "uniform sampler2D uAtlas;\n"
+    "varying vec2 vUV;\n"
+    "varying float vTint;\n"
+    "void main() {\n"
+    "    vec4 c = texture2D(uAtlas, vUV);\n"
+    "    if (c.a < 0.5) discard;\n"
+    "    gl_FragColor = vec4(c.rgb * vTint, 1.0);\n"
+    "}\n";
+
+// **********************************************
+// ************ IMPOSTOR ATLAS ******************
+// **********************************************
+
+// Renders every species from IMPOSTOR_VIEWS directions into one texture with
+// the fixed-function pipeline, so impostors match the near meshes.
+static bool renderImpostorAtlas() {
+    if (!glExt.hasFramebuffers) return false;
+    int atlasW = IMPOSTOR_VIEWS * IMPOSTOR_TILE, atlasH = NUM_SPECIES * IMPOSTOR_TILE;
+
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasW, atlasH, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    GLuint fbo, depth;
+    glExt.GenRenderbuffers(1, &depth);
+    glExt.BindRenderbuffer(GL_RENDERBUFFER, depth);
+    glExt.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, atlasW, atlasH);
+    glExt.GenFramebuffers(1, &fbo);
+    glExt.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glExt.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlasTexture, 0);
+    glExt.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    bool ok = glExt.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (ok) {
+        GLfloat clearColor[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glViewport(0, 0, atlasW, atlasH);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        for (int s = 0; s < NUM_SPECIES; ++s) {
+            float halfW = SPECIES_HALF_WIDTH[s], height = SPECIES_HEIGHT[s];
+            for (int k = 0; k < IMPOSTOR_VIEWS; ++k) {
+                glViewport(k * IMPOSTOR_TILE, s * IMPOSTOR_TILE, IMPOSTOR_TILE, IMPOSTOR_TILE);
+                glMatrixMode(GL_PROJECTION);
+                glLoadIdentity();
+                glOrtho(-halfW, halfW, 0.0, height, 1.0, 100.0);
+                glMatrixMode(GL_MODELVIEW);
+                glLoadIdentity();
+                float angle = 2.0f * (float)M_PI * k / IMPOSTOR_VIEWS;
+                gluLookAt(50.0f * std::cos(angle), 0.0f, 50.0f * std::sin(angle),
+                          0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+                drawMeshImmediate(s);
+            }
+        }
+
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        glViewport(0, 0, windowWidth, windowHeight);
+
+        // Mip chain so distant impostors don't shimmer
+        std::vector<unsigned char> pixels((size_t)atlasW * atlasH * 4);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        gluBuild2DMipmaps(GL_TEXTURE_2D, GL_RGBA8, atlasW, atlasH, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glExt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glExt.DeleteFramebuffers(1, &fbo);
+    glExt.DeleteRenderbuffers(1, &depth);
+    if (!ok) {
+        glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+    }
+    return ok;
+}
+
+// **********************************************
+// ************ SETUP ***************************
+// **********************************************
+
+void initVegetation(int targetCount) {
+    instances.clear();
+    rngState = 0x9E3779B9u;
+
+    // The original ring of trees comes first so it always survives
+    for (int i = 0; i < NUM_SURROUNDING_TREES; ++i) {
+        float x, z;
+        if (!surroundingTreePosition(i, x, z)) continue;
+        VegetationInstance v = makeInstance(x, z, SPECIES_CONIFER);
+        v.scale = 128; v.rotation = 0; v.tint = 128;
+        instances.push_back(v);
+    }
+    int remaining = targetCount - (int)instances.size();
+    if (remaining > 0) {
+        int shrubs = (int)(remaining * VEG_SHRUB_SHARE);
+        scatterSpecies(SPECIES_CONIFER, remaining - shrubs);
+        scatterSpecies(SPECIES_SHRUB, shrubs);
+    }
+    buildCells();
+    buildMeshes();
+
+    if (glExt.hasInstancing) {
+        glExt.GenBuffers(1, &meshBuffer);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, meshVerts.size() * sizeof(VegVertex), &meshVerts[0], GL_STATIC_DRAW);
+        glExt.GenBuffers(1, &instanceBuffer);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glExt.BufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(VegetationInstance),
+                         instances.empty() ? 0 : &instances[0], GL_STATIC_DRAW);
+        glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+        meshProgram = buildShaderProgram("vegetation mesh", MESH_VS, MESH_FS, VEG_ATTRIBUTES);
+        if (renderImpostorAtlas())
+            impostorProgram = buildShaderProgram("vegetation impostor", IMPOSTOR_VS, IMPOSTOR_FS, VEG_ATTRIBUTES);
+
+        if (meshProgram) {
+            glExt.UseProgram(meshProgram);
+            glExt.Uniform1f(glExt.GetUniformLocation(meshProgram, "uPositionStep"), VEG_POSITION_STEP);
+            glExt.Uniform1f(glExt.GetUniformLocation(meshProgram, "uRotationStep"), VEG_ROTATION_STEP_DEG * DEG_TO_RAD);
+        }
+        if (impostorProgram) {
+            glExt.UseProgram(impostorProgram);
+            glExt.Uniform1f(glExt.GetUniformLocation(impostorProgram, "uPositionStep"), VEG_POSITION_STEP);
+            glExt.Uniform1f(glExt.GetUniformLocation(impostorProgram, "uRotationStep"), VEG_ROTATION_STEP_DEG * DEG_TO_RAD);
+            glExt.Uniform1i(glExt.GetUniformLocation(impostorProgram, "uAtlas"), 0);
+            glExt.Uniform2f(glExt.GetUniformLocation(impostorProgram, "uAtlasGrid"),
+                            (float)IMPOSTOR_VIEWS, (float)NUM_SPECIES);
+            impostorEyeLoc = glExt.GetUniformLocation(impostorProgram, "uEye");
+            impostorSizeLoc = glExt.GetUniformLocation(impostorProgram, "uSize");
+            impostorRowLoc = glExt.GetUniformLocation(impostorProgram, "uRow");
+        }
+        glExt.UseProgram(0);
+    }
+
+    if (!meshProgram) {
+        // No instancing: one display list per species, placed per plant
+        for (int s = 0; s < NUM_SPECIES; ++s) {
+            fallbackLists[s] = glGenLists(1);
+            glNewList(fallbackLists[s], GL_COMPILE);
+            drawMeshImmediate(s);
+            glEndList();
+        }
+    }
+
+    ready = true;
+    std::cout << "Vegetation: " << instances.size() << " plants in " << cells.size() << " cells, "
+              << sizeof(VegetationInstance) << " bytes each"
+              << (meshProgram ? ", instanced" : ", display lists")
+              << (impostorProgram ? " + impostors" : "") << std::endl;
+}
+
+int vegetationInstanceCount() {
+    return (int)instances.size();
+}
+
+int vegetationCellCount() {
+    return (int)cells.size();
+}
+
+const Bounds& vegetationCellBounds(int cell) {
+    return cells[cell].bounds;
+}
+
+// **********************************************
+// ************ DRAWING *************************
+// **********************************************
+
+static void bindInstanceAttributes(int firstInstance) {
+    glExt.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    const char* base = (const char*)0 + firstInstance * sizeof(VegetationInstance);
+    glExt.VertexAttribPointer(3, 2, GL_SHORT, GL_FALSE, sizeof(VegetationInstance), base);
+    glExt.VertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VegetationInstance),
+                              base + offsetof(VegetationInstance, scale));
+}
+
+static void beginInstancedPass(GLuint program, bool withNormalsAndColors) {
+    glExt.UseProgram(program);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+    glExt.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VegVertex), (const void*)offsetof(VegVertex, pos));
+    glExt.EnableVertexAttribArray(0);
+    if (withNormalsAndColors) {
+        glExt.VertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VegVertex), (const void*)offsetof(VegVertex, normal));
+        glExt.VertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(VegVertex), (const void*)offsetof(VegVertex, color));
+        glExt.EnableVertexAttribArray(1);
+        glExt.EnableVertexAttribArray(2);
+    }
+    glExt.EnableVertexAttribArray(3);
+    glExt.EnableVertexAttribArray(4);
+    glExt.VertexAttribDivisor(3, 1);
+    glExt.VertexAttribDivisor(4, 1);
+}
+
+static void endInstancedPass() {
+    glExt.VertexAttribDivisor(3, 0);
+    glExt.VertexAttribDivisor(4, 0);
+    for (int a = 0; a < 5; ++a) glExt.DisableVertexAttribArray(a);
+    glExt.BindBuffer(GL_ARRAY_BUFFER, 0);
+    glExt.UseProgram(0);
+}
+
+// Model matrices for a cell's plants are built in one batch, then each plant
+// is one glMultMatrixf instead of a translate, rotate and scale
+static void drawFallback(const int* visible, int visibleCount) {
+    for (int c = 0; c < visibleCount; ++c) {
+        const VegCell& cell = cells[visible[c]];
+        for (int s = 0; s < NUM_SPECIES; ++s) {
+            int count = cell.count[s];
+            if (!count) continue;
+            float* x = frameAllocArray<float>(count);
+            float* z = frameAllocArray<float>(count);
+            float* yaw = frameAllocArray<float>(count);
+            float* scale = frameAllocArray<float>(count);
+            float* matrices = frameAllocArray<float>(count * 16);
+            for (int k = 0; k < count; ++k) {
+                const VegetationInstance& v = instances[cell.first[s] + k];
+                x[k] = v.x * VEG_POSITION_STEP;
+                z[k] = v.z * VEG_POSITION_STEP;
+                yaw[k] = v.rotation * VEG_ROTATION_STEP_DEG;
+                scale[k] = 0.6f + v.scale / 255.0f * 0.8f;
+            }
+            composeYawTransforms(x, 0, z, yaw, scale, count, matrices);
+            for (int k = 0; k < count; ++k) {
+                glPushMatrix();
+                glMultMatrixf(matrices + k * 16);
+                glCallList(fallbackLists[s]);
+                glPopMatrix();
+            }
+        }
+    }
+}
+
+void drawVegetation(const float eye[3], const Frustum& frustum, const unsigned char* hiddenCells) {
+    if (!ready) return;
+
+    // --- Cull cells and pick mesh or impostor per cell ---
+    float impostorDistance = VEG_IMPOSTOR_DISTANCE * IMPOSTOR_DISTANCE_SCALE[governorDetailLevel()];
+    int* visibleMesh = frameAllocArray<int>(cells.size()); // per-view scratch
+    int* visibleImpostor = frameAllocArray<int>(cells.size());
+    int meshCells = 0, impostorCells = 0;
+    for (size_t c = 0; c < cells.size(); ++c) {
+        const VegCell& cell = cells[c];
+        if ((hiddenCells && hiddenCells[c]) || !boundsInFrustum(cell.bounds, frustum)) continue;
+        float cx = 0.5f * (cell.bounds.min[0] + cell.bounds.max[0]) - eye[0];
+        float cz = 0.5f * (cell.bounds.min[2] + cell.bounds.max[2]) - eye[2];
+        bool far = cx * cx + cz * cz > impostorDistance * impostorDistance;
+        if (far && impostorProgram) visibleImpostor[impostorCells++] = (int)c;
+        else visibleMesh[meshCells++] = (int)c;
+    }
+
+    long meshPlants = 0, impostorPlants = 0;
+    if (!meshProgram) {
+        drawFallback(visibleMesh, meshCells);
+        for (int c = 0; c < meshCells; ++c)
+            meshPlants += cells[visibleMesh[c]].count[0] + cells[visibleMesh[c]].count[1];
+        statsAdd(STAT_PLANTS_MESH, meshPlants);
+        return;
+    }
+
+    // --- Near cells: instanced meshes ---
+    if (meshCells) {
+        beginInstancedPass(meshProgram, true);
+        for (int c = 0; c < meshCells; ++c) {
+            const VegCell& cell = cells[visibleMesh[c]];
+            for (int s = 0; s < NUM_SPECIES; ++s) {
+                if (!cell.count[s]) continue;
+                bindInstanceAttributes(cell.first[s]);
+                glExt.DrawArraysInstanced(GL_TRIANGLES, meshFirst[s], meshCount[s], cell.count[s]);
+                meshPlants += cell.count[s];
+            }
+        }
+        endInstancedPass();
+    }
+
+    // --- Far cells: one billboard per plant from the atlas ---
+    if (impostorCells) {
+        beginInstancedPass(impostorProgram, false);
+        glExt.Uniform3f(impostorEyeLoc, eye[0], eye[1], eye[2]);
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        for (int s = 0; s < NUM_SPECIES; ++s) {
+            glExt.Uniform2f(impostorSizeLoc, SPECIES_HALF_WIDTH[s], SPECIES_HEIGHT[s]);
+            glExt.Uniform1f(impostorRowLoc, (float)s);
+            for (int c = 0; c < impostorCells; ++c) {
+                const VegCell& cell = cells[visibleImpostor[c]];
+                if (!cell.count[s]) continue;
+                bindInstanceAttributes(cell.first[s]);
+                glExt.DrawArraysInstanced(GL_TRIANGLE_STRIP, quadFirst, 4, cell.count[s]);
+                impostorPlants += cell.count[s];
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glDisable(GL_TEXTURE_2D);
+        endInstancedPass();
+    }
+
+    statsAdd(STAT_PLANTS_MESH, meshPlants);
+    statsAdd(STAT_PLANTS_IMPOSTOR, impostorPlants);
+}
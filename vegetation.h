@@ -0,0 +1,46 @@
+#ifndef VEGETATION_H
+#define VEGETATION_H
+
+#include "viewMath.h"
+
+// **********************************************
+// ************ PARK VEGETATION *****************
+// **********************************************
+
+// Thousands of trees and shrubs scattered around the stadium by density
+// maps. Close cells are drawn as instanced low-poly meshes, distant cells as
+// camera-facing impostors cut from an atlas rendered once at start-up.
+
+enum VegetationSpecies {
+    SPECIES_CONIFER, // the three-cone tree that used to ring the stadium
+    SPECIES_SHRUB,
+    NUM_SPECIES
+};
+
+// One plant, 8 bytes. Also the per-instance vertex attribute layout.
+struct VegetationInstance {
+    short x, z;              // world position in VEG_POSITION_STEP units
+    unsigned char scale;     // 0-255 -> 0.6-1.4
+    unsigned char rotation;  // VEG_ROTATION_STEP_DEG units, 255 = a full turn
+    unsigned char species;
+    unsigned char tint;      // foliage brightness 0-255 -> 0.75-1.25
+};
+
+const float VEG_POSITION_STEP = 0.05f;
+const float VEG_ROTATION_STEP_DEG = 360.0f / 255.0f;
+
+// Scatters targetCount plants and uploads the meshes, instances and
+// impostor atlas. Call once after loadGLExtensions().
+void initVegetation(int targetCount);
+
+// Draws every cell inside the frustum; eye picks mesh or impostor per cell.
+// hiddenCells, when not 0, has a byte per cell and non-zero cells are skipped.
+void drawVegetation(const float eye[3], const Frustum& frustum, const unsigned char* hiddenCells);
+
+int vegetationInstanceCount();
+
+// The culling cells, for occlusion tests
+int vegetationCellCount();
+const Bounds& vegetationCellBounds(int cell);
+
+#endif
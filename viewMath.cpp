@@ -0,0 +1,143 @@
+#include "viewMath.h"
+#include "simdMath.h"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+void perspectiveMatrix(float fovYDeg, float aspect, float zNear, float zFar, float m[16]) {
+    float f = 1.0f / std::tan(fovYDeg * (float)M_PI / 360.0f);
+    for (int i = 0; i < 16; ++i) m[i] = 0.0f;
+    m[0] = f / aspect;
+    m[5] = f;
+    m[10] = (zFar + zNear) / (zNear - zFar);
+    m[11] = -1.0f;
+    m[14] = (2.0f * zFar * zNear) / (zNear - zFar);
+}
+
+void lookAtMatrix(const float eye[3], const float target[3], const float up[3], float m[16]) {
+    float f[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+    float len = std::sqrt(f[0] * f[0] + f[1] * f[1] + f[2] * f[2]);
+    f[0] /= len; f[1] /= len; f[2] /= len;
+
+    // s = f x up, u = s x f
+    float s[3] = { f[1] * up[2] - f[2] * up[1], f[2] * up[0] - f[0] * up[2], f[0] * up[1] - f[1] * up[0] };
+    len = std::sqrt(s[0] * s[0] + s[1] * s[1] + s[2] * s[2]);
+    s[0] /= len; s[1] /= len; s[2] /= len;
+    float u[3] = { s[1] * f[2] - s[2] * f[1], s[2] * f[0] - s[0] * f[2], s[0] * f[1] - s[1] * f[0] };
+
+    m[0] = s[0]; m[4] = s[1]; m[8]  = s[2];
+    m[1] = u[0]; m[5] = u[1]; m[9]  = u[2];
+    m[2] = -f[0]; m[6] = -f[1]; m[10] = -f[2];
+    m[3] = 0.0f; m[7] = 0.0f; m[11] = 0.0f;
+    m[12] = -(s[0] * eye[0] + s[1] * eye[1] + s[2] * eye[2]);
+    m[13] = -(u[0] * eye[0] + u[1] * eye[1] + u[2] * eye[2]);
+    m[14] =  (f[0] * eye[0] + f[1] * eye[1] + f[2] * eye[2]);
+    m[15] = 1.0f;
+}
+
+void multiplyMatrices(const float a[16], const float b[16], float out[16]) {
+    multiplyMatrixBatch(a, b, 1, out);
+}
+
+static void identityMatrix(float m[16]) {
+    for (int i = 0; i < 16; ++i) m[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+}
+
+void translationMatrix(float x, float y, float z, float m[16]) {
+    identityMatrix(m);
+    m[12] = x; m[13] = y; m[14] = z;
+}
+
+void rotationMatrix(float deg, float ax, float ay, float az, float m[16]) {
+    float r = deg * (float)M_PI / 180.0f, c = std::cos(r), s = std::sin(r), t = 1.0f - c;
+    identityMatrix(m);
+    m[0] = t * ax * ax + c;      m[4] = t * ax * ay - s * az; m[8] = t * ax * az + s * ay;
+    m[1] = t * ax * ay + s * az; m[5] = t * ay * ay + c;      m[9] = t * ay * az - s * ax;
+    m[2] = t * ax * az - s * ay; m[6] = t * ay * az + s * ax; m[10] = t * az * az + c;
+}
+
+void scalingMatrix(float x, float y, float z, float m[16]) {
+    identityMatrix(m);
+    m[0] = x; m[5] = y; m[10] = z;
+}
+
+// Cofactor expansion, as in the MESA gluInvertMatrix
+bool invertMatrix(const float m[16], float out[16]) {
+    float inv[16];
+    inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+    if (det == 0.0f) return false;
+    det = 1.0f / det;
+    for (int i = 0; i < 16; ++i) out[i] = inv[i] * det;
+    return true;
+}
+
+// Gribb/Hartmann: each plane is row 3 of the matrix plus or minus row 0, 1 or 2
+void extractFrustum(const float m[16], Frustum& f) {
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 4; ++k) {
+            f.planes[i * 2][k]     = m[k * 4 + 3] + m[k * 4 + i];
+            f.planes[i * 2 + 1][k] = m[k * 4 + 3] - m[k * 4 + i];
+        }
+    }
+    for (int p = 0; p < 6; ++p) {
+        float* pl = f.planes[p];
+        float len = std::sqrt(pl[0] * pl[0] + pl[1] * pl[1] + pl[2] * pl[2]);
+        if (len > 0.0f) { pl[0] /= len; pl[1] /= len; pl[2] /= len; pl[3] /= len; }
+    }
+}
+
+// Box is outside when its most positive corner is behind any plane
+bool boundsInFrustum(const Bounds& b, const Frustum& f) {
+    for (int p = 0; p < 6; ++p) {
+        const float* pl = f.planes[p];
+        float x = pl[0] >= 0.0f ? b.max[0] : b.min[0];
+        float y = pl[1] >= 0.0f ? b.max[1] : b.min[1];
+        float z = pl[2] >= 0.0f ? b.max[2] : b.min[2];
+        if (pl[0] * x + pl[1] * y + pl[2] * z + pl[3] < 0.0f) return false;
+    }
+    return true;
+}
+
+void makeBounds(Bounds& b, float minX, float minY, float minZ, float maxX, float maxY, float maxZ) {
+    b.min[0] = minX; b.min[1] = minY; b.min[2] = minZ;
+    b.max[0] = maxX; b.max[1] = maxY; b.max[2] = maxZ;
+}
+
+void growBounds(Bounds& b, float x, float y, float z) {
+    if (x < b.min[0]) b.min[0] = x;
+    if (y < b.min[1]) b.min[1] = y;
+    if (z < b.min[2]) b.min[2] = z;
+    if (x > b.max[0]) b.max[0] = x;
+    if (y > b.max[1]) b.max[1] = y;
+    if (z > b.max[2]) b.max[2] = z;
+}
+
+Bounds ellipseArcBounds(float radiusX, float radiusZ, float startDeg, float endDeg, float y0, float y1) {
+    Bounds b;
+    makeBounds(b, 1e30f, y0, 1e30f, -1e30f, y1, -1e30f);
+    int steps = 32;
+    for (int i = 0; i <= steps; ++i) {
+        float angle = (startDeg + (endDeg - startDeg) * i / steps) * (float)M_PI / 180.0f;
+        growBounds(b, radiusX * std::cos(angle), y0, radiusZ * std::sin(angle));
+    }
+    return b;
+}
@@ -0,0 +1,40 @@
+#ifndef VIEW_MATH_H
+#define VIEW_MATH_H
+
+// **********************************************
+// ************ CAMERA / FRUSTUM MATH ***********
+// **********************************************
+
+// CPU copies of what gluPerspective/gluLookAt build, so culling never has to
+// read matrices back from GL. Matrices are column-major like OpenGL's.
+
+struct Bounds {
+    float min[3];
+    float max[3];
+};
+
+// Plane i is a*x + b*y + c*z + d >= 0 for points inside
+struct Frustum {
+    float planes[6][4];
+};
+
+void perspectiveMatrix(float fovYDeg, float aspect, float zNear, float zFar, float m[16]);
+void lookAtMatrix(const float eye[3], const float target[3], const float up[3], float m[16]);
+void multiplyMatrices(const float a[16], const float b[16], float out[16]); // out = a * b
+bool invertMatrix(const float m[16], float out[16]); // false if singular
+
+// What glTranslatef/glRotatef/glScalef multiply by
+void translationMatrix(float x, float y, float z, float m[16]);
+void rotationMatrix(float deg, float ax, float ay, float az, float m[16]); // unit axis
+void scalingMatrix(float x, float y, float z, float m[16]);
+
+void extractFrustum(const float viewProj[16], Frustum& f);
+bool boundsInFrustum(const Bounds& b, const Frustum& f);
+
+void makeBounds(Bounds& b, float minX, float minY, float minZ, float maxX, float maxY, float maxZ);
+void growBounds(Bounds& b, float x, float y, float z);
+
+// Bounds of an elliptical arc swept between two heights
+Bounds ellipseArcBounds(float radiusX, float radiusZ, float startDeg, float endDeg, float y0, float y1);
+
+#endif